@@ -229,6 +229,10 @@ Boolean portIdentityAllOnes(PortIdentity *portIdentity) {
 /*Local clock is becoming Master. Table 13 (9.3.5) of the spec.*/
 void m1(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 {
+	ParentDS parentPrevious = ptpClock->parentDS;
+	TimePropertiesDS tpPrevious = ptpClock->timePropertiesDS;
+	Integer8 delayReqPrevious = ptpClock->portDS.logMinDelayReqInterval;
+
 	/*Current data set update*/
 	ptpClock->currentDS.stepsRemoved = 0;
 	
@@ -271,6 +275,13 @@ void m1(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 	    ptpClock->timePropertiesDS.leap61 = FALSE;
 	}
 
+	/* m1 runs on every BMC pass as master - only changes invalidate management responses */
+	if(memcmp(&parentPrevious, &ptpClock->parentDS, sizeof(ParentDS)) ||
+	    memcmp(&tpPrevious, &ptpClock->timePropertiesDS, sizeof(TimePropertiesDS)) ||
+	    delayReqPrevious != ptpClock->portDS.logMinDelayReqInterval) {
+		ptpClock->datasetGeneration++;
+	}
+
 }
 
 
@@ -292,6 +303,9 @@ void s1(MsgHeader *header,MsgAnnounce *announce,PtpClock *ptpClock, const RunTim
 
 	Boolean firstUpdate = !cmpPortIdentity(&ptpClock->parentDS.parentPortIdentity, &ptpClock->portDS.portIdentity);
 	TimePropertiesDS tpPrevious = ptpClock->timePropertiesDS;
+	ParentDS parentPrevious = ptpClock->parentDS;
+	Integer8 announcePrevious = ptpClock->portDS.logAnnounceInterval;
+	UInteger8 domainPrevious = ptpClock->defaultDS.domainNumber;
 
 	Boolean previousLeap59 = FALSE;
 	Boolean previousLeap61 = FALSE;
@@ -389,6 +403,14 @@ void s1(MsgHeader *header,MsgAnnounce *announce,PtpClock *ptpClock, const RunTim
 	    SET_ALARM(ALRM_TIMEPROP_CHANGE, TRUE);
 	} 
 
+	/* s1 runs on every Announce from the parent - only changes invalidate management responses */
+	if(memcmp(&parentPrevious, &ptpClock->parentDS, sizeof(ParentDS)) ||
+	    memcmp(&tpPrevious, &ptpClock->timePropertiesDS, sizeof(TimePropertiesDS)) ||
+	    announcePrevious != ptpClock->portDS.logAnnounceInterval ||
+	    domainPrevious != ptpClock->defaultDS.domainNumber) {
+		ptpClock->datasetGeneration++;
+	}
+
 	/* non-slave logic done, exit if not slave */
         if (ptpClock->portDS.portState != PTP_SLAVE) {
 		return;
@@ -758,11 +780,13 @@ bmc(ForeignMasterRecord *foreignMaster,
     const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 {
 	Integer16 i,best;
+	UInteger8 state;
 
 	DBGV("number_foreign_records : %d \n", ptpClock->number_foreign_records);
 	if (!ptpClock->number_foreign_records)
 		if (ptpClock->portDS.portState == PTP_MASTER)	{
 			m1(rtOpts,ptpClock);
+			PTPD_PROBE3(bmc__decision, 0, -1, ptpClock->portDS.portState);
 			return ptpClock->portDS.portState;
 		}
 
@@ -774,6 +798,8 @@ bmc(ForeignMasterRecord *foreignMaster,
 	DBGV("Best record : %d \n",best);
 	ptpClock->foreign_record_best = best;
 	ptpClock->bestMaster = &foreignMaster[best];
-	return (bmcStateDecision(ptpClock->bestMaster,
-				 rtOpts,ptpClock));
+	state = bmcStateDecision(ptpClock->bestMaster, rtOpts, ptpClock);
+
+	PTPD_PROBE3(bmc__decision, ptpClock->number_foreign_records, best, state);
+	return state;
 }
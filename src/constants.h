@@ -107,7 +107,8 @@ section 7.6.2.5, page 56:
 #define DEFAULT_CLOCK_VARIANCE			0xFFFF                                            
 
 #define UNICAST_MESSAGEINTERVAL 0x7F
-#define MAX_FOLLOWUP_GAP 3
+/* in-flight Sync / Delay_Req exchanges tracked by sequenceId - 2 s worth at 128 Hz, power of 2 */
+#define EXCHANGE_TABLE_SIZE 256
 #define DEFAULT_MAX_FOREIGN_RECORDS  	5
 #define DEFAULT_PARENTS_STATS			FALSE
 
@@ -139,6 +140,49 @@ section 7.6.2.5, page 56:
 #define TL_LENGTH					4
 /** \}*/
 
+/** \name Send templates
+ Pre-packed messages kept in PtpClock, patched in place on send (dep/msg.c)*/
+ /**\{*/
+enum {
+	MSG_TEMPLATE_SYNC = 0,
+	MSG_TEMPLATE_FOLLOW_UP,
+	MSG_TEMPLATE_DELAY_RESP,
+	MSG_TEMPLATE_ANNOUNCE,
+	MSG_TEMPLATE_MAX
+};
+#define MSG_TEMPLATE_LENGTH				ANNOUNCE_LENGTH
+/** \}*/
+
+/** \name Management response cache
+ Packed GET response TLVs kept in PtpClock, see handleManagement()*/
+ /**\{*/
+enum {
+	MM_CACHE_CLOCK_DESCRIPTION = 0,
+	MM_CACHE_USER_DESCRIPTION,
+	MM_CACHE_DEFAULT_DATA_SET,
+	MM_CACHE_PARENT_DATA_SET,
+	MM_CACHE_TIME_PROPERTIES_DATA_SET,
+	MM_CACHE_PORT_DATA_SET,
+	MM_CACHE_PRIORITY1,
+	MM_CACHE_PRIORITY2,
+	MM_CACHE_DOMAIN,
+	MM_CACHE_SLAVE_ONLY,
+	MM_CACHE_LOG_ANNOUNCE_INTERVAL,
+	MM_CACHE_ANNOUNCE_RECEIPT_TIMEOUT,
+	MM_CACHE_LOG_SYNC_INTERVAL,
+	MM_CACHE_VERSION_NUMBER,
+	MM_CACHE_CLOCK_ACCURACY,
+	MM_CACHE_UTC_PROPERTIES,
+	MM_CACHE_TRACEABILITY_PROPERTIES,
+	MM_CACHE_TIMESCALE_PROPERTIES,
+	MM_CACHE_UNICAST_NEGOTIATION_ENABLE,
+	MM_CACHE_DELAY_MECHANISM,
+	MM_CACHE_LOG_MIN_PDELAY_REQ_INTERVAL,
+	MM_CACHE_MAX
+};
+#define MM_CACHE_TLV_LENGTH				(PACKET_SIZE - MANAGEMENT_LENGTH)
+/** \}*/
+
 /*Enumeration defined in tables of the spec*/
 
 /**
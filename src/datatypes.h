@@ -92,12 +92,184 @@ typedef struct
 	uint32_t delaySMOutliersFound;	  /* Number of outliers found by the delaySM filter */
 #endif /* PTPD_STATISTICS */
 	uint32_t maxDelayDrops; /* number of samples dropped due to maxDelay threshold */
+	uint32_t logRecordsDropped; /* log records dropped because the log writer ring was full */
 
 	uint32_t messageSendRate;	/* RX message rate per sec */
 	uint32_t messageReceiveRate;	/* TX message rate per sec */
 
 } PtpdCounters;
 
+/*
+ * Descriptor table for PtpdCounters, the one list used wherever counters are
+ * exported by name (control socket, statistics segment, OpenMetrics):
+ * X(field, metric type, metric family, metric labels, metric help).
+ * Metric type NONE: not exported as a metric. Help text is only needed on
+ * the first counter of each family. Every PtpdCounters field must be listed.
+ */
+#ifdef PTPD_STATISTICS
+#define PTPD_STATISTICS_COUNTERS(X) \
+	X(delayMSOutliersFound, COUNTER, "ptpd_outliers", "filter=\"delay_ms\"", "Outliers found by the delay filters") \
+	X(delaySMOutliersFound, COUNTER, "ptpd_outliers", "filter=\"delay_sm\"", NULL)
+#else
+#define PTPD_STATISTICS_COUNTERS(X)
+#endif /* PTPD_STATISTICS */
+
+#define PTPD_COUNTERS(X) \
+	X(announceMessagesSent, COUNTER, "ptpd_messages_sent", "type=\"announce\"", "PTP messages sent") \
+	X(announceMessagesReceived, COUNTER, "ptpd_messages_received", "type=\"announce\"", "PTP messages received") \
+	X(syncMessagesSent, COUNTER, "ptpd_messages_sent", "type=\"sync\"", NULL) \
+	X(syncMessagesReceived, COUNTER, "ptpd_messages_received", "type=\"sync\"", NULL) \
+	X(followUpMessagesSent, COUNTER, "ptpd_messages_sent", "type=\"follow_up\"", NULL) \
+	X(followUpMessagesReceived, COUNTER, "ptpd_messages_received", "type=\"follow_up\"", NULL) \
+	X(delayReqMessagesSent, COUNTER, "ptpd_messages_sent", "type=\"delay_req\"", NULL) \
+	X(delayReqMessagesReceived, COUNTER, "ptpd_messages_received", "type=\"delay_req\"", NULL) \
+	X(delayRespMessagesSent, COUNTER, "ptpd_messages_sent", "type=\"delay_resp\"", NULL) \
+	X(delayRespMessagesReceived, COUNTER, "ptpd_messages_received", "type=\"delay_resp\"", NULL) \
+	X(pdelayReqMessagesSent, COUNTER, "ptpd_messages_sent", "type=\"pdelay_req\"", NULL) \
+	X(pdelayReqMessagesReceived, COUNTER, "ptpd_messages_received", "type=\"pdelay_req\"", NULL) \
+	X(pdelayRespMessagesSent, COUNTER, "ptpd_messages_sent", "type=\"pdelay_resp\"", NULL) \
+	X(pdelayRespMessagesReceived, COUNTER, "ptpd_messages_received", "type=\"pdelay_resp\"", NULL) \
+	X(pdelayRespFollowUpMessagesSent, COUNTER, "ptpd_messages_sent", "type=\"pdelay_resp_follow_up\"", NULL) \
+	X(pdelayRespFollowUpMessagesReceived, COUNTER, "ptpd_messages_received", "type=\"pdelay_resp_follow_up\"", NULL) \
+	X(signalingMessagesSent, COUNTER, "ptpd_messages_sent", "type=\"signaling\"", NULL) \
+	X(signalingMessagesReceived, COUNTER, "ptpd_messages_received", "type=\"signaling\"", NULL) \
+	X(managementMessagesSent, COUNTER, "ptpd_messages_sent", "type=\"management\"", NULL) \
+	X(managementMessagesReceived, COUNTER, "ptpd_messages_received", "type=\"management\"", NULL) \
+	X(foreignAdded, NONE, NULL, NULL, NULL) \
+	X(foreignCount, NONE, NULL, NULL, NULL) \
+	X(foreignRemoved, NONE, NULL, NULL, NULL) \
+	X(foreignOverflows, NONE, NULL, NULL, NULL) \
+	X(stateTransitions, COUNTER, "ptpd_state_transitions", NULL, "Port state changes") \
+	X(bestMasterChanges, COUNTER, "ptpd_best_master_changes", NULL, "Best master changes as result of BMC") \
+	X(announceTimeouts, COUNTER, "ptpd_announce_timeouts", NULL, "Announce receipt timeouts") \
+	X(discardedMessages, COUNTER, "ptpd_messages_discarded", NULL, "Messages discarded") \
+	X(unknownMessages, COUNTER, "ptpd_messages_unknown", NULL, "Messages of unknown type") \
+	X(ignoredAnnounce, COUNTER, "ptpd_announce_ignored", NULL, "Announce messages ignored") \
+	X(aclTimingMessagesDiscarded, COUNTER, "ptpd_acl_messages_discarded", "acl=\"timing\"", "Messages discarded by access lists") \
+	X(aclManagementMessagesDiscarded, COUNTER, "ptpd_acl_messages_discarded", "acl=\"management\"", NULL) \
+	X(messageRecvErrors, COUNTER, "ptpd_errors", "type=\"receive\"", "Message and protocol errors") \
+	X(messageSendErrors, COUNTER, "ptpd_errors", "type=\"send\"", NULL) \
+	X(messageFormatErrors, COUNTER, "ptpd_errors", "type=\"format\"", NULL) \
+	X(protocolErrors, COUNTER, "ptpd_errors", "type=\"protocol\"", NULL) \
+	X(versionMismatchErrors, COUNTER, "ptpd_errors", "type=\"version_mismatch\"", NULL) \
+	X(domainMismatchErrors, COUNTER, "ptpd_errors", "type=\"domain_mismatch\"", NULL) \
+	X(sequenceMismatchErrors, COUNTER, "ptpd_errors", "type=\"sequence_mismatch\"", NULL) \
+	X(delayMechanismMismatchErrors, COUNTER, "ptpd_errors", "type=\"delay_mechanism_mismatch\"", NULL) \
+	X(consecutiveSequenceErrors, GAUGE, "ptpd_consecutive_sequence_errors", NULL, "Current run of sequence mismatch errors") \
+	X(unicastGrantsRequested, COUNTER, "ptpd_unicast_grants", "event=\"requested\"", "Unicast negotiation events") \
+	X(unicastGrantsGranted, COUNTER, "ptpd_unicast_grants", "event=\"granted\"", NULL) \
+	X(unicastGrantsDenied, COUNTER, "ptpd_unicast_grants", "event=\"denied\"", NULL) \
+	X(unicastGrantsCancelSent, COUNTER, "ptpd_unicast_grants", "event=\"cancel_sent\"", NULL) \
+	X(unicastGrantsCancelReceived, COUNTER, "ptpd_unicast_grants", "event=\"cancel_received\"", NULL) \
+	X(unicastGrantsCancelAckSent, COUNTER, "ptpd_unicast_grants", "event=\"cancel_ack_sent\"", NULL) \
+	X(unicastGrantsCancelAckReceived, COUNTER, "ptpd_unicast_grants", "event=\"cancel_ack_received\"", NULL) \
+	PTPD_STATISTICS_COUNTERS(X) \
+	X(maxDelayDrops, COUNTER, "ptpd_max_delay_drops", NULL, "Samples dropped due to the maxDelay threshold") \
+	X(logRecordsDropped, COUNTER, "ptpd_log_records_dropped", NULL, "Log records dropped because the log writer ring was full") \
+	X(messageSendRate, GAUGE, "ptpd_message_send_rate", NULL, "Messages sent per second") \
+	X(messageReceiveRate, GAUGE, "ptpd_message_receive_rate", NULL, "Messages received per second")
+
+#define PTPD_COUNTER_ENUM(field, type, family, labels, help) PTPD_COUNTER_##field,
+enum {
+	PTPD_COUNTERS(PTPD_COUNTER_ENUM)
+	PTPD_COUNTER_MAX
+};
+#undef PTPD_COUNTER_ENUM
+
+/* a PtpdCounters field missing from PTPD_COUNTERS() fails here */
+typedef char ptpdCountersCheck[(sizeof(PtpdCounters) == PTPD_COUNTER_MAX * sizeof(uint32_t)) ? 1 : -1];
+
+enum {
+	PTPD_METRIC_NONE = 0,
+	PTPD_METRIC_COUNTER,
+	PTPD_METRIC_GAUGE
+};
+
+typedef struct {
+	const char *name;	/* PtpdCounters field name */
+	size_t offset;
+	int metricType;
+	const char *metricFamily;
+	const char *metricLabels;
+	const char *metricHelp;
+} PtpdCounterInfo;
+
+/* hot path stages timed by the latency probes */
+enum {
+	LATENCY_RX_DISPATCH = 0,	/* receive timestamp to processMessage() */
+	LATENCY_RX_OFFSET,		/* receive timestamp to offset computed */
+	LATENCY_RX_SERVO,		/* receive timestamp to servo update done */
+	LATENCY_TX_SYNC,		/* SYNC_INTERVAL_TIMER deadline to issueSync() */
+	LATENCY_STAGE_MAX
+};
+
+/**
+ * \struct LatencyStage
+ * \brief Latency counters for one hot path stage, all in nanoseconds
+ */
+typedef struct {
+	uint32_t count;
+	uint32_t last;
+	uint32_t max;
+	uint64_t total;
+#ifdef PTPD_STATISTICS
+	/* percentiles, snapshotted every statistics update interval */
+	LogHistogram live;
+	LogHistogramSnapshot snapshot;
+#endif /* PTPD_STATISTICS */
+} LatencyStage;
+
+/**
+ * \struct LatencyProbes
+ * \brief Message processing and transmit scheduling latency
+ */
+typedef struct {
+	/* receive timestamp to dispatch, and monotonic time of dispatch */
+	uint32_t rxDispatch;
+	TimeInternal rxMonotonic;
+	/* Sync interval deadlines passed without a Sync being sent */
+	uint32_t syncOverruns;
+#ifdef PTPD_STATISTICS
+	int32_t snapshotTime;
+#endif /* PTPD_STATISTICS */
+	LatencyStage stages[LATENCY_STAGE_MAX];
+} LatencyProbes;
+
+/**
+ * \struct StatsLogAccumulator
+ * \brief Running summary of one statistics log quantity, in seconds
+ */
+typedef struct {
+	uint32_t count;
+	double min;
+	double max;
+	double mean;
+	double m2;		/* sum of squared differences from the mean */
+#ifdef PTPD_STATISTICS
+	LogHistogram histogram;	/* magnitudes, for percentiles */
+#endif /* PTPD_STATISTICS */
+} StatsLogAccumulator;
+
+/**
+ * \struct StatsLogAggregate
+ * \brief Statistics log interval summary, see global:statistics_log_mode
+ */
+typedef struct {
+	Boolean started;
+	Integer32 start;		/* interval start, seconds */
+	/* last sample fed, so a repeated log call does not count it twice */
+	char lastMessage;
+	UInteger16 lastSequenceId;
+	StatsLogAccumulator offset;
+	StatsLogAccumulator delay;
+	/* counter values at the interval start */
+	uint32_t sequenceErrors;
+#ifdef PTPD_STATISTICS
+	uint32_t delayMSOutliers;
+	uint32_t delaySMOutliers;
+#endif /* PTPD_STATISTICS */
+} StatsLogAggregate;
+
 /**
  * \struct PIservo
  * \brief PI controller model structure
@@ -135,6 +307,107 @@ typedef struct{
 #endif /* PTPD_STATISTICS */
 } PIservo;
 
+/**
+ * \struct ServoOffsetBuffer
+ * \brief Offsets queued between fixed-rate servo updates
+ */
+
+typedef struct {
+    int count;			/* offsets currently queued */
+    int head;			/* next slot */
+    Integer32 offset[SERVO_BUFFER_MAX];	/* offset from master, ns */
+    TimeInternal time[SERVO_BUFFER_MAX];	/* when the offset was computed */
+    UInteger32 overflows;	/* offsets overwritten before they were used */
+} ServoOffsetBuffer;
+
+#ifdef PTPD_STATISTICS
+/**
+ * \struct HoldoverModel
+ * \brief Frequency model built while locked, used to predict drift when master is lost
+ */
+
+typedef struct {
+    Boolean enabled;
+    Boolean active;		/* clock is in holdover - predicted frequency is being applied */
+    Boolean modelValid;		/* enough samples to produce a prediction */
+    int windowSize;		/* number of samples in the regression window */
+    int maxDuration;		/* seconds after which prediction is frozen, 0 = no limit */
+    int count;			/* samples currently in the window */
+    int head;			/* next sample slot */
+    double sampleTime[HOLDOVER_WINDOW_MAX];	/* sample time, seconds since epoch */
+    double sampleDrift[HOLDOVER_WINDOW_MAX];	/* mean observed drift, ppb */
+    TimeInternal epoch;		/* time origin for sample times */
+    /* regression result: drift(t) = driftIntercept + driftTrend * t */
+    double driftIntercept;	/* ppb */
+    double driftTrend;		/* ppb per second */
+    double driftResidual;	/* residual standard deviation, ppb */
+    double trendError;		/* standard error of the trend, ppb per second */
+    TimeInternal startTime;	/* when holdover was entered */
+    double entryOffset;		/* absolute offset from master when holdover was entered, ns */
+    double elapsed;		/* seconds in holdover */
+    double predictedDrift;	/* currently applied drift, ppb */
+    double timeError;		/* estimated time error accumulated since entry, ns */
+} HoldoverModel;
+#endif /* PTPD_STATISTICS */
+
+/**
+ * \struct PtpExchange
+ * \brief In-flight two-step Sync or Delay_Req, waiting for its Follow_Up / Delay_Resp
+ */
+
+typedef struct {
+    Boolean inUse;
+    UInteger16 sequenceId;
+    PortIdentity peer;			/* Sync sender / parent the Delay_Req went to */
+    TimeInternal timestamp;		/* Sync receive time / Delay_Req send time */
+    TimeInternal correctionField;	/* Sync correctionField, added to the Follow_Up's */
+} PtpExchange;
+
+/**
+ * \struct MsgTemplate
+ * \brief Pre-packed outgoing message, rebuilt from the datasets when invalidated
+ */
+
+typedef struct {
+    Boolean valid;
+    Octet buf[MSG_TEMPLATE_LENGTH];
+} MsgTemplate;
+
+/**
+ * \struct MMCacheEntry
+ * \brief Packed management GET response TLV, valid while its generation is current
+ */
+
+typedef struct {
+    UInteger32 generation;
+    UInteger16 length;
+    Octet buf[MM_CACHE_TLV_LENGTH];
+} MMCacheEntry;
+
+/**
+ * \struct MsgArena
+ * \brief Bump allocator for management and signaling TLVs, released per TLV / message
+ */
+
+typedef struct {
+    union {
+	Octet buf[MSG_ARENA_SIZE];
+	void *alignPtr;
+	double alignDouble;
+    } data;
+    size_t used;
+} MsgArena;
+
+/**
+ * \struct MsgView
+ * \brief Length-validated read-only view of a received message, see dep/msgview.h
+ */
+
+typedef struct {
+    const Octet *buf;
+    ssize_t length;
+} MsgView;
+
 typedef struct {
 	Boolean activity; 		/* periodic check, updateClock sets this to let the watchdog know we're holding clock control */
 	Boolean	available; 	/* flags that we can control the clock */
@@ -210,6 +483,47 @@ typedef struct {
     Integer32 transportAddress;
 } SyncDestEntry;
 
+/**
+ * \struct WarmStartGrant
+ * \brief Unicast grant received from the parent, as saved in the state file
+ */
+
+typedef struct {
+    Boolean granted;
+    Integer8 logInterval;	/* interval we got granted */
+    UInteger32 duration;	/* grant duration */
+    UInteger32 timeLeft;	/* time left when the snapshot was taken */
+} WarmStartGrant;
+
+/**
+ * \struct WarmStartState
+ * \brief Learned slave state saved to the state file and restored on restart, see dep/warmstart.c
+ */
+
+typedef struct {
+    UInteger32 savedAt;		/* seconds since epoch */
+    UInteger32 flags;		/* WARMSTART_* */
+    ClockIdentity clockIdentity;	/* our own - a snapshot of another clock is ignored */
+    UInteger8 domainNumber;
+    Enumeration8 delayMechanism;
+    /* parent */
+    PortIdentity parentPortIdentity;
+    ClockIdentity grandmasterIdentity;
+    Integer32 parentAddress;
+    /* filtered mean path delay (E2E) or peer mean path delay (P2P), ns */
+    Integer32 meanPathDelay;
+    /* servo: observed drift is the PI integrator */
+    double observedDrift;
+    double driftMean;
+    double driftStdDev;
+    /* outlier filter thresholds, after auto-tuning */
+    double oFilterMSThreshold;
+    double oFilterSMThreshold;
+    /* UTC offset, leap second and traceability flags */
+    TimePropertiesDS timePropertiesDS;
+    WarmStartGrant grants[PTP_MAX_MESSAGE_INDEXED];
+} WarmStartState;
+
 
 /**
  * \struct RunTimeOpts
@@ -293,6 +607,7 @@ typedef struct {
 	Boolean preferUtcValid;
 	Boolean requireUtcValid;
 	Boolean useSysLog;
+	Boolean logAsync;
 	Boolean checkConfigOnly;
 	Boolean printLockFile;
 
@@ -311,12 +626,22 @@ typedef struct {
 	Boolean periodicUpdates;
 	Boolean logStatistics;
 	Enumeration8 statisticsTimestamp;
+	Enumeration8 statisticsLogFormat;
+	Enumeration8 statisticsLogMode;
 
 	Enumeration8 logLevel;
 	int statisticsLogInterval;
 
 	int statusFileUpdateInterval;
 
+	Boolean statsSegment;
+	char statsSegmentName[PATH_MAX+1];
+
+	Boolean metricsExport;
+	char metricsAddress[PATH_MAX+1];
+	Boolean controlSocket;
+	char controlSocketPath[PATH_MAX+1];
+
 	Boolean ignore_daemon_lock;
 	Boolean do_IGMP_refresh;
 	Boolean  nonDaemon;
@@ -335,11 +660,17 @@ typedef struct {
 	char leapFile[PATH_MAX+1]; /* leap seconds file location */
 	Enumeration8 drift_recovery_method; /* how the observed drift is managed
 				      between restarts */
+	Boolean warmStart;		/* save / restore the state snapshot across restarts */
+	char warmStartFile[PATH_MAX+1];	/* state snapshot location */
+	int warmStartSaveInterval;	/* seconds between snapshots while slave */
+	int warmStartMaxAge;		/* older snapshots are ignored on startup */
+	Boolean warmStartKeepGrants;	/* leave unicast grants running on a clean stop */
 
 	LeapSecondInfo	leapInfo;
 
 	Boolean snmpEnabled;		/* SNMP subsystem enabled / disabled even if compiled in */
 	Boolean snmpTrapsEnabled; 	/* enable sending of SNMP traps (requires alarms enabled) */
+	int snmpSnapshotInterval;	/* seconds between SNMP table snapshots */
 	Boolean alarmsEnabled; 		/* enable support for alarms */
 	int	alarmMinAge;		/* minimal alarm age in seconds (from set to clear notification) */
 	int	alarmInitialDelay;	/* initial delay before we start processing alarms; example:  */
@@ -400,6 +731,9 @@ typedef struct {
 	double servoKI;
 	Enumeration8 servoDtMethod;
 	double servoMaxdT;
+	/* fixed servo update interval (seconds), 0 = update on every offset */
+	double servoUpdateInterval;
+	Enumeration8 servoUpdateMethod;
 
 	/**
 	 *  When enabled, ptpd ensures that Sync message sequence numbers
@@ -430,6 +764,18 @@ typedef struct {
 	int servoStabilityPeriod;
 
 	Boolean maxDelayStableOnly;
+
+	Boolean holdoverEnabled;
+	int holdoverWindow;
+	int holdoverMaxDuration;
+	Integer32 holdoverAlarmThreshold;
+
+	/* adaptive Delay_Req rate: burst at the minimum interval, sparse once delay is stable */
+	Boolean delayReqAdaptive;
+	int delayReqBurstLength;
+	Integer8 logDelayReqIntervalSparse;
+	double delayReqStabilityThreshold;
+	int delayReqStabilityPeriod;
 #endif
 	/* also used by the periodic message ticker */
 	int statsUpdateInterval;
@@ -547,7 +893,23 @@ typedef struct {
 	Octet msgObuf[PACKET_SIZE];
 	Octet msgIbuf[PACKET_SIZE];
 
-	int followUpGap;
+	/* send templates, see msgInvalidateTemplates() */
+	MsgTemplate msgTemplates[MSG_TEMPLATE_MAX];
+
+	/* bumped whenever the datasets change, invalidates mmCache */
+	UInteger32 datasetGeneration;
+	/* packed GET responses, see handleManagement() */
+	MMCacheEntry mmCache[MM_CACHE_MAX];
+
+	/* view of msgIbuf for the message being handled */
+	MsgView msgView;
+
+	/* TLV data of the message being handled / sent, see msgArenaAlloc() */
+	MsgArena msgArena;
+
+	/* in-flight exchanges, slot = sequenceId % EXCHANGE_TABLE_SIZE */
+	PtpExchange syncExchanges[EXCHANGE_TABLE_SIZE];
+	PtpExchange delayReqExchanges[EXCHANGE_TABLE_SIZE];
 
 /*
 	20110630: These variables were deprecated in favor of the ones that appear in the stats log (delayMS and delaySM)
@@ -570,7 +932,6 @@ typedef struct {
 	TimeInternal	pdelaySM;
 	TimeInternal	delayMS;
 	TimeInternal	delaySM;
-	TimeInternal  lastSyncCorrectionField;
 	TimeInternal  lastPdelayRespCorrectionField;
 
 	Boolean  sentPdelayReq;
@@ -601,6 +962,8 @@ typedef struct {
 
 	/*Stats header will be re-printed when set to true*/
 	Boolean resetStatisticsLog;
+	/* statistics log interval summary */
+	StatsLogAggregate statsLogAggregate;
 
 	int listenCount; // number of consecutive resets to listening
 	int resetCount;
@@ -630,6 +993,11 @@ typedef struct {
 	double last_saved_drift;                     /* Last observed drift value written to file */
 	Boolean drift_saved;                            /* Did we save a drift value already? */
 
+	/* state snapshot from the previous run, see dep/warmstart.c */
+	WarmStartState warmStart;
+	Boolean warmStartPending;	/* loaded, applied when the saved parent is selected */
+	Boolean keepGrants;		/* clean stop with warm_start_keep_grants: leave the unicast grants running */
+
 	/* user description is max size + 1 to leave space for a null terminator */
 	Octet userDescription[USER_DESCRIPTION_MAX + 1];
 	Octet profileIdentity[6];
@@ -644,8 +1012,13 @@ typedef struct {
 	 */
 	PtpdCounters counters;
 
+	/* hot path latency counters */
+	LatencyProbes latency;
+
 	/* PI servo model */
 	PIservo servo;
+	/* offsets waiting for the next fixed-rate servo update */
+	ServoOffsetBuffer servoBuffer;
 
 	/* "panic mode" support */
 	Boolean panicMode; /* in panic mode - do not update clock or calculate offsets */
@@ -678,6 +1051,18 @@ typedef struct {
 	*/
 	PtpEngineSlaveStats slaveStats;
 
+	/* ADEV / TDEV / MTIE estimates over the offset from master */
+	ClockStability stability;
+
+	/* percentile histograms, snapshotted on every statistics update */
+	PtpEngineHistograms histograms;
+
+	/* frequency prediction used when master is lost */
+	HoldoverModel holdover;
+
+	/* Delay_Reqs left to send at the minimum interval before backing off */
+	int delayReqBurstLeft;
+
 	OutlierFilter 	oFilterMS;
 	OutlierFilter	oFilterSM;
 
@@ -125,6 +125,15 @@ getAlarmMessage(char *out, int count, AlarmEntry *alarm)
 	    snprintf(out, count, ": Configured domain is %d, last seen %d", alarm->eventData.defaultDS.domainNumber,
 			alarm->eventData.portDS.lastMismatchedDomain);
 	    return;
+	case ALRM_HOLDOVER:
+	    if(alarm->state == ALARM_UNSET) {
+		snprintf(out, count, ": Holdover ended after %u s, estimated time error %d ns",
+			alarm->eventData.holdoverSeconds, alarm->eventData.holdoverTimeError);
+		return;
+	    }
+	    snprintf(out, count, ": In holdover for %u s, estimated time error %d ns",
+			alarm->eventData.holdoverSeconds, alarm->eventData.holdoverTimeError);
+	    return;
 	default:
 	    return;
     }
@@ -193,7 +202,8 @@ initAlarms(AlarmEntry* alarms, int count, void *userData)
     { "NWFL", 	"NETWORK_FAULT", 	"A network fault has occurred",				FALSE, ALRM_NETWORK_FLT,	FALSE, 		{alarmHandler_log}},
     { "FADJ", 	"FAST_ADJ", 		"Clock is being adjusted too fast", 			FALSE, ALRM_FAST_ADJ,		FALSE, 		{alarmHandler_log}},
     { "TPR", 	"TIMEPROP_CHANGE", 	"Time properties have changed",				FALSE, ALRM_TIMEPROP_CHANGE,	TRUE, 		{eventHandler_log}},
-    { "DOM", 	"DOMAIN_MISMATCH", 	"Clock is receiving all messages from incorrect domain",FALSE, ALRM_DOMAIN_MISMATCH,	FALSE, 		{alarmHandler_log}}
+    { "DOM", 	"DOMAIN_MISMATCH", 	"Clock is receiving all messages from incorrect domain",FALSE, ALRM_DOMAIN_MISMATCH,	FALSE, 		{alarmHandler_log}},
+    { "HOLD", 	"HOLDOVER", 		"Clock is in holdover and time error is above threshold",FALSE, ALRM_HOLDOVER,	FALSE, 		{alarmHandler_log}}
 
     };
 
@@ -296,6 +306,15 @@ capturePtpEventData(PtpEventData *eventData, PtpClock *ptpClock, RunTimeOpts *rt
     }
 
     eventData->ofmAlarmThreshold = rtOpts->ofmAlarmThreshold;
+
+#ifdef PTPD_STATISTICS
+    eventData->holdoverSeconds = ptpClock->holdover.elapsed;
+    /* time error grows with elapsed^2 and can outgrow the 32-bit notification field */
+    eventData->holdoverTimeError = max(min(ptpClock->holdover.timeError, (double)INT32_MAX), (double)INT32_MIN);
+#else
+    eventData->holdoverSeconds = 0;
+    eventData->holdoverTimeError = 0;
+#endif /* PTPD_STATISTICS */
 }
 
 /*
@@ -57,6 +57,7 @@ typedef enum {
 	ALRM_FAST_ADJ = 8,			/*+/- currently only at maxppb */
 	ALRM_TIMEPROP_CHANGE = 9,		/*x done*/
 	ALRM_DOMAIN_MISMATCH = 10, 		/*+/- currently only when all packets come from an incorrect domain */
+	ALRM_HOLDOVER = 11,			/*x done*/
 	ALRM_MAX
 } AlarmType;
 
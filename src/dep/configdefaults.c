@@ -200,6 +200,8 @@ loadDefaultSettings( RunTimeOpts* rtOpts )
 	rtOpts->noAdjust = NO_ADJUST;  // false
 	rtOpts->logStatistics = TRUE;
 	rtOpts->statisticsTimestamp = TIMESTAMP_DATETIME;
+	rtOpts->statisticsLogFormat = STATSLOG_FORMAT_CSV;
+	rtOpts->statisticsLogMode = STATSLOG_MODE_SAMPLE;
 
 	rtOpts->periodicUpdates = FALSE; /* periodically log a status update */
 
@@ -218,6 +220,8 @@ loadDefaultSettings( RunTimeOpts* rtOpts )
 	rtOpts->ignore_delayreq_interval_master = FALSE;
 	rtOpts->do_IGMP_refresh = TRUE;
 	rtOpts->useSysLog       = FALSE;
+	/* log through the asynchronous log writer thread */
+	rtOpts->logAsync	= FALSE;
 	rtOpts->announceReceiptTimeout  = DEFAULT_ANNOUNCE_RECEIPT_TIMEOUT;
 #ifdef RUNTIME_DEBUG
 	rtOpts->debug_level = LOG_INFO;			/* by default debug messages as disabled, but INFO messages and below are printed */
@@ -249,10 +253,16 @@ loadDefaultSettings( RunTimeOpts* rtOpts )
 	rtOpts->drift_recovery_method = DRIFT_KERNEL;
 	strncpy(rtOpts->lockDirectory, DEFAULT_LOCKDIR, PATH_MAX);
 	strncpy(rtOpts->driftFile, DEFAULT_DRIFTFILE, PATH_MAX);
+	rtOpts->warmStart = FALSE;
+	strncpy(rtOpts->warmStartFile, DEFAULT_WARMSTART_FILE, PATH_MAX);
+	rtOpts->warmStartSaveInterval = 60;
+	rtOpts->warmStartMaxAge = 600;
+	rtOpts->warmStartKeepGrants = FALSE;
 /*	strncpy(rtOpts->lockFile, DEFAULT_LOCKFILE, PATH_MAX); */
 	rtOpts->autoLockFile = FALSE;
 	rtOpts->snmpEnabled = FALSE;
 	rtOpts->snmpTrapsEnabled = FALSE;
+	rtOpts->snmpSnapshotInterval = 1;
 	rtOpts->alarmsEnabled = FALSE;
 	rtOpts->alarmInitialDelay = 0;
 	rtOpts->alarmMinAge = 30;
@@ -280,6 +290,9 @@ loadDefaultSettings( RunTimeOpts* rtOpts )
 	rtOpts->servoDtMethod = DT_CONSTANT;
 	/* when measuring dT, use a maximum of 5 sync intervals (would correspond to avg 20% discard rate) */
 	rtOpts->servoMaxdT = 5.0;
+	/* servo runs on every offset update by default */
+	rtOpts->servoUpdateInterval = 0.0;
+	rtOpts->servoUpdateMethod = SERVO_COMBINE_MEAN;
 
 	/* disabled by default */
 	rtOpts->announceTimeoutGracePeriod = 0;
@@ -360,6 +373,23 @@ loadDefaultSettings( RunTimeOpts* rtOpts )
 	rtOpts->calibrationDelay = 0;
 	/* if set to TRUE and maxDelay is defined, only check against threshold if servo is stable */
 	rtOpts->maxDelayStableOnly = FALSE;
+	/* holdover: predict frequency from the drift model when master is lost */
+	rtOpts->holdoverEnabled = FALSE;
+	/* drift model window: number of statsUpdateInterval periods */
+	rtOpts->holdoverWindow = 60;
+	/* stop extrapolating drift trend after this many seconds in holdover, 0 = never */
+	rtOpts->holdoverMaxDuration = 3600;
+	/* raise holdover alarm when estimated time error exceeds this (ns) */
+	rtOpts->holdoverAlarmThreshold = 1000;
+	/* adaptive Delay_Req rate disabled by default */
+	rtOpts->delayReqAdaptive = FALSE;
+	/* Delay_Reqs sent at the minimum interval after master acquisition or delay instability */
+	rtOpts->delayReqBurstLength = 16;
+	/* back off to one Delay_Req every 8 seconds once delay is stable */
+	rtOpts->logDelayReqIntervalSparse = 3;
+	/* mean path delay std dev (ns) considered stable, and for how many statistics intervals */
+	rtOpts->delayReqStabilityThreshold = 1000.0;
+	rtOpts->delayReqStabilityPeriod = 3;
 	/* if set to non-zero, reset slave if more than this amount of consecutive delay measurements was above maxDelay */
 	rtOpts->maxDelayMaxRejected = 0;
 #endif
@@ -367,6 +397,15 @@ loadDefaultSettings( RunTimeOpts* rtOpts )
 	/* status file options */
 	rtOpts->statusFileUpdateInterval = 1;
 
+	/* shared memory statistics segment - default name derived from interface */
+	rtOpts->statsSegment = FALSE;
+	rtOpts->statsSegmentName[0] = '\0';
+
+	rtOpts->metricsExport = FALSE;
+	strncpy(rtOpts->metricsAddress, DEFAULT_METRICS_ADDRESS, PATH_MAX);
+	rtOpts->controlSocket = FALSE;
+	strncpy(rtOpts->controlSocketPath, DEFAULT_CONTROL_PATH, PATH_MAX);
+
 	rtOpts->ofmAlarmThreshold = 0;
 
 	/* panic mode options */
@@ -117,6 +117,12 @@ if it's POSIX compatible, if you succeed, report it to ptpd-devel@sourceforge.ne
 #define FLAG_FIELD_LENGTH         2
 
 #define PACKET_SIZE  300
+/*
+ * per-message arena for decoded / outgoing management and signaling TLVs:
+ * one TLV and its response never need more than a few PACKET_SIZEs
+ */
+#define MSG_ARENA_SIZE	4096
+#define MSG_ARENA_ALIGN	8
 #define PACKET_BEGIN_UDP (ETHER_HDR_LEN + sizeof(struct ip) + \
 	    sizeof(struct udphdr))
 #define PACKET_BEGIN_ETHER (ETHER_HDR_LEN)
@@ -154,6 +160,15 @@ if it's POSIX compatible, if you succeed, report it to ptpd-devel@sourceforge.ne
 /* default status file location */
 #define DEFAULT_STATUSFILE DEFAULT_LOCKDIR"/"PTPD_PROGNAME".status"
 
+/* default OpenMetrics endpoint - local only */
+#define DEFAULT_METRICS_ADDRESS "127.0.0.1:9329"
+
+/* default control socket location */
+#define DEFAULT_CONTROL_PATH DEFAULT_LOCKDIR"/"PTPD_PROGNAME".control"
+
+/* default warm start state snapshot location */
+#define DEFAULT_WARMSTART_FILE DEFAULT_LOCKDIR"/"PTPD_PROGNAME".state"
+
 /* Highest log level (default) catches all */
 #define LOG_ALL LOG_DEBUGV
 
@@ -186,6 +201,18 @@ enum {
 	TIMESTAMP_BOTH
 };
 
+/* statistics log format */
+enum {
+	STATSLOG_FORMAT_CSV,
+	STATSLOG_FORMAT_BINARY
+};
+
+/* statistics log mode */
+enum {
+	STATSLOG_MODE_SAMPLE,
+	STATSLOG_MODE_AGGREGATE
+};
+
 /* servo dT calculation mode */
 enum {
 	DT_NONE,
@@ -193,6 +220,13 @@ enum {
 	DT_MEASURED
 };
 
+/* how offsets queued between fixed-rate servo updates are combined */
+enum {
+	SERVO_COMBINE_MEAN,
+	SERVO_COMBINE_MEDIAN,
+	SERVO_COMBINE_REGRESSION
+};
+
 /* StatFilter op type */
 enum {
 	FILTER_NONE,
@@ -246,6 +280,14 @@ enum {
 
 #define MAX_SEQ_ERRORS 50
 
+/* offsets queued between fixed-rate servo updates - 128 Hz Sync at 2 s update interval */
+#define SERVO_BUFFER_MAX 256
+
+/* holdover: frequency model window limit and prediction update interval (seconds) */
+#define HOLDOVER_WINDOW_MAX 128
+#define HOLDOVER_MIN_SAMPLES 4
+#define HOLDOVER_UPDATE_INTERVAL 1
+
 #define MAXTIMESTR 32
 
 #endif /*CONSTANTS_DEP_H_*/
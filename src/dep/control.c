@@ -0,0 +1,567 @@
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file    control.c
+ * @authors The PTPd Project
+ * @date   Mon Feb 1 11:20:43 2016
+ * This source file contains the local control socket: a line based
+ * request / response protocol on a Unix socket served by sockserver.c
+ * and polled from netSelect().
+ *
+ * A request is a single line: <command> [arguments]. The response is
+ * "OK" or "ERR <reason>", followed by "<name> <value>" lines, and is
+ * terminated by an empty line. Requests can be pipelined.
+ *
+ *   get default|current|parent|time_properties|port  - datasets
+ *   stats                                            - servo and slave statistics
+ *   counters                                         - PtpdCounters
+ *   grants                                           - unicast grant tables
+ *   config <section:key>                             - current setting
+ *   set <section:key> <value>                        - change a setting
+ *   help
+ */
+
+#include "../ptpd.h"
+
+#define CONTROL_REQUEST_SIZE	512
+#define CONTROL_BUFFER_SIZE	16384
+#define CONTROL_IDLE_TIMEOUT	60	/* seconds without a request before dropping a client */
+
+typedef struct {
+	SocketClient socket;		/* first: the server hands us back a SocketClient */
+	Boolean discard;		/* dropping the rest of an overlong request */
+	char request[CONTROL_REQUEST_SIZE + 1];
+	char buffer[CONTROL_BUFFER_SIZE];
+} ControlClient;
+
+typedef void (*ControlHandler)(ControlClient *client, char *arg, char *value);
+
+static void controlGet(ControlClient *client, char *arg, char *value);
+static void controlStats(ControlClient *client, char *arg, char *value);
+static void controlCounters(ControlClient *client, char *arg, char *value);
+static void controlGrants(ControlClient *client, char *arg, char *value);
+static void controlConfig(ControlClient *client, char *arg, char *value);
+static void controlSet(ControlClient *client, char *arg, char *value);
+static void controlHelp(ControlClient *client, char *arg, char *value);
+
+/* arguments: number of words after the command - the value of set is the rest of the line */
+static const struct {
+	const char *name;
+	int arguments;
+	ControlHandler handler;
+	const char *usage;
+} commandTable[] = {
+	{ "get",	1, controlGet,		"get default|current|parent|time_properties|port" },
+	{ "stats",	0, controlStats,	"stats" },
+	{ "counters",	0, controlCounters,	"counters" },
+	{ "grants",	0, controlGrants,	"grants" },
+	{ "config",	1, controlConfig,	"config <section:key>" },
+	{ "set",	2, controlSet,		"set <section:key> <value>" },
+	{ "help",	0, controlHelp,		"help" }
+};
+
+#define COMMAND_COUNT (sizeof(commandTable) / sizeof(commandTable[0]))
+
+static void controlConnected(SocketClient *socket);
+static void controlRespond(SocketClient *socket);
+
+/* the socket can change the configuration - owner only */
+static SocketServer controlServer = {
+	"control", FALSE, TRUE, CONTROL_IDLE_TIMEOUT, controlConnected, controlRespond, -1
+};
+
+static PtpClock *controlPtpClock = NULL;
+static RunTimeOpts *controlRtOpts = NULL;
+static ControlClient clients[SOCKSERVER_MAX_CLIENTS];
+static Boolean clientsInitialised = FALSE;
+
+/* start, stop or move the control socket according to current configuration */
+void
+controlInit(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	int i;
+
+	if(!clientsInitialised) {
+		for(i = 0; i < SOCKSERVER_MAX_CLIENTS; i++) {
+			socketServerAddClient(&controlServer, &clients[i].socket,
+				clients[i].request, CONTROL_REQUEST_SIZE,
+				clients[i].buffer, CONTROL_BUFFER_SIZE);
+		}
+		clientsInitialised = TRUE;
+	}
+
+	controlPtpClock = ptpClock;
+	controlRtOpts = rtOpts;
+
+	if(!rtOpts->controlSocket) {
+		controlShutdown();
+		return;
+	}
+
+	socketServerStart(&controlServer, rtOpts->controlSocketPath);
+
+}
+
+void
+controlShutdown()
+{
+	socketServerStop(&controlServer);
+}
+
+/* add our sockets to the select() sets */
+void
+controlSelectInfo(int *nfds, fd_set *readfds, fd_set *writefds)
+{
+	socketServerSelectInfo(&controlServer, nfds, readfds, writefds);
+}
+
+/* replace whatever the response has so far with an error */
+static void
+controlError(ControlClient *client, const char *reason)
+{
+	client->socket.bufferLength = 0;
+	client->socket.overflow = FALSE;
+	socketClientAppend(&client->socket, "ERR %s\n", reason);
+}
+
+static void
+controlUsage(ControlClient *client, const char *usage)
+{
+	client->socket.bufferLength = 0;
+	client->socket.overflow = FALSE;
+	socketClientAppend(&client->socket, "ERR usage: %s\n", usage);
+}
+
+static void
+appendTimeInternal(ControlClient *client, const char *name, const TimeInternal *t)
+{
+	socketClientAppend(&client->socket, "%s %.9f\n", name, timeInternalToDouble(t));
+}
+
+static void
+renderDefaultDS(ControlClient *client, const PtpClock *ptpClock)
+{
+	const DefaultDS *ds = &ptpClock->defaultDS;
+
+	socketClientAppend(&client->socket, "twoStepFlag %d\n", ds->twoStepFlag);
+	socketClientAppend(&client->socket, "clockIdentity ");
+	socketClientAppendClockIdentity(&client->socket, ds->clockIdentity);
+	socketClientAppend(&client->socket, "\n");
+	socketClientAppend(&client->socket, "numberPorts %d\n", ds->numberPorts);
+	socketClientAppend(&client->socket, "clockClass %d\n", ds->clockQuality.clockClass);
+	socketClientAppend(&client->socket, "clockAccuracy 0x%02x\n", ds->clockQuality.clockAccuracy);
+	socketClientAppend(&client->socket, "offsetScaledLogVariance 0x%04x\n", ds->clockQuality.offsetScaledLogVariance);
+	socketClientAppend(&client->socket, "priority1 %d\n", ds->priority1);
+	socketClientAppend(&client->socket, "priority2 %d\n", ds->priority2);
+	socketClientAppend(&client->socket, "domainNumber %d\n", ds->domainNumber);
+	socketClientAppend(&client->socket, "slaveOnly %d\n", ds->slaveOnly);
+}
+
+static void
+renderCurrentDS(ControlClient *client, const PtpClock *ptpClock)
+{
+	const CurrentDS *ds = &ptpClock->currentDS;
+
+	socketClientAppend(&client->socket, "stepsRemoved %d\n", ds->stepsRemoved);
+	appendTimeInternal(client, "offsetFromMaster", &ds->offsetFromMaster);
+	appendTimeInternal(client, "meanPathDelay", &ds->meanPathDelay);
+}
+
+static void
+renderParentDS(ControlClient *client, const PtpClock *ptpClock)
+{
+	const ParentDS *ds = &ptpClock->parentDS;
+
+	socketClientAppend(&client->socket, "parentPortIdentity ");
+	socketClientAppendPortIdentity(&client->socket, &ds->parentPortIdentity);
+	socketClientAppend(&client->socket, "\n");
+	socketClientAppend(&client->socket, "parentStats %d\n", ds->parentStats);
+	socketClientAppend(&client->socket, "observedParentOffsetScaledLogVariance 0x%04x\n", ds->observedParentOffsetScaledLogVariance);
+	socketClientAppend(&client->socket, "observedParentClockPhaseChangeRate %d\n", ds->observedParentClockPhaseChangeRate);
+	socketClientAppend(&client->socket, "grandmasterIdentity ");
+	socketClientAppendClockIdentity(&client->socket, ds->grandmasterIdentity);
+	socketClientAppend(&client->socket, "\n");
+	socketClientAppend(&client->socket, "grandmasterClockClass %d\n", ds->grandmasterClockQuality.clockClass);
+	socketClientAppend(&client->socket, "grandmasterClockAccuracy 0x%02x\n", ds->grandmasterClockQuality.clockAccuracy);
+	socketClientAppend(&client->socket, "grandmasterOffsetScaledLogVariance 0x%04x\n", ds->grandmasterClockQuality.offsetScaledLogVariance);
+	socketClientAppend(&client->socket, "grandmasterPriority1 %d\n", ds->grandmasterPriority1);
+	socketClientAppend(&client->socket, "grandmasterPriority2 %d\n", ds->grandmasterPriority2);
+}
+
+static void
+renderTimePropertiesDS(ControlClient *client, const PtpClock *ptpClock)
+{
+	const TimePropertiesDS *ds = &ptpClock->timePropertiesDS;
+
+	socketClientAppend(&client->socket, "currentUtcOffset %d\n", ds->currentUtcOffset);
+	socketClientAppend(&client->socket, "currentUtcOffsetValid %d\n", ds->currentUtcOffsetValid);
+	socketClientAppend(&client->socket, "leap59 %d\n", ds->leap59);
+	socketClientAppend(&client->socket, "leap61 %d\n", ds->leap61);
+	socketClientAppend(&client->socket, "timeTraceable %d\n", ds->timeTraceable);
+	socketClientAppend(&client->socket, "frequencyTraceable %d\n", ds->frequencyTraceable);
+	socketClientAppend(&client->socket, "ptpTimescale %d\n", ds->ptpTimescale);
+	socketClientAppend(&client->socket, "timeSource %s\n", getTimeSourceName(ds->timeSource));
+}
+
+static void
+renderPortDS(ControlClient *client, const PtpClock *ptpClock)
+{
+	const PortDS *ds = &ptpClock->portDS;
+
+	socketClientAppend(&client->socket, "portIdentity ");
+	socketClientAppendPortIdentity(&client->socket, &ds->portIdentity);
+	socketClientAppend(&client->socket, "\n");
+	socketClientAppend(&client->socket, "portState %s\n", portState_getName(ds->portState));
+	socketClientAppend(&client->socket, "logMinDelayReqInterval %d\n", ds->logMinDelayReqInterval);
+	appendTimeInternal(client, "peerMeanPathDelay", &ds->peerMeanPathDelay);
+	socketClientAppend(&client->socket, "logAnnounceInterval %d\n", ds->logAnnounceInterval);
+	socketClientAppend(&client->socket, "announceReceiptTimeout %d\n", ds->announceReceiptTimeout);
+	socketClientAppend(&client->socket, "logSyncInterval %d\n", ds->logSyncInterval);
+	socketClientAppend(&client->socket, "delayMechanism %s\n", delayMechToString(ds->delayMechanism));
+	socketClientAppend(&client->socket, "logMinPdelayReqInterval %d\n", ds->logMinPdelayReqInterval);
+	socketClientAppend(&client->socket, "versionNumber %d\n", ds->versionNumber);
+}
+
+static const struct {
+	const char *name;
+	void (*render)(ControlClient *, const PtpClock *);
+} datasetTable[] = {
+	{ "default",		renderDefaultDS },
+	{ "current",		renderCurrentDS },
+	{ "parent",		renderParentDS },
+	{ "time_properties",	renderTimePropertiesDS },
+	{ "port",		renderPortDS }
+};
+
+#define DATASET_COUNT (sizeof(datasetTable) / sizeof(datasetTable[0]))
+
+static void
+controlGet(ControlClient *client, char *arg, char *value)
+{
+
+	int i;
+
+	for(i = 0; i < DATASET_COUNT; i++) {
+		if(!strcmp(arg, datasetTable[i].name)) {
+			datasetTable[i].render(client, controlPtpClock);
+			return;
+		}
+	}
+
+	controlError(client, "unknown dataset");
+
+}
+
+static void
+controlStats(ControlClient *client, char *arg, char *value)
+{
+
+	const PtpClock *ptpClock = controlPtpClock;
+
+	socketClientAppend(&client->socket, "portState %s\n", portState_getName(ptpClock->portDS.portState));
+	socketClientAppend(&client->socket, "parentPortIdentity ");
+	socketClientAppendPortIdentity(&client->socket, &ptpClock->parentDS.parentPortIdentity);
+	socketClientAppend(&client->socket, "\n");
+	appendTimeInternal(client, "offsetFromMaster", &ptpClock->currentDS.offsetFromMaster);
+	appendTimeInternal(client, "meanPathDelay", ptpClock->portDS.delayMechanism == P2P ?
+		    &ptpClock->portDS.peerMeanPathDelay : &ptpClock->currentDS.meanPathDelay);
+	socketClientAppend(&client->socket, "observedDrift %.3f\n", ptpClock->servo.observedDrift);
+	socketClientAppend(&client->socket, "servoMaxOutput %d\n", ptpClock->servo.runningMaxOutput);
+	socketClientAppend(&client->socket, "calibrated %d\n", ptpClock->isCalibrated);
+#ifdef PTPD_STATISTICS
+	socketClientAppend(&client->socket, "servoStable %d\n", ptpClock->servo.isStable);
+	socketClientAppend(&client->socket, "driftMean %.3f\n", ptpClock->servo.driftMean);
+	socketClientAppend(&client->socket, "driftStdDev %.3f\n", ptpClock->servo.driftStdDev);
+	socketClientAppend(&client->socket, "driftMedian %.3f\n", ptpClock->servo.driftMedian);
+	socketClientAppend(&client->socket, "holdover %d\n", ptpClock->holdover.active);
+	socketClientAppend(&client->socket, "statsCalculated %d\n", ptpClock->slaveStats.statsCalculated);
+	socketClientAppend(&client->socket, "offsetMean %.9f\n", ptpClock->slaveStats.ofmMean);
+	socketClientAppend(&client->socket, "offsetStdDev %.9f\n", ptpClock->slaveStats.ofmStdDev);
+	socketClientAppend(&client->socket, "offsetMedian %.9f\n", ptpClock->slaveStats.ofmMedian);
+	socketClientAppend(&client->socket, "offsetMin %.9f\n", ptpClock->slaveStats.ofmMinFinal);
+	socketClientAppend(&client->socket, "offsetMax %.9f\n", ptpClock->slaveStats.ofmMaxFinal);
+	socketClientAppend(&client->socket, "pathDelayMean %.9f\n", ptpClock->slaveStats.mpdMean);
+	socketClientAppend(&client->socket, "pathDelayStdDev %.9f\n", ptpClock->slaveStats.mpdStdDev);
+	socketClientAppend(&client->socket, "pathDelayMedian %.9f\n", ptpClock->slaveStats.mpdMedian);
+	socketClientAppend(&client->socket, "pathDelayMin %.9f\n", ptpClock->slaveStats.mpdMinFinal);
+	socketClientAppend(&client->socket, "pathDelayMax %.9f\n", ptpClock->slaveStats.mpdMaxFinal);
+	socketClientAppend(&client->socket, "pathDelayStable %d\n", ptpClock->slaveStats.mpdIsStable);
+#endif /* PTPD_STATISTICS */
+
+}
+
+static void
+controlCounters(ControlClient *client, char *arg, char *value)
+{
+
+	int i;
+
+	for(i = 0; i < PTPD_COUNTER_MAX; i++) {
+		socketClientAppend(&client->socket, "%s %u\n", getPtpdCounterInfo(i)->name,
+			getPtpdCounter(&controlPtpClock->counters, i));
+	}
+
+}
+
+/* one line per active grant: grant <address> <portIdentity> <message type> <granted> <logInterval> <duration> <timeLeft> */
+static void
+renderGrantTable(ControlClient *client, const UnicastGrantTable *table)
+{
+
+	const UnicastGrantData *grant;
+	struct in_addr address;
+	int i;
+
+	address.s_addr = table->transportAddress;
+
+	for(i = 0; i < PTP_MAX_MESSAGE_INDEXED; i++) {
+		grant = &table->grantData[i];
+		if(!grant->granted && !grant->requested) {
+			continue;
+		}
+		socketClientAppend(&client->socket, "grant %s ", inet_ntoa(address));
+		socketClientAppendPortIdentity(&client->socket, &table->portIdentity);
+		socketClientAppend(&client->socket, " %s %d %d %u %u\n",
+			getMessageTypeName(grant->messageType),
+			grant->granted, grant->logInterval,
+			grant->duration, grant->timeLeft);
+	}
+
+}
+
+static void
+controlGrants(ControlClient *client, char *arg, char *value)
+{
+
+	int i;
+
+	for(i = 0; i < UNICAST_MAX_DESTINATIONS; i++) {
+		renderGrantTable(client, &controlPtpClock->unicastGrants[i]);
+	}
+
+	renderGrantTable(client, &controlPtpClock->peerGrants);
+
+}
+
+static void
+controlConfig(ControlClient *client, char *arg, char *value)
+{
+
+	const char *current = iniparser_getstring(controlRtOpts->currentConfig, arg, NULL);
+
+	if(current == NULL) {
+		controlError(client, "unknown setting");
+		return;
+	}
+
+	socketClientAppend(&client->socket, "%s %s\n", arg, current);
+
+}
+
+/* same path as a management SET: apply the current configuration with one setting changed */
+static void
+controlSet(ControlClient *client, char *arg, char *value)
+{
+
+	dictionary *candidate;
+	Boolean applied;
+
+	if(iniparser_getstring(controlRtOpts->currentConfig, arg, NULL) == NULL) {
+		controlError(client, "unknown setting");
+		return;
+	}
+
+	NOTICE("Control socket: setting %s to \"%s\"\n", arg, value);
+
+	candidate = dictionary_new(0);
+	dictionary_merge(controlRtOpts->currentConfig, candidate, 1, 0, NULL);
+	setConfig(candidate, arg, value);
+	applied = applyConfig(candidate, controlRtOpts, controlPtpClock);
+	dictionary_del(&candidate);
+
+	if(!applied) {
+		controlError(client, "configuration not applied - see log");
+		return;
+	}
+
+	/* report the value as parsed */
+	controlConfig(client, arg, NULL);
+
+}
+
+static void
+controlHelp(ControlClient *client, char *arg, char *value)
+{
+
+	int i;
+
+	for(i = 0; i < COMMAND_COUNT; i++) {
+		socketClientAppend(&client->socket, "usage %s\n", commandTable[i].usage);
+	}
+
+}
+
+/* split the request line and run it, leaving the full response in the buffer */
+static void
+runRequest(ControlClient *client, char *line)
+{
+
+	char *command, *arg = NULL, *value = NULL;
+	char *p;
+	int i;
+
+	command = line + strspn(line, " \t");
+	if((p = strpbrk(command, " \t")) != NULL) {
+		*p++ = '\0';
+		arg = p + strspn(p, " \t");
+	}
+
+	for(i = 0; i < COMMAND_COUNT; i++) {
+		if(!strcmp(command, commandTable[i].name)) {
+			break;
+		}
+	}
+
+	if(i == COMMAND_COUNT) {
+		controlError(client, "unknown command");
+		goto out;
+	}
+
+	if(commandTable[i].arguments > 0) {
+		if(arg == NULL || *arg == '\0') {
+			controlUsage(client, commandTable[i].usage);
+			goto out;
+		}
+		if((p = strpbrk(arg, " \t")) != NULL) {
+			*p++ = '\0';
+			value = p + strspn(p, " \t");
+		}
+		/* configuration keys are lower case */
+		for(p = arg; *p != '\0'; p++) {
+			*p = tolower((unsigned char)*p);
+		}
+	}
+
+	if((commandTable[i].arguments == 2) != (value != NULL && *value != '\0') ||
+	    (commandTable[i].arguments == 0 && arg != NULL && *arg != '\0')) {
+		controlUsage(client, commandTable[i].usage);
+		goto out;
+	}
+
+	socketClientAppend(&client->socket, "OK\n");
+	commandTable[i].handler(client, arg, value);
+
+	if(client->socket.overflow) {
+		controlError(client, "response too large");
+	}
+
+out:
+	socketClientAppend(&client->socket, "\n");
+
+}
+
+/* run the next complete request line, if there is one */
+static Boolean
+nextRequest(ControlClient *client)
+{
+
+	SocketClient *socket = &client->socket;
+	char *end;
+	int lineLength;
+
+	if((end = memchr(client->request, '\n', socket->requestLength)) == NULL) {
+		if(socket->requestLength >= CONTROL_REQUEST_SIZE) {
+			/* no room left for the end of the line - answer once, then skip to the next one */
+			socket->requestLength = 0;
+			if(!client->discard) {
+				client->discard = TRUE;
+				controlError(client, "request too long");
+				socketClientAppend(socket, "\n");
+				return TRUE;
+			}
+		}
+		return FALSE;
+	}
+
+	*end = '\0';
+	if(end > client->request && end[-1] == '\r') {
+		end[-1] = '\0';
+	}
+
+	lineLength = end - client->request + 1;
+
+	/* skip empty lines and the tail of an overlong request */
+	if(client->discard) {
+		client->discard = FALSE;
+	} else if(client->request[strspn(client->request, " \t")] != '\0') {
+		runRequest(client, client->request);
+	}
+
+	memmove(client->request, client->request + lineLength, socket->requestLength - lineLength);
+	socket->requestLength -= lineLength;
+	client->request[socket->requestLength] = '\0';
+
+	return TRUE;
+
+}
+
+static void
+controlConnected(SocketClient *socket)
+{
+	((ControlClient*)socket)->discard = FALSE;
+}
+
+/*
+ * reply to the next pipelined request - the server keeps asking as long as
+ * the replies go out, bounded by the size of the request buffer
+ */
+static void
+controlRespond(SocketClient *socket)
+{
+	while(socket->bufferLength == 0 && nextRequest((ControlClient*)socket)) {
+		;
+	}
+}
+
+/*
+ * service our sockets after select() - with NULL sets (select() failed or
+ * timed out) only the idle timeouts are checked.
+ */
+void
+controlProcess(fd_set *readfds, fd_set *writefds)
+{
+
+	if(controlPtpClock == NULL) {
+		return;
+	}
+
+	socketServerProcess(&controlServer, readfds, writefds);
+
+}
@@ -1150,7 +1150,7 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 
 	/* from 30 seconds to 7 days */
 	parseResult &= configMapInt(opCode, opArg, dict, target, "ptpengine:unicast_grant_duration",
-		PTPD_RESTART_PROTOCOL, INTTYPE_U32, &rtOpts->unicastGrantDuration, rtOpts->unicastGrantDuration,
+		PTPD_RESTART_NONE, INTTYPE_U32, &rtOpts->unicastGrantDuration, rtOpts->unicastGrantDuration,
 		"Time (seconds) unicast messages are requested for by slaves\n"
 	"	 when using unicast negotiation, and maximum time unicast message\n"
 	"	 transmission is granted to slaves by masters\n", RANGECHECK_RANGE, 30, 604800);
@@ -1255,6 +1255,36 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 	CONFIG_CONDITIONAL_ASSERTION(rtOpts->logMinDelayReqInterval >= rtOpts->logMaxDelayReqInterval,
 					"ptpengine:log_delayreq_interval value must be lower than ptpengine:log_delayreq_interval_max\n");
 
+#ifdef PTPD_STATISTICS
+	parseResult &= configMapBoolean(opCode, opArg, dict, target, "ptpengine:delayreq_adaptive",
+		PTPD_RESTART_NONE, &rtOpts->delayReqAdaptive, rtOpts->delayReqAdaptive,
+		"Adapt the slave's Delay Request rate to mean path delay stability: send\n"
+	"	 Delay Requests at the minimum (master or grant) interval after master\n"
+	"	 acquisition and whenever path delay becomes unstable, and back off to\n"
+	"	 ptpengine:log_delayreq_interval_sparse once it is stable. Requires statistics.");
+
+	parseResult &= configMapInt(opCode, opArg, dict, target, "ptpengine:delayreq_burst_length",
+		PTPD_RESTART_NONE, INTTYPE_INT, &rtOpts->delayReqBurstLength, rtOpts->delayReqBurstLength,
+		"Number of Delay Requests sent at the minimum interval after master acquisition\n"
+	"	 or when path delay becomes unstable, before backing off is allowed.", RANGECHECK_RANGE, 1, 1024);
+
+	parseResult &= configMapInt(opCode, opArg, dict, target, "ptpengine:log_delayreq_interval_sparse",
+		PTPD_RESTART_NONE, INTTYPE_I8, &rtOpts->logDelayReqIntervalSparse, rtOpts->logDelayReqIntervalSparse,
+		"Delay Request interval used with ptpengine:delayreq_adaptive while mean path\n"
+	"	 delay is stable. Never faster than the minimum interval in use.\n"
+    "	"LOG2_HELP,RANGECHECK_RANGE,-7,7);
+
+	parseResult &= configMapDouble(opCode, opArg, dict, target, "ptpengine:delayreq_stability_threshold",
+		PTPD_RESTART_NONE, &rtOpts->delayReqStabilityThreshold, rtOpts->delayReqStabilityThreshold,
+		"Mean path delay standard deviation (nanoseconds) below which path delay\n"
+	"	 is considered stable.", RANGECHECK_RANGE, 1.0, 1000000000.0);
+
+	parseResult &= configMapInt(opCode, opArg, dict, target, "ptpengine:delayreq_stability_period",
+		PTPD_RESTART_NONE, INTTYPE_INT, &rtOpts->delayReqStabilityPeriod, rtOpts->delayReqStabilityPeriod,
+		"Number of statistics update intervals the mean path delay standard deviation\n"
+	"	 has to stay below threshold to be considered stable.", RANGECHECK_RANGE, 1, 100);
+#endif /* PTPD_STATISTICS */
+
 	parseResult &= configMapInt(opCode, opArg, dict, target, "ptpengine:log_peer_delayreq_interval",
 		PTPD_RESTART_NONE, INTTYPE_I8, &rtOpts->logMinPdelayReqInterval, rtOpts->logMinPdelayReqInterval,
 		"Minimum peer delay request message interval in peer to peer delay mode.\n"
@@ -1476,18 +1506,18 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 	"	 in master state.");
 
 	parseResult &= configMapInt(opCode, opArg, dict, target, "ptpengine:master_igmp_refresh_interval",
-		PTPD_RESTART_PROTOCOL, INTTYPE_I8, &rtOpts->masterRefreshInterval, rtOpts->masterRefreshInterval,
+		PTPD_UPDATE_TIMERS, INTTYPE_I8, &rtOpts->masterRefreshInterval, rtOpts->masterRefreshInterval,
 		"Periodic IGMP join interval (seconds) in master state when running\n"
 		"	 IPv4 multicast: when set below 10 or when ptpengine:igmp_refresh\n"
 		"	 is disabled, this setting has no effect.",RANGECHECK_RANGE,0,255);
 
 	parseResult &= configMapInt(opCode, opArg, dict, target, "ptpengine:multicast_ttl",
-		PTPD_RESTART_NETWORK, INTTYPE_INT, &rtOpts->ttl, rtOpts->ttl,
+		PTPD_UPDATE_SOCKETS, INTTYPE_INT, &rtOpts->ttl, rtOpts->ttl,
 		"Multicast time to live for multicast PTP packets (ignored and set to 1\n"
 	"	 for peer to peer messages).",RANGECHECK_RANGE,1,64);
 
 	parseResult &= configMapInt(opCode, opArg, dict, target, "ptpengine:ip_dscp",
-		PTPD_RESTART_NETWORK, INTTYPE_INT, &rtOpts->dscpValue, rtOpts->dscpValue,
+		PTPD_UPDATE_SOCKETS, INTTYPE_INT, &rtOpts->dscpValue, rtOpts->dscpValue,
 		"DiffServ CodepPoint for packet prioritisation (decimal). When set to zero, \n"
 	"	 this option is not used. Use 46 for Expedited Forwarding (0x2e).",RANGECHECK_RANGE,0,63);
 
@@ -1919,6 +1949,39 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 		PTPD_RESTART_NONE, rtOpts->driftFile, sizeof(rtOpts->driftFile), rtOpts->driftFile,
 	"Specify drift file");
 
+	parseResult &= configMapBoolean(opCode, opArg, dict, target, "clock:warm_start",
+		PTPD_RESTART_NONE, &rtOpts->warmStart, rtOpts->warmStart,
+		"Save a snapshot of the learned slave state (parent, path delay, servo drift and\n"
+	"	 statistics, outlier filter thresholds, UTC offset and leap\n"
+	"	 flags) periodically and on shutdown, and restore it on startup. When the same\n"
+	"	 parent is selected again, the path delay filter is pre-loaded and calibration\n"
+	"	 is skipped, so the clock converges immediately. To keep unicast grants\n"
+	"	 running across a restart, use the clock:warm_start_keep_grants setting.\n"
+	"	 To specify the state file, use the clock:warm_start_file setting.");
+
+	parseResult &= configMapString(opCode, opArg, dict, target, "clock:warm_start_file",
+		PTPD_RESTART_NONE, rtOpts->warmStartFile, sizeof(rtOpts->warmStartFile), rtOpts->warmStartFile,
+	"Specify warm start state file");
+
+	parseResult &= configMapInt(opCode, opArg, dict, target, "clock:warm_start_save_interval",
+		PTPD_RESTART_NONE, INTTYPE_INT, &rtOpts->warmStartSaveInterval, rtOpts->warmStartSaveInterval,
+		"Interval (seconds) between warm start state snapshots while in slave state.",
+	RANGECHECK_RANGE, 5, 3600);
+
+	parseResult &= configMapInt(opCode, opArg, dict, target, "clock:warm_start_max_age",
+		PTPD_RESTART_NONE, INTTYPE_INT, &rtOpts->warmStartMaxAge, rtOpts->warmStartMaxAge,
+		"Maximum age (seconds) of a warm start state snapshot to be used on startup.",
+	RANGECHECK_RANGE, 10, 86400);
+
+	parseResult &= configMapBoolean(opCode, opArg, dict, target, "clock:warm_start_keep_grants",
+		PTPD_RESTART_NONE, &rtOpts->warmStartKeepGrants, rtOpts->warmStartKeepGrants,
+		"Do not cancel the unicast grants received from the parent when stopped with\n"
+	"	 SIGINT or SIGTERM, and save them in the warm start snapshot, so that the\n"
+	"	 master keeps serving them across a planned restart. Only enable this if\n"
+	"	 the daemon is always restarted: after a permanent stop, the master keeps\n"
+	"	 sending until the grants expire. Grants are always cancelled when exiting\n"
+	"	 on an error. Requires clock:warm_start.");
+
 	parseResult &= configMapInt(opCode, opArg, dict, target, "clock:leap_second_pause_period",
 		PTPD_RESTART_NONE, INTTYPE_INT, &rtOpts->leapSecondPausePeriod,
 		rtOpts->leapSecondPausePeriod,
@@ -2007,6 +2070,24 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 		"Maximum servo update interval (delta t) when using measured servo update interval\n"
 	"	 (servo:dt_method = measured), specified as sync interval multiplier.", RANGECHECK_RANGE, 1.5,100.0);
 
+	parseResult &= configMapDouble(opCode, opArg, dict, target, "servo:update_interval",
+		PTPD_UPDATE_TIMERS, &rtOpts->servoUpdateInterval, rtOpts->servoUpdateInterval,
+		"Run the clock servo at a fixed interval (seconds) instead of on every offset\n"
+	"	 update. Offsets received in between are queued and combined using\n"
+	"	 servo:update_method. 0 = servo runs on every offset update (Sync rate).", RANGECHECK_RANGE, 0.0, 60.0);
+
+	parseResult &= configMapSelectValue(opCode, opArg, dict, target, "servo:update_method",
+		PTPD_RESTART_NONE, &rtOpts->servoUpdateMethod, rtOpts->servoUpdateMethod,
+		"How queued offsets are combined into a single servo input when\n"
+	"	 servo:update_interval is set:\n"
+	"	 mean:       arithmetic mean,\n"
+	"	 median:     median - rejects occasional outliers,\n"
+	"	 regression: linear fit, offset estimated at the time of the servo update.",
+			"mean", SERVO_COMBINE_MEAN,
+			"median", SERVO_COMBINE_MEDIAN,
+			"regression", SERVO_COMBINE_REGRESSION, NULL
+	);
+
 #ifdef PTPD_STATISTICS
 	parseResult &= configMapBoolean(opCode, opArg, dict, target, "servo:stability_detection",
 		PTPD_RESTART_NONE, &rtOpts->servoStabilityDetection,
@@ -2038,6 +2119,30 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 	"	 allows to preserve observed drift if servo cannot stabilise.\n", RANGECHECK_RANGE,
 	1,60);
 
+	parseResult &= configMapBoolean(opCode, opArg, dict, target, "servo:holdover_enable",
+		PTPD_RESTART_NONE, &rtOpts->holdoverEnabled, rtOpts->holdoverEnabled,
+		"Enable holdover: while the servo is locked, build a model of the observed drift\n"
+	"	 and its trend from the statistics updates, and keep applying the predicted\n"
+	"	 frequency when the master is lost.");
+
+	parseResult &= configMapInt(opCode, opArg, dict, target, "servo:holdover_window",
+		PTPD_RESTART_NONE, INTTYPE_INT, &rtOpts->holdoverWindow, rtOpts->holdoverWindow,
+		"Number of statistics update intervals (global:statistics_update_interval)\n"
+	"	 of observed drift used to build the holdover frequency model.", RANGECHECK_RANGE,
+	HOLDOVER_MIN_SAMPLES, HOLDOVER_WINDOW_MAX);
+
+	parseResult &= configMapInt(opCode, opArg, dict, target, "servo:holdover_max_duration",
+		PTPD_RESTART_NONE, INTTYPE_INT, &rtOpts->holdoverMaxDuration, rtOpts->holdoverMaxDuration,
+		"Time (seconds) after which the drift trend is no longer extrapolated in holdover\n"
+	"	 and the last predicted frequency is held. 0 = no limit.", RANGECHECK_RANGE,
+	0, 604800);
+
+	parseResult &= configMapInt(opCode, opArg, dict, target, "servo:holdover_alarm_threshold",
+		PTPD_RESTART_NONE, INTTYPE_I32, &rtOpts->holdoverAlarmThreshold, rtOpts->holdoverAlarmThreshold,
+		"Estimated holdover time error (nanoseconds) above which the HOLDOVER alarm is raised.\n"
+	"	 0 = raise the alarm as soon as the clock enters holdover.", RANGECHECK_RANGE,
+	0, NANOSECONDS_MAX);
+
 #endif
 
 	parseResult &= configMapInt(opCode, opArg, dict, target, "servo:max_delay",
@@ -2063,7 +2168,7 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 	"        This is limited to 50 dropped messages.\n");
 
 	parseResult &= configMapInt(opCode, opArg, dict, target, "ptpengine:clock_update_timeout",
-		PTPD_RESTART_PROTOCOL, INTTYPE_INT, &rtOpts->clockUpdateTimeout, rtOpts->clockUpdateTimeout,
+		PTPD_UPDATE_TIMERS, INTTYPE_INT, &rtOpts->clockUpdateTimeout, rtOpts->clockUpdateTimeout,
 		"If set to non-zero, timeout in seconds, after which the slave resets if no clock updates made. \n", RANGECHECK_RANGE,
 		0, 3600);
 
@@ -2098,6 +2203,12 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 	parseResult &= configMapBoolean(opCode, opArg, dict, target, "global:enable_snmp_traps",
 	    PTPD_RESTART_ALARMS, &rtOpts->snmpTrapsEnabled, rtOpts->snmpTrapsEnabled,
 		 "Enable sending SNMP traps (only if global:enable_alarms set and global:enable_snmp set).\n");
+	parseResult &= configMapInt(opCode, opArg, dict, target, "global:snmp_snapshot_interval",
+		PTPD_RESTART_NONE, INTTYPE_INT, &rtOpts->snmpSnapshotInterval, rtOpts->snmpSnapshotInterval,
+		"Interval (seconds) at which the SNMP agent's view of the clock is refreshed.\n"
+	"	 SNMP requests are served from this snapshot by a separate thread, so that\n"
+	"	 walks never delay the protocol engine. Counter clears are applied on the next refresh.",
+	RANGECHECK_RANGE, 1, 60);
 #else
 	if(!(opCode & CFGOP_PARSE_QUIET) && CONFIG_ISTRUE("global:enable_snmp"))
 	    INFO("SNMP support not enabled. Please compile with PTPD_SNMP to use global:enable_snmp\n");
@@ -2112,6 +2223,13 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 		"Send log messages to syslog. Disabling this\n"
 	"        sends all messages to stdout (or speficied log file).");
 
+	parseResult &= configMapBoolean(opCode, opArg, dict, target, "global:log_async",
+		PTPD_RESTART_LOGGING, &rtOpts->logAsync, rtOpts->logAsync,
+		"Hand all log, statistics and status file output over to a separate\n"
+	"	 writer thread, so that the protocol engine never waits for disk or syslog.\n"
+	"	 When the writer falls behind, records below warning level are dropped\n"
+	"	 first and counted in the logRecordsDropped counter.");
+
 	parseResult &= configMapString(opCode, opArg, dict, target, "global:lock_file",
 		PTPD_RESTART_DAEMON, rtOpts->lockFile, sizeof(rtOpts->lockFile), rtOpts->lockFile,
 	"Lock file location");
@@ -2167,6 +2285,40 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 		"Status file update interval in seconds.", RANGECHECK_RANGE,
 	1,30);
 
+	parseResult &= configMapBoolean(opCode, opArg, dict, target, "global:stats_segment",
+		PTPD_RESTART_LOGGING, &rtOpts->statsSegment, rtOpts->statsSegment,
+		"Publish port state, offset, delay, drift, counters, slave statistics and\n"
+	"	 alarm states in a POSIX shared memory segment, updated on every servo\n"
+	"	 update and at least every global:status_update_interval seconds.\n"
+	"	 Read it with ptpd2-shmstat or the reader in dep/statsshm.h.");
+
+	parseResult &= configMapString(opCode, opArg, dict, target, "global:stats_segment_name",
+		PTPD_RESTART_LOGGING, rtOpts->statsSegmentName, sizeof(rtOpts->statsSegmentName), rtOpts->statsSegmentName,
+		"Name of the shared memory statistics segment (see shm_open(3)).\n"
+	"	 If not set, /"PTPD_PROGNAME".<interface> is used.");
+
+	parseResult &= configMapBoolean(opCode, opArg, dict, target, "global:metrics_export",
+		PTPD_RESTART_LOGGING, &rtOpts->metricsExport, rtOpts->metricsExport,
+		"Serve port state, servo state, counters, slave statistics, alarm states,\n"
+	"	 access list counters and unicast grant table usage in OpenMetrics\n"
+	"	 (Prometheus) text format over HTTP at global:metrics_address.");
+
+	parseResult &= configMapString(opCode, opArg, dict, target, "global:metrics_address",
+		PTPD_RESTART_LOGGING, rtOpts->metricsAddress, sizeof(rtOpts->metricsAddress), rtOpts->metricsAddress,
+		"Address of the OpenMetrics endpoint: [IPv4 address:]port for TCP, where the\n"
+	"	 address defaults to 127.0.0.1, or an absolute path for a Unix socket.");
+
+	parseResult &= configMapBoolean(opCode, opArg, dict, target, "global:control_socket",
+		PTPD_RESTART_LOGGING, &rtOpts->controlSocket, rtOpts->controlSocket,
+		"Accept local control requests on a Unix socket at global:control_socket_path:\n"
+	"	 dataset queries, statistics, counters, unicast grant tables and\n"
+	"	 configuration changes, one request per line. The socket is only\n"
+	"	 accessible to the user running "PTPD_PROGNAME".");
+
+	parseResult &= configMapString(opCode, opArg, dict, target, "global:control_socket_path",
+		PTPD_RESTART_LOGGING, rtOpts->controlSocketPath, sizeof(rtOpts->controlSocketPath), rtOpts->controlSocketPath,
+		"Absolute path of the control socket.");
+
 #ifdef RUNTIME_DEBUG
 	parseResult &= configMapSelectValue(opCode, opArg, dict, target, "global:debug_level",
 		PTPD_RESTART_NONE, (uint8_t*)&rtOpts->debug_level, rtOpts->debug_level,
@@ -2230,7 +2382,8 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 	parseResult &= configMapInt(opCode, opArg, dict, target, "global:statistics_log_interval",
 		PTPD_RESTART_NONE, INTTYPE_INT, &rtOpts->statisticsLogInterval, rtOpts->statisticsLogInterval,
 		 "Log timing statistics every n seconds for Sync and Delay messages\n"
-	"	 (0 - log all).",RANGECHECK_MIN,0,0);
+	"	 (0 - log all). With global:statistics_log_mode=aggregate, this is\n"
+	"	 the summary interval.",RANGECHECK_MIN,0,0);
 
 	parseResult &= configMapInt(opCode, opArg, dict, target, "global:statistics_file_max_size",
 		PTPD_RESTART_LOGGING, INTTYPE_U32, &rtOpts->statisticsLog.maxSize, rtOpts->statisticsLog.maxSize,
@@ -2295,6 +2448,36 @@ parseConfig ( int opCode, void *opArg, dictionary* dict, RunTimeOpts *rtOpts )
 		"both",		TIMESTAMP_BOTH, NULL
 		);
 
+	parseResult &= configMapSelectValue(opCode, opArg, dict, target, "global:statistics_log_format",
+		PTPD_RESTART_LOGGING, &rtOpts->statisticsLogFormat, rtOpts->statisticsLogFormat,
+		"Format of the statistics log file:\n"
+	"        csv - one comma separated text line per sample\n"
+	"        binary - fixed-size little-endian records with a versioned header,\n"
+	"                 decoded with ptpd2-statsdecode. Only used with global:statistics_file,\n"
+	"                 statistics logged to standard output are always CSV.\n",
+		"csv",		STATSLOG_FORMAT_CSV,
+		"binary",	STATSLOG_FORMAT_BINARY, NULL
+		);
+
+	parseResult &= configMapSelectValue(opCode, opArg, dict, target, "global:statistics_log_mode",
+		PTPD_RESTART_NONE, &rtOpts->statisticsLogMode, rtOpts->statisticsLogMode,
+		"Statistics log mode:\n"
+	"        sample - log every sample, or one Sync and one Delay sample\n"
+	"                 per global:statistics_log_interval seconds\n"
+	"        aggregate - log one summary per global:statistics_log_interval\n"
+	"                 seconds (minimum 1): count, min, max, mean and std dev\n"
+	"                 of offset and delay, percentiles when compiled with\n"
+	"                 statistics support, sequence errors and outliers.\n"
+	"                 Every sample is counted. CSV format only.\n",
+		"sample",	STATSLOG_MODE_SAMPLE,
+		"aggregate",	STATSLOG_MODE_AGGREGATE, NULL
+		);
+
+	CONFIG_KEY_CONDITIONAL_ASSERTION("global:statistics_log_mode",
+		rtOpts->statisticsLogMode == STATSLOG_MODE_AGGREGATE &&
+		rtOpts->statisticsLogFormat == STATSLOG_FORMAT_BINARY,
+		"global:statistics_log_mode=aggregate can only be used with global:statistics_log_format=csv");
+
 	/* If statistics file is enabled but logStatistics isn't, disable logging to file */
 	CONFIG_KEY_CONDITIONAL_TRIGGER(rtOpts->statisticsLog.logEnabled && !rtOpts->logStatistics,
 					rtOpts->statisticsLog.logEnabled, FALSE, rtOpts->statisticsLog.logEnabled);
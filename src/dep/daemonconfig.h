@@ -40,6 +40,10 @@
 #define PTPD_RESTART_NTPENGINE	1 << 10
 #define PTPD_RESTART_NTPCONFIG	1 << 11
 #define PTPD_RESTART_ALARMS	1 << 12
+/* Timer intervals changed: running timers can be re-armed in place */
+#define PTPD_UPDATE_TIMERS	1 << 13
+/* Socket options changed: can be re-applied to the open sockets */
+#define PTPD_UPDATE_SOCKETS	1 << 14
 
 #define LOG2_HELP "(expressed as log 2 i.e. -1=0.5s, 0=1s, 1=2s etc.)"
 #define MAX_LINE_SIZE 1024
@@ -100,6 +100,7 @@ typedef struct {
 	Boolean logEnabled;
 	Boolean truncateOnReopen;
 	Boolean unlinkOnClose;
+	Boolean rotated;	/* set by the log writer thread after rotation */
 
 	uint32_t lastHash;
 	UInteger32 maxSize;
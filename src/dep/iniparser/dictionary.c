@@ -70,6 +70,59 @@ static char * xstrdup(const char * s)
     return t ;
 }
 
+/*
+ * (Re)build the hash index for the current storage size. The index has
+ * at least twice as many slots as the storage, so it is never more than
+ * half full and probe sequences stay short. An index of the right size
+ * is cleared and reused, so this only fails when the dictionary grows,
+ * and then leaves the old index in place.
+ */
+static int dictionary_reindex(dictionary * d)
+{
+    unsigned    slots ;
+    unsigned    slot ;
+    int     *   index ;
+    int         i ;
+
+    for (slots=1 ; slots < 2 * (unsigned)d->size ; slots <<= 1)
+        ;
+
+    if (d->index!=NULL && slots==d->mask + 1) {
+        memset(d->index, 0, slots * sizeof(int));
+    } else {
+        index = (int *)calloc(slots, sizeof(int));
+        if (index==NULL) {
+            return -1 ;
+        }
+        free(d->index);
+        d->index = index ;
+        d->mask = slots - 1 ;
+    }
+
+    for (i=0 ; i<d->n ; i++) {
+        for (slot = d->hash[i] & d->mask ; d->index[slot] ; slot = (slot + 1) & d->mask)
+            ;
+        d->index[slot] = i + 1 ;
+    }
+    return 0 ;
+}
+
+/* Position of a key in the entry arrays, -1 if not present */
+static int dictionary_lookup(dictionary * d, const char * key, unsigned hash)
+{
+    unsigned    slot ;
+    int         i ;
+
+    for (slot = hash & d->mask ; d->index[slot] ; slot = (slot + 1) & d->mask) {
+        i = d->index[slot] - 1 ;
+        /* Compare hash, then string to avoid hash collisions */
+        if (hash==d->hash[i] && !strcmp(key, d->key[i])) {
+            return i ;
+        }
+    }
+    return -1 ;
+}
+
 /*---------------------------------------------------------------------------
                             Function codes
  ---------------------------------------------------------------------------*/
@@ -128,6 +181,13 @@ dictionary * dictionary_new(int size)
     d->val  = (char **)calloc(size, sizeof(char*));
     d->key  = (char **)calloc(size, sizeof(char*));
     d->hash = (unsigned int *)calloc(size, sizeof(unsigned));
+    if (d->val==NULL || d->key==NULL || d->hash==NULL || dictionary_reindex(d)) {
+        free(d->val);
+        free(d->key);
+        free(d->hash);
+        free(d);
+        return NULL ;
+    }
     return d ;
 }
 
@@ -154,6 +214,7 @@ void dictionary_del(dictionary ** d)
     free((*d)->val);
     free((*d)->key);
     free((*d)->hash);
+    free((*d)->index);
     free(*d);
     *d = NULL;
     return ;
@@ -175,22 +236,10 @@ void dictionary_del(dictionary ** d)
 /*--------------------------------------------------------------------------*/
 char * dictionary_get(dictionary * d, const char * key, char * def)
 {
-    unsigned    hash ;
     int         i ;
 
-    hash = dictionary_hash(key);
-    for (i=0 ; i<d->size ; i++) {
-        if (d->key[i]==NULL)
-            continue ;
-        /* Compare hash */
-        if (hash==d->hash[i]) {
-            /* Compare string, to avoid hash collisions */
-            if (!strcmp(key, d->key[i])) {
-                return d->val[i] ;
-            }
-        }
-    }
-    return def ;
+    i = dictionary_lookup(d, key, dictionary_hash(key));
+    return (i < 0) ? def : d->val[i] ;
 }
 
 /*-------------------------------------------------------------------------*/
@@ -223,27 +272,21 @@ int dictionary_set(dictionary * d, const char * key, const char * val)
 {
     int         i ;
     unsigned    hash ;
+    unsigned    slot ;
 
     if (d==NULL || key==NULL) return -1 ;
-   
+
     /* Compute hash for this key */
     hash = dictionary_hash(key) ;
     /* Find if value is already in dictionary */
-    if (d->n>0) {
-        for (i=0 ; i<d->size ; i++) {
-            if (d->key[i]==NULL)
-                continue ;
-            if (hash==d->hash[i]) { /* Same hash value */
-                if (!strcmp(key, d->key[i])) {   /* Same key */
-                    /* Found a value: modify and return */
-                    if (d->val[i]!=NULL)
-                        free(d->val[i]);
-                    d->val[i] = val ? xstrdup(val) : NULL ;
-                    /* Value has been modified: return */
-                    return 0 ;
-                }
-            }
-        }
+    i = dictionary_lookup(d, key, hash);
+    if (i >= 0) {
+        /* Found a value: modify and return */
+        if (d->val[i]!=NULL)
+            free(d->val[i]);
+        d->val[i] = val ? xstrdup(val) : NULL ;
+        /* Value has been modified: return */
+        return 0 ;
     }
     /* Add a new value */
     /* See if dictionary needs to grow */
@@ -259,20 +302,22 @@ int dictionary_set(dictionary * d, const char * key, const char * val)
         }
         /* Double size */
         d->size *= 2 ;
+        if (dictionary_reindex(d)) {
+            return -1 ;
+        }
     }
 
-    /* Insert key in the first empty slot. Start at d->n and wrap at
-       d->size. Because d->n < d->size this will necessarily
-       terminate. */
-    for (i=d->n ; d->key[i] ; ) {
-        if(++i == d->size) i = 0;
-    }
-    /* Copy key */
+    /* Append, keeping insertion order */
+    i = d->n ;
     d->key[i]  = xstrdup(key);
     d->val[i]  = val ? xstrdup(val) : NULL ;
     d->hash[i] = hash;
     d->n ++ ;
 
+    for (slot = hash & d->mask ; d->index[slot] ; slot = (slot + 1) & d->mask)
+        ;
+    d->index[slot] = i + 1 ;
+
     return 0 ;
 
 }
@@ -290,38 +335,32 @@ int dictionary_set(dictionary * d, const char * key, const char * val)
 /*--------------------------------------------------------------------------*/
 void dictionary_unset(dictionary * d, const char * key)
 {
-    unsigned    hash ;
     int         i ;
 
     if (key == NULL) {
         return;
     }
 
-    hash = dictionary_hash(key);
-    for (i=0 ; i<d->size ; i++) {
-        if (d->key[i]==NULL)
-            continue ;
-        /* Compare hash */
-        if (hash==d->hash[i]) {
-            /* Compare string, to avoid hash collisions */
-            if (!strcmp(key, d->key[i])) {
-                /* Found key */
-                break ;
-            }
-        }
-    }
-    if (i>=d->size)
+    i = dictionary_lookup(d, key, dictionary_hash(key));
+    if (i < 0)
         /* Key not found */
         return ;
 
     free(d->key[i]);
-    d->key[i] = NULL ;
     if (d->val[i]!=NULL) {
         free(d->val[i]);
-        d->val[i] = NULL ;
     }
-    d->hash[i] = 0 ;
+
+    /* Close the gap to keep entries in order, then rebuild the index */
+    memmove(&d->key[i], &d->key[i+1], (d->n - i - 1) * sizeof(char*));
+    memmove(&d->val[i], &d->val[i+1], (d->n - i - 1) * sizeof(char*));
+    memmove(&d->hash[i], &d->hash[i+1], (d->n - i - 1) * sizeof(unsigned));
     d->n -- ;
+    d->key[d->n] = NULL ;
+    d->val[d->n] = NULL ;
+    d->hash[d->n] = 0 ;
+
+    dictionary_reindex(d);
     return ;
 }
 
@@ -428,7 +467,7 @@ void dictionary_dump(dictionary * d, FILE * out)
         fprintf(out, "empty dictionary\n");
         return ;
     }
-    for (i=0 ; i<d->size ; i++) {
+    for (i=0 ; i<d->n ; i++) {
         if (d->key[i]) {
             fprintf(out, "%20s\t[%s]\n",
                     d->key[i],
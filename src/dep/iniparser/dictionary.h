@@ -41,9 +41,10 @@ void logMessage(int priority, const char *format, ...);
   @brief    Dictionary object
 
   This object contains a list of string/string associations. Each
-  association is identified by a unique string key. Looking up values
-  in the dictionary is speeded up by the use of a (hopefully collision-free)
-  hash function.
+  association is identified by a unique string key. Entries are kept
+  in insertion order in positions 0 to n-1 of the key, val and hash
+  arrays, and looked up through an open addressing (linear probing)
+  index over their hash values.
  */
 /*-------------------------------------------------------------------------*/
 typedef struct _dictionary_ {
@@ -52,6 +53,8 @@ typedef struct _dictionary_ {
     char        **  val ;   /** List of string values */
     char        **  key ;   /** List of string keys */
     unsigned     *  hash ;  /** List of hash values for keys */
+    int          *  index ; /** Hash index: entry position + 1, 0 if free */
+    unsigned        mask ;  /** Hash index size - 1 */
 } dictionary ;
 
 
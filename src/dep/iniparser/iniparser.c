@@ -116,7 +116,7 @@ int iniparser_getnsec(dictionary * d)
 
     if (d==NULL) return -1 ;
     nsec=0 ;
-    for (i=0 ; i<d->size ; i++) {
+    for (i=0 ; i<d->n ; i++) {
         if (d->key[i]==NULL)
             continue ;
         if (strchr(d->key[i], ':')==NULL) {
@@ -147,7 +147,7 @@ char * iniparser_getsecname(dictionary * d, int n)
 
     if (d==NULL || n<0) return NULL ;
     foundsec=0 ;
-    for (i=0 ; i<d->size ; i++) {
+    for (i=0 ; i<d->n ; i++) {
         if (d->key[i]==NULL)
             continue ;
         if (strchr(d->key[i], ':')==NULL) {
@@ -180,7 +180,7 @@ void iniparser_dump(dictionary * d, FILE * f)
     int     i ;
 
     if (d==NULL || f==NULL) return ;
-    for (i=0 ; i<d->size ; i++) {
+    for (i=0 ; i<d->n ; i++) {
         if (d->key[i]==NULL)
             continue ;
         if (d->val[i]!=NULL) {
@@ -214,7 +214,7 @@ void iniparser_dump_ini(dictionary * d, FILE * f)
     nsec = iniparser_getnsec(d);
     if (nsec<1) {
         /* No section in file: dump all keys as they are */
-        for (i=0 ; i<d->size ; i++) {
+        for (i=0 ; i<d->n ; i++) {
             if (d->key[i]==NULL)
                 continue ;
             fprintf(f, "%s = %s\n", d->key[i], d->val[i]);
@@ -253,7 +253,7 @@ void iniparser_dumpsection_ini(dictionary * d, char * s, FILE * f)
     seclen  = (int)strlen(s);
     fprintf(f, "\n[%s]\n", s);
     snprintf(keym, ASCIILINESZ, "%s:", s);
-    for (j=0 ; j<d->size ; j++) {
+    for (j=0 ; j<d->n ; j++) {
         if (d->key[j]==NULL)
             continue ;
         if (!strncmp(d->key[j], keym, seclen+1)) {
@@ -289,7 +289,7 @@ int iniparser_getsecnkeys(dictionary * d, char * s)
     seclen  = (int)strlen(s);
     snprintf(keym, ASCIILINESZ, "%s:", s);
 
-    for (j=0 ; j<d->size ; j++) {
+    for (j=0 ; j<d->n ; j++) {
         if (d->key[j]==NULL)
             continue ;
         if (!strncmp(d->key[j], keym, seclen+1))
@@ -337,7 +337,7 @@ char ** iniparser_getseckeys(dictionary * d, char * s)
    
     i = 0;
 
-    for (j=0 ; j<d->size ; j++) {
+    for (j=0 ; j<d->n ; j++) {
         if (d->key[j]==NULL)
             continue ;
         if (!strncmp(d->key[j], keym, seclen+1)) {
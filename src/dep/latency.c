@@ -0,0 +1,152 @@
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file    latency.c
+ * @authors The PTPd Project
+ * @date   Tue Feb 2 14:20:51 2016
+ * This source file contains the hot path latency probes: time from packet
+ * receipt to dispatch, offset computation and servo update, and Sync
+ * transmit lateness against the Sync interval timer.
+ */
+
+#include "../ptpd.h"
+
+static void
+feedLatencyStage(const RunTimeOpts *rtOpts, PtpClock *ptpClock, int stage, int64_t ns)
+{
+	LatencyProbes *probes = &ptpClock->latency;
+	LatencyStage *st = &probes->stages[stage];
+#ifdef PTPD_STATISTICS
+	TimeInternal now;
+	int i;
+#endif /* PTPD_STATISTICS */
+
+	/* the local clock may have been stepped in between */
+	if(ns < 0) {
+		ns = 0;
+	}
+	if(ns > UINT32_MAX) {
+		ns = UINT32_MAX;
+	}
+
+	st->count++;
+	st->last = ns;
+	st->total += ns;
+	if(ns > st->max) {
+		st->max = ns;
+	}
+
+#ifdef PTPD_STATISTICS
+	feedLogHistogram(&st->live, ns / 1E9);
+
+	getTimeMonotonic(&now);
+	if(now.seconds - probes->snapshotTime >= rtOpts->statsUpdateInterval) {
+		probes->snapshotTime = now.seconds;
+		for(i = 0; i < LATENCY_STAGE_MAX; i++) {
+			snapshotLogHistogram(&probes->stages[i].live, &probes->stages[i].snapshot);
+			resetLogHistogram(&probes->stages[i].live);
+		}
+	}
+#endif /* PTPD_STATISTICS */
+}
+
+void
+resetLatencyProbes(LatencyProbes *probes)
+{
+	memset(probes, 0, sizeof(*probes));
+}
+
+/*
+ * Called when a message is dispatched. Event messages carry the kernel
+ * receive timestamp (local clock), general messages have none (NULL) and
+ * start the clock here. Later stages add monotonic time since dispatch.
+ */
+void
+latencyRxDispatch(const RunTimeOpts *rtOpts, PtpClock *ptpClock, const TimeInternal *rxTime)
+{
+	LatencyProbes *probes = &ptpClock->latency;
+	TimeInternal now;
+
+	getTimeMonotonic(&probes->rxMonotonic);
+
+	if(rxTime == NULL || (rxTime->seconds == 0 && rxTime->nanoseconds == 0)) {
+		probes->rxDispatch = 0;
+		return;
+	}
+
+	getTime(&now);
+	subTime(&now, &now, rxTime);
+
+	probes->rxDispatch = min(max(timeInternalToDouble(&now) * 1E9, 0), UINT32_MAX);
+	feedLatencyStage(rtOpts, ptpClock, LATENCY_RX_DISPATCH, probes->rxDispatch);
+}
+
+void
+latencyRxStage(const RunTimeOpts *rtOpts, PtpClock *ptpClock, int stage)
+{
+	LatencyProbes *probes = &ptpClock->latency;
+	TimeInternal now;
+
+	getTimeMonotonic(&now);
+	subTime(&now, &now, &probes->rxMonotonic);
+
+	feedLatencyStage(rtOpts, ptpClock, stage, probes->rxDispatch +
+		(int64_t)now.seconds * 1000000000 + now.nanoseconds);
+}
+
+/* called from issueSync(): how late are we against the timer deadline */
+void
+latencyTxSync(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+	IntervalTimer *timer = &ptpClock->timers[SYNC_INTERVAL_TIMER];
+	TimeInternal now;
+
+	getTimeMonotonic(&now);
+
+	ptpClock->latency.syncOverruns += timer->overruns;
+	feedLatencyStage(rtOpts, ptpClock, LATENCY_TX_SYNC,
+		(timeInternalToDouble(&now) - timer->lastDeadline) * 1E9);
+}
+
+const char*
+getLatencyStageName(int stage)
+{
+	switch(stage) {
+	case LATENCY_RX_DISPATCH:
+		return "Rx to dispatch";
+	case LATENCY_RX_OFFSET:
+		return "Rx to offset";
+	case LATENCY_RX_SERVO:
+		return "Rx to servo";
+	case LATENCY_TX_SYNC:
+		return "Sync Tx lateness";
+	default:
+		return "unknown";
+	}
+}
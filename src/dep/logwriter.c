@@ -0,0 +1,505 @@
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file    logwriter.c
+ * @authors The PTPd Project
+ * @date   Sat Jan 9 16:14:10 2016
+ * This source file contains the implementation of the asynchronous
+ * log writer. All file, console and syslog output can be handed
+ * over to a separate thread through a lock-free single producer /
+ * single consumer byte ring, so that the protocol engine never blocks
+ * on disk I/O. The producer is always the main thread. Log output is
+ * owned by the main thread whether the writer runs or not - messages
+ * logged by any other thread (the writer itself, the SNMP agent) are
+ * parked in a small locked queue and logged by the main thread.
+ */
+
+#include "../ptpd.h"
+
+#ifdef PTPD_LOGWRITER
+
+#include <pthread.h>
+#include <semaphore.h>
+
+/* record header, followed by the NUL-terminated payload */
+typedef struct {
+	uint32_t size;		/* total record size including header, aligned */
+	uint32_t length;	/* payload length excluding the terminating NUL */
+	int16_t type;
+	int16_t priority;
+	LogFileHandler *handler;
+} LogRecordHeader;
+
+/* records are 32-byte aligned, so any skipped tail can hold a wrap marker */
+#define LOGRECORD_ALIGN(x) (((x) + 31) & ~((uint32_t)31))
+
+typedef struct {
+	/* written by the producer only */
+	uint32_t head;
+	char pad1[60];
+	/* written by the consumer only */
+	uint32_t tail;
+	char pad2[60];
+	int sleeping;
+	int running;
+	Boolean started;
+	pthread_t thread;
+	pthread_t producer;
+	sem_t wakeup;
+	uint32_t dropped;
+	char buffer[LOGWRITER_RING_SIZE];
+} LogWriter;
+
+static LogWriter writer;
+
+typedef struct {
+	int priority;
+	char message[LOGWRITER_DEFERRED_LENGTH];
+} LogDeferredMessage;
+
+/* messages from other threads: any number of producers, the main thread consumes */
+typedef struct {
+	Boolean ownerSet;
+	pthread_t owner;
+	pthread_mutex_t lock;
+	uint32_t head;
+	uint32_t tail;
+	uint32_t dropped;
+	Boolean flushing;
+	LogDeferredMessage messages[LOGWRITER_DEFERRED_MAX];
+} LogDeferredQueue;
+
+static LogDeferredQueue deferred = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static void* logWriterThread(void *arg);
+static void dispatchRecord(LogRecordHeader *header, char *data);
+static Boolean ringGet(LogRecordHeader **header, char **data);
+static void ringRelease(LogRecordHeader *header);
+
+/* producer: reserve space and copy a record into the ring */
+Boolean
+logWriterQueue(int type, LogFileHandler *handler, int priority, const char *data, int len)
+{
+
+	extern PtpClock *G_ptpClock;
+
+	uint32_t head, tail, size, offset, skip = 0;
+	uint32_t limit = (priority <= LOG_WARNING) ? LOGWRITER_RING_SIZE : LOGWRITER_LOW_WATERMARK;
+	LogRecordHeader *header;
+
+	if(len < 0) {
+		return FALSE;
+	}
+
+	if(len > LOGWRITER_RECORD_MAX) {
+		len = LOGWRITER_RECORD_MAX;
+	}
+
+	size = LOGRECORD_ALIGN(sizeof(LogRecordHeader) + len + 1);
+
+	head = __atomic_load_n(&writer.head, __ATOMIC_RELAXED);
+	tail = __atomic_load_n(&writer.tail, __ATOMIC_ACQUIRE);
+	offset = head & (LOGWRITER_RING_SIZE - 1);
+
+	/* records are contiguous - skip the remainder of the ring if it does not fit */
+	if((LOGWRITER_RING_SIZE - offset) < size) {
+		skip = LOGWRITER_RING_SIZE - offset;
+	}
+
+	if((head - tail) + skip + size > limit) {
+		writer.dropped++;
+		if(G_ptpClock != NULL) {
+			G_ptpClock->counters.logRecordsDropped++;
+		}
+		return FALSE;
+	}
+
+	if(skip) {
+		header = (LogRecordHeader*)(writer.buffer + offset);
+		header->type = LOGWRITER_WRAP;
+		header->size = skip;
+		head += skip;
+		offset = 0;
+	}
+
+	header = (LogRecordHeader*)(writer.buffer + offset);
+	header->size = size;
+	header->length = len;
+	header->type = type;
+	header->priority = priority;
+	header->handler = handler;
+	memcpy(writer.buffer + offset + sizeof(LogRecordHeader), data, len);
+	writer.buffer[offset + sizeof(LogRecordHeader) + len] = '\0';
+
+	__atomic_store_n(&writer.head, head + size, __ATOMIC_RELEASE);
+
+	/* only wake the writer up if it went to sleep - no syscall otherwise */
+	if(__atomic_exchange_n(&writer.sleeping, 0, __ATOMIC_SEQ_CST)) {
+		sem_post(&writer.wakeup);
+	}
+
+	return TRUE;
+
+}
+
+/* consumer: peek at the next record, skipping wrap markers */
+static Boolean
+ringGet(LogRecordHeader **header, char **data)
+{
+
+	uint32_t head, tail, offset;
+	LogRecordHeader *h;
+
+	tail = __atomic_load_n(&writer.tail, __ATOMIC_RELAXED);
+
+	for(;;) {
+		head = __atomic_load_n(&writer.head, __ATOMIC_ACQUIRE);
+		if(head == tail) {
+			return FALSE;
+		}
+		offset = tail & (LOGWRITER_RING_SIZE - 1);
+		h = (LogRecordHeader*)(writer.buffer + offset);
+		if(h->type != LOGWRITER_WRAP) {
+			break;
+		}
+		tail += h->size;
+		__atomic_store_n(&writer.tail, tail, __ATOMIC_RELEASE);
+	}
+
+	*header = h;
+	*data = (char*)h + sizeof(LogRecordHeader);
+	return TRUE;
+
+}
+
+/* consumer: hand the record's space back to the producer */
+static void
+ringRelease(LogRecordHeader *header)
+{
+	uint32_t tail = __atomic_load_n(&writer.tail, __ATOMIC_RELAXED);
+	__atomic_store_n(&writer.tail, tail + header->size, __ATOMIC_RELEASE);
+}
+
+static void
+dispatchRecord(LogRecordHeader *header, char *data)
+{
+
+	LogFileHandler *handler = header->handler;
+
+	switch(header->type) {
+
+	    case LOGWRITER_FILE:
+		if(handler == NULL || handler->logFP == NULL) {
+		    break;
+		}
+		fwrite(data, 1, header->length, handler->logFP);
+		if(maintainLogSize(handler)) {
+		    __atomic_store_n(&handler->rotated, TRUE, __ATOMIC_RELEASE);
+		}
+		break;
+
+	    case LOGWRITER_REPLACE:
+		if(handler == NULL || handler->logFP == NULL) {
+		    break;
+		}
+		/* bypass stdio: the FILE position and buffer belong to synchronous writers */
+		if(ftruncate(fileno(handler->logFP), 0) < 0) {
+		    DBG("logWriter: could not truncate %s file\n", handler->logID);
+		}
+		if(pwrite(fileno(handler->logFP), data, header->length, 0) < 0) {
+		    DBG("logWriter: could not write %s file\n", handler->logID);
+		}
+		break;
+
+	    case LOGWRITER_STDERR:
+		fwrite(data, 1, header->length, stderr);
+		break;
+
+	    case LOGWRITER_STDOUT:
+		fwrite(data, 1, header->length, stdout);
+		fflush(stdout);
+		break;
+
+	    case LOGWRITER_SYSLOG:
+		syslog(header->priority, "%s", data);
+		break;
+
+	    default:
+		break;
+
+	}
+
+}
+
+static void*
+logWriterThread(void *arg)
+{
+
+	LogRecordHeader *header;
+	char *data;
+	struct timespec ts;
+
+	for(;;) {
+
+		while(ringGet(&header, &data)) {
+			dispatchRecord(header, data);
+			ringRelease(header);
+		}
+
+		if(!__atomic_load_n(&writer.running, __ATOMIC_ACQUIRE)) {
+			/* one last pass - the producer may have queued after we drained */
+			if(!ringGet(&header, &data)) {
+				break;
+			}
+			continue;
+		}
+
+		__atomic_store_n(&writer.sleeping, 1, __ATOMIC_SEQ_CST);
+		/* re-check after announcing we are about to sleep */
+		if(ringGet(&header, &data) || !__atomic_load_n(&writer.running, __ATOMIC_ACQUIRE)) {
+			__atomic_store_n(&writer.sleeping, 0, __ATOMIC_SEQ_CST);
+			continue;
+		}
+
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_nsec += LOGWRITER_IDLE_MS * 1000000;
+		if(ts.tv_nsec >= 1000000000) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+		sem_timedwait(&writer.wakeup, &ts);
+		__atomic_store_n(&writer.sleeping, 0, __ATOMIC_SEQ_CST);
+
+	}
+
+	return NULL;
+
+}
+
+Boolean
+logWriterStart()
+{
+
+	sigset_t mask, oldMask;
+	int ret;
+
+	if(writer.started) {
+		return TRUE;
+	}
+
+	writer.head = 0;
+	writer.tail = 0;
+	writer.sleeping = 0;
+	writer.dropped = 0;
+	writer.running = 1;
+
+	if(sem_init(&writer.wakeup, 0, 0) < 0) {
+		PERROR("logWriter: could not initialise semaphore");
+		return FALSE;
+	}
+
+	/* signals are handled by the main thread only */
+	sigfillset(&mask);
+	pthread_sigmask(SIG_SETMASK, &mask, &oldMask);
+	ret = pthread_create(&writer.thread, NULL, logWriterThread, NULL);
+	pthread_sigmask(SIG_SETMASK, &oldMask, NULL);
+
+	if(ret != 0) {
+		ERROR("logWriter: could not start log writer thread: %s\n", strerror(ret));
+		sem_destroy(&writer.wakeup);
+		return FALSE;
+	}
+
+	writer.producer = pthread_self();
+	writer.started = TRUE;
+	INFO("Started asynchronous log writer\n");
+	return TRUE;
+
+}
+
+/* stop the writer thread after it has drained the ring */
+void
+logWriterStop()
+{
+
+	if(!writer.started) {
+		return;
+	}
+
+	__atomic_store_n(&writer.running, 0, __ATOMIC_RELEASE);
+	sem_post(&writer.wakeup);
+	pthread_join(writer.thread, NULL);
+	sem_destroy(&writer.wakeup);
+	writer.started = FALSE;
+
+	if(writer.dropped) {
+		WARNING("Asynchronous log writer dropped %d records since start\n", writer.dropped);
+	}
+
+	INFO("Stopped asynchronous log writer\n");
+
+}
+
+/* the calling thread owns all log output from now on - call once we have daemonised */
+void
+logWriterInit()
+{
+	deferred.owner = pthread_self();
+	__atomic_store_n(&deferred.ownerSet, TRUE, __ATOMIC_RELEASE);
+}
+
+/* called by any thread: TRUE if the message was handed over to the main thread */
+Boolean
+logWriterDefer(int priority, const char *format, va_list ap)
+{
+
+	LogDeferredMessage *entry;
+
+	if(!__atomic_load_n(&deferred.ownerSet, __ATOMIC_ACQUIRE) ||
+	    pthread_equal(pthread_self(), deferred.owner)) {
+		return FALSE;
+	}
+
+	pthread_mutex_lock(&deferred.lock);
+
+	if(deferred.head - deferred.tail >= LOGWRITER_DEFERRED_MAX) {
+		deferred.dropped++;
+	} else {
+		entry = &deferred.messages[deferred.head % LOGWRITER_DEFERRED_MAX];
+		entry->priority = priority;
+		vsnprintf(entry->message, sizeof(entry->message), format, ap);
+		__atomic_store_n(&deferred.head, deferred.head + 1, __ATOMIC_RELEASE);
+	}
+
+	pthread_mutex_unlock(&deferred.lock);
+
+	return TRUE;
+
+}
+
+/* main thread: log the messages handed over by other threads */
+void
+logWriterFlushDeferred()
+{
+
+	LogDeferredMessage entry;
+	uint32_t dropped;
+
+	/* nothing queued: no locking on the main thread's logging path */
+	if(deferred.flushing || __atomic_load_n(&deferred.head, __ATOMIC_ACQUIRE) == deferred.tail) {
+		return;
+	}
+
+	/* logMessage() calls us again for every message we log */
+	deferred.flushing = TRUE;
+
+	for(;;) {
+		pthread_mutex_lock(&deferred.lock);
+		if(deferred.head == deferred.tail) {
+			dropped = deferred.dropped;
+			deferred.dropped = 0;
+			pthread_mutex_unlock(&deferred.lock);
+			break;
+		}
+		entry = deferred.messages[deferred.tail % LOGWRITER_DEFERRED_MAX];
+		deferred.tail++;
+		pthread_mutex_unlock(&deferred.lock);
+		logMessage(entry.priority, "%s", entry.message);
+	}
+
+	if(dropped) {
+		WARNING("Dropped %d log messages from other threads\n", dropped);
+	}
+
+	deferred.flushing = FALSE;
+
+}
+
+/* TRUE if output should be queued: writer running and we are the producer */
+Boolean
+logWriterActive()
+{
+	return writer.started && pthread_equal(pthread_self(), writer.producer);
+}
+
+/* TRUE once after the writer has rotated or truncated this log file */
+Boolean
+logWriterRotated(LogFileHandler *handler)
+{
+	return __atomic_exchange_n(&handler->rotated, FALSE, __ATOMIC_ACQ_REL);
+}
+
+#else
+
+Boolean
+logWriterStart()
+{
+	WARNING("Asynchronous logging is not supported on this platform - logging synchronously\n");
+	return FALSE;
+}
+
+void
+logWriterStop()
+{
+}
+
+Boolean
+logWriterActive()
+{
+	return FALSE;
+}
+
+Boolean
+logWriterQueue(int type, LogFileHandler *handler, int priority, const char *data, int len)
+{
+	return FALSE;
+}
+
+Boolean
+logWriterRotated(LogFileHandler *handler)
+{
+	return FALSE;
+}
+
+void
+logWriterInit()
+{
+}
+
+Boolean
+logWriterDefer(int priority, const char *format, va_list ap)
+{
+	return FALSE;
+}
+
+void
+logWriterFlushDeferred()
+{
+}
+
+#endif /* PTPD_LOGWRITER */
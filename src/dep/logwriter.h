@@ -0,0 +1,80 @@
+#ifndef PTPDLOGWRITER_H_
+#define PTPDLOGWRITER_H_
+
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file    logwriter.h
+ * @authors The PTPd Project
+ * @date   Sat Jan 9 16:14:10 2016
+ * Data type and function definitions for the asynchronous
+ * log writer thread and its single producer / single consumer ring.
+ */
+
+#include "datatypes_dep.h"
+
+/* the log writer needs threads, a timed semaphore and atomic builtins */
+#if defined(HAVE_PTHREAD_H) && defined(HAVE_SEMAPHORE_H) && \
+    defined(HAVE_SEM_TIMEDWAIT) && defined(HAVE_OPEN_MEMSTREAM) && \
+    defined(HAVE_ATOMIC_BUILTINS)
+#define PTPD_LOGWRITER
+#endif
+
+/* ring capacity in bytes - must be a power of 2 */
+#define LOGWRITER_RING_SIZE	262144
+/* largest single record, longer records are truncated */
+#define LOGWRITER_RECORD_MAX	32768
+/* records below LOG_WARNING may only fill the ring up to this many bytes */
+#define LOGWRITER_LOW_WATERMARK	(LOGWRITER_RING_SIZE / 4 * 3)
+/* writer thread idle wakeup period in milliseconds */
+#define LOGWRITER_IDLE_MS	100
+/* messages logged by other threads, waiting for the main thread */
+#define LOGWRITER_DEFERRED_MAX	32
+/* longest deferred message, longer messages are truncated */
+#define LOGWRITER_DEFERRED_LENGTH	512
+
+/* log record destinations */
+enum {
+	LOGWRITER_WRAP = 0,	/* internal: skip to start of ring */
+	LOGWRITER_FILE,		/* append to a LogFileHandler, maintain its size */
+	LOGWRITER_REPLACE,	/* replace the contents of a LogFileHandler (status file) */
+	LOGWRITER_STDERR,
+	LOGWRITER_STDOUT,
+	LOGWRITER_SYSLOG
+};
+
+void logWriterInit(void);
+Boolean logWriterStart(void);
+void logWriterStop(void);
+Boolean logWriterActive(void);
+Boolean logWriterQueue(int type, LogFileHandler *handler, int priority, const char *data, int len);
+Boolean logWriterRotated(LogFileHandler *handler);
+Boolean logWriterDefer(int priority, const char *format, va_list ap);
+void logWriterFlushDeferred(void);
+
+#endif /*PTPDLOGWRITER_H_*/
@@ -0,0 +1,584 @@
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file    metrics.c
+ * @authors The PTPd Project
+ * @date   Tue Jan 12 10:41:05 2016
+ * This source file contains the OpenMetrics exporter: a minimal HTTP
+ * endpoint on a local TCP or Unix socket served by sockserver.c and
+ * polled from netSelect(). Each response is rendered a buffer at a time,
+ * so a slow scraper never holds up the protocol engine.
+ */
+
+#include "../ptpd.h"
+
+#define METRICS_REQUEST_SIZE	1024
+#define METRICS_BUFFER_SIZE	4096
+#define METRICS_ITEM_MAX	1024	/* largest output of a single renderItem() call */
+#define METRICS_IDLE_TIMEOUT	10	/* seconds without progress before dropping a client */
+
+#define METRICS_CONTENT_TYPE	"application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+/* response sections, rendered in this order */
+enum {
+	MS_HEADER = 0,
+	MS_INFO,
+	MS_PORT,
+	MS_SERVO,
+	MS_COUNTERS,
+	MS_SLAVESTATS,
+	MS_ALARMS,
+	MS_ACL,
+	MS_GRANTS,
+	MS_EOF,
+	MS_DONE
+};
+
+typedef struct {
+	SocketClient socket;		/* first: the server hands us back a SocketClient */
+	Boolean responding;		/* request read, response in progress */
+	int status;			/* HTTP status of the response */
+	int section;			/* render cursor: section and item within it */
+	int item;
+	char request[METRICS_REQUEST_SIZE + 1];
+	char buffer[METRICS_BUFFER_SIZE];
+	/* counters are copied when the response starts, so they are consistent across chunks */
+	PtpdCounters counters;
+} MetricsClient;
+
+static void metricsConnected(SocketClient *socket);
+static void metricsRespond(SocketClient *socket);
+
+static SocketServer metricsServer = {
+	"metrics", TRUE, FALSE, METRICS_IDLE_TIMEOUT, metricsConnected, metricsRespond, -1
+};
+
+static PtpClock *metricsPtpClock = NULL;
+static const RunTimeOpts *metricsRtOpts = NULL;
+static MetricsClient clients[SOCKSERVER_MAX_CLIENTS];
+static Boolean clientsInitialised = FALSE;
+
+/* start, stop or move the exporter according to current configuration */
+void
+metricsInit(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	int i;
+
+	if(!clientsInitialised) {
+		for(i = 0; i < SOCKSERVER_MAX_CLIENTS; i++) {
+			socketServerAddClient(&metricsServer, &clients[i].socket,
+				clients[i].request, METRICS_REQUEST_SIZE,
+				clients[i].buffer, METRICS_BUFFER_SIZE);
+		}
+		clientsInitialised = TRUE;
+	}
+
+	metricsPtpClock = ptpClock;
+	metricsRtOpts = rtOpts;
+
+	if(!rtOpts->metricsExport) {
+		metricsShutdown();
+		return;
+	}
+
+	socketServerStart(&metricsServer, rtOpts->metricsAddress);
+
+}
+
+void
+metricsShutdown()
+{
+	socketServerStop(&metricsServer);
+}
+
+/* add our sockets to the select() sets */
+void
+metricsSelectInfo(int *nfds, fd_set *readfds, fd_set *writefds)
+{
+	socketServerSelectInfo(&metricsServer, nfds, readfds, writefds);
+}
+
+static void
+appendFamily(MetricsClient *client, const char *name, const char *type, const char *help)
+{
+	socketClientAppend(&client->socket, "# TYPE %s %s\n# HELP %s %s\n", name, type, name, help);
+}
+
+/* OpenMetrics spells the special values differently from printf */
+static void
+appendDouble(MetricsClient *client, double value)
+{
+	if(isnan(value)) {
+		socketClientAppend(&client->socket, "NaN\n");
+	} else if(isinf(value)) {
+		socketClientAppend(&client->socket, "%sInf\n", value < 0 ? "-" : "+");
+	} else {
+		socketClientAppend(&client->socket, "%.12g\n", value);
+	}
+}
+
+static void
+appendGauge(MetricsClient *client, const char *name, const char *help, double value)
+{
+	appendFamily(client, name, "gauge", help);
+	socketClientAppend(&client->socket, "%s ", name);
+	appendDouble(client, value);
+}
+
+/* label values are quoted, with backslash, quote and newline escaped */
+static void
+appendLabelValue(MetricsClient *client, const char *value)
+{
+
+	char escaped[METRICS_ITEM_MAX / 4];
+	int len = 0;
+
+	for(; *value != '\0' && len < (int)sizeof(escaped) - 3; value++) {
+		if(*value == '\\' || *value == '"') {
+			escaped[len++] = '\\';
+			escaped[len++] = *value;
+		} else if(*value == '\n') {
+			escaped[len++] = '\\';
+			escaped[len++] = 'n';
+		} else {
+			escaped[len++] = *value;
+		}
+	}
+	escaped[len] = '\0';
+
+	socketClientAppend(&client->socket, "\"%s\"", escaped);
+
+}
+
+static int
+countGrants(const PtpClock *ptpClock)
+{
+
+	int i, j, count = 0;
+
+	for(i = 0; i < UNICAST_MAX_DESTINATIONS; i++) {
+		for(j = 0; j < PTP_MAX_MESSAGE_INDEXED; j++) {
+			if(ptpClock->unicastGrants[i].grantData[j].granted) {
+				count++;
+				break;
+			}
+		}
+	}
+
+	return count;
+
+}
+
+static void
+renderHeader(MetricsClient *client)
+{
+
+	switch(client->status) {
+	case 200:
+		socketClientAppend(&client->socket, "HTTP/1.1 200 OK\r\n"
+				"Content-Type: "METRICS_CONTENT_TYPE"\r\n"
+				"Cache-Control: no-cache\r\n"
+				"Connection: close\r\n\r\n");
+		client->section++;
+		return;
+	case 404:
+		socketClientAppend(&client->socket, "HTTP/1.1 404 Not Found\r\n");
+		break;
+	case 405:
+		socketClientAppend(&client->socket, "HTTP/1.1 405 Method Not Allowed\r\nAllow: GET\r\n");
+		break;
+	default:
+		socketClientAppend(&client->socket, "HTTP/1.1 400 Bad Request\r\n");
+		break;
+	}
+
+	socketClientAppend(&client->socket, "Content-Type: text/plain\r\n"
+			"Connection: close\r\n\r\n"
+			"Metrics are served at /metrics\n");
+	client->section = MS_DONE;
+
+}
+
+static void
+renderServo(MetricsClient *client, const PtpClock *ptpClock)
+{
+
+	switch(client->item) {
+	case 0:
+		appendGauge(client, "ptpd_offset_from_master_seconds", "Current offset from master",
+			timeInternalToDouble(&ptpClock->currentDS.offsetFromMaster));
+		break;
+	case 1:
+		appendGauge(client, "ptpd_mean_path_delay_seconds", "Current mean path delay",
+			timeInternalToDouble(ptpClock->portDS.delayMechanism == P2P ?
+			    &ptpClock->portDS.peerMeanPathDelay : &ptpClock->currentDS.meanPathDelay));
+		break;
+	case 2:
+		appendGauge(client, "ptpd_servo_observed_drift_ppb", "Frequency adjustment applied by the servo",
+			ptpClock->servo.observedDrift);
+		break;
+	case 3:
+		appendGauge(client, "ptpd_servo_max_output", "Servo output is at its maximum frequency adjustment",
+			ptpClock->servo.runningMaxOutput ? 1 : 0);
+		break;
+	case 4:
+		appendGauge(client, "ptpd_clock_calibrated", "Clock has been calibrated",
+			ptpClock->isCalibrated ? 1 : 0);
+		break;
+#ifdef PTPD_STATISTICS
+	case 5:
+		appendGauge(client, "ptpd_servo_stable", "Servo has reached its stability threshold",
+			ptpClock->servo.isStable ? 1 : 0);
+		break;
+	case 6:
+		appendFamily(client, "ptpd_servo_drift_ppb", "gauge", "Observed drift statistics");
+		socketClientAppend(&client->socket, "ptpd_servo_drift_ppb{stat=\"mean\"} ");
+		appendDouble(client, ptpClock->servo.driftMean);
+		socketClientAppend(&client->socket, "ptpd_servo_drift_ppb{stat=\"stddev\"} ");
+		appendDouble(client, ptpClock->servo.driftStdDev);
+		socketClientAppend(&client->socket, "ptpd_servo_drift_ppb{stat=\"median\"} ");
+		appendDouble(client, ptpClock->servo.driftMedian);
+		break;
+	case 7:
+		appendGauge(client, "ptpd_holdover_active", "Clock is in holdover",
+			ptpClock->holdover.active ? 1 : 0);
+		break;
+#endif /* PTPD_STATISTICS */
+	default:
+		client->section++;
+		client->item = 0;
+		return;
+	}
+
+	client->item++;
+
+}
+
+#ifdef PTPD_STATISTICS
+static void
+appendStats(MetricsClient *client, const char *name, const char *help,
+	    double mean, double stdDev, double median, double min, double max)
+{
+	appendFamily(client, name, "gauge", help);
+	socketClientAppend(&client->socket, "%s{stat=\"mean\"} ", name);
+	appendDouble(client, mean);
+	socketClientAppend(&client->socket, "%s{stat=\"stddev\"} ", name);
+	appendDouble(client, stdDev);
+	socketClientAppend(&client->socket, "%s{stat=\"median\"} ", name);
+	appendDouble(client, median);
+	socketClientAppend(&client->socket, "%s{stat=\"min\"} ", name);
+	appendDouble(client, min);
+	socketClientAppend(&client->socket, "%s{stat=\"max\"} ", name);
+	appendDouble(client, max);
+}
+#endif /* PTPD_STATISTICS */
+
+static void
+renderSlaveStats(MetricsClient *client, const PtpClock *ptpClock)
+{
+
+#ifdef PTPD_STATISTICS
+	const PtpEngineSlaveStats *stats = &ptpClock->slaveStats;
+
+	switch(client->item) {
+	case 0:
+		appendGauge(client, "ptpd_slave_stats_valid", "Slave statistics have been calculated",
+			stats->statsCalculated ? 1 : 0);
+		break;
+	case 1:
+		appendStats(client, "ptpd_slave_offset_seconds",
+			"Offset from master over the last statistics update interval",
+			stats->ofmMean, stats->ofmStdDev, stats->ofmMedian,
+			stats->ofmMinFinal, stats->ofmMaxFinal);
+		break;
+	case 2:
+		appendStats(client, "ptpd_slave_path_delay_seconds",
+			"Mean path delay over the last statistics update interval",
+			stats->mpdMean, stats->mpdStdDev, stats->mpdMedian,
+			stats->mpdMinFinal, stats->mpdMaxFinal);
+		break;
+	case 3:
+		appendGauge(client, "ptpd_slave_path_delay_stable", "Mean path delay has stabilised",
+			stats->mpdIsStable ? 1 : 0);
+		break;
+	default:
+		client->section++;
+		client->item = 0;
+		return;
+	}
+
+	client->item++;
+#else
+	client->section++;
+#endif /* PTPD_STATISTICS */
+
+}
+
+/*
+ * the metric family of a PtpdCounters entry, if it starts one: the family
+ * header and every counter in it, wherever they are in PtpdCounters
+ */
+static void
+renderCounterFamily(MetricsClient *client, int counter)
+{
+
+	const PtpdCounterInfo *info = getPtpdCounterInfo(counter);
+	const PtpdCounterInfo *member;
+	int i;
+
+	if(info->metricType == PTPD_METRIC_NONE) {
+		return;
+	}
+
+	for(i = 0; i < counter; i++) {
+		member = getPtpdCounterInfo(i);
+		if(member->metricType != PTPD_METRIC_NONE &&
+		    !strcmp(member->metricFamily, info->metricFamily)) {
+			return;
+		}
+	}
+
+	appendFamily(client, info->metricFamily,
+		info->metricType == PTPD_METRIC_COUNTER ? "counter" : "gauge", info->metricHelp);
+
+	for(i = counter; i < PTPD_COUNTER_MAX; i++) {
+		member = getPtpdCounterInfo(i);
+		if(member->metricType == PTPD_METRIC_NONE ||
+		    strcmp(member->metricFamily, info->metricFamily)) {
+			continue;
+		}
+		socketClientAppend(&client->socket, "%s%s%s%s%s %u\n", member->metricFamily,
+			member->metricType == PTPD_METRIC_COUNTER ? "_total" : "",
+			member->metricLabels ? "{" : "",
+			member->metricLabels ? member->metricLabels : "",
+			member->metricLabels ? "}" : "",
+			getPtpdCounter(&client->counters, i));
+	}
+
+}
+
+/* emit one item and advance the cursor - each item fits in METRICS_ITEM_MAX */
+static void
+renderItem(MetricsClient *client)
+{
+
+	const PtpClock *ptpClock = metricsPtpClock;
+	int i;
+
+	switch(client->section) {
+
+	case MS_HEADER:
+		renderHeader(client);
+		return;
+
+	case MS_INFO:
+		appendFamily(client, "ptpd_build", "info", "Daemon version");
+		socketClientAppend(&client->socket, "ptpd_build_info{version=\""USER_VERSION"\"} 1\n");
+		appendFamily(client, "ptpd_port", "info", "Port identity and configuration");
+		socketClientAppend(&client->socket, "ptpd_port_info{interface=");
+		appendLabelValue(client, metricsRtOpts->ifaceName);
+		socketClientAppend(&client->socket, ",port_identity=\"");
+		socketClientAppendPortIdentity(&client->socket, &ptpClock->portDS.portIdentity);
+		socketClientAppend(&client->socket, "\",domain=\"%d\",delay_mechanism=\"%s\"} 1\n",
+			ptpClock->defaultDS.domainNumber,
+			ptpClock->portDS.delayMechanism == P2P ? "P2P" : "E2E");
+		appendFamily(client, "ptpd_parent", "info", "Current parent and grandmaster");
+		socketClientAppend(&client->socket, "ptpd_parent_info{parent_port_identity=\"");
+		socketClientAppendPortIdentity(&client->socket, &ptpClock->parentDS.parentPortIdentity);
+		socketClientAppend(&client->socket, "\",grandmaster_identity=\"");
+		socketClientAppendClockIdentity(&client->socket, ptpClock->parentDS.grandmasterIdentity);
+		socketClientAppend(&client->socket, "\"} 1\n");
+		client->section++;
+		return;
+
+	case MS_PORT:
+		appendFamily(client, "ptpd_port_state", "stateset", "PTP port state");
+		for(i = PTP_INITIALIZING; i <= PTP_SLAVE; i++) {
+			socketClientAppend(&client->socket, "ptpd_port_state{ptpd_port_state=\"%s\"} %d\n",
+				portState_getName(i), ptpClock->portDS.portState == i);
+		}
+		client->section++;
+		return;
+
+	case MS_SERVO:
+		renderServo(client, ptpClock);
+		return;
+
+	case MS_COUNTERS:
+		if(client->item >= PTPD_COUNTER_MAX) {
+			client->section++;
+			client->item = 0;
+			return;
+		}
+		renderCounterFamily(client, client->item++);
+		return;
+
+	case MS_SLAVESTATS:
+		renderSlaveStats(client, ptpClock);
+		return;
+
+	case MS_ALARMS:
+		appendFamily(client, "ptpd_alarm_set", "gauge", "Alarm condition is currently set");
+		for(i = 0; i < ALRM_MAX; i++) {
+			if(ptpClock->alarms[i].internalOnly) {
+				continue;
+			}
+			socketClientAppend(&client->socket, "ptpd_alarm_set{alarm=\"%s\"} %d\n",
+				ptpClock->alarms[i].name, ptpClock->alarms[i].state == ALARM_SET);
+		}
+		client->section++;
+		return;
+
+	case MS_ACL:
+		if(ptpClock->netPath.timingAcl != NULL || ptpClock->netPath.managementAcl != NULL) {
+			appendFamily(client, "ptpd_acl_passed", "counter", "Messages permitted by access lists");
+			if(ptpClock->netPath.timingAcl != NULL)
+				socketClientAppend(&client->socket, "ptpd_acl_passed_total{acl=\"timing\"} %u\n",
+					ptpClock->netPath.timingAcl->passedCounter);
+			if(ptpClock->netPath.managementAcl != NULL)
+				socketClientAppend(&client->socket, "ptpd_acl_passed_total{acl=\"management\"} %u\n",
+					ptpClock->netPath.managementAcl->passedCounter);
+			appendFamily(client, "ptpd_acl_dropped", "counter", "Messages denied by access lists");
+			if(ptpClock->netPath.timingAcl != NULL)
+				socketClientAppend(&client->socket, "ptpd_acl_dropped_total{acl=\"timing\"} %u\n",
+					ptpClock->netPath.timingAcl->droppedCounter);
+			if(ptpClock->netPath.managementAcl != NULL)
+				socketClientAppend(&client->socket, "ptpd_acl_dropped_total{acl=\"management\"} %u\n",
+					ptpClock->netPath.managementAcl->droppedCounter);
+		}
+		client->section++;
+		return;
+
+	case MS_GRANTS:
+		appendGauge(client, "ptpd_unicast_grant_table_entries", "Unicast grant table entries with active grants",
+			countGrants(ptpClock));
+		appendGauge(client, "ptpd_unicast_grant_table_size", "Unicast grant table capacity",
+			UNICAST_MAX_DESTINATIONS);
+		appendGauge(client, "ptpd_unicast_slaves", "Slaves granted Announce messages",
+			ptpClock->slaveCount);
+		client->section++;
+		return;
+
+	case MS_EOF:
+		socketClientAppend(&client->socket, "# EOF\n");
+		client->section++;
+		return;
+
+	default:
+		client->section = MS_DONE;
+		return;
+
+	}
+
+}
+
+static void
+parseRequest(MetricsClient *client)
+{
+
+	char *path, *end;
+
+	client->status = 400;
+
+	if(strncmp(client->request, "GET ", 4)) {
+		if(strchr(client->request, ' ') != NULL) {
+			client->status = 405;
+		}
+		return;
+	}
+
+	path = client->request + 4;
+	if((end = strpbrk(path, " ?\r\n")) == NULL) {
+		return;
+	}
+
+	if((end - path == 8 && !strncmp(path, "/metrics", 8)) ||
+	    (end - path == 1 && *path == '/')) {
+		client->status = 200;
+	} else {
+		client->status = 404;
+	}
+
+}
+
+static void
+metricsConnected(SocketClient *socket)
+{
+	((MetricsClient*)socket)->responding = FALSE;
+}
+
+/* render the next chunk of the response once the request is in - one request per connection */
+static void
+metricsRespond(SocketClient *socket)
+{
+
+	MetricsClient *client = (MetricsClient*)socket;
+
+	if(!client->responding) {
+		/* we only need the request line, but wait for the end of the headers */
+		if(strstr(client->request, "\r\n\r\n") != NULL || strstr(client->request, "\n\n") != NULL) {
+			parseRequest(client);
+		} else if(socket->requestLength >= METRICS_REQUEST_SIZE) {
+			client->status = 400;
+		} else {
+			return;
+		}
+		client->responding = TRUE;
+		client->section = MS_HEADER;
+		client->item = 0;
+		client->counters = metricsPtpClock->counters;
+	}
+
+	while(client->section != MS_DONE &&
+	    METRICS_BUFFER_SIZE - socket->bufferLength >= METRICS_ITEM_MAX) {
+		renderItem(client);
+	}
+
+	if(socket->bufferLength == 0) {
+		socketClientClose(socket);
+	}
+
+}
+
+/*
+ * service our sockets after select() - with NULL sets (select() failed or
+ * timed out) only the idle timeouts are checked.
+ */
+void
+metricsProcess(fd_set *readfds, fd_set *writefds)
+{
+
+	if(metricsPtpClock == NULL) {
+		return;
+	}
+
+	socketServerProcess(&metricsServer, readfds, writefds);
+
+}
@@ -99,7 +99,16 @@ void unpack##type##Upper( void* from, void* to, PtpClock *ptpClock ) \
         *(type *)to = (*(char *)from >> 4) & 0x0F; \
 }
 
-PACK_SIMPLE( Boolean )
+/* Boolean is an enum in memory but a single octet on the wire */
+void packBoolean( void* from, void* to )
+{
+	*(UInteger8 *)to = *(Boolean *)from ? 1 : 0;
+}
+void unpackBoolean( void* from, void* to, PtpClock *ptpClock )
+{
+	*(Boolean *)to = *(UInteger8 *)from ? TRUE : FALSE;
+}
+
 PACK_SIMPLE( UInteger8 )
 PACK_SIMPLE( Octet )
 PACK_SIMPLE( Enumeration8 )
@@ -158,6 +167,89 @@ bufGuard(int max, long base, int len, long beginning, int size)
 	);
 }
 
+/*
+ * The def sizes of variable-length fields read the length from the
+ * destination struct, which is not filled in until the field is unpacked.
+ * peek<type>() loads just the length prefix from the wire first so that
+ * bufGuard() checks the real field size; avail is what is left of the message.
+ */
+#define PEEK_FIXED( type ) \
+static inline Boolean \
+peek##type(Octet *buf, int avail, type *data) \
+{ \
+	return TRUE; \
+}
+
+PEEK_FIXED( Octet )
+PEEK_FIXED( Enumeration16 )
+PEEK_FIXED( UInteger32 )
+
+static inline Boolean
+peekPTPText(Octet *buf, int avail, PTPText *s)
+{
+	if(avail < 1) {
+		return FALSE;
+	}
+	s->lengthField = buf[0];
+	return TRUE;
+}
+
+static inline Boolean
+peekPhysicalAddress(Octet *buf, int avail, PhysicalAddress *p)
+{
+	if(avail < 2) {
+		return FALSE;
+	}
+	p->addressLength = (buf[0] << 8) | buf[1];
+	return TRUE;
+}
+
+static inline Boolean
+peekPortAddress(Octet *buf, int avail, PortAddress *p)
+{
+	if(avail < 4) {
+		return FALSE;
+	}
+	p->addressLength = (buf[2] << 8) | buf[3];
+	return TRUE;
+}
+
+/*
+ * Per-message TLV arena: decoded management / signaling TLVs and the
+ * responses built from them are carved out of ptpClock->msgArena instead
+ * of the heap. Callers take a mark before handling a TLV or building a
+ * message and release back to it when done, so nesting (a message sent
+ * while another is being handled) is fine.
+ */
+void*
+msgArenaAlloc(MsgArena *arena, size_t size)
+{
+	size_t start = (arena->used + MSG_ARENA_ALIGN - 1) & ~((size_t)MSG_ARENA_ALIGN - 1);
+
+	if(size > MSG_ARENA_SIZE || start > MSG_ARENA_SIZE - size) {
+		DBG("msgArenaAlloc: %zu bytes requested, %zu of %d in use\n",
+			size, arena->used, MSG_ARENA_SIZE);
+		return NULL;
+	}
+
+	arena->used = start + size;
+	return arena->data.buf + start;
+}
+
+size_t
+msgArenaMark(MsgArena *arena)
+{
+	return arena->used;
+}
+
+void
+msgArenaRelease(MsgArena *arena, size_t mark)
+{
+	if(mark < arena->used) {
+		arena->used = mark;
+	}
+}
+
 void
 unpackUInteger48( void *buf, void *i, PtpClock *ptpClock)
 {
@@ -192,7 +284,7 @@ int
 unpackMMSlaveOnly( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
 	int offset = 0;
-	XMALLOC(m->tlv->dataField, sizeof(MMSlaveOnly));
+	ARENA_ALLOC(m->tlv->dataField, sizeof(MMSlaveOnly));
 	MMSlaveOnly* data = (MMSlaveOnly*)m->tlv->dataField;
 	/* see src/def/README for a note on this X-macro */
 	#define OPERATE( name, size, type ) \
@@ -230,10 +322,13 @@ int
 unpackMMClockDescription( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
 	int offset = 0;
-	XMALLOC(m->tlv->dataField, sizeof(MMClockDescription));
+	ARENA_ALLOC(m->tlv->dataField, sizeof(MMClockDescription));
 	MMClockDescription* data = (MMClockDescription*)m->tlv->dataField;
 	memset(data, 0, sizeof(MMClockDescription));
 	#define OPERATE( name, size, type ) \
+		if(!peek##type(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset,\
+			m->header.messageLength - (baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset),\
+			&data->name)) return 0;\
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
 		unpack##type( buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset,\
 			      &data->name, ptpClock ); \
@@ -284,10 +379,13 @@ int
 unpackMMUserDescription( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
 	int offset = 0;
-	XMALLOC(m->tlv->dataField, sizeof(MMUserDescription));
+	ARENA_ALLOC(m->tlv->dataField, sizeof(MMUserDescription));
 	MMUserDescription* data = (MMUserDescription*)m->tlv->dataField;
 	memset(data, 0, sizeof(MMUserDescription));
 	#define OPERATE( name, size, type ) \
+		if(!peek##type(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset,\
+			m->header.messageLength - (baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset),\
+			&data->name)) return 0;\
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
 		unpack##type( buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset,\
 			      &data->name, ptpClock ); \
@@ -336,7 +434,7 @@ freeMMUserDescription( MMUserDescription* data)
 int unpackMMInitialize( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMInitialize));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMInitialize));
         MMInitialize* data = (MMInitialize*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -371,7 +469,7 @@ packMMInitialize( MsgManagement* m, Octet *buf)
 int unpackMMDefaultDataSet( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMDefaultDataSet));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMDefaultDataSet));
         MMDefaultDataSet* data = (MMDefaultDataSet*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -406,7 +504,7 @@ packMMDefaultDataSet( MsgManagement* m, Octet *buf)
 int unpackMMCurrentDataSet( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMCurrentDataSet));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMCurrentDataSet));
         MMCurrentDataSet* data = (MMCurrentDataSet*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -441,7 +539,7 @@ packMMCurrentDataSet( MsgManagement* m, Octet *buf)
 int unpackMMParentDataSet( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMParentDataSet));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMParentDataSet));
         MMParentDataSet* data = (MMParentDataSet*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -476,7 +574,7 @@ packMMParentDataSet( MsgManagement* m, Octet *buf)
 int unpackMMTimePropertiesDataSet( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMTimePropertiesDataSet));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMTimePropertiesDataSet));
         MMTimePropertiesDataSet* data = (MMTimePropertiesDataSet*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -511,7 +609,7 @@ packMMTimePropertiesDataSet( MsgManagement* m, Octet *buf)
 int unpackMMPortDataSet( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMPortDataSet));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMPortDataSet));
         MMPortDataSet* data = (MMPortDataSet*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -546,7 +644,7 @@ packMMPortDataSet( MsgManagement* m, Octet *buf)
 int unpackMMPriority1( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMPriority1));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMPriority1));
         MMPriority1* data = (MMPriority1*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -581,7 +679,7 @@ packMMPriority1( MsgManagement* m, Octet *buf)
 int unpackMMPriority2( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMPriority2));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMPriority2));
         MMPriority2* data = (MMPriority2*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -616,7 +714,7 @@ packMMPriority2( MsgManagement* m, Octet *buf)
 int unpackMMDomain( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMDomain));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMDomain));
         MMDomain* data = (MMDomain*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -651,7 +749,7 @@ packMMDomain( MsgManagement* m, Octet *buf)
 int unpackMMLogAnnounceInterval( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMLogAnnounceInterval));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMLogAnnounceInterval));
         MMLogAnnounceInterval* data = (MMLogAnnounceInterval*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -686,7 +784,7 @@ packMMLogAnnounceInterval( MsgManagement* m, Octet *buf)
 int unpackMMAnnounceReceiptTimeout( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField,sizeof(MMAnnounceReceiptTimeout));
+        ARENA_ALLOC(m->tlv->dataField,sizeof(MMAnnounceReceiptTimeout));
         MMAnnounceReceiptTimeout* data = (MMAnnounceReceiptTimeout*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -721,7 +819,7 @@ packMMAnnounceReceiptTimeout( MsgManagement* m, Octet *buf)
 int unpackMMLogSyncInterval( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMLogSyncInterval));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMLogSyncInterval));
         MMLogSyncInterval* data = (MMLogSyncInterval*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -756,7 +854,7 @@ packMMLogSyncInterval( MsgManagement* m, Octet *buf)
 int unpackMMVersionNumber( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMVersionNumber));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMVersionNumber));
         MMVersionNumber* data = (MMVersionNumber*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -791,7 +889,7 @@ packMMVersionNumber( MsgManagement* m, Octet *buf)
 int unpackMMTime( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMTime));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMTime));
         MMTime* data = (MMTime*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -826,7 +924,7 @@ packMMTime( MsgManagement* m, Octet *buf)
 int unpackMMClockAccuracy( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMClockAccuracy));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMClockAccuracy));
         MMClockAccuracy* data = (MMClockAccuracy*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -861,7 +959,7 @@ packMMClockAccuracy( MsgManagement* m, Octet *buf)
 int unpackMMUtcProperties( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMUtcProperties));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMUtcProperties));
         MMUtcProperties* data = (MMUtcProperties*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -896,7 +994,7 @@ packMMUtcProperties( MsgManagement* m, Octet *buf)
 int unpackMMTraceabilityProperties( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMTraceabilityProperties));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMTraceabilityProperties));
         MMTraceabilityProperties* data = (MMTraceabilityProperties*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -931,7 +1029,7 @@ packMMTraceabilityProperties( MsgManagement* m, Octet *buf)
 int unpackMMTimescaleProperties( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMTimescaleProperties));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMTimescaleProperties));
         MMTimescaleProperties* data = (MMTimescaleProperties*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -967,7 +1065,7 @@ packMMTimescaleProperties( MsgManagement* m, Octet *buf)
 int unpackMMUnicastNegotiationEnable( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMUnicastNegotiationEnable));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMUnicastNegotiationEnable));
         MMUnicastNegotiationEnable* data = (MMUnicastNegotiationEnable*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -1003,7 +1101,7 @@ packMMUnicastNegotiationEnable( MsgManagement* m, Octet *buf)
 int unpackMMDelayMechanism( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMDelayMechanism));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMDelayMechanism));
         MMDelayMechanism* data = (MMDelayMechanism*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -1038,7 +1136,7 @@ packMMDelayMechanism( MsgManagement* m, Octet *buf)
 int unpackMMLogMinPdelayReqInterval( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMLogMinPdelayReqInterval));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMLogMinPdelayReqInterval));
         MMLogMinPdelayReqInterval* data = (MMLogMinPdelayReqInterval*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
@@ -1073,9 +1171,12 @@ packMMLogMinPdelayReqInterval( MsgManagement* m, Octet *buf)
 int unpackMMErrorStatus( Octet *buf, int baseOffset, MsgManagement* m, PtpClock* ptpClock)
 {
         int offset = 0;
-        XMALLOC(m->tlv->dataField, sizeof(MMErrorStatus));
+        ARENA_ALLOC(m->tlv->dataField, sizeof(MMErrorStatus));
         MMErrorStatus* data = (MMErrorStatus*)m->tlv->dataField;
         #define OPERATE( name, size, type ) \
+		if(!peek##type(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset,\
+			m->header.messageLength - (baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset),\
+			&data->name)) return 0;\
 		if(!bufGuard(PACKET_SIZE, (long)buf, m->header.messageLength, (long)(buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset), size)) return 0;\
                 unpack##type( buf + baseOffset + MANAGEMENT_LENGTH + TLV_LENGTH + offset,\
                               &data->name, ptpClock ); \
@@ -1125,7 +1226,7 @@ void
 unpackSMRequestUnicastTransmission( Octet *buf, MsgSignaling* m, PtpClock* ptpClock)
 {
 	int offset = 0;
-	XMALLOC(m->tlv->valueField, sizeof(SMRequestUnicastTransmission));
+	ARENA_ALLOC(m->tlv->valueField, sizeof(SMRequestUnicastTransmission));
 	SMRequestUnicastTransmission* data = (SMRequestUnicastTransmission*)m->tlv->valueField;
 	/* see src/def/README for a note on this X-macro */
 	#define OPERATE( name, size, type ) \
@@ -1160,7 +1261,7 @@ void
 unpackSMGrantUnicastTransmission( Octet *buf, MsgSignaling* m, PtpClock* ptpClock)
 {
 	int offset = 0;
-	XMALLOC(m->tlv->valueField, sizeof(SMGrantUnicastTransmission));
+	ARENA_ALLOC(m->tlv->valueField, sizeof(SMGrantUnicastTransmission));
 	SMGrantUnicastTransmission* data = (SMGrantUnicastTransmission*)m->tlv->valueField;
 
 	/* see src/def/README for a note on this X-macro */
@@ -1194,7 +1295,7 @@ void
 unpackSMCancelUnicastTransmission( Octet *buf, MsgSignaling* m, PtpClock* ptpClock)
 {
 	int offset = 0;
-	XMALLOC(m->tlv->valueField, sizeof(SMCancelUnicastTransmission));
+	ARENA_ALLOC(m->tlv->valueField, sizeof(SMCancelUnicastTransmission));
 	SMCancelUnicastTransmission* data = (SMCancelUnicastTransmission*)m->tlv->valueField;
 	/* see src/def/README for a note on this X-macro */
 	#define OPERATE( name, size, type ) \
@@ -1228,7 +1329,7 @@ void
 unpackSMAcknowledgeCancelUnicastTransmission( Octet *buf, MsgSignaling* m, PtpClock* ptpClock)
 {
 	int offset = 0;
-	XMALLOC(m->tlv->valueField, sizeof(SMAcknowledgeCancelUnicastTransmission));
+	ARENA_ALLOC(m->tlv->valueField, sizeof(SMAcknowledgeCancelUnicastTransmission));
 	SMAcknowledgeCancelUnicastTransmission* data = (SMAcknowledgeCancelUnicastTransmission*)m->tlv->valueField;
 	/* see src/def/README for a note on this X-macro */
 	#define OPERATE( name, size, type ) \
@@ -1399,10 +1500,12 @@ unpackPortAddress( Octet *buf, PortAddress *p, PtpClock *ptpClock)
 {
 	unpackEnumeration16( buf, &p->networkProtocol, ptpClock);
 	unpackUInteger16( buf+2, &p->addressLength, ptpClock);
-	if(p->addressLength) {
-		XMALLOC(p->addressField, p->addressLength);
+	/* can not be longer than the packet - and must not exhaust the arena */
+	if(p->addressLength && p->addressLength <= PACKET_SIZE &&
+	    (p->addressField = msgArenaAlloc(&ptpClock->msgArena, p->addressLength))) {
 		memcpy( p->addressField, buf+4, p->addressLength);
 	} else {
+		p->addressLength = 0;
 		p->addressField = NULL;
 	}
 }
@@ -1417,23 +1520,22 @@ packPortAddress(PortAddress *p, Octet *buf)
 	}
 }
 
+/* arena memory - released with the message, see msgArenaRelease() */
 void
 freePortAddress(PortAddress *p)
 {
-	if(p->addressField) {
-		free(p->addressField);
-		p->addressField = NULL;
-	}
+	p->addressField = NULL;
 }
 
 void
 unpackPTPText( Octet *buf, PTPText *s, PtpClock *ptpClock)
 {
 	unpackUInteger8( buf, &s->lengthField, ptpClock);
-	if(s->lengthField) {
-		XMALLOC(s->textField, s->lengthField);
+	if(s->lengthField &&
+	    (s->textField = msgArenaAlloc(&ptpClock->msgArena, s->lengthField))) {
 		memcpy( s->textField, buf+1, s->lengthField);
 	} else {
+		s->lengthField = 0;
 		s->textField = NULL;
 	}
 }
@@ -1450,20 +1552,18 @@ packPTPText(PTPText *s, Octet *buf)
 void
 freePTPText(PTPText *s)
 {
-	if(s->textField) {
-		free(s->textField);
-		s->textField = NULL;
-	}
+	s->textField = NULL;
 }
 
 void
 unpackPhysicalAddress( Octet *buf, PhysicalAddress *p, PtpClock *ptpClock)
 {
 	unpackUInteger16( buf, &p->addressLength, ptpClock);
-	if(p->addressLength) {
-		XMALLOC(p->addressField, p->addressLength);
+	if(p->addressLength && p->addressLength <= PACKET_SIZE &&
+	    (p->addressField = msgArenaAlloc(&ptpClock->msgArena, p->addressLength))) {
 		memcpy( p->addressField, buf+2, p->addressLength);
 	} else {
+		p->addressLength = 0;
 		p->addressField = NULL;
 	}
 }
@@ -1480,10 +1580,7 @@ packPhysicalAddress(PhysicalAddress *p, Octet *buf)
 void
 freePhysicalAddress(PhysicalAddress *p)
 {
-	if(p->addressField) {
-		free(p->addressField);
-		p->addressField = NULL;
-	}
+	p->addressField = NULL;
 }
 
 void
@@ -1502,49 +1599,38 @@ copyPortIdentity( PortIdentity *dest, PortIdentity *src)
 void
 unpackMsgHeader(Octet *buf, MsgHeader *header, PtpClock *ptpClock)
 {
-	int offset = 0;
-	MsgHeader* data = header;
-	#define OPERATE( name, size, type) \
-		unpack##type (buf + offset, &data->name, ptpClock); \
-		offset = offset + size;
-	#include "../def/message/header.def"
+	msgLoadMsgHeader(buf, header);
 }
 
 void
 packMsgHeader(MsgHeader *h, Octet *buf)
 {
-	int offset = 0;
-
 	/* set uninitalized bytes to zero */
 	h->reserved0 = 0;
 	h->reserved1 = 0;
 	h->reserved2 = 0;
 
-	#define OPERATE( name, size, type ) \
-		pack##type( &h->name, buf + offset ); \
-		offset = offset + size;
-	#include "../def/message/header.def"
+	msgStoreMsgHeader(buf, h);
 }
 
 void
 unpackManagementTLV(Octet *buf, int baseOffset, MsgManagement *m, PtpClock* ptpClock)
 {
-	int offset = 0;
-	XMALLOC(m->tlv, sizeof(ManagementTLV));
+	ManagementTLV *data;
+	ARENA_ALLOC(m->tlv, sizeof(ManagementTLV));
+	data = m->tlv;
 	/* read the management TLV */
 	#define OPERATE( name, size, type ) \
-		unpack##type( buf + baseOffset + MANAGEMENT_LENGTH + offset, &m->tlv->name, ptpClock ); \
-		offset = offset + size;
+		MSGLAYOUT_LOAD(buf + baseOffset + MANAGEMENT_LENGTH, MANAGEMENT_TLV, name, type)
 	#include "../def/managementTLV/managementTLV.def"
 }
 
 void
 packManagementTLV(ManagementTLV *tlv, Octet *buf)
 {
-	int offset = 0;
+	ManagementTLV *data = tlv;
 	#define OPERATE( name, size, type ) \
-		pack##type( &tlv->name, buf + MANAGEMENT_LENGTH + offset ); \
-		offset = offset + size;
+		MSGLAYOUT_STORE(buf + MANAGEMENT_LENGTH, MANAGEMENT_TLV, name, type)
 	#include "../def/managementTLV/managementTLV.def"
 }
 
@@ -1559,10 +1645,9 @@ freeManagementTLV(MsgManagement *m)
                         } else if(m->tlv->tlvType == TLV_MANAGEMENT_ERROR_STATUS) {
                                 freeMMErrorStatusTLV(m->tlv);
                         }
-                        free(m->tlv->dataField);
 			m->tlv->dataField = NULL;
                 }
-                free(m->tlv);
+		/* arena memory, released by the caller with msgArenaRelease() */
 		m->tlv = NULL;
         }
 }
@@ -1570,27 +1655,26 @@ freeManagementTLV(MsgManagement *m)
 void
 packMsgManagement(MsgManagement *m, Octet *buf)
 {
-	int offset = 0;
 	MsgManagement *data = m;
 
 	/* set unitialized bytes to zero */
 	m->reserved0 = 0;
 	m->reserved1 = 0;
+	m->header.reserved0 = 0;
+	m->header.reserved1 = 0;
+	m->header.reserved2 = 0;
 
 	#define OPERATE( name, size, type) \
-		pack##type (&data->name, buf + offset); \
-		offset = offset + size;
+		MSGLAYOUT_STORE(buf, MANAGEMENT, name, type)
 	#include "../def/message/management.def"
 
 }
 
 void unpackMsgManagement(Octet *buf, MsgManagement *m, PtpClock *ptpClock)
 {
-	int offset = 0;
 	MsgManagement* data = m;
 	#define OPERATE( name, size, type) \
-		unpack##type (buf + offset, &data->name, ptpClock); \
-		offset = offset + size;
+		MSGLAYOUT_LOAD(buf, MANAGEMENT, name, type)
 	#include "../def/message/management.def"
 
 	#ifdef PTPD_DBG
@@ -1601,22 +1685,21 @@ void unpackMsgManagement(Octet *buf, MsgManagement *m, PtpClock *ptpClock)
 void
 unpackSignalingTLV(Octet *buf, MsgSignaling *m, PtpClock* ptpClock)
 {
-	int offset = 0;
-	XMALLOC(m->tlv, sizeof(SignalingTLV));
+	SignalingTLV *data;
+	ARENA_ALLOC(m->tlv, sizeof(SignalingTLV));
+	data = m->tlv;
 	/* read the signaling TLV */
 	#define OPERATE( name, size, type ) \
-		unpack##type( buf + SIGNALING_LENGTH + offset, &m->tlv->name, ptpClock ); \
-		offset = offset + size;
+		MSGLAYOUT_LOAD(buf + SIGNALING_LENGTH, SIGNALING_TLV, name, type)
 	#include "../def/signalingTLV/signalingTLV.def"
 }
 
 void
 packSignalingTLV(SignalingTLV *tlv, Octet *buf)
 {
-	int offset = 0;
+	SignalingTLV *data = tlv;
 	#define OPERATE( name, size, type ) \
-		pack##type( &tlv->name, buf + SIGNALING_LENGTH + offset ); \
-		offset = offset + size;
+		MSGLAYOUT_STORE(buf + SIGNALING_LENGTH, SIGNALING_TLV, name, type)
 	#include "../def/signalingTLV/signalingTLV.def"
 }
 
@@ -1625,11 +1708,8 @@ freeSignalingTLV(MsgSignaling *m)
 {
         /* cleanup outgoing signaling TLV */
         if(m->tlv) {
-                if(m->tlv->valueField) {
-                        free(m->tlv->valueField);
-			m->tlv->valueField = NULL;
-                }
-                free(m->tlv);
+		/* arena memory, released by the caller with msgArenaRelease() */
+		m->tlv->valueField = NULL;
 		m->tlv = NULL;
         }
 }
@@ -1637,12 +1717,15 @@ freeSignalingTLV(MsgSignaling *m)
 void
 packMsgSignaling(MsgSignaling *m, Octet *buf)
 {
-	int offset = 0;
 	MsgSignaling *data = m;
 
+	/* set unitialized bytes to zero */
+	m->header.reserved0 = 0;
+	m->header.reserved1 = 0;
+	m->header.reserved2 = 0;
+
 	#define OPERATE( name, size, type) \
-		pack##type (&data->name, buf + offset); \
-		offset = offset + size;
+		MSGLAYOUT_STORE(buf, SIGNALING, name, type)
 	#include "../def/message/signaling.def"
 
 }
@@ -1650,11 +1733,9 @@ packMsgSignaling(MsgSignaling *m, Octet *buf)
 void
 unpackMsgSignaling(Octet *buf, MsgSignaling *m, PtpClock *ptpClock)
 {
-	int offset = 0;
 	MsgSignaling* data = m;
 	#define OPERATE( name, size, type) \
-		unpack##type (buf + offset, &data->name, ptpClock); \
-		offset = offset + size;
+		MSGLAYOUT_LOAD(buf, SIGNALING, name, type)
 	#include "../def/message/signaling.def"
 
 	#ifdef PTPD_DBG
@@ -1666,24 +1747,7 @@ unpackMsgSignaling(Octet *buf, MsgSignaling *m, PtpClock *ptpClock)
 void
 msgUnpackHeader(Octet * buf, MsgHeader * header)
 {
-	header->transportSpecific = (*(Nibble *) (buf + 0)) >> 4;
-	header->messageType = (*(Enumeration4 *) (buf + 0)) & 0x0F;
-	header->versionPTP = (*(UInteger4 *) (buf + 1)) & 0x0F;
-	/* force reserved bit to zero if not */
-	header->messageLength = flip16(*(UInteger16 *) (buf + 2));
-	header->domainNumber = (*(UInteger8 *) (buf + 4));
-	header->flagField0 = (*(Octet *) (buf + 6));
-	header->flagField1 = (*(Octet *) (buf + 7));
-	memcpy(&header->correctionField.msb, (buf + 8), 4);
-	memcpy(&header->correctionField.lsb, (buf + 12), 4);
-	header->correctionField.msb = flip32(header->correctionField.msb);
-	header->correctionField.lsb = flip32(header->correctionField.lsb);
-	copyClockIdentity(header->sourcePortIdentity.clockIdentity, (buf + 20));
-	header->sourcePortIdentity.portNumber =
-		flip16(*(UInteger16 *) (buf + 28));
-	header->sequenceId = flip16(*(UInteger16 *) (buf + 30));
-	header->controlField = (*(UInteger8 *) (buf + 32));
-	header->logMessageInterval = (*(Integer8 *) (buf + 33));
+	msgLoadMsgHeader(buf, header);
 
 #ifdef PTPD_DBG
 	msgHeader_display(header);
@@ -1694,50 +1758,89 @@ msgUnpackHeader(Octet * buf, MsgHeader * header)
 void
 msgPackHeader(Octet * buf, PtpClock * ptpClock)
 {
+	UInteger8 octet;
 
-	/* (spec annex D) */
-	*(UInteger8 *) (buf + 0) = ptpClock->portDS.transportSpecific << 4;
-	*(UInteger4 *) (buf + 1) = ptpClock->portDS.versionNumber;
-	*(UInteger8 *) (buf + 4) = ptpClock->defaultDS.domainNumber;
+	/* (spec annex D) - clears messageType and the reserved nibble */
+	octet = ptpClock->portDS.transportSpecific << 4;
+	msgStoreUInteger8(buf + HEADER_OFFSET_transportSpecific, &octet);
+	octet = ptpClock->portDS.versionNumber;
+	msgStoreUInteger8(buf + HEADER_OFFSET_versionPTP, &octet);
+	msgStoreUInteger8(buf + HEADER_OFFSET_domainNumber, &ptpClock->defaultDS.domainNumber);
 	/* clear flag field - message packing functions should populate it */
-	memset((buf + 6), 0, 2);
+	memset(buf + HEADER_OFFSET_flagField0, 0, 2);
 
-	memset((buf + 8), 0, 8);
-	copyClockIdentity((buf + 20), ptpClock->portDS.portIdentity.clockIdentity);
-	*(UInteger16 *) (buf + 28) = flip16(ptpClock->portDS.portIdentity.portNumber);
+	memset(buf + HEADER_OFFSET_correctionField, 0, 8);
+	msgStorePortIdentity(buf + HEADER_OFFSET_sourcePortIdentity, &ptpClock->portDS.portIdentity);
 	/* LogMessageInterval defaults to 0x7F, will be set to another value if needed as per table 24*/
-	*(UInteger8 *) (buf + 33) = 0x7F;
+	buf[HEADER_OFFSET_logMessageInterval] = 0x7F;
 }
 
+/* Table 19 and 23: the header fields set by the message type */
+static void
+msgPackHeaderType(Octet * buf, Enumeration4 messageType, UInteger16 messageLength, UInteger8 controlField)
+{
+	msgStoreEnumeration4Lower(buf + HEADER_OFFSET_messageType, &messageType);
+	msgStoreUInteger16(buf + HEADER_OFFSET_messageLength, &messageLength);
+	msgStoreUInteger8(buf + HEADER_OFFSET_controlField, &controlField);
+}
 
-#ifndef PTPD_SLAVE_ONLY
-/*Pack SYNC message into OUT buffer of ptpClock*/
+/*
+ * Drop all send templates - must be called whenever anything they were built
+ * from changes: port / default datasets, transport or unicast mode. Templates
+ * are rebuilt lazily on the next send.
+ */
 void
-msgPackSync(Octet * buf, UInteger16 sequenceId, Timestamp * originTimestamp, PtpClock * ptpClock)
+msgInvalidateTemplates(PtpClock * ptpClock)
 {
-	msgPackHeader(buf, ptpClock);
+	int i;
+
+	for(i = 0; i < MSG_TEMPLATE_MAX; i++) {
+		ptpClock->msgTemplates[i].valid = FALSE;
+	}
+}
+
+/* Return the template of given type, packing it with packFn if not valid */
+static const Octet*
+msgGetTemplate(PtpClock * ptpClock, int type, void (*packFn)(Octet *, PtpClock *))
+{
+	MsgTemplate *template = &ptpClock->msgTemplates[type];
+
+	if(!template->valid) {
+		memset(template->buf, 0, MSG_TEMPLATE_LENGTH);
+		msgPackHeader(template->buf, ptpClock);
+		packFn(template->buf, ptpClock);
+		template->valid = TRUE;
+	}
 
-	/* changes in header */
-	*(char *)(buf + 0) = *(char *)(buf + 0) & 0xF0;
-	/* RAZ messageType */
-	*(char *)(buf + 0) = *(char *)(buf + 0) | 0x00;
+	return template->buf;
+}
+
+
+#ifndef PTPD_SLAVE_ONLY
+/* Sync template: everything but sequenceId and originTimestamp */
+static void
+msgPackSyncTemplate(Octet * buf, PtpClock * ptpClock)
+{
+	msgPackHeaderType(buf, SYNC, SYNC_LENGTH, 0x00);
 	/* Two step flag - table 20: Sync and PdelayResp only */
 	if (ptpClock->defaultDS.twoStepFlag)
-		*(UInteger8 *) (buf + 6) |= PTP_TWO_STEP;
-	/* Table 19 */
-	*(UInteger16 *) (buf + 2) = flip16(SYNC_LENGTH);
-	*(UInteger16 *) (buf + 30) = flip16(sequenceId);
-	*(UInteger8 *) (buf + 32) = 0x00;
+		buf[HEADER_OFFSET_flagField0] |= PTP_TWO_STEP;
 
 	 /* Table 24 - unless it's multicast, logMessageInterval remains    0x7F */
 	 if(rtOpts.transport == IEEE_802_3 || rtOpts.ipMode != IPMODE_UNICAST )
-		*(Integer8 *) (buf + 33) = ptpClock->portDS.logSyncInterval;
-	memset((buf + 8), 0, 8);
+		msgStoreInteger8(buf + HEADER_OFFSET_logMessageInterval, &ptpClock->portDS.logSyncInterval);
+}
+
+/*Pack SYNC message into OUT buffer of ptpClock*/
+void
+msgPackSync(Octet * buf, UInteger16 sequenceId, Timestamp * originTimestamp, PtpClock * ptpClock)
+{
+	memcpy(buf, msgGetTemplate(ptpClock, MSG_TEMPLATE_SYNC, msgPackSyncTemplate), SYNC_LENGTH);
+
+	msgStoreUInteger16(buf + HEADER_OFFSET_sequenceId, &sequenceId);
 
 	/* Sync message */
-	*(UInteger16 *) (buf + 34) = flip16(originTimestamp->secondsField.msb);
-	*(UInteger32 *) (buf + 36) = flip32(originTimestamp->secondsField.lsb);
-	*(UInteger32 *) (buf + 40) = flip32(originTimestamp->nanosecondsField);
+	msgStoreTimestamp(buf + SYNC_OFFSET_originTimestamp, originTimestamp);
 }
 #endif /* PTPD_SLAVE_ONLY */
 
@@ -1745,12 +1848,7 @@ msgPackSync(Octet * buf, UInteger16 sequenceId, Timestamp * originTimestamp, Ptp
 void
 msgUnpackSync(Octet * buf, MsgSync * sync)
 {
-	sync->originTimestamp.secondsField.msb =
-		flip16(*(UInteger16 *) (buf + 34));
-	sync->originTimestamp.secondsField.lsb =
-		flip32(*(UInteger32 *) (buf + 36));
-	sync->originTimestamp.nanosecondsField =
-		flip32(*(UInteger32 *) (buf + 40));
+	msgLoadTimestamp(buf + SYNC_OFFSET_originTimestamp, &sync->originTimestamp);
 
 #ifdef PTPD_DBG
 	msgSync_display(sync);
@@ -1760,53 +1858,47 @@ msgUnpackSync(Octet * buf, MsgSync * sync)
 
 /* When building slave only, this code does not get compiled */
 #ifndef PTPD_SLAVE_ONLY
+/*
+ * Announce template: header only. The body carries parent and time properties
+ * datasets, which change outside updateDatasets(), so it is packed on every send.
+ */
+static void
+msgPackAnnounceTemplate(Octet * buf, PtpClock * ptpClock)
+{
+	msgPackHeaderType(buf, ANNOUNCE, ANNOUNCE_LENGTH, 0x05);
+	/* Table 24: for Announce, logMessageInterval is never 0x7F */
+	msgStoreInteger8(buf + HEADER_OFFSET_logMessageInterval, &ptpClock->portDS.logAnnounceInterval);
+}
+
 /*Pack Announce message into OUT buffer of ptpClock*/
 void
 msgPackAnnounce(Octet * buf, UInteger16 sequenceId, Timestamp * originTimestamp, PtpClock * ptpClock)
 {
-	UInteger16 stepsRemoved;
-	
-	msgPackHeader(buf, ptpClock);
+	memcpy(buf, msgGetTemplate(ptpClock, MSG_TEMPLATE_ANNOUNCE, msgPackAnnounceTemplate), HEADER_LENGTH);
 
-	/* changes in header */
-	*(char *)(buf + 0) = *(char *)(buf + 0) & 0xF0;
-	/* RAZ messageType */
-	*(char *)(buf + 0) = *(char *)(buf + 0) | 0x0B;
-	/* Table 19 */
-	*(UInteger16 *) (buf + 2) = flip16(ANNOUNCE_LENGTH);
-	*(UInteger16 *) (buf + 30) = flip16(sequenceId);
-	*(UInteger8 *) (buf + 32) = 0x05;
-	/* Table 24: for Announce, logMessageInterval is never 0x7F */
-	*(Integer8 *) (buf + 33) = ptpClock->portDS.logAnnounceInterval;
+	msgStoreUInteger16(buf + HEADER_OFFSET_sequenceId, &sequenceId);
 
 	/* Announce message */
-	*(UInteger16 *) (buf + 34) = flip16(originTimestamp->secondsField.msb);
-	*(UInteger32 *) (buf + 36) = flip32(originTimestamp->secondsField.lsb);
-	*(UInteger32 *) (buf + 40) = flip32(originTimestamp->nanosecondsField);
-
-	*(Integer16 *) (buf + 44) = flip16(ptpClock->timePropertiesDS.currentUtcOffset);
-	*(UInteger8 *) (buf + 47) = ptpClock->parentDS.grandmasterPriority1;
-	*(UInteger8 *) (buf + 48) = ptpClock->defaultDS.clockQuality.clockClass;
-	*(Enumeration8 *) (buf + 49) = ptpClock->defaultDS.clockQuality.clockAccuracy;
-	*(UInteger16 *) (buf + 50) =
-		flip16(ptpClock->defaultDS.clockQuality.offsetScaledLogVariance);
-	*(UInteger8 *) (buf + 52) = ptpClock->parentDS.grandmasterPriority2;
-	copyClockIdentity((buf + 53), ptpClock->parentDS.grandmasterIdentity);
-	/* resolve bugs #37 and #40 - alignment errors on ARMv5 */
-	stepsRemoved = flip16(ptpClock->currentDS.stepsRemoved);
-	memcpy(buf + 61, &stepsRemoved, sizeof(UInteger16));
-	*(Enumeration8 *) (buf + 63) = ptpClock->timePropertiesDS.timeSource;
+	msgStoreTimestamp(buf + ANNOUNCE_OFFSET_originTimestamp, originTimestamp);
+	msgStoreUInteger16(buf + ANNOUNCE_OFFSET_currentUtcOffset, &ptpClock->timePropertiesDS.currentUtcOffset);
+	buf[ANNOUNCE_OFFSET_reserved] = 0;
+	msgStoreUInteger8(buf + ANNOUNCE_OFFSET_grandmasterPriority1, &ptpClock->parentDS.grandmasterPriority1);
+	msgStoreClockQuality(buf + ANNOUNCE_OFFSET_grandmasterClockQuality, &ptpClock->defaultDS.clockQuality);
+	msgStoreUInteger8(buf + ANNOUNCE_OFFSET_grandmasterPriority2, &ptpClock->parentDS.grandmasterPriority2);
+	msgStoreClockIdentity(buf + ANNOUNCE_OFFSET_grandmasterIdentity, &ptpClock->parentDS.grandmasterIdentity);
+	msgStoreUInteger16(buf + ANNOUNCE_OFFSET_stepsRemoved, &ptpClock->currentDS.stepsRemoved);
+	msgStoreEnumeration8(buf + ANNOUNCE_OFFSET_timeSource, &ptpClock->timePropertiesDS.timeSource);
 
 	/*
 	 * TimePropertiesDS in FlagField, 2nd octet - spec 13.3.2.6 table 20
 	 * Could / should have used constants here PTP_LI_61 etc, but this is clean
 	 */
-	*(UInteger8*) (buf + 7) = ptpClock->timePropertiesDS.leap61			<< 0;
-	*(UInteger8*) (buf + 7) |= (ptpClock->timePropertiesDS.leap59)			<< 1;
-	*(UInteger8*) (buf + 7) |= (ptpClock->timePropertiesDS.currentUtcOffsetValid)	<< 2;
-	*(UInteger8*) (buf + 7) |= (ptpClock->timePropertiesDS.ptpTimescale)		<< 3;
-	*(UInteger8*) (buf + 7) |= (ptpClock->timePropertiesDS.timeTraceable)		<< 4;
-	*(UInteger8*) (buf + 7) |= (ptpClock->timePropertiesDS.frequencyTraceable)	<< 5;
+	buf[HEADER_OFFSET_flagField1] = ptpClock->timePropertiesDS.leap61			<< 0;
+	buf[HEADER_OFFSET_flagField1] |= (ptpClock->timePropertiesDS.leap59)			<< 1;
+	buf[HEADER_OFFSET_flagField1] |= (ptpClock->timePropertiesDS.currentUtcOffsetValid)	<< 2;
+	buf[HEADER_OFFSET_flagField1] |= (ptpClock->timePropertiesDS.ptpTimescale)		<< 3;
+	buf[HEADER_OFFSET_flagField1] |= (ptpClock->timePropertiesDS.timeTraceable)		<< 4;
+	buf[HEADER_OFFSET_flagField1] |= (ptpClock->timePropertiesDS.frequencyTraceable)	<< 5;
 }
 #endif /* PTPD_SLAVE_ONLY */
 
@@ -1814,28 +1906,14 @@ msgPackAnnounce(Octet * buf, UInteger16 sequenceId, Timestamp * originTimestamp,
 void
 msgUnpackAnnounce(Octet * buf, MsgAnnounce * announce)
 {
-	UInteger16 stepsRemoved;
-	
-	announce->originTimestamp.secondsField.msb =
-		flip16(*(UInteger16 *) (buf + 34));
-	announce->originTimestamp.secondsField.lsb =
-		flip32(*(UInteger32 *) (buf + 36));
-	announce->originTimestamp.nanosecondsField =
-		flip32(*(UInteger32 *) (buf + 40));
-	announce->currentUtcOffset = flip16(*(UInteger16 *) (buf + 44));
-	announce->grandmasterPriority1 = *(UInteger8 *) (buf + 47);
-	announce->grandmasterClockQuality.clockClass =
-		*(UInteger8 *) (buf + 48);
-	announce->grandmasterClockQuality.clockAccuracy =
-		*(Enumeration8 *) (buf + 49);
-	announce->grandmasterClockQuality.offsetScaledLogVariance =
-		flip16(*(UInteger16 *) (buf + 50));
-	announce->grandmasterPriority2 = *(UInteger8 *) (buf + 52);
-	copyClockIdentity(announce->grandmasterIdentity, (buf + 53));
-	/* resolve bugs #37 and #40 - alignment errors on ARMv5 */
-	memcpy(&stepsRemoved, buf + 61, sizeof(UInteger16));
-	announce->stepsRemoved = flip16(stepsRemoved);
-	announce->timeSource = *(Enumeration8 *) (buf + 63);
+	msgLoadTimestamp(buf + ANNOUNCE_OFFSET_originTimestamp, &announce->originTimestamp);
+	msgLoadInteger16(buf + ANNOUNCE_OFFSET_currentUtcOffset, &announce->currentUtcOffset);
+	msgLoadUInteger8(buf + ANNOUNCE_OFFSET_grandmasterPriority1, &announce->grandmasterPriority1);
+	msgLoadClockQuality(buf + ANNOUNCE_OFFSET_grandmasterClockQuality, &announce->grandmasterClockQuality);
+	msgLoadUInteger8(buf + ANNOUNCE_OFFSET_grandmasterPriority2, &announce->grandmasterPriority2);
+	msgLoadClockIdentity(buf + ANNOUNCE_OFFSET_grandmasterIdentity, &announce->grandmasterIdentity);
+	msgLoadUInteger16(buf + ANNOUNCE_OFFSET_stepsRemoved, &announce->stepsRemoved);
+	msgLoadEnumeration8(buf + ANNOUNCE_OFFSET_timeSource, &announce->timeSource);
 
 	#ifdef PTPD_DBG
 	msgAnnounce_display(announce);
@@ -1843,32 +1921,27 @@ msgUnpackAnnounce(Octet * buf, MsgAnnounce * announce)
 }
 
 #ifndef PTPD_SLAVE_ONLY /* does not get compiled when building slave only */
+/* Follow_Up template: everything but sequenceId and preciseOriginTimestamp */
+static void
+msgPackFollowUpTemplate(Octet * buf, PtpClock * ptpClock)
+{
+	msgPackHeaderType(buf, FOLLOW_UP, FOLLOW_UP_LENGTH, 0x02);
+
+	 /* Table 24 - unless it's multicast, logMessageInterval remains    0x7F */
+	 if(rtOpts.transport == IEEE_802_3 || rtOpts.ipMode != IPMODE_UNICAST)
+		msgStoreInteger8(buf + HEADER_OFFSET_logMessageInterval, &ptpClock->portDS.logSyncInterval);
+}
+
 /*pack Follow_up message into OUT buffer of ptpClock*/
 void
 msgPackFollowUp(Octet * buf, Timestamp * preciseOriginTimestamp, PtpClock * ptpClock, const UInteger16 sequenceId)
 {
-	msgPackHeader(buf, ptpClock);
-	
-	/* changes in header */
-	*(char *)(buf + 0) = *(char *)(buf + 0) & 0xF0;
-	/* RAZ messageType */
-	*(char *)(buf + 0) = *(char *)(buf + 0) | 0x08;
-	/* Table 19 */
-	*(UInteger16 *) (buf + 2) = flip16(FOLLOW_UP_LENGTH);
-	*(UInteger16 *) (buf + 30) = flip16(sequenceId);
-	*(UInteger8 *) (buf + 32) = 0x02;
+	memcpy(buf, msgGetTemplate(ptpClock, MSG_TEMPLATE_FOLLOW_UP, msgPackFollowUpTemplate), FOLLOW_UP_LENGTH);
 
-	 /* Table 24 - unless it's multicast, logMessageInterval remains    0x7F */
-	 if(rtOpts.transport == IEEE_802_3 || rtOpts.ipMode != IPMODE_UNICAST)
-		*(Integer8 *) (buf + 33) = ptpClock->portDS.logSyncInterval;
+	msgStoreUInteger16(buf + HEADER_OFFSET_sequenceId, &sequenceId);
 
 	/* Follow_up message */
-	*(UInteger16 *) (buf + 34) =
-		flip16(preciseOriginTimestamp->secondsField.msb);
-	*(UInteger32 *) (buf + 36) =
-		flip32(preciseOriginTimestamp->secondsField.lsb);
-	*(UInteger32 *) (buf + 40) =
-		flip32(preciseOriginTimestamp->nanosecondsField);
+	msgStoreTimestamp(buf + FOLLOW_UP_OFFSET_preciseOriginTimestamp, preciseOriginTimestamp);
 }
 #endif /* PTPD_SLAVE_ONLY */
 
@@ -1876,12 +1949,7 @@ msgPackFollowUp(Octet * buf, Timestamp * preciseOriginTimestamp, PtpClock * ptpC
 void
 msgUnpackFollowUp(Octet * buf, MsgFollowUp * follow)
 {
-	follow->preciseOriginTimestamp.secondsField.msb =
-		flip16(*(UInteger16 *) (buf + 34));
-	follow->preciseOriginTimestamp.secondsField.lsb =
-		flip32(*(UInteger32 *) (buf + 36));
-	follow->preciseOriginTimestamp.nanosecondsField =
-		flip32(*(UInteger32 *) (buf + 40));
+	msgLoadTimestamp(buf + FOLLOW_UP_OFFSET_preciseOriginTimestamp, &follow->preciseOriginTimestamp);
 
 	#ifdef PTPD_DBG
 	msgFollowUp_display(follow);
@@ -1894,27 +1962,15 @@ void
 msgPackPdelayReq(Octet * buf, Timestamp * originTimestamp, PtpClock * ptpClock)
 {
 	msgPackHeader(buf, ptpClock);
-	
-	/* changes in header */
-	*(char *)(buf + 0) = *(char *)(buf + 0) & 0xF0;
-	/* RAZ messageType */
-	*(char *)(buf + 0) = *(char *)(buf + 0) | 0x02;
-	/* Table 19 */
-	*(UInteger16 *) (buf + 2) = flip16(PDELAY_REQ_LENGTH);
-	*(UInteger16 *) (buf + 30) = flip16(ptpClock->sentPdelayReqSequenceId);
-	*(UInteger8 *) (buf + 32) = 0x05;
-	/* Table 23 */
-	*(Integer8 *) (buf + 33) = 0x7F;
-	/* Table 24 */
-	memset((buf + 8), 0, 8);
+	msgPackHeaderType(buf, PDELAY_REQ, PDELAY_REQ_LENGTH, 0x05);
+	msgStoreUInteger16(buf + HEADER_OFFSET_sequenceId, &ptpClock->sentPdelayReqSequenceId);
+	/* Table 23, 24: logMessageInterval 0x7F, correctionField cleared by msgPackHeader() */
 
 	/* Pdelay_req message */
-	*(UInteger16 *) (buf + 34) = flip16(originTimestamp->secondsField.msb);
-	*(UInteger32 *) (buf + 36) = flip32(originTimestamp->secondsField.lsb);
-	*(UInteger32 *) (buf + 40) = flip32(originTimestamp->nanosecondsField);
+	msgStoreTimestamp(buf + PDELAY_REQ_OFFSET_originTimestamp, originTimestamp);
 
-	memset((buf + 44), 0, 10);
 	/* RAZ reserved octets */
+	memset(buf + PDELAY_REQ_OFFSET_reserved, 0, PDELAY_REQ_LENGTH - PDELAY_REQ_OFFSET_reserved);
 }
 
 /*pack delayReq message into OUT buffer of ptpClock*/
@@ -1922,69 +1978,48 @@ void
 msgPackDelayReq(Octet * buf, Timestamp * originTimestamp, PtpClock * ptpClock)
 {
 	msgPackHeader(buf, ptpClock);
-
-	/* changes in header */
-	*(char *)(buf + 0) = *(char *)(buf + 0) & 0xF0;
-	/* RAZ messageType */
-	*(char *)(buf + 0) = *(char *)(buf + 0) | 0x01;
-	/* Table 19 */
-	*(UInteger16 *) (buf + 2) = flip16(DELAY_REQ_LENGTH);
+	msgPackHeaderType(buf, DELAY_REQ, DELAY_REQ_LENGTH, 0x01);
 
 	/* -- PTP_UNICAST flag will be set in netsend* if needed */
 
-	*(UInteger16 *) (buf + 30) = flip16(ptpClock->sentDelayReqSequenceId);
-	*(UInteger8 *) (buf + 32) = 0x01;
-	/* Table 23 */
-	*(Integer8 *) (buf + 33) = 0x7F;
-	/* Table 24 */
-	memset((buf + 8), 0, 8);
+	msgStoreUInteger16(buf + HEADER_OFFSET_sequenceId, &ptpClock->sentDelayReqSequenceId);
+	/* Table 23, 24: logMessageInterval 0x7F, correctionField cleared by msgPackHeader() */
 
-	/* Pdelay_req message */
-	*(UInteger16 *) (buf + 34) = flip16(originTimestamp->secondsField.msb);
-	*(UInteger32 *) (buf + 36) = flip32(originTimestamp->secondsField.lsb);
-	*(UInteger32 *) (buf + 40) = flip32(originTimestamp->nanosecondsField);
+	/* Delay_req message */
+	msgStoreTimestamp(buf + DELAY_REQ_OFFSET_originTimestamp, originTimestamp);
+}
+
+/* Delay_Resp template: header constants, the rest comes from the Delay_Req */
+static void
+msgPackDelayRespTemplate(Octet * buf, PtpClock * ptpClock)
+{
+	msgPackHeaderType(buf, DELAY_RESP, DELAY_RESP_LENGTH, 0x03);
 }
 
 /*pack delayResp message into OUT buffer of ptpClock*/
 void
 msgPackDelayResp(Octet * buf, MsgHeader * header, Timestamp * receiveTimestamp, PtpClock * ptpClock)
 {
-	msgPackHeader(buf, ptpClock);
-	
-	/* changes in header */
-	*(char *)(buf + 0) = *(char *)(buf + 0) & 0xF0;
-	/* RAZ messageType */
-	*(char *)(buf + 0) = *(char *)(buf + 0) | 0x09;
-	/* Table 19 */
-	*(UInteger16 *) (buf + 2) = flip16(DELAY_RESP_LENGTH);
-	*(UInteger8 *) (buf + 4) = header->domainNumber;
+	memcpy(buf, msgGetTemplate(ptpClock, MSG_TEMPLATE_DELAY_RESP, msgPackDelayRespTemplate), DELAY_RESP_LENGTH);
 
-	/* -- PTP_UNICAST flag will be set in netsend* if needed */
-
-	memset((buf + 8), 0, 8);
+	msgStoreUInteger8(buf + HEADER_OFFSET_domainNumber, &header->domainNumber);
 
-	/* Copy correctionField of PdelayReqMessage */
-	*(Integer32 *) (buf + 8) = flip32(header->correctionField.msb);
-	*(Integer32 *) (buf + 12) = flip32(header->correctionField.lsb);
+	/* -- PTP_UNICAST flag will be set in netsend* if needed */
 
-	*(UInteger16 *) (buf + 30) = flip16(header->sequenceId);
+	/* Copy correctionField of DelayReqMessage */
+	msgStoreInteger64(buf + HEADER_OFFSET_correctionField, &header->correctionField);
 
-	*(UInteger8 *) (buf + 32) = 0x03;
+	msgStoreUInteger16(buf + HEADER_OFFSET_sequenceId, &header->sequenceId);
 
 	 /* Table 24 - unless it's multicast, logMessageInterval remains    0x7F */
 	 /* really tempting to cheat here, at least for hybrid, but standard is a standard */
 	if ((header->flagField0 & PTP_UNICAST) != PTP_UNICAST) {
-	    *(Integer8 *) (buf + 33) = ptpClock->portDS.logMinDelayReqInterval;
+		msgStoreInteger8(buf + HEADER_OFFSET_logMessageInterval, &ptpClock->portDS.logMinDelayReqInterval);
 	}
 
-	/* Pdelay_resp message */
-	*(UInteger16 *) (buf + 34) =
-		flip16(receiveTimestamp->secondsField.msb);
-	*(UInteger32 *) (buf + 36) = flip32(receiveTimestamp->secondsField.lsb);
-	*(UInteger32 *) (buf + 40) = flip32(receiveTimestamp->nanosecondsField);
-	copyClockIdentity((buf + 44), header->sourcePortIdentity.clockIdentity);
-	*(UInteger16 *) (buf + 52) =
-		flip16(header->sourcePortIdentity.portNumber);
+	/* Delay_resp message */
+	msgStoreTimestamp(buf + DELAY_RESP_OFFSET_receiveTimestamp, receiveTimestamp);
+	msgStorePortIdentity(buf + DELAY_RESP_OFFSET_requestingPortIdentity, &header->sourcePortIdentity);
 }
 
 /*pack PdelayResp message into OUT buffer of ptpClock*/
@@ -1992,34 +2027,18 @@ void
 msgPackPdelayResp(Octet * buf, MsgHeader * header, Timestamp * requestReceiptTimestamp, PtpClock * ptpClock)
 {
 	msgPackHeader(buf, ptpClock);
-	
-	/* changes in header */
-	*(char *)(buf + 0) = *(char *)(buf + 0) & 0xF0;
-	/* RAZ messageType */
-	*(char *)(buf + 0) = *(char *)(buf + 0) | 0x03;
+	msgPackHeaderType(buf, PDELAY_RESP, PDELAY_RESP_LENGTH, 0x05);
 	/* Two step flag - table 20: Sync and PdelayResp only */
 	if (ptpClock->defaultDS.twoStepFlag)
-		*(UInteger8 *) (buf + 6) |= PTP_TWO_STEP;
-	/* Table 19 */
-	*(UInteger16 *) (buf + 2) = flip16(PDELAY_RESP_LENGTH);
-	*(UInteger8 *) (buf + 4) = header->domainNumber;
-	memset((buf + 8), 0, 8);
-
+		buf[HEADER_OFFSET_flagField0] |= PTP_TWO_STEP;
+	msgStoreUInteger8(buf + HEADER_OFFSET_domainNumber, &header->domainNumber);
 
-	*(UInteger16 *) (buf + 30) = flip16(header->sequenceId);
-
-	*(UInteger8 *) (buf + 32) = 0x05;
-	/* Table 23 */
-	*(Integer8 *) (buf + 33) = 0x7F;
-	/* Table 24 */
+	msgStoreUInteger16(buf + HEADER_OFFSET_sequenceId, &header->sequenceId);
+	/* Table 23, 24: logMessageInterval 0x7F */
 
 	/* Pdelay_resp message */
-	*(UInteger16 *) (buf + 34) = flip16(requestReceiptTimestamp->secondsField.msb);
-	*(UInteger32 *) (buf + 36) = flip32(requestReceiptTimestamp->secondsField.lsb);
-	*(UInteger32 *) (buf + 40) = flip32(requestReceiptTimestamp->nanosecondsField);
-	copyClockIdentity((buf + 44), header->sourcePortIdentity.clockIdentity);
-	*(UInteger16 *) (buf + 52) = flip16(header->sourcePortIdentity.portNumber);
-
+	msgStoreTimestamp(buf + PDELAY_RESP_OFFSET_requestReceiptTimestamp, requestReceiptTimestamp);
+	msgStorePortIdentity(buf + PDELAY_RESP_OFFSET_requestingPortIdentity, &header->sourcePortIdentity);
 }
 
 
@@ -2027,12 +2046,7 @@ msgPackPdelayResp(Octet * buf, MsgHeader * header, Timestamp * requestReceiptTim
 void
 msgUnpackDelayReq(Octet * buf, MsgDelayReq * delayreq)
 {
-	delayreq->originTimestamp.secondsField.msb =
-		flip16(*(UInteger16 *) (buf + 34));
-	delayreq->originTimestamp.secondsField.lsb =
-		flip32(*(UInteger32 *) (buf + 36));
-	delayreq->originTimestamp.nanosecondsField =
-		flip32(*(UInteger32 *) (buf + 40));
+	msgLoadTimestamp(buf + DELAY_REQ_OFFSET_originTimestamp, &delayreq->originTimestamp);
 
 	#ifdef PTPD_DBG
 	msgDelayReq_display(delayreq);
@@ -2045,12 +2059,7 @@ msgUnpackDelayReq(Octet * buf, MsgDelayReq * delayreq)
 void
 msgUnpackPdelayReq(Octet * buf, MsgPdelayReq * pdelayreq)
 {
-	pdelayreq->originTimestamp.secondsField.msb =
-		flip16(*(UInteger16 *) (buf + 34));
-	pdelayreq->originTimestamp.secondsField.lsb =
-		flip32(*(UInteger32 *) (buf + 36));
-	pdelayreq->originTimestamp.nanosecondsField =
-		flip32(*(UInteger32 *) (buf + 40));
+	msgLoadTimestamp(buf + PDELAY_REQ_OFFSET_originTimestamp, &pdelayreq->originTimestamp);
 
 	#ifdef PTPD_DBG
 	msgPdelayReq_display(pdelayreq);
@@ -2063,16 +2072,8 @@ msgUnpackPdelayReq(Octet * buf, MsgPdelayReq * pdelayreq)
 void
 msgUnpackDelayResp(Octet * buf, MsgDelayResp * resp)
 {
-	resp->receiveTimestamp.secondsField.msb =
-		flip16(*(UInteger16 *) (buf + 34));
-	resp->receiveTimestamp.secondsField.lsb =
-		flip32(*(UInteger32 *) (buf + 36));
-	resp->receiveTimestamp.nanosecondsField =
-		flip32(*(UInteger32 *) (buf + 40));
-	copyClockIdentity(resp->requestingPortIdentity.clockIdentity,
-	       (buf + 44));
-	resp->requestingPortIdentity.portNumber =
-		flip16(*(UInteger16 *) (buf + 52));
+	msgLoadTimestamp(buf + DELAY_RESP_OFFSET_receiveTimestamp, &resp->receiveTimestamp);
+	msgLoadPortIdentity(buf + DELAY_RESP_OFFSET_requestingPortIdentity, &resp->requestingPortIdentity);
 
 	#ifdef PTPD_DBG
 	msgDelayResp_display(resp);
@@ -2084,16 +2085,8 @@ msgUnpackDelayResp(Octet * buf, MsgDelayResp * resp)
 void
 msgUnpackPdelayResp(Octet * buf, MsgPdelayResp * presp)
 {
-	presp->requestReceiptTimestamp.secondsField.msb =
-		flip16(*(UInteger16 *) (buf + 34));
-	presp->requestReceiptTimestamp.secondsField.lsb =
-		flip32(*(UInteger32 *) (buf + 36));
-	presp->requestReceiptTimestamp.nanosecondsField =
-		flip32(*(UInteger32 *) (buf + 40));
-	copyClockIdentity(presp->requestingPortIdentity.clockIdentity,
-	       (buf + 44));
-	presp->requestingPortIdentity.portNumber =
-		flip16(*(UInteger16 *) (buf + 52));
+	msgLoadTimestamp(buf + PDELAY_RESP_OFFSET_requestReceiptTimestamp, &presp->requestReceiptTimestamp);
+	msgLoadPortIdentity(buf + PDELAY_RESP_OFFSET_requestingPortIdentity, &presp->requestingPortIdentity);
 
 	#ifdef PTPD_DBG
 	msgPdelayResp_display(presp);
@@ -2105,49 +2098,24 @@ void
 msgPackPdelayRespFollowUp(Octet * buf, MsgHeader * header, Timestamp * responseOriginTimestamp, PtpClock * ptpClock, const UInteger16 sequenceId)
 {
 	msgPackHeader(buf, ptpClock);
-	
-	/* changes in header */
-	*(char *)(buf + 0) = *(char *)(buf + 0) & 0xF0;
-	/* RAZ messageType */
-	*(char *)(buf + 0) = *(char *)(buf + 0) | 0x0A;
-	/* Table 19 */
-	*(UInteger16 *) (buf + 2) = flip16(PDELAY_RESP_FOLLOW_UP_LENGTH);
-	*(UInteger16 *) (buf + 30) = flip16(sequenceId);
-	*(UInteger8 *) (buf + 32) = 0x05;
-	/* Table 23 */
-	*(Integer8 *) (buf + 33) = 0x7F;
-	/* Table 24 */
+	msgPackHeaderType(buf, PDELAY_RESP_FOLLOW_UP, PDELAY_RESP_FOLLOW_UP_LENGTH, 0x05);
+	msgStoreUInteger16(buf + HEADER_OFFSET_sequenceId, &sequenceId);
+	/* Table 23, 24: logMessageInterval 0x7F */
 
 	/* Copy correctionField of PdelayReqMessage */
-	*(Integer32 *) (buf + 8) = flip32(header->correctionField.msb);
-	*(Integer32 *) (buf + 12) = flip32(header->correctionField.lsb);
+	msgStoreInteger64(buf + HEADER_OFFSET_correctionField, &header->correctionField);
 
 	/* Pdelay_resp_follow_up message */
-	*(UInteger16 *) (buf + 34) =
-		flip16(responseOriginTimestamp->secondsField.msb);
-	*(UInteger32 *) (buf + 36) =
-		flip32(responseOriginTimestamp->secondsField.lsb);
-	*(UInteger32 *) (buf + 40) =
-		flip32(responseOriginTimestamp->nanosecondsField);
-	copyClockIdentity((buf + 44), header->sourcePortIdentity.clockIdentity);
-	*(UInteger16 *) (buf + 52) =
-		flip16(header->sourcePortIdentity.portNumber);
+	msgStoreTimestamp(buf + PDELAY_RESP_FOLLOW_UP_OFFSET_responseOriginTimestamp, responseOriginTimestamp);
+	msgStorePortIdentity(buf + PDELAY_RESP_FOLLOW_UP_OFFSET_requestingPortIdentity, &header->sourcePortIdentity);
 }
 
 /*Unpack PdelayResp message from IN buffer of ptpClock to msgtmp.presp*/
 void
 msgUnpackPdelayRespFollowUp(Octet * buf, MsgPdelayRespFollowUp * prespfollow)
 {
-	prespfollow->responseOriginTimestamp.secondsField.msb =
-		flip16(*(UInteger16 *) (buf + 34));
-	prespfollow->responseOriginTimestamp.secondsField.lsb =
-		flip32(*(UInteger32 *) (buf + 36));
-	prespfollow->responseOriginTimestamp.nanosecondsField =
-		flip32(*(UInteger32 *) (buf + 40));
-	copyClockIdentity(prespfollow->requestingPortIdentity.clockIdentity,
-	       (buf + 44));
-	prespfollow->requestingPortIdentity.portNumber =
-		flip16(*(UInteger16 *) (buf + 52));
+	msgLoadTimestamp(buf + PDELAY_RESP_FOLLOW_UP_OFFSET_responseOriginTimestamp, &prespfollow->responseOriginTimestamp);
+	msgLoadPortIdentity(buf + PDELAY_RESP_FOLLOW_UP_OFFSET_requestingPortIdentity, &prespfollow->requestingPortIdentity);
 
 #ifdef PTPD_DBG
         msgPdelayRespFollowUp_display(prespfollow);
@@ -2469,7 +2437,8 @@ msgUnpackManagement(Octet *buf, MsgManagement * manage, MsgHeader * header, PtpC
 {
 	unpackMsgManagement(buf, manage, ptpClock);
 
-	if ( manage->header.messageLength >= (MANAGEMENT_LENGTH + tlvOffset + TL_LENGTH) )
+	/* a management TLV carries its managementId after the type and length */
+	if ( manage->header.messageLength >= (MANAGEMENT_LENGTH + tlvOffset + TLV_LENGTH) )
 	{
 		unpackManagementTLV(buf, tlvOffset, manage, ptpClock);
 
@@ -0,0 +1,334 @@
+#ifndef PTPD_MSGLAYOUT_H_
+#define PTPD_MSGLAYOUT_H_
+
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file    msglayout.h
+ * @authors The PTPd Project
+ * @date   Mon Jan 18 09:41:27 2016
+ * Wire layout of the fixed-size messages and structures, generated at
+ * compile time from the src/def definitions: <PREFIX>_OFFSET_<field> is the
+ * offset of a field, <PREFIX>_OFFSET_END the total length. msgLoad<type>()
+ * and msgStore<type>() read and write one field at a constant offset, so
+ * an X-macro over a definition expands into straight-line loads and stores
+ * with no per-field calls or bounds checks - the caller checks the message
+ * length once. Only variable-length TLV data goes through the generic
+ * pack / unpack functions in msg.c.
+ */
+
+#define MSGLAYOUT_OFFSET(prefix, name, size) \
+	prefix##_OFFSET_##name, prefix##_OFFSET_##name##_LAST = prefix##_OFFSET_##name + (size) - 1,
+
+/* derived types */
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(TIMESTAMP, name, size)
+#include "../def/derivedData/timestamp.def"
+	TIMESTAMP_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(PORT_IDENTITY, name, size)
+#include "../def/derivedData/portIdentity.def"
+	PORT_IDENTITY_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(CLOCK_QUALITY, name, size)
+#include "../def/derivedData/clockQuality.def"
+	CLOCK_QUALITY_OFFSET_END
+};
+
+/* messages */
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(HEADER, name, size)
+#include "../def/message/header.def"
+	HEADER_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(ANNOUNCE, name, size)
+#include "../def/message/announce.def"
+	ANNOUNCE_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(SYNC, name, size)
+#include "../def/message/sync.def"
+	SYNC_OFFSET_END
+};
+
+/* Table 26 covers Sync and Delay_Req */
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(DELAY_REQ, name, size)
+#include "../def/message/sync.def"
+	DELAY_REQ_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(FOLLOW_UP, name, size)
+#include "../def/message/followUp.def"
+	FOLLOW_UP_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(DELAY_RESP, name, size)
+#include "../def/message/delayResp.def"
+	DELAY_RESP_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(PDELAY_REQ, name, size)
+#include "../def/message/pdelayReq.def"
+	PDELAY_REQ_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(PDELAY_RESP, name, size)
+#include "../def/message/pdelayResp.def"
+	PDELAY_RESP_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(PDELAY_RESP_FOLLOW_UP, name, size)
+#include "../def/message/pdelayRespFollowUp.def"
+	PDELAY_RESP_FOLLOW_UP_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(MANAGEMENT, name, size)
+#include "../def/message/management.def"
+	MANAGEMENT_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(SIGNALING, name, size)
+#include "../def/message/signaling.def"
+	SIGNALING_OFFSET_END
+};
+
+/* TLV headers, relative to the start of the TLV */
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(MANAGEMENT_TLV, name, size)
+#include "../def/managementTLV/managementTLV.def"
+	MANAGEMENT_TLV_OFFSET_END
+};
+
+enum {
+#define OPERATE( name, size, type ) MSGLAYOUT_OFFSET(SIGNALING_TLV, name, size)
+#include "../def/signalingTLV/signalingTLV.def"
+	SIGNALING_TLV_OFFSET_END
+};
+
+/* the definitions and the Table 19 lengths must agree */
+typedef char msgLayoutCheck[(TIMESTAMP_OFFSET_END == 10 &&
+			     PORT_IDENTITY_OFFSET_END == 10 &&
+			     CLOCK_QUALITY_OFFSET_END == 4 &&
+			     HEADER_OFFSET_END == HEADER_LENGTH &&
+			     ANNOUNCE_OFFSET_END == ANNOUNCE_LENGTH &&
+			     SYNC_OFFSET_END == SYNC_LENGTH &&
+			     DELAY_REQ_OFFSET_END == DELAY_REQ_LENGTH &&
+			     FOLLOW_UP_OFFSET_END == FOLLOW_UP_LENGTH &&
+			     DELAY_RESP_OFFSET_END == DELAY_RESP_LENGTH &&
+			     PDELAY_REQ_OFFSET_END == PDELAY_REQ_LENGTH &&
+			     PDELAY_RESP_OFFSET_END == PDELAY_RESP_LENGTH &&
+			     PDELAY_RESP_FOLLOW_UP_OFFSET_END == PDELAY_RESP_FOLLOW_UP_LENGTH &&
+			     MANAGEMENT_OFFSET_END == MANAGEMENT_LENGTH &&
+			     SIGNALING_OFFSET_END == SIGNALING_LENGTH &&
+			     MANAGEMENT_TLV_OFFSET_END == TLV_LENGTH &&
+			     SIGNALING_TLV_OFFSET_END == TL_LENGTH) ? 1 : -1];
+
+/*
+ * Field loads and stores. memcpy() of a constant size compiles to a single
+ * (unaligned) load or store, without the alignment faults of casting the
+ * buffer - see bugs #37 and #40.
+ */
+
+#define MSGLAYOUT_OCTET( type ) \
+static inline void msgLoad##type(const Octet *buf, type *data) \
+{ \
+	*data = *(const UInteger8 *)buf; \
+} \
+static inline void msgStore##type(Octet *buf, const type *data) \
+{ \
+	*(UInteger8 *)buf = *data; \
+}
+
+#define MSGLAYOUT_ENDIAN( type, size ) \
+static inline void msgLoad##type(const Octet *buf, type *data) \
+{ \
+	memcpy(data, buf, sizeof(type)); \
+	*data = flip##size(*data); \
+} \
+static inline void msgStore##type(Octet *buf, const type *data) \
+{ \
+	type value = flip##size(*data); \
+	memcpy(buf, &value, sizeof(type)); \
+}
+
+/* the upper nibble has size 0 in the definitions, the lower one stores the octet */
+#define MSGLAYOUT_NIBBLES( type ) \
+static inline void msgLoad##type##Upper(const Octet *buf, type *data) \
+{ \
+	*data = (*(const UInteger8 *)buf >> 4) & 0x0F; \
+} \
+static inline void msgStore##type##Upper(Octet *buf, const type *data) \
+{ \
+	*(UInteger8 *)buf = (*(UInteger8 *)buf & 0x0F) | (*data << 4); \
+} \
+static inline void msgLoad##type##Lower(const Octet *buf, type *data) \
+{ \
+	*data = *(const UInteger8 *)buf & 0x0F; \
+} \
+static inline void msgStore##type##Lower(Octet *buf, const type *data) \
+{ \
+	*(UInteger8 *)buf = (*(UInteger8 *)buf & 0xF0) | (*data & 0x0F); \
+}
+
+MSGLAYOUT_OCTET( Octet )
+MSGLAYOUT_OCTET( UInteger8 )
+MSGLAYOUT_OCTET( Integer8 )
+MSGLAYOUT_OCTET( Enumeration8 )
+
+MSGLAYOUT_ENDIAN( UInteger16, 16 )
+MSGLAYOUT_ENDIAN( Integer16, 16 )
+MSGLAYOUT_ENDIAN( Enumeration16, 16 )
+MSGLAYOUT_ENDIAN( UInteger32, 32 )
+MSGLAYOUT_ENDIAN( Integer32, 32 )
+
+MSGLAYOUT_NIBBLES( Nibble )
+MSGLAYOUT_NIBBLES( Enumeration4 )
+MSGLAYOUT_NIBBLES( UInteger4 )
+
+static inline void
+msgLoadUInteger48(const Octet *buf, UInteger48 *data)
+{
+	msgLoadUInteger16(buf, &data->msb);
+	msgLoadUInteger32(buf + 2, &data->lsb);
+}
+
+static inline void
+msgStoreUInteger48(Octet *buf, const UInteger48 *data)
+{
+	msgStoreUInteger16(buf, &data->msb);
+	msgStoreUInteger32(buf + 2, &data->lsb);
+}
+
+static inline void
+msgLoadInteger64(const Octet *buf, Integer64 *data)
+{
+	msgLoadInteger32(buf, &data->msb);
+	msgLoadUInteger32(buf + 4, &data->lsb);
+}
+
+static inline void
+msgStoreInteger64(Octet *buf, const Integer64 *data)
+{
+	msgStoreInteger32(buf, &data->msb);
+	msgStoreUInteger32(buf + 4, &data->lsb);
+}
+
+static inline void
+msgLoadClockIdentity(const Octet *buf, ClockIdentity *data)
+{
+	memcpy(*data, buf, CLOCK_IDENTITY_LENGTH);
+}
+
+static inline void
+msgStoreClockIdentity(Octet *buf, const ClockIdentity *data)
+{
+	memcpy(buf, *data, CLOCK_IDENTITY_LENGTH);
+}
+
+/* derived types and the header are generated from their definitions */
+
+#define MSGLAYOUT_LOAD( base, prefix, name, type ) \
+	msgLoad##type((base) + prefix##_OFFSET_##name, &data->name);
+#define MSGLAYOUT_STORE( base, prefix, name, type ) \
+	msgStore##type((base) + prefix##_OFFSET_##name, &data->name);
+
+static inline void
+msgLoadTimestamp(const Octet *buf, Timestamp *data)
+{
+	#define OPERATE( name, size, type ) MSGLAYOUT_LOAD(buf, TIMESTAMP, name, type)
+	#include "../def/derivedData/timestamp.def"
+}
+
+static inline void
+msgStoreTimestamp(Octet *buf, const Timestamp *data)
+{
+	#define OPERATE( name, size, type ) MSGLAYOUT_STORE(buf, TIMESTAMP, name, type)
+	#include "../def/derivedData/timestamp.def"
+}
+
+static inline void
+msgLoadPortIdentity(const Octet *buf, PortIdentity *data)
+{
+	#define OPERATE( name, size, type ) MSGLAYOUT_LOAD(buf, PORT_IDENTITY, name, type)
+	#include "../def/derivedData/portIdentity.def"
+}
+
+static inline void
+msgStorePortIdentity(Octet *buf, const PortIdentity *data)
+{
+	#define OPERATE( name, size, type ) MSGLAYOUT_STORE(buf, PORT_IDENTITY, name, type)
+	#include "../def/derivedData/portIdentity.def"
+}
+
+static inline void
+msgLoadClockQuality(const Octet *buf, ClockQuality *data)
+{
+	#define OPERATE( name, size, type ) MSGLAYOUT_LOAD(buf, CLOCK_QUALITY, name, type)
+	#include "../def/derivedData/clockQuality.def"
+}
+
+static inline void
+msgStoreClockQuality(Octet *buf, const ClockQuality *data)
+{
+	#define OPERATE( name, size, type ) MSGLAYOUT_STORE(buf, CLOCK_QUALITY, name, type)
+	#include "../def/derivedData/clockQuality.def"
+}
+
+static inline void
+msgLoadMsgHeader(const Octet *buf, MsgHeader *data)
+{
+	#define OPERATE( name, size, type ) MSGLAYOUT_LOAD(buf, HEADER, name, type)
+	#include "../def/message/header.def"
+}
+
+static inline void
+msgStoreMsgHeader(Octet *buf, const MsgHeader *data)
+{
+	#define OPERATE( name, size, type ) MSGLAYOUT_STORE(buf, HEADER, name, type)
+	#include "../def/message/header.def"
+}
+
+#endif /* PTPD_MSGLAYOUT_H_ */
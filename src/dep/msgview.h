@@ -0,0 +1,123 @@
+#ifndef PTPD_MSGVIEW_H_
+#define PTPD_MSGVIEW_H_
+
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file    msgview.h
+ * @authors The PTPd Project
+ * @date   Thu Jan 14 10:05:12 2016
+ * Read-only views of a received message. processMessage() validates the
+ * buffer length against the minimum length of the message type once, and
+ * handlers then read fields straight from the receive buffer at the
+ * offsets msglayout.h generates from the src/def definitions. Messages
+ * are only unpacked into structures where a handler keeps a copy (BMC
+ * records).
+ */
+
+/* minimum length of a message of given type, unknown types only need a header */
+static inline ssize_t
+msgMinLength(Enumeration4 messageType)
+{
+	switch(messageType) {
+	case SYNC:
+		return SYNC_LENGTH;
+	case DELAY_REQ:
+		return DELAY_REQ_LENGTH;
+	case PDELAY_REQ:
+		return PDELAY_REQ_LENGTH;
+	case PDELAY_RESP:
+		return PDELAY_RESP_LENGTH;
+	case FOLLOW_UP:
+		return FOLLOW_UP_LENGTH;
+	case DELAY_RESP:
+		return DELAY_RESP_LENGTH;
+	case PDELAY_RESP_FOLLOW_UP:
+		return PDELAY_RESP_FOLLOW_UP_LENGTH;
+	case ANNOUNCE:
+		return ANNOUNCE_LENGTH;
+	case SIGNALING:
+		return SIGNALING_LENGTH;
+	case MANAGEMENT:
+		return MANAGEMENT_LENGTH;
+	default:
+		return HEADER_LENGTH;
+	}
+}
+
+/*
+ * attach view to buffer - FALSE if the message is shorter than its type
+ * requires, or if messageLength claims more than was received: TLV walks
+ * are bounded by messageLength only.
+ */
+static inline Boolean
+msgViewInit(MsgView *view, const Octet *buf, ssize_t length)
+{
+	UInteger16 messageLength = 0;
+
+	if(length >= HEADER_LENGTH) {
+		msgLoadUInteger16(buf + HEADER_OFFSET_messageLength, &messageLength);
+	}
+
+	if(length < HEADER_LENGTH ||
+	    length < msgMinLength(*(const UInteger8 *) buf & 0x0F) ||
+	    messageLength > length) {
+		view->buf = NULL;
+		view->length = 0;
+		return FALSE;
+	}
+
+	view->buf = buf;
+	view->length = length;
+	return TRUE;
+}
+
+static inline UInteger16
+msgViewUInteger16(const MsgView *view, int offset)
+{
+	UInteger16 value;
+
+	msgLoadUInteger16(view->buf + offset, &value);
+	return value;
+}
+
+static inline void
+msgViewTimestamp(const MsgView *view, int offset, Timestamp *timestamp)
+{
+	msgLoadTimestamp(view->buf + offset, timestamp);
+}
+
+/* compare a PortIdentity field in place */
+static inline Boolean
+msgViewPortIdentityEqual(const MsgView *view, int offset, const PortIdentity *portIdentity)
+{
+	return !memcmp(view->buf + offset, portIdentity->clockIdentity, CLOCK_IDENTITY_LENGTH) &&
+		(msgViewUInteger16(view, offset + CLOCK_IDENTITY_LENGTH) == portIdentity->portNumber);
+}
+
+#endif /* PTPD_MSGVIEW_H_ */
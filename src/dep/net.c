@@ -68,12 +68,6 @@
 #define PCAP_TIMEOUT 1 /* expressed in milliseconds */
 #endif
 
-#if defined PTPD_SNMP
-#include <net-snmp/net-snmp-config.h>
-#include <net-snmp/net-snmp-includes.h>
-#include <net-snmp/agent/net-snmp-agent-includes.h>
-#endif
-
 /* choose kernel-level nanoseconds or microseconds resolution on the client-side */
 #if !defined(SO_TIMESTAMPING) && !defined(SO_TIMESTAMPNS) && !defined(SO_TIMESTAMP) && !defined(SO_BINTIME)
 #error No kernel-level support for packet timestamping detected!
@@ -1414,13 +1408,7 @@ netSelect(TimeInternal * timeout, NetPath * netPath, fd_set *readfds)
 {
 	int ret, nfds;
 	struct timeval tv, *tv_ptr;
-
-
-#if defined PTPD_SNMP
-	extern const RunTimeOpts rtOpts;
-	struct timeval snmp_timer_wait = { 0, 0}; // initialise to avoid unused warnings when SNMP disabled
-	int snmpblock = 0;
-#endif
+	fd_set writefds;
 
 	if (timeout) {
 		if(isTimeInternalNegative(timeout)) {
@@ -1460,37 +1448,25 @@ netSelect(TimeInternal * timeout, NetPath * netPath, fd_set *readfds)
 #endif
 	nfds++;
 
-#if defined PTPD_SNMP
-if (rtOpts.snmpEnabled) {
-	snmpblock = 1;
-	if (tv_ptr) {
-		snmpblock = 0;
-		memcpy(&snmp_timer_wait, tv_ptr, sizeof(struct timeval));
-	}
-	snmp_select_info(&nfds, readfds, &snmp_timer_wait, &snmpblock);
-	if (snmpblock == 0)
-		tv_ptr = &snmp_timer_wait;
-}
-#endif
+	FD_ZERO(&writefds);
+	metricsSelectInfo(&nfds, readfds, &writefds);
+	controlSelectInfo(&nfds, readfds, &writefds);
 
-	ret = select(nfds, readfds, 0, 0, tv_ptr);
+	ret = select(nfds, readfds, &writefds, 0, tv_ptr);
+
+	/* on error or timeout the sets are not usable, only check idle clients */
+	if (ret > 0) {
+		metricsProcess(readfds, &writefds);
+		controlProcess(readfds, &writefds);
+	} else {
+		metricsProcess(NULL, NULL);
+		controlProcess(NULL, NULL);
+	}
 
 	if (ret < 0) {
 		if (errno == EAGAIN || errno == EINTR)
 			return 0;
 	}
-#if defined PTPD_SNMP
-if (rtOpts.snmpEnabled) {
-	/* Maybe we have received SNMP related data */
-	if (ret > 0) {
-		snmp_read(readfds);
-	} else if (ret == 0) {
-		snmp_timeout();
-		run_alarms();
-	}
-	netsnmp_check_outstanding_agent_requests();
-}
-#endif
 	return ret;
 }
 
@@ -2298,3 +2274,39 @@ netRefreshIGMP(NetPath * netPath, const RunTimeOpts * rtOpts, PtpClock * ptpCloc
 
 	return TRUE;
 }
+
+/*
+ * re-apply DSCP and multicast TTL to the open sockets after a configuration change
+ */
+/*
+ * @return TRUE if successful
+ */
+Boolean
+netApplySocketOptions(NetPath * netPath, const RunTimeOpts * rtOpts)
+{
+	DBG("netApplySocketOptions\n");
+
+	if(rtOpts->transport != UDP_IPV4 || netPath->eventSock < 0 || netPath->generalSock < 0) {
+		return TRUE;
+	}
+
+	/* unlike netInit(), also clear the DSCP bits if they were set before */
+	if (setsockopt(netPath->eventSock, IPPROTO_IP, IP_TOS,
+		 &rtOpts->dscpValue, sizeof(int)) < 0
+	    || setsockopt(netPath->generalSock, IPPROTO_IP, IP_TOS,
+		&rtOpts->dscpValue, sizeof(int)) < 0) {
+		    PERROR("Failed to set socket DSCP bits");
+		    return FALSE;
+	}
+
+	if(rtOpts->ipMode != IPMODE_UNICAST) {
+		if(!netSetMulticastTTL(netPath->eventSock,rtOpts->ttl) ||
+		    !netSetMulticastTTL(netPath->generalSock,rtOpts->ttl))
+			return FALSE;
+
+		netPath->ttlEvent = rtOpts->ttl;
+		netPath->ttlGeneral = rtOpts->ttl;
+	}
+
+	return TRUE;
+}
@@ -50,6 +50,7 @@ static int outlierFilterTune(OutlierFilter *filter);
 static void outlierFilterUpdate(OutlierFilter *filter);
 static Boolean outlierFilterConfigure(OutlierFilter *filter, OutlierFilterConfig *config);
 static Boolean outlierFilterFilter(OutlierFilter *filter, double sample);
+static Boolean outlierFilterApply(OutlierFilter *filter, double sample);
 static int outlierFilterDisplay(OutlierFilter *filter);
 
 int
@@ -202,9 +203,22 @@ outlierFilterConfigure(OutlierFilter *filter, OutlierFilterConfig *config)
 
 }
 
-/* 2 x fairy dust, 3 x unicorn droppings, 1 x magic beanstalk juice. blend, spray on the affected area twice per day */
+/* filter a sample - true = accepted */
 static Boolean
 outlierFilterFilter(OutlierFilter *filter, double sample)
+{
+
+	Boolean accepted = outlierFilterApply(filter, sample);
+
+	PTPD_PROBE4(outlier__filter, filter->id, (int64_t)(sample * 1E9), accepted, filter->blocking);
+
+	return accepted;
+
+}
+
+/* 2 x fairy dust, 3 x unicorn droppings, 1 x magic beanstalk juice. blend, spray on the affected area twice per day */
+static Boolean
+outlierFilterApply(OutlierFilter *filter, double sample)
 {
 
 	/* true = accepted - this is to tell the user if we advised to throw away the sample */
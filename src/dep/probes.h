@@ -0,0 +1,83 @@
+#ifndef PTPDPROBES_H_
+#define PTPDPROBES_H_
+
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file    probes.h
+ * @authors The PTPd Project
+ * @date   Wed Jan 13 14:22:50 2016
+ * Statically defined tracing (SDT / USDT) probes. When <sys/sdt.h> is
+ * available at build time (unless --disable-sdt is used), each probe is a
+ * single nop plus an ELF note, and can be attached at runtime with perf, bpftrace or SystemTap, e.g.:
+ *
+ *   bpftrace -e 'usdt:/usr/sbin/ptpd2:ptpd:offset__update { printf("%d\n", arg1); }'
+ *
+ * Without SDT support the probes compile to nothing. All time values
+ * are signed 64-bit nanoseconds, provider name is "ptpd":
+ *
+ * msg__receive(length)                          processMessage() entry
+ * msg__dispatch(messageType, sequenceId, fromSelf)  accepted, about to be handled
+ * msg__done(messageType, sequenceId)            handler returned
+ * state__change(oldState, newState)             toState()
+ * bmc__decision(foreignRecords, best, state)    bmc() result
+ * offset__update(delayMS, offsetFromMaster, offsetOK)  end of updateOffset()
+ * delay__update(delaySM, meanPathDelay)         end of updateDelay()
+ * pdelay__update(pdelayMS, peerMeanPathDelay)   end of updatePeerDelay()
+ * adj__freq(adj)                                adjFreq(), in ppb * 1000
+ * outlier__filter(id, sample, accepted, blocking)  outlier filter verdict
+ * grant__create(messageType, address, duration, logInterval, asMaster)
+ * grant__expire(messageType, address)           unicast grant expired
+ */
+
+#ifdef PTPD_SDT
+
+#include <sys/sdt.h>
+
+#define PTPD_PROBE(name)			DTRACE_PROBE(ptpd, name)
+#define PTPD_PROBE1(name, a)			DTRACE_PROBE1(ptpd, name, a)
+#define PTPD_PROBE2(name, a, b)			DTRACE_PROBE2(ptpd, name, a, b)
+#define PTPD_PROBE3(name, a, b, c)		DTRACE_PROBE3(ptpd, name, a, b, c)
+#define PTPD_PROBE4(name, a, b, c, d)		DTRACE_PROBE4(ptpd, name, a, b, c, d)
+#define PTPD_PROBE5(name, a, b, c, d, e)	DTRACE_PROBE5(ptpd, name, a, b, c, d, e)
+
+#else
+
+#define PTPD_PROBE(name)			do {} while(0)
+#define PTPD_PROBE1(name, a)			do {} while(0)
+#define PTPD_PROBE2(name, a, b)			do {} while(0)
+#define PTPD_PROBE3(name, a, b, c)		do {} while(0)
+#define PTPD_PROBE4(name, a, b, c, d)		do {} while(0)
+#define PTPD_PROBE5(name, a, b, c, d, e)	do {} while(0)
+
+#endif /* PTPD_SDT */
+
+/* TimeInternal as nanoseconds for probe arguments */
+#define PROBE_NS(t) ((int64_t)(t).seconds * 1000000000LL + (t).nanoseconds)
+
+#endif /* PTPDPROBES_H_ */
@@ -227,6 +227,10 @@ void msgUnpackPdelayRespFollowUp(Octet * buf,MsgPdelayRespFollowUp*);
 Boolean msgUnpackManagement(Octet * buf,MsgManagement*, MsgHeader*, PtpClock *ptpClock, const int tlvOffset);
 Boolean msgUnpackSignaling(Octet * buf,MsgSignaling*, MsgHeader*, PtpClock *ptpClock, const int tlvOffset);
 void msgPackHeader(Octet * buf,PtpClock*);
+void msgInvalidateTemplates(PtpClock*);
+void* msgArenaAlloc(MsgArena*, size_t);
+size_t msgArenaMark(MsgArena*);
+void msgArenaRelease(MsgArena*, size_t);
 #ifndef PTPD_SLAVE_ONLY
 void msgPackAnnounce(Octet * buf, UInteger16, Timestamp*, PtpClock*);
 void msgPackSync(Octet * buf, UInteger16, Timestamp*, PtpClock*);
@@ -377,6 +381,7 @@ ssize_t netSendGeneral(Octet*,UInteger16,NetPath*,const RunTimeOpts*,Integer32 )
 ssize_t netSendPeerGeneral(Octet*,UInteger16,NetPath*,const RunTimeOpts*, Integer32);
 ssize_t netSendPeerEvent(Octet*,UInteger16,NetPath*,const RunTimeOpts*,Integer32,TimeInternal*);
 Boolean netRefreshIGMP(NetPath *, const RunTimeOpts *, PtpClock *);
+Boolean netApplySocketOptions(NetPath *, const RunTimeOpts *);
 Boolean hostLookup(const char* hostname, Integer32* addr);
 
 /** \}*/
@@ -388,6 +393,7 @@ Boolean hostLookup(const char* hostname, Integer32* addr);
 
 void snmpInit(RunTimeOpts *, PtpClock *);
 void snmpShutdown();
+void snmpUpdate(RunTimeOpts *, PtpClock *);
 void eventHandler_snmp(AlarmEntry *alarm);
 void alarmHandler_snmp(AlarmEntry *alarm);
 
@@ -397,6 +403,42 @@ void alarmHandler_snmp(AlarmEntry *alarm);
 /** \}*/
 #endif
 
+/** \name latency.c (Unix API dependent)
+ * -Hot path latency probes*/
+ /**\{*/
+void resetLatencyProbes(LatencyProbes *probes);
+void latencyRxDispatch(const RunTimeOpts *rtOpts, PtpClock *ptpClock, const TimeInternal *rxTime);
+void latencyRxStage(const RunTimeOpts *rtOpts, PtpClock *ptpClock, int stage);
+void latencyTxSync(const RunTimeOpts *rtOpts, PtpClock *ptpClock);
+const char* getLatencyStageName(int stage);
+/** \}*/
+
+/** \name metrics.c (Unix API dependent)
+ * -OpenMetrics exporter on a local TCP or Unix socket*/
+ /**\{*/
+void metricsInit(const RunTimeOpts *rtOpts, PtpClock *ptpClock);
+void metricsShutdown(void);
+void metricsSelectInfo(int *nfds, fd_set *readfds, fd_set *writefds);
+void metricsProcess(fd_set *readfds, fd_set *writefds);
+/** \}*/
+
+/** \name control.c (Unix API dependent)
+ * -Local control socket for queries and configuration changes*/
+ /**\{*/
+void controlInit(RunTimeOpts *rtOpts, PtpClock *ptpClock);
+void controlShutdown(void);
+void controlSelectInfo(int *nfds, fd_set *readfds, fd_set *writefds);
+void controlProcess(fd_set *readfds, fd_set *writefds);
+/** \}*/
+
+/** \name warmstart.c (Unix API dependent)
+ * -State snapshot saved across restarts*/
+ /**\{*/
+Boolean saveWarmStart(const RunTimeOpts *rtOpts, PtpClock *ptpClock, Boolean quiet);
+void loadWarmStart(const RunTimeOpts *rtOpts, PtpClock *ptpClock);
+void applyWarmStart(const RunTimeOpts *rtOpts, PtpClock *ptpClock);
+/** \}*/
+
 /** \name servo.c
  * -Clock servo*/
  /**\{*/
@@ -408,6 +450,9 @@ void updateOffset(TimeInternal*,TimeInternal*,
   offset_from_master_filter*,const RunTimeOpts*,PtpClock*,TimeInternal*);
 void checkOffset(const RunTimeOpts*, PtpClock*);
 void updateClock(const RunTimeOpts*,PtpClock*);
+void queueClockUpdate(const RunTimeOpts*,PtpClock*);
+void runServoUpdate(const RunTimeOpts*,PtpClock*);
+void resetServoBuffer(ServoOffsetBuffer*);
 void stepClock(const RunTimeOpts * rtOpts, PtpClock * ptpClock);
 
 /** \}*/
@@ -423,7 +468,7 @@ PtpClock * ptpdStartup(int,char**,Integer16*,RunTimeOpts*);
 void ptpdShutdown(PtpClock * ptpClock);
 void checkSignals(RunTimeOpts * rtOpts, PtpClock * ptpClock);
 void restartSubsystems(RunTimeOpts *rtOpts, PtpClock *ptpClock);
-void applyConfig(dictionary *baseConfig, RunTimeOpts *rtOpts, PtpClock *ptpClock);
+Boolean applyConfig(dictionary *baseConfig, RunTimeOpts *rtOpts, PtpClock *ptpClock);
 
 void enable_runtime_debug(void );
 void disable_runtime_debug(void );
@@ -451,15 +496,28 @@ Boolean maintainLogSize(LogFileHandler* handler);
 int restartLog(LogFileHandler* handler, Boolean quiet);
 void restartLogging(RunTimeOpts* rtOpts);
 void stopLogging(RunTimeOpts* rtOpts);
+
+/* shared memory statistics segment needs shm_open and atomic builtins */
+#if defined(HAVE_SHM_OPEN) && defined(HAVE_ATOMIC_BUILTINS)
+#define PTPD_STATSSHM
+#endif
+
+void restartStatsSegment(const RunTimeOpts *rtOpts);
+void closeStatsSegment(void);
+void updateStatsSegment(PtpClock *ptpClock);
+
 void logStatistics(PtpClock *ptpClock);
 void periodicUpdate(const RunTimeOpts *rtOpts, PtpClock *ptpClock);
 void displayStatus(PtpClock *ptpClock, const char *prefixMessage);
 void displayPortIdentity(PortIdentity *port, const char *prefixMessage);
 int snprint_PortIdentity(char *s, int max_len, const PortIdentity *id);
+const PtpdCounterInfo* getPtpdCounterInfo(int counter);
+uint32_t getPtpdCounter(const PtpdCounters *counters, int counter);
 Boolean nanoSleep(TimeInternal*);
 void getTime(TimeInternal*);
 void getTimeMonotonic(TimeInternal*);
 void setTime(TimeInternal*);
+void stepTime(TimeInternal*);
 #ifdef linux
 void setRtc(TimeInternal *);
 #endif /* linux */
@@ -477,6 +535,10 @@ Boolean adjFreq(double);
 double getAdjFreq(void);
 
 #ifdef HAVE_SYS_TIMEX_H
+/* Batch kernel clock changes into a single adjtimex() call */
+void clockActuatorBegin(void);
+Boolean clockActuatorCommit(void);
+
 void informClockSource(PtpClock* ptpClock);
 
 /* Helper function to manage ntpadjtime / adjtimex flags */
@@ -507,6 +569,11 @@ double runPIservo(PIservo* servo, const Integer32 input);
 
 #ifdef PTPD_STATISTICS
 void updatePtpEngineStats (PtpClock* ptpClock, const RunTimeOpts* rtOpts);
+void setupHoldover(HoldoverModel *holdover, const RunTimeOpts *rtOpts);
+void resetHoldover(HoldoverModel *holdover);
+void startHoldover(const RunTimeOpts *rtOpts, PtpClock *ptpClock);
+void updateHoldover(const RunTimeOpts *rtOpts, PtpClock *ptpClock);
+void endHoldover(const RunTimeOpts *rtOpts, PtpClock *ptpClock);
 #endif /* PTPD_STATISTICS */
 
 void writeStatusFile(PtpClock *ptpClock, const RunTimeOpts *rtOpts, Boolean quiet);
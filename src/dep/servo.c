@@ -64,6 +64,8 @@
 
 #ifdef PTPD_STATISTICS
 static void checkServoStable(PtpClock *ptpClock, const RunTimeOpts *rtOpts);
+static void fitHoldoverModel(HoldoverModel *holdover);
+static void feedHoldover(PtpClock *ptpClock, const RunTimeOpts *rtOpts);
 #endif
 
 void
@@ -112,6 +114,13 @@ initClock(const RunTimeOpts * rtOpts, PtpClock * ptpClock)
 
 	ptpClock->maxDelayRejected = 0;
 
+	/* in-flight exchanges are meaningless after a reset */
+	memset(ptpClock->syncExchanges, 0, sizeof(ptpClock->syncExchanges));
+	memset(ptpClock->delayReqExchanges, 0, sizeof(ptpClock->delayReqExchanges));
+
+	/* queued offsets are meaningless after a reset */
+	resetServoBuffer(&ptpClock->servoBuffer);
+
 }
 
 void
@@ -234,6 +243,8 @@ updateDelay(one_way_delay_filter * mpd_filt, const RunTimeOpts * rtOpts, PtpCloc
 	}
 #endif
 
+	feedLogHistogram(&ptpClock->histograms.live[PTP_HISTOGRAM_DELAYSM], timeInternalToDouble(&ptpClock->rawDelaySM));
+
 	/* run the delayMS stats filter */
 	if(rtOpts->filterSMOpts.enabled) {
 	    if(!feedDoubleMovingStatFilter(ptpClock->filterSM, timeInternalToDouble(&ptpClock->rawDelaySM))) {
@@ -332,11 +343,15 @@ finish:
 
 DBG("UpdateDelay: Max delay hit: %d\n", maxDelayHit);
 
+	PTPD_PROBE2(delay__update, PROBE_NS(ptpClock->delaySM),
+		PROBE_NS(ptpClock->currentDS.meanPathDelay));
+
 #ifdef PTPD_STATISTICS
 	/* don't churn on stats containers with the old value if we've discarded an outlier */
 	if(!(ptpClock->oFilterSM.config.enabled && ptpClock->oFilterSM.config.discard && ptpClock->oFilterSM.lastOutlier)) {
 		feedDoublePermanentStdDev(&ptpClock->slaveStats.mpdStats, timeInternalToDouble(&ptpClock->currentDS.meanPathDelay));
 		feedDoublePermanentMedian(&ptpClock->slaveStats.mpdMedianContainer, timeInternalToDouble(&ptpClock->currentDS.meanPathDelay));
+		feedLogHistogram(&ptpClock->histograms.live[PTP_HISTOGRAM_MPD], timeInternalToDouble(&ptpClock->currentDS.meanPathDelay));
 		if(!ptpClock->slaveStats.mpdStatsUpdated) {
 			if(timeInternalToDouble(&ptpClock->currentDS.meanPathDelay) != 0.0){
 			ptpClock->slaveStats.mpdMax = timeInternalToDouble(&ptpClock->currentDS.meanPathDelay);
@@ -432,6 +447,8 @@ updatePeerDelay(one_way_delay_filter * mpd_filt, const RunTimeOpts * rtOpts, Ptp
 
 	DBGV("delay filter %d, %d\n", mpd_filt->y, mpd_filt->s_exp);
 
+	PTPD_PROBE2(pdelay__update, PROBE_NS(ptpClock->pdelayMS),
+		PROBE_NS(ptpClock->portDS.peerMeanPathDelay));
 
 	if(ptpClock->portDS.portState == PTP_SLAVE)
 	logStatistics(ptpClock);
@@ -549,6 +566,8 @@ DBG("UpdateOffset: max delay hit: %d\n", maxDelayHit);
 	    	addTime(&ptpClock->rawDelayMS, &ptpClock->rawDelayMS, &bob);
 	}
 */
+	feedLogHistogram(&ptpClock->histograms.live[PTP_HISTOGRAM_DELAYMS], timeInternalToDouble(&ptpClock->rawDelayMS));
+
 	/* run the delayMS stats filter */
 	if(rtOpts->filterMSOpts.enabled) {
 	    /* FALSE if filter wants to skip the update */
@@ -634,8 +653,11 @@ DBG("UpdateOffset: max delay hit: %d\n", maxDelayHit);
 	ptpClock->offsetFirstUpdated = TRUE;
 	ptpClock->clockControl.offsetOK = TRUE;
 
+	latencyRxStage(rtOpts, ptpClock, LATENCY_RX_OFFSET);
+
 #ifdef PTPD_STATISTICS
 	if(!ptpClock->oFilterMS.lastOutlier) {
+		TimeInternal now;
             feedDoublePermanentStdDev(&ptpClock->slaveStats.ofmStats, timeInternalToDouble(&ptpClock->currentDS.offsetFromMaster));
             feedDoublePermanentMedian(&ptpClock->slaveStats.ofmMedianContainer, timeInternalToDouble(&ptpClock->currentDS.offsetFromMaster));
 		if(!ptpClock->slaveStats.ofmStatsUpdated) {
@@ -649,11 +671,19 @@ DBG("UpdateOffset: max delay hit: %d\n", maxDelayHit);
 		    ptpClock->slaveStats.ofmMin = min(ptpClock->slaveStats.ofmMin, timeInternalToDouble(&ptpClock->currentDS.offsetFromMaster));
 		}
 
+		getTimeMonotonic(&now);
+		feedClockStability(&ptpClock->stability,
+			timeInternalToDouble(&ptpClock->currentDS.offsetFromMaster), now.seconds);
+		feedLogHistogram(&ptpClock->histograms.live[PTP_HISTOGRAM_OFM],
+			timeInternalToDouble(&ptpClock->currentDS.offsetFromMaster));
 
 	}
 #endif /* PTPD_STATISTICS */
 
 finish:
+	PTPD_PROBE3(offset__update, PROBE_NS(ptpClock->delayMS),
+		PROBE_NS(ptpClock->currentDS.offsetFromMaster), ptpClock->clockControl.offsetOK);
+
 	logStatistics(ptpClock);
 
 	DBGV("\n--Offset Correction-- \n");
@@ -692,12 +722,12 @@ stepClock(const RunTimeOpts * rtOpts, PtpClock * ptpClock)
 
 	ptpClock->clockControl.stepRequired = FALSE;
 
-	TimeInternal oldTime, newTime;
+	TimeInternal step;
 	/*No need to reset the frequency offset: if we're far off, it will quickly get back to a high value */
-	getTime(&oldTime);
-	subTime(&newTime, &oldTime, &ptpClock->currentDS.offsetFromMaster);
+	clearTime(&step);
+	subTime(&step, &step, &ptpClock->currentDS.offsetFromMaster);
 
-	setTime(&newTime);
+	stepTime(&step);
 
 	ptpClock->clockStatus.majorChange = TRUE;
 
@@ -953,21 +983,11 @@ void checkOffset(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 
 }
 
-void
-updateClock(const RunTimeOpts * rtOpts, PtpClock * ptpClock)
+/* step or slew the clock towards offset - the gate checks have been done by the caller */
+static void
+applyClockUpdate(const RunTimeOpts * rtOpts, PtpClock * ptpClock, const TimeInternal *offset)
 {
 
-	if(rtOpts->noAdjust) {
-		ptpClock->clockControl.available = FALSE;
-		DBGV("updateClock: noAdjust - skipped clock update\n");
-		return;
-	}
-	
-	if(!ptpClock->clockControl.updateOK) {
-		DBGV("updateClock: !clockUpdateOK - skipped clock update\n");
-		return;
-	}
-
 	DBGV("==> updateClock\n");
 
 	if(ptpClock->clockControl.stepRequired) {
@@ -976,7 +996,7 @@ updateClock(const RunTimeOpts * rtOpts, PtpClock * ptpClock)
 			ptpClock->clockControl.stepRequired = FALSE;
 			return;
 		} else {
-			if(ptpClock->currentDS.offsetFromMaster.nanoseconds > 0)
+			if(offset->nanoseconds > 0)
 				ptpClock->servo.observedDrift = rtOpts->servoMaxPpb;
 			else
 				ptpClock->servo.observedDrift = -rtOpts->servoMaxPpb;
@@ -994,13 +1014,13 @@ updateClock(const RunTimeOpts * rtOpts, PtpClock * ptpClock)
 	if((!rtOpts->calibrationDelay) || ptpClock->isCalibrated) {
 
 		/* Adjust the clock first -> the PI controller runs here */
-		adjFreq_wrapper(rtOpts, ptpClock, runPIservo(&ptpClock->servo, ptpClock->currentDS.offsetFromMaster.nanoseconds));
+		adjFreq_wrapper(rtOpts, ptpClock, runPIservo(&ptpClock->servo, offset->nanoseconds));
 	}
 		warn_operator_fast_slewing(rtOpts, ptpClock, ptpClock->servo.observedDrift);
 		/* let the clock source know it's being synced */
 		ptpClock->clockStatus.inSync = TRUE;
-		ptpClock->clockStatus.clockOffset = (ptpClock->currentDS.offsetFromMaster.seconds * 1E9 +
-						ptpClock->currentDS.offsetFromMaster.nanoseconds) / 1000;
+		ptpClock->clockStatus.clockOffset = (offset->seconds * 1E9 +
+						offset->nanoseconds) / 1000;
 		ptpClock->clockStatus.update = TRUE;
 	}
 
@@ -1032,6 +1052,207 @@ updateClock(const RunTimeOpts * rtOpts, PtpClock * ptpClock)
 	}
 #endif
 
+	updateStatsSegment(ptpClock);
+
+}
+
+void
+updateClock(const RunTimeOpts * rtOpts, PtpClock * ptpClock)
+{
+
+	if(rtOpts->noAdjust) {
+		ptpClock->clockControl.available = FALSE;
+		DBGV("updateClock: noAdjust - skipped clock update\n");
+		return;
+	}
+	
+	if(!ptpClock->clockControl.updateOK) {
+		DBGV("updateClock: !clockUpdateOK - skipped clock update\n");
+		return;
+	}
+
+	applyClockUpdate(rtOpts, ptpClock, &ptpClock->currentDS.offsetFromMaster);
+
+}
+
+/*
+ * Fixed-rate servo updates: with servo:update_interval set, accepted offsets
+ * are queued and the servo runs from SERVO_UPDATE_TIMER instead of on every
+ * Sync, so the servo (and adjtimex) rate no longer follows the Sync rate.
+ */
+
+void
+resetServoBuffer(ServoOffsetBuffer *buffer)
+{
+	buffer->count = 0;
+	buffer->head = 0;
+}
+
+void
+queueClockUpdate(const RunTimeOpts * rtOpts, PtpClock * ptpClock)
+{
+
+	ServoOffsetBuffer *buffer = &ptpClock->servoBuffer;
+
+	/* servo follows offset updates, or this cannot wait for the next servo update */
+	if(rtOpts->servoUpdateInterval <= 0.0 ||
+	    ptpClock->clockControl.stepRequired ||
+	    ptpClock->currentDS.offsetFromMaster.seconds != 0) {
+		resetServoBuffer(buffer);
+		updateClock(rtOpts, ptpClock);
+		latencyRxStage(rtOpts, ptpClock, LATENCY_RX_SERVO);
+		return;
+	}
+
+	/* oldest offset is overwritten if the servo falls behind */
+	if(buffer->count == SERVO_BUFFER_MAX) {
+		buffer->overflows++;
+	} else {
+		buffer->count++;
+	}
+
+	buffer->offset[buffer->head] = ptpClock->currentDS.offsetFromMaster.nanoseconds;
+	getTimeMonotonic(&buffer->time[buffer->head]);
+	buffer->head = (buffer->head + 1) % SERVO_BUFFER_MAX;
+
+	if(!timerRunning(&ptpClock->timers[SERVO_UPDATE_TIMER])) {
+		timerStart(&ptpClock->timers[SERVO_UPDATE_TIMER], rtOpts->servoUpdateInterval);
+	}
+
+}
+
+/* combine queued offsets into one servo input, estimated for the time of the update */
+static double
+combineServoBuffer(const ServoOffsetBuffer *buffer, Enumeration8 method)
+{
+
+	double samples[SERVO_BUFFER_MAX];
+	double x[SERVO_BUFFER_MAX];
+	double meanX = 0.0, meanY = 0.0, sxx = 0.0, sxy = 0.0;
+	double tmp;
+	TimeInternal now, delta;
+	int i, j;
+	int first = (buffer->head - buffer->count + SERVO_BUFFER_MAX) % SERVO_BUFFER_MAX;
+
+	for(i = 0; i < buffer->count; i++) {
+		samples[i] = buffer->offset[(first + i) % SERVO_BUFFER_MAX];
+		meanY += samples[i];
+	}
+
+	meanY /= buffer->count;
+
+	switch(method) {
+
+	case SERVO_COMBINE_MEDIAN:
+
+		/* insertion sort - the buffer is small and usually nearly sorted anyway */
+		for(i = 1; i < buffer->count; i++) {
+			tmp = samples[i];
+			for(j = i - 1; j >= 0 && samples[j] > tmp; j--) {
+				samples[j + 1] = samples[j];
+			}
+			samples[j + 1] = tmp;
+		}
+
+		if(buffer->count % 2) {
+			return samples[buffer->count / 2];
+		}
+
+		return (samples[buffer->count / 2 - 1] + samples[buffer->count / 2]) / 2.0;
+
+	case SERVO_COMBINE_REGRESSION:
+
+		/* too few points to fit a line */
+		if(buffer->count < 3) {
+			return meanY;
+		}
+
+		/* fit offset(t) over the queued offsets, t relative to now */
+		getTimeMonotonic(&now);
+
+		for(i = 0; i < buffer->count; i++) {
+			subTime(&delta, &buffer->time[(first + i) % SERVO_BUFFER_MAX], &now);
+			x[i] = timeInternalToDouble(&delta);
+			meanX += x[i];
+		}
+
+		meanX /= buffer->count;
+
+		for(i = 0; i < buffer->count; i++) {
+			sxx += (x[i] - meanX) * (x[i] - meanX);
+			sxy += (x[i] - meanX) * (samples[i] - meanY);
+		}
+
+		if(sxx <= 0.0) {
+			return meanY;
+		}
+
+		/* interpolated offset at t = 0 */
+		return meanY - (sxy / sxx) * meanX;
+
+	case SERVO_COMBINE_MEAN:
+	default:
+		return meanY;
+
+	}
+
+}
+
+void
+runServoUpdate(const RunTimeOpts * rtOpts, PtpClock * ptpClock)
+{
+
+	ServoOffsetBuffer *buffer = &ptpClock->servoBuffer;
+	TimeInternal offset;
+	double combined;
+
+	/* nothing new since the last update - CLOCK_UPDATE_TIMER deals with lost updates */
+	if(buffer->count == 0) {
+		DBGV("runServoUpdate: no offsets queued\n");
+		return;
+	}
+
+	/*
+	 * queued offsets passed checkOffset() when they arrived, but the clock
+	 * may have been put off limits since: drop them rather than steer now
+	 */
+	if(rtOpts->noAdjust) {
+		ptpClock->clockControl.available = FALSE;
+		DBGV("runServoUpdate: noAdjust - dropped queued offsets\n");
+		resetServoBuffer(buffer);
+		return;
+	}
+
+	if(ptpClock->leapSecondInProgress) {
+		DBGV("runServoUpdate: leapSecondInProgress - dropped queued offsets\n");
+		/* let the watchdog know that we still want to hold the clock control */
+		ptpClock->clockControl.activity = TRUE;
+		resetServoBuffer(buffer);
+		return;
+	}
+
+	if(ptpClock->panicMode) {
+		DBGV("runServoUpdate: panic mode - dropped queued offsets\n");
+		resetServoBuffer(buffer);
+		return;
+	}
+
+	combined = combineServoBuffer(buffer, rtOpts->servoUpdateMethod);
+
+	DBGV("runServoUpdate: %d offsets combined into %.0f ns\n", buffer->count, combined);
+
+	resetServoBuffer(buffer);
+
+	/*
+	 * the servo sees one combined offset per update interval - currentDS
+	 * keeps the last measured offset for everything that reports it
+	 */
+	offset.seconds = 0;
+	offset.nanoseconds = round(combined);
+	ptpClock->servo.dT = rtOpts->servoUpdateInterval;
+
+	applyClockUpdate(rtOpts, ptpClock, &offset);
+
 }
 
 void
@@ -1204,6 +1425,270 @@ checkServoStable(PtpClock *ptpClock, const RunTimeOpts *rtOpts)
 
 }
 
+/* least squares fit of mean observed drift over time: drift(t) = intercept + trend * t */
+static void
+fitHoldoverModel(HoldoverModel *holdover)
+{
+
+	double tMean = 0.0, dMean = 0.0;
+	double sxx = 0.0, sxy = 0.0, sse = 0.0;
+	double dt, res;
+	int i;
+
+	if(holdover->count == 0) {
+		holdover->modelValid = FALSE;
+		return;
+	}
+
+	for(i = 0; i < holdover->count; i++) {
+		tMean += holdover->sampleTime[i];
+		dMean += holdover->sampleDrift[i];
+	}
+
+	tMean /= holdover->count;
+	dMean /= holdover->count;
+
+	for(i = 0; i < holdover->count; i++) {
+		dt = holdover->sampleTime[i] - tMean;
+		sxx += dt * dt;
+		sxy += dt * (holdover->sampleDrift[i] - dMean);
+	}
+
+	holdover->driftTrend = (sxx > 0.0) ? sxy / sxx : 0.0;
+	holdover->driftIntercept = dMean - holdover->driftTrend * tMean;
+
+	for(i = 0; i < holdover->count; i++) {
+		res = holdover->sampleDrift[i] -
+		    (holdover->driftIntercept + holdover->driftTrend * holdover->sampleTime[i]);
+		sse += res * res;
+	}
+
+	holdover->driftResidual = (holdover->count > 2) ? sqrt(sse / (holdover->count - 2)) : 0.0;
+	holdover->trendError = (sxx > 0.0) ? holdover->driftResidual / sqrt(sxx) : 0.0;
+	holdover->modelValid = (holdover->count >= HOLDOVER_MIN_SAMPLES);
+
+}
+
+/* add the last statistics period's mean drift to the holdover model - only while locked */
+static void
+feedHoldover(PtpClock *ptpClock, const RunTimeOpts *rtOpts)
+{
+
+	HoldoverModel *holdover = &ptpClock->holdover;
+	TimeInternal now, delta;
+
+	if(!holdover->enabled || holdover->active) {
+		return;
+	}
+
+	if(ptpClock->portDS.portState != PTP_SLAVE || !ptpClock->clockControl.granted ||
+	    ptpClock->servo.runningMaxOutput || !ptpClock->servo.statsCalculated) {
+		return;
+	}
+
+	if(rtOpts->servoStabilityDetection && !ptpClock->servo.isStable) {
+		return;
+	}
+
+	getTimeMonotonic(&now);
+
+	if(holdover->count == 0) {
+		holdover->epoch = now;
+	}
+
+	subTime(&delta, &now, &holdover->epoch);
+
+	holdover->sampleTime[holdover->head] = timeInternalToDouble(&delta);
+	holdover->sampleDrift[holdover->head] = ptpClock->servo.driftMean;
+	holdover->head = (holdover->head + 1) % holdover->windowSize;
+
+	if(holdover->count < holdover->windowSize) {
+		holdover->count++;
+	}
+
+	fitHoldoverModel(holdover);
+
+	DBG("Holdover model: %d samples, drift %.03f ppb, trend %.06f ppb/s, residual %.03f ppb\n",
+		holdover->count, holdover->driftIntercept + holdover->driftTrend *
+		holdover->sampleTime[(holdover->head + holdover->windowSize - 1) % holdover->windowSize],
+		holdover->driftTrend, holdover->driftResidual);
+
+}
+
+void
+setupHoldover(HoldoverModel *holdover, const RunTimeOpts *rtOpts)
+{
+
+	/* window size change invalidates the collected samples - not applied while in holdover */
+	if(!holdover->active && holdover->windowSize != rtOpts->holdoverWindow) {
+		resetHoldover(holdover);
+		holdover->windowSize = rtOpts->holdoverWindow;
+	}
+
+	holdover->enabled = rtOpts->holdoverEnabled;
+	holdover->maxDuration = rtOpts->holdoverMaxDuration;
+
+}
+
+void
+resetHoldover(HoldoverModel *holdover)
+{
+	holdover->count = 0;
+	holdover->head = 0;
+	holdover->modelValid = FALSE;
+	holdover->driftIntercept = 0.0;
+	holdover->driftTrend = 0.0;
+	holdover->driftResidual = 0.0;
+	holdover->trendError = 0.0;
+}
+
+/* master lost: start applying the predicted frequency if we have a usable model */
+void
+startHoldover(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	HoldoverModel *holdover = &ptpClock->holdover;
+
+	if(!holdover->enabled || holdover->active) {
+		return;
+	}
+
+	if(rtOpts->noAdjust || !ptpClock->clockControl.granted) {
+		return;
+	}
+
+	if(!holdover->modelValid) {
+		NOTICE("Holdover model not ready (%d of %d samples) - not entering holdover\n",
+			holdover->count, HOLDOVER_MIN_SAMPLES);
+		return;
+	}
+
+	getTimeMonotonic(&holdover->startTime);
+	holdover->elapsed = 0.0;
+	holdover->entryOffset = fabs(timeInternalToDouble(&ptpClock->currentDS.offsetFromMaster)) * 1E9;
+	holdover->timeError = holdover->entryOffset;
+	holdover->active = TRUE;
+
+	NOTICE("Entering holdover: drift trend %.06f ppb/s, residual %.03f ppb from %d samples\n",
+		holdover->driftTrend, holdover->driftResidual, holdover->count);
+
+	updateHoldover(rtOpts, ptpClock);
+	timerStart(&ptpClock->timers[HOLDOVER_UPDATE_TIMER], HOLDOVER_UPDATE_INTERVAL);
+
+}
+
+/* apply the predicted frequency and update the time error estimate */
+void
+updateHoldover(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	HoldoverModel *holdover = &ptpClock->holdover;
+	TimeInternal now, delta;
+	double t, tPredict;
+
+	if(!holdover->active) {
+		return;
+	}
+
+	/* another time service took over the clock, or holdover was disabled */
+	if(!holdover->enabled || !ptpClock->clockControl.granted) {
+		endHoldover(rtOpts, ptpClock);
+		return;
+	}
+
+	getTimeMonotonic(&now);
+	subTime(&delta, &now, &holdover->startTime);
+	holdover->elapsed = timeInternalToDouble(&delta);
+
+	/* past the maximum duration, the trend is no longer extrapolated */
+	tPredict = holdover->elapsed;
+	if(holdover->maxDuration && tPredict > holdover->maxDuration) {
+		tPredict = holdover->maxDuration;
+	}
+
+	subTime(&delta, &holdover->startTime, &holdover->epoch);
+	t = timeInternalToDouble(&delta) + tPredict;
+
+	holdover->predictedDrift = holdover->driftIntercept + holdover->driftTrend * t;
+	CLAMP(holdover->predictedDrift, ptpClock->servo.maxOutput);
+
+	/*
+	 * Time error grows with the offset we had when the master was lost,
+	 * plus the phase integrated from the frequency uncertainty (ppb * s = ns)
+	 * and from the uncertainty of the drift trend.
+	 */
+	holdover->timeError = holdover->entryOffset +
+		holdover->driftResidual * holdover->elapsed +
+		0.5 * holdover->trendError * holdover->elapsed * holdover->elapsed;
+
+	ptpClock->servo.observedDrift = holdover->predictedDrift;
+	ptpClock->servo.dT = HOLDOVER_UPDATE_INTERVAL;
+	adjFreq_wrapper(rtOpts, ptpClock, -holdover->predictedDrift);
+
+	SET_ALARM(ALRM_HOLDOVER, holdover->timeError >= rtOpts->holdoverAlarmThreshold);
+
+	DBGV("Holdover: %.0f s, predicted drift %.03f ppb, estimated time error %.0f ns\n",
+		holdover->elapsed, holdover->predictedDrift, holdover->timeError);
+
+}
+
+/* leave holdover - the last predicted frequency is handed over to the servo */
+void
+endHoldover(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	HoldoverModel *holdover = &ptpClock->holdover;
+
+	if(!holdover->active) {
+		return;
+	}
+
+	timerStop(&ptpClock->timers[HOLDOVER_UPDATE_TIMER]);
+	holdover->active = FALSE;
+	ptpClock->servo.observedDrift = holdover->predictedDrift;
+
+	SET_ALARM(ALRM_HOLDOVER, FALSE);
+
+	NOTICE("Leaving holdover after %.0f s, estimated time error %.0f ns\n",
+		holdover->elapsed, holdover->timeError);
+
+}
+
+/* mean path delay stability - drives the adaptive Delay_Req rate */
+static void
+checkDelayStable(PtpClock *ptpClock, const RunTimeOpts *rtOpts)
+{
+
+	PtpEngineSlaveStats *stats = &ptpClock->slaveStats;
+	Boolean wasStable = stats->mpdIsStable;
+
+	/* not enough delay samples in this interval to say anything */
+	if(ptpClock->portDS.delayMechanism != E2E ||
+	    stats->mpdStats.meanContainer.count < 2.0) {
+		return;
+	}
+
+	if((stats->mpdStdDev * 1E9) <= rtOpts->delayReqStabilityThreshold) {
+		if(++stats->mpdStableCount >= rtOpts->delayReqStabilityPeriod) {
+			stats->mpdIsStable = TRUE;
+		}
+	} else {
+		stats->mpdStableCount = 0;
+		stats->mpdIsStable = FALSE;
+	}
+
+	if(stats->mpdIsStable && !wasStable) {
+		DBG("Mean path delay stable (std dev %.0f ns)\n", stats->mpdStdDev * 1E9);
+	}
+
+	/* delay changed - measure at the full rate until it settles */
+	if(wasStable && !stats->mpdIsStable) {
+		DBG("Mean path delay unstable (std dev %.0f ns)\n", stats->mpdStdDev * 1E9);
+		startDelayReqBurst(rtOpts, ptpClock);
+	}
+
+}
+
 void
 updatePtpEngineStats (PtpClock* ptpClock, const RunTimeOpts* rtOpts)
 {
@@ -1231,9 +1716,13 @@ updatePtpEngineStats (PtpClock* ptpClock, const RunTimeOpts* rtOpts)
 	ptpClock->servo.driftMinFinal = ptpClock->servo.driftMin;
 	ptpClock->servo.driftMaxFinal = ptpClock->servo.driftMax;
 
+	snapshotPtpEngineHistograms(&ptpClock->histograms);
+
 	resetDoublePermanentMean(&ptpClock->oFilterMS.acceptedStats);
 	resetDoublePermanentMean(&ptpClock->oFilterSM.acceptedStats);
 
+	checkDelayStable(ptpClock, rtOpts);
+
 	if(ptpClock->slaveStats.mpdStats.meanContainer.count >= 10.0) {
 		resetDoublePermanentStdDev(&ptpClock->slaveStats.mpdStats);
 		resetDoublePermanentMedian(&ptpClock->slaveStats.mpdMedianContainer);
@@ -1254,6 +1743,8 @@ updatePtpEngineStats (PtpClock* ptpClock, const RunTimeOpts* rtOpts)
 		checkServoStable(ptpClock, rtOpts);
 	}
 
+	feedHoldover(ptpClock, rtOpts);
+
 	ptpClock->offsetUpdates = 0;
 	ptpClock->acceptedUpdates = 0;
 
@@ -41,6 +41,8 @@
 #include <net-snmp/net-snmp-includes.h>
 #include <net-snmp/agent/net-snmp-agent-includes.h>
 
+#include <pthread.h>
+
 //static void sendNotif(int event);
 static void sendNotif(int eventType, PtpEventData *eventData);
 
@@ -231,11 +233,27 @@ enum {
     PTPBASE_PTPD_SPECIFIC_COUNTERS_DELAYMS_OUTLIERS_FOUND,
     PTPBASE_PTPD_SPECIFIC_COUNTERS_DELAYSM_OUTLIERS_FOUND,
     PTPBASE_PTPD_SPECIFIC_COUNTERS_MAX_DELAY_DROPS,
+    PTPBASE_PTPD_SPECIFIC_COUNTERS_SYNC_OVERRUNS,
     /* ptpBasePtpdSpecificData */
     PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYMS,
     PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYMS_STRING,
     PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYSM,
-    PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYSM_STRING
+    PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYSM_STRING,
+    PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_ACTIVE,
+    PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_SECONDS,
+    PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_PREDICTED_DRIFT,
+    PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_TIME_ERROR,
+    PTPBASE_PTPD_STABILITY_TAU,
+    PTPBASE_PTPD_STABILITY_ADEV_STRING,
+    PTPBASE_PTPD_STABILITY_TDEV_STRING,
+    PTPBASE_PTPD_STABILITY_MTIE_STRING,
+    PTPBASE_PTPD_STABILITY_SAMPLES,
+    PTPBASE_PTPD_PERCENTILE_NAME,
+    PTPBASE_PTPD_PERCENTILE_SAMPLES,
+    PTPBASE_PTPD_PERCENTILE_P50,
+    PTPBASE_PTPD_PERCENTILE_P99,
+    PTPBASE_PTPD_PERCENTILE_P999,
+    PTPBASE_PTPD_PERCENTILE_MAX
 };
 
 /* trap / notification definitions */
@@ -259,6 +277,8 @@ enum {
 	PTPBASE_NOTIFS_TIMEPROPERTIESDS_CHANGE,
 	PTPBASE_NOTIFS_DOMAIN_MISMATCH,
 	PTPBASE_NOTIFS_DOMAIN_MISMATCH_CLEARED,
+	PTPBASE_NOTIFS_HOLDOVER,
+	PTPBASE_NOTIFS_HOLDOVER_CLEARED,
 };
 
 #define SNMP_PTP_ORDINARY_CLOCK 1
@@ -279,16 +299,105 @@ enum {
 #define PTPBASE_MIB_OID \
 	1, 3, 6, 1, 4, 1, 46649, 1, 1
 #define PTPBASE_MIB_INDEX2 \
-	snmpPtpClock->defaultDS.domainNumber, SNMP_PTP_CLOCK_INSTANCE
+	snmpSnapshot->defaultDS.domainNumber, SNMP_PTP_CLOCK_INSTANCE
 #define PTPBASE_MIB_INDEX3 \
-	snmpPtpClock->defaultDS.domainNumber, SNMP_PTP_ORDINARY_CLOCK, SNMP_PTP_CLOCK_INSTANCE
+	snmpSnapshot->defaultDS.domainNumber, SNMP_PTP_ORDINARY_CLOCK, SNMP_PTP_CLOCK_INSTANCE
 #define PTPBASE_MIB_INDEX4 \
-	snmpPtpClock->defaultDS.domainNumber, SNMP_PTP_ORDINARY_CLOCK, SNMP_PTP_CLOCK_INSTANCE, snmpPtpClock->portDS.portIdentity.portNumber
+	snmpSnapshot->defaultDS.domainNumber, SNMP_PTP_ORDINARY_CLOCK, SNMP_PTP_CLOCK_INSTANCE, snmpSnapshot->portDS.portIdentity.portNumber
 
 static oid  ptp_oid[] = { PTPBASE_MIB_OID };
 
-static PtpClock *snmpPtpClock;
-static RunTimeOpts *snmpRtOpts;
+/*
+ * The MIB handlers never touch the live PtpClock. The protocol engine
+ * copies everything they read into a table snapshot every
+ * global:snmp_snapshot_interval seconds, and the AgentX session is
+ * served by a separate thread which only ever sees a published,
+ * immutable snapshot. Pointers held by PtpClock are resolved at
+ * snapshot time, so nothing here can dangle.
+ */
+typedef struct {
+	DefaultDS defaultDS;
+	CurrentDS currentDS;
+	ParentDS parentDS;
+	TimePropertiesDS timePropertiesDS;
+	PortDS portDS;
+	PtpdCounters counters;
+	Octet userDescription[USER_DESCRIPTION_MAX + 1];
+	/* netPath */
+	uint64_t sentPacketsTotal;
+	uint64_t receivedPacketsTotal;
+	struct in_addr interfaceAddr;
+	int ifIndex;
+	/* bestMaster, parentGrants */
+	Boolean bestMasterValid;
+	UInteger32 bestMasterAddr;
+	UInteger32 grantDuration;
+	UInteger16 number_foreign_records;
+	int unicastDestinationCount;
+	int slaveCount;
+	uint32_t syncOverruns;
+	TimeInternal rawDelayMS;
+	TimeInternal rawDelaySM;
+	PIservo servo;
+#ifdef PTPD_STATISTICS
+	PtpEngineSlaveStats slaveStats;
+	HoldoverModel holdover;
+	StabilityTau taus[STABILITY_TAUS];
+	LogHistogramSnapshot histograms[PTP_HISTOGRAM_MAX];
+	LogHistogramSnapshot latency[LATENCY_STAGE_MAX];
+#endif /* PTPD_STATISTICS */
+	/* runtime options */
+	UInteger32 ofmAlarmThreshold;
+	Enumeration8 transport;
+	Enumeration8 ipMode;
+	Boolean unicastNegotiation;
+	int statsUpdateInterval;
+} SnmpTableSnapshot;
+
+/* queued notifications, dropped when the agent falls this far behind */
+#define SNMP_NOTIF_QUEUE	32
+/* longest agent sleep between shutdown checks */
+#define SNMP_AGENT_IDLE_MS	500
+/* publish retry (seconds) when the agent held the snapshot */
+#define SNMP_SNAPSHOT_RETRY	0.1
+
+/* counter sets cleared through SNMP SETs, applied by the protocol engine */
+#define SNMP_CLEAR_ALL		(1 << 0)
+#define SNMP_CLEAR_MESSAGES	(1 << 1)
+#define SNMP_CLEAR_PROTOCOL	(1 << 2)
+#define SNMP_CLEAR_ERRORS	(1 << 3)
+#define SNMP_CLEAR_UNICAST	(1 << 4)
+#define SNMP_CLEAR_SECURITY	(1 << 5)
+#define SNMP_CLEAR_PTPD		(1 << 6)
+
+typedef struct {
+	int notifId;
+	PtpEventData eventData;
+} SnmpQueuedNotif;
+
+typedef struct {
+	Boolean started;
+	int running;
+	pthread_t thread;
+	/* wakes the agent up when a notification is queued or on shutdown */
+	int wakeup[2];
+	/* held by the agent while it serves requests from the front snapshot */
+	pthread_mutex_t snapshotLock;
+	SnmpTableSnapshot snapshots[2];
+	/* back buffer, owned by the protocol engine */
+	SnmpTableSnapshot *back;
+	/* SNMP_CLEAR_* requests, set by the agent */
+	int clearRequests;
+	/* single producer (protocol engine) / single consumer (agent) ring */
+	uint32_t notifHead;
+	uint32_t notifTail;
+	uint32_t notifDropped;
+	SnmpQueuedNotif notifs[SNMP_NOTIF_QUEUE];
+} SnmpAgent;
+
+static SnmpAgent snmpAgent;
+/* front snapshot, only dereferenced with snapshotLock held */
+static SnmpTableSnapshot *snmpSnapshot;
 
 /* Helper functions to build header_*indexed_table() functions.  Those
    functions keep an internal state. They are not reentrant!
@@ -475,15 +584,15 @@ snmpSystemTable(SNMP_SIGNATURE) {
 	SNMP_INDEXED_TABLE;
 
 	/* We only have one index: one domain, one instance */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_CLOCK_INSTANCE;
-	SNMP_ADD_INDEX(index, 2, snmpPtpClock);
+	SNMP_ADD_INDEX(index, 2, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
 	switch (vp->magic) {
 	case PTPBASE_DOMAIN_CLOCK_PORTS_TOTAL:
-		return SNMP_GAUGE(snmpPtpClock->defaultDS.numberPorts);
+		return SNMP_GAUGE(snmpSnapshot->defaultDS.numberPorts);
 	}
 
 	return NULL;
@@ -500,7 +609,7 @@ snmpSystemDomainTable(SNMP_SIGNATURE) {
 
 	/* We only have one index: ordinary clock */
 	index[0] = SNMP_PTP_ORDINARY_CLOCK;
-	SNMP_ADD_INDEX(index, 1, snmpPtpClock);
+	SNMP_ADD_INDEX(index, 1, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
@@ -525,102 +634,102 @@ snmpClockDSTable(SNMP_SIGNATURE) {
 	memset(tmpStr, 0, sizeof(tmpStr));
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	SNMP_ADD_INDEX(index, 3, snmpPtpClock);
+	SNMP_ADD_INDEX(index, 3, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
 	switch (vp->magic) {
 	/* ptpbaseClockCurrentDSTable */
 	case PTPBASE_CLOCK_CURRENT_DS_STEPS_REMOVED:
-		return SNMP_UNSIGNED(snmpPtpClock->currentDS.stepsRemoved);
+		return SNMP_UNSIGNED(snmpSnapshot->currentDS.stepsRemoved);
 	case PTPBASE_CLOCK_CURRENT_DS_OFFSET_FROM_MASTER:
-		return SNMP_TIMEINTERNAL(snmpPtpClock->currentDS.offsetFromMaster);
+		return SNMP_TIMEINTERNAL(snmpSnapshot->currentDS.offsetFromMaster);
 	case PTPBASE_CLOCK_CURRENT_DS_MEAN_PATH_DELAY:
-		return SNMP_TIMEINTERNAL(snmpPtpClock->currentDS.meanPathDelay);
+		return SNMP_TIMEINTERNAL(snmpSnapshot->currentDS.meanPathDelay);
 	/* PTPd: offsets as string */
 	case PTPBASE_CLOCK_CURRENT_DS_OFFSET_FROM_MASTER_STRING:
-		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpPtpClock->currentDS.offsetFromMaster));
+		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpSnapshot->currentDS.offsetFromMaster));
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_CLOCK_CURRENT_DS_MEAN_PATH_DELAY_STRING:
-		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpPtpClock->currentDS.meanPathDelay));
+		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpSnapshot->currentDS.meanPathDelay));
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_CLOCK_CURRENT_DS_OFFSET_FROM_MASTER_THRESHOLD:
-		return SNMP_INTEGER(snmpRtOpts->ofmAlarmThreshold);
+		return SNMP_INTEGER(snmpSnapshot->ofmAlarmThreshold);
 
 	/* ptpbaseClockParentDSTable */
 	case PTPBASE_CLOCK_PARENT_DS_PARENT_PORT_ID:
-		return SNMP_OCTETSTR(&snmpPtpClock->parentDS.parentPortIdentity,
+		return SNMP_OCTETSTR(&snmpSnapshot->parentDS.parentPortIdentity,
 				     sizeof(PortIdentity));
 	case PTPBASE_CLOCK_PARENT_DS_PARENT_STATS:
-		return SNMP_BOOLEAN(snmpPtpClock->parentDS.parentStats);
+		return SNMP_BOOLEAN(snmpSnapshot->parentDS.parentStats);
 	case PTPBASE_CLOCK_PARENT_DS_OFFSET:
-		return SNMP_INTEGER(snmpPtpClock->parentDS.observedParentOffsetScaledLogVariance);
+		return SNMP_INTEGER(snmpSnapshot->parentDS.observedParentOffsetScaledLogVariance);
 	case PTPBASE_CLOCK_PARENT_DS_CLOCK_PH_CH_RATE:
-		return SNMP_INTEGER(snmpPtpClock->parentDS.observedParentClockPhaseChangeRate);
+		return SNMP_INTEGER(snmpSnapshot->parentDS.observedParentClockPhaseChangeRate);
 	case PTPBASE_CLOCK_PARENT_DS_GM_CLOCK_IDENTITY:
-		return SNMP_OCTETSTR(&snmpPtpClock->parentDS.grandmasterIdentity,
+		return SNMP_OCTETSTR(&snmpSnapshot->parentDS.grandmasterIdentity,
 				     sizeof(ClockIdentity));
 	case PTPBASE_CLOCK_PARENT_DS_GM_CLOCK_PRIO1:
-		return SNMP_UNSIGNED(snmpPtpClock->parentDS.grandmasterPriority1);
+		return SNMP_UNSIGNED(snmpSnapshot->parentDS.grandmasterPriority1);
 	case PTPBASE_CLOCK_PARENT_DS_GM_CLOCK_PRIO2:
-		return SNMP_UNSIGNED(snmpPtpClock->parentDS.grandmasterPriority2);
+		return SNMP_UNSIGNED(snmpSnapshot->parentDS.grandmasterPriority2);
 	case PTPBASE_CLOCK_PARENT_DS_GM_CLOCK_QUALITY_CLASS:
-		return SNMP_UNSIGNED(snmpPtpClock->parentDS.grandmasterClockQuality.clockClass);
+		return SNMP_UNSIGNED(snmpSnapshot->parentDS.grandmasterClockQuality.clockClass);
 	case PTPBASE_CLOCK_PARENT_DS_GM_CLOCK_QUALITY_ACCURACY:
-		return SNMP_INTEGER(snmpPtpClock->parentDS.grandmasterClockQuality.clockAccuracy);
+		return SNMP_INTEGER(snmpSnapshot->parentDS.grandmasterClockQuality.clockAccuracy);
 	case PTPBASE_CLOCK_PARENT_DS_GM_CLOCK_QUALITY_OFFSET:
-		return SNMP_INTEGER(snmpPtpClock->parentDS.grandmasterClockQuality.offsetScaledLogVariance);
+		return SNMP_INTEGER(snmpSnapshot->parentDS.grandmasterClockQuality.offsetScaledLogVariance);
 	/* PTPd addition */
 	case PTPBASE_CLOCK_PARENT_DS_PARENT_PORT_ADDRESS_TYPE:
 		/* Only supports IPv4 */
 		return SNMP_INTEGER(SNMP_IPv4);
 	case PTPBASE_CLOCK_PARENT_DS_PARENT_PORT_ADDRESS:
-		if(snmpRtOpts->transport != UDP_IPV4)
+		if(snmpSnapshot->transport != UDP_IPV4)
 		    return SNMP_IPADDR(0);
-		if(!snmpPtpClock->bestMaster)
+		if(!snmpSnapshot->bestMasterValid)
 		    return SNMP_IPADDR(0);
-		return SNMP_IPADDR(snmpPtpClock->bestMaster->sourceAddr);
+		return SNMP_IPADDR(snmpSnapshot->bestMasterAddr);
 	/* ptpbaseClockDefaultDSTable */
 	case PTPBASE_CLOCK_DEFAULT_DS_TWO_STEP_FLAG:
-		return SNMP_BOOLEAN(snmpPtpClock->defaultDS.twoStepFlag);
+		return SNMP_BOOLEAN(snmpSnapshot->defaultDS.twoStepFlag);
 	case PTPBASE_CLOCK_DEFAULT_DS_CLOCK_IDENTITY:
-		return SNMP_OCTETSTR(&snmpPtpClock->defaultDS.clockIdentity,
+		return SNMP_OCTETSTR(&snmpSnapshot->defaultDS.clockIdentity,
 				     sizeof(ClockIdentity));
 	case PTPBASE_CLOCK_DEFAULT_DS_PRIO1:
-		return SNMP_UNSIGNED(snmpPtpClock->defaultDS.priority1);
+		return SNMP_UNSIGNED(snmpSnapshot->defaultDS.priority1);
 	case PTPBASE_CLOCK_DEFAULT_DS_PRIO2:
-		return SNMP_UNSIGNED(snmpPtpClock->defaultDS.priority2);
+		return SNMP_UNSIGNED(snmpSnapshot->defaultDS.priority2);
 	case PTPBASE_CLOCK_DEFAULT_DS_SLAVE_ONLY:
-		return SNMP_BOOLEAN(snmpPtpClock->defaultDS.slaveOnly);
+		return SNMP_BOOLEAN(snmpSnapshot->defaultDS.slaveOnly);
 	case PTPBASE_CLOCK_DEFAULT_DS_QUALITY_CLASS:
-		return SNMP_UNSIGNED(snmpPtpClock->defaultDS.clockQuality.clockClass);
+		return SNMP_UNSIGNED(snmpSnapshot->defaultDS.clockQuality.clockClass);
 	case PTPBASE_CLOCK_DEFAULT_DS_QUALITY_ACCURACY:
-		return SNMP_INTEGER(snmpPtpClock->defaultDS.clockQuality.clockAccuracy);
+		return SNMP_INTEGER(snmpSnapshot->defaultDS.clockQuality.clockAccuracy);
 	case PTPBASE_CLOCK_DEFAULT_DS_QUALITY_OFFSET:
-		return SNMP_INTEGER(snmpPtpClock->defaultDS.clockQuality.offsetScaledLogVariance);
+		return SNMP_INTEGER(snmpSnapshot->defaultDS.clockQuality.offsetScaledLogVariance);
 	/* PTPd addition */
 	case PTPBASE_CLOCK_DEFAULT_DS_DOMAIN_NUMBER:
-		return SNMP_INTEGER(snmpPtpClock->defaultDS.domainNumber);
+		return SNMP_INTEGER(snmpSnapshot->defaultDS.domainNumber);
 	/* ptpbaseClockTimePropertiesDSTable */
 	case PTPBASE_CLOCK_TIME_PROPERTIES_DS_CURRENT_UTC_OFFSET_VALID:
-		return SNMP_BOOLEAN(snmpPtpClock->timePropertiesDS.currentUtcOffsetValid);
+		return SNMP_BOOLEAN(snmpSnapshot->timePropertiesDS.currentUtcOffsetValid);
 	case PTPBASE_CLOCK_TIME_PROPERTIES_DS_CURRENT_UTC_OFFSET:
-		return SNMP_INTEGER(snmpPtpClock->timePropertiesDS.currentUtcOffset);
+		return SNMP_INTEGER(snmpSnapshot->timePropertiesDS.currentUtcOffset);
 	case PTPBASE_CLOCK_TIME_PROPERTIES_DS_LEAP59:
-		return SNMP_BOOLEAN(snmpPtpClock->timePropertiesDS.leap59);
+		return SNMP_BOOLEAN(snmpSnapshot->timePropertiesDS.leap59);
 	case PTPBASE_CLOCK_TIME_PROPERTIES_DS_LEAP61:
-		return SNMP_BOOLEAN(snmpPtpClock->timePropertiesDS.leap61);
+		return SNMP_BOOLEAN(snmpSnapshot->timePropertiesDS.leap61);
 	case PTPBASE_CLOCK_TIME_PROPERTIES_DS_TIME_TRACEABLE:
-		return SNMP_BOOLEAN(snmpPtpClock->timePropertiesDS.timeTraceable);
+		return SNMP_BOOLEAN(snmpSnapshot->timePropertiesDS.timeTraceable);
 	case PTPBASE_CLOCK_TIME_PROPERTIES_DS_FREQ_TRACEABLE:
-		return SNMP_BOOLEAN(snmpPtpClock->timePropertiesDS.frequencyTraceable);
+		return SNMP_BOOLEAN(snmpSnapshot->timePropertiesDS.frequencyTraceable);
 	case PTPBASE_CLOCK_TIME_PROPERTIES_DS_PTP_TIMESCALE:
-		return SNMP_BOOLEAN(snmpPtpClock->timePropertiesDS.ptpTimescale);
+		return SNMP_BOOLEAN(snmpSnapshot->timePropertiesDS.ptpTimescale);
 	case PTPBASE_CLOCK_TIME_PROPERTIES_DS_SOURCE:
-		return SNMP_INTEGER(snmpPtpClock->timePropertiesDS.timeSource);
+		return SNMP_INTEGER(snmpSnapshot->timePropertiesDS.timeSource);
 	}
 
 	return NULL;
@@ -636,11 +745,11 @@ snmpClockPortTable(SNMP_SIGNATURE) {
 	SNMP_INDEXED_TABLE;
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	index[3] = snmpPtpClock->portDS.portIdentity.portNumber;
-	SNMP_ADD_INDEX(index, 4, snmpPtpClock);
+	index[3] = snmpSnapshot->portDS.portIdentity.portNumber;
+	SNMP_ADD_INDEX(index, 4, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
@@ -649,74 +758,74 @@ snmpClockPortTable(SNMP_SIGNATURE) {
 	case PTPBASE_CLOCK_PORT_NAME:
 	case PTPBASE_CLOCK_PORT_DS_PORT_NAME:
 	case PTPBASE_CLOCK_PORT_RUNNING_NAME:
-		return SNMP_OCTETSTR(snmpPtpClock->userDescription,
-				     strlen(snmpPtpClock->userDescription));
+		return SNMP_OCTETSTR(snmpSnapshot->userDescription,
+				     strlen(snmpSnapshot->userDescription));
 	case PTPBASE_CLOCK_PORT_ROLE:
-		return SNMP_INTEGER((snmpPtpClock->portDS.portState == PTP_MASTER)?
+		return SNMP_INTEGER((snmpSnapshot->portDS.portState == PTP_MASTER)?
 				    SNMP_PTP_PORT_MASTER:SNMP_PTP_PORT_SLAVE);
 	case PTPBASE_CLOCK_PORT_SYNC_ONE_STEP:
-		return (snmpPtpClock->defaultDS.twoStepFlag == TRUE)?SNMP_FALSE:SNMP_TRUE;
+		return (snmpSnapshot->defaultDS.twoStepFlag == TRUE)?SNMP_FALSE:SNMP_TRUE;
 	case PTPBASE_CLOCK_PORT_CURRENT_PEER_ADDRESS_TYPE:
 		/* Only supports IPv4 */
 		return SNMP_INTEGER(SNMP_IPv4);
 	case PTPBASE_CLOCK_PORT_CURRENT_PEER_ADDRESS:
-		if(snmpRtOpts->transport != UDP_IPV4)
+		if(snmpSnapshot->transport != UDP_IPV4)
 		    return SNMP_IPADDR(0);
-		return(SNMP_IPADDR(snmpPtpClock->netPath.interfaceAddr.s_addr));
+		return(SNMP_IPADDR(snmpSnapshot->interfaceAddr.s_addr));
 	case PTPBASE_CLOCK_PORT_NUM_ASSOCIATED_PORTS:
-		if(snmpPtpClock->portDS.portState == PTP_MASTER && snmpRtOpts->unicastNegotiation) {
-			return SNMP_INTEGER(snmpPtpClock->slaveCount);
+		if(snmpSnapshot->portDS.portState == PTP_MASTER && snmpSnapshot->unicastNegotiation) {
+			return SNMP_INTEGER(snmpSnapshot->slaveCount);
 		}
-		if(snmpPtpClock->portDS.portState == PTP_MASTER && snmpPtpClock->unicastDestinationCount) {
-			return SNMP_INTEGER(snmpPtpClock->unicastDestinationCount);
+		if(snmpSnapshot->portDS.portState == PTP_MASTER && snmpSnapshot->unicastDestinationCount) {
+			return SNMP_INTEGER(snmpSnapshot->unicastDestinationCount);
 		}
-		if(snmpPtpClock->portDS.portState == PTP_SLAVE) {
-			return SNMP_INTEGER(snmpPtpClock->number_foreign_records);
+		if(snmpSnapshot->portDS.portState == PTP_SLAVE) {
+			return SNMP_INTEGER(snmpSnapshot->number_foreign_records);
 		}
 		return SNMP_INTEGER(0);
 	/* ptpbaseClockPortDSTable */
 	case PTPBASE_CLOCK_PORT_DS_PORT_IDENTITY:
-		return SNMP_OCTETSTR(&snmpPtpClock->portDS.portIdentity,
+		return SNMP_OCTETSTR(&snmpSnapshot->portDS.portIdentity,
 				     sizeof(PortIdentity));
 	case PTPBASE_CLOCK_PORT_DS_ANNOUNCEMENT_INTERVAL:
 		/* TODO: is it really logAnnounceInterval? */
-		return SNMP_INTEGER(snmpPtpClock->portDS.logAnnounceInterval);
+		return SNMP_INTEGER(snmpSnapshot->portDS.logAnnounceInterval);
 	case PTPBASE_CLOCK_PORT_DS_ANNOUNCE_RCT_TIMEOUT:
-		return SNMP_INTEGER(snmpPtpClock->portDS.announceReceiptTimeout);
+		return SNMP_INTEGER(snmpSnapshot->portDS.announceReceiptTimeout);
 	case PTPBASE_CLOCK_PORT_DS_SYNC_INTERVAL:
 		/* TODO: is it really logSyncInterval? */
-		return SNMP_INTEGER(snmpPtpClock->portDS.logSyncInterval);
+		return SNMP_INTEGER(snmpSnapshot->portDS.logSyncInterval);
 	case PTPBASE_CLOCK_PORT_DS_MIN_DELAY_REQ_INTERVAL:
 		/* TODO: is it really logMinDelayReqInterval? */
-		return SNMP_INTEGER(snmpPtpClock->portDS.logMinDelayReqInterval);
+		return SNMP_INTEGER(snmpSnapshot->portDS.logMinDelayReqInterval);
 	case PTPBASE_CLOCK_PORT_DS_PEER_DELAY_REQ_INTERVAL:
 		/* TODO: is it really logMinPdelayReqInterval? */
-		return SNMP_INTEGER(snmpPtpClock->portDS.logMinPdelayReqInterval);
+		return SNMP_INTEGER(snmpSnapshot->portDS.logMinPdelayReqInterval);
 	case PTPBASE_CLOCK_PORT_DS_DELAY_MECH:
-		return SNMP_INTEGER(snmpPtpClock->portDS.delayMechanism);
+		return SNMP_INTEGER(snmpSnapshot->portDS.delayMechanism);
 	case PTPBASE_CLOCK_PORT_DS_PEER_MEAN_PATH_DELAY:
-		return SNMP_TIMEINTERNAL(snmpPtpClock->portDS.peerMeanPathDelay);
+		return SNMP_TIMEINTERNAL(snmpSnapshot->portDS.peerMeanPathDelay);
 	case PTPBASE_CLOCK_PORT_DS_GRANT_DURATION:
-		if(snmpRtOpts->unicastNegotiation && snmpPtpClock->parentGrants) {
-			return SNMP_UNSIGNED(snmpPtpClock->parentGrants->grantData[SYNC_INDEXED].duration);
+		if(snmpSnapshot->unicastNegotiation) {
+			return SNMP_UNSIGNED(snmpSnapshot->grantDuration);
 		}
 		return SNMP_UNSIGNED(0);
 	case PTPBASE_CLOCK_PORT_DS_PTP_VERSION:
-		return SNMP_INTEGER(snmpPtpClock->portDS.versionNumber);
+		return SNMP_INTEGER(snmpSnapshot->portDS.versionNumber);
 	case PTPBASE_CLOCK_PORT_DS_PEER_MEAN_PATH_DELAY_STRING:
-		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpPtpClock->portDS.peerMeanPathDelay));
+		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpSnapshot->portDS.peerMeanPathDelay));
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_CLOCK_PORT_DS_LAST_MISMATCHED_DOMAIN:
-		return SNMP_INTEGER(snmpPtpClock->portDS.lastMismatchedDomain);
+		return SNMP_INTEGER(snmpSnapshot->portDS.lastMismatchedDomain);
 
 	/* ptpbaseClockPortRunningTable */
 	case PTPBASE_CLOCK_PORT_RUNNING_STATE:
-		return SNMP_INTEGER(snmpPtpClock->portDS.portState);
+		return SNMP_INTEGER(snmpSnapshot->portDS.portState);
 	case PTPBASE_CLOCK_PORT_RUNNING_ROLE:
-		return SNMP_INTEGER((snmpPtpClock->portDS.portState == PTP_MASTER)?
+		return SNMP_INTEGER((snmpSnapshot->portDS.portState == PTP_MASTER)?
 				    SNMP_PTP_PORT_MASTER:SNMP_PTP_PORT_SLAVE);
 	case PTPBASE_CLOCK_PORT_RUNNING_INTERFACE_INDEX:
-		return SNMP_INTEGER(snmpPtpClock->netPath.interfaceInfo.ifIndex);
+		return SNMP_INTEGER(snmpSnapshot->ifIndex);
 	case PTPBASE_CLOCK_PORT_RUNNING_IPVERSION:
 		/* IPv4 only */
 		return SNMP_INTEGER(4);
@@ -725,16 +834,16 @@ snmpClockPortTable(SNMP_SIGNATURE) {
 		return SNMP_INTEGER(0);
 	case PTPBASE_CLOCK_PORT_RUNNING_TX_MODE:
 	case PTPBASE_CLOCK_PORT_RUNNING_RX_MODE:	
-		if (snmpRtOpts->ipMode == IPMODE_UNICAST)
+		if (snmpSnapshot->ipMode == IPMODE_UNICAST)
 			return SNMP_INTEGER(SNMP_PTP_TX_UNICAST);
-		if (snmpRtOpts->ipMode == IPMODE_HYBRID)
+		if (snmpSnapshot->ipMode == IPMODE_HYBRID)
 			return SNMP_INTEGER(SNMP_PTP_TX_MULTICAST_MIX);
 		return SNMP_INTEGER(SNMP_PTP_TX_MULTICAST);
 	case PTPBASE_CLOCK_PORT_RUNNING_PACKETS_RECEIVED:
 
-		return SNMP_COUNTER64(snmpPtpClock->netPath.receivedPacketsTotal);
+		return SNMP_COUNTER64(snmpSnapshot->receivedPacketsTotal);
 	case PTPBASE_CLOCK_PORT_RUNNING_PACKETS_SENT:
-		return SNMP_COUNTER64(snmpPtpClock->netPath.sentPacketsTotal);
+		return SNMP_COUNTER64(snmpSnapshot->sentPacketsTotal);
 	}
 
 
@@ -750,6 +859,7 @@ snmpWriteClearCounters (int action, u_char *var_val, u_char var_val_type, size_t
 	oid myOid1 = name[name_len - 1 - 6];
 	/* field: 4 oids from end (index fields) */
 	oid myOid2 = name[name_len - 1 - 4];
+	int clear = 0;
 
 	if(var_val_type != ASN_INTEGER) {
 	    return SNMP_ERR_WRONGTYPE;
@@ -770,101 +880,49 @@ snmpWriteClearCounters (int action, u_char *var_val, u_char var_val_type, size_t
 		    case 12: /* message counters */
 				/* all counters */
 				if(myOid2 == 5) {
-					memset(&snmpPtpClock->counters, 0, sizeof(PtpdCounters));
-					return SNMP_ERR_NOERROR;
+					clear = SNMP_CLEAR_ALL;
 				}
 				/* message counters */
 				if(myOid2 == 6) {
-					snmpPtpClock->counters.announceMessagesSent = 0;
-					snmpPtpClock->counters.announceMessagesReceived = 0;
-					snmpPtpClock->counters.syncMessagesSent = 0;
-					snmpPtpClock->counters.syncMessagesReceived = 0;
-					snmpPtpClock->counters.followUpMessagesSent = 0;
-					snmpPtpClock->counters.followUpMessagesReceived = 0;
-					snmpPtpClock->counters.delayReqMessagesSent = 0;
-					snmpPtpClock->counters.delayReqMessagesReceived = 0;
-					snmpPtpClock->counters.delayRespMessagesSent = 0;
-					snmpPtpClock->counters.delayRespMessagesReceived = 0;
-					snmpPtpClock->counters.pdelayReqMessagesSent = 0;
-					snmpPtpClock->counters.pdelayReqMessagesReceived = 0;
-					snmpPtpClock->counters.pdelayRespMessagesSent = 0;
-					snmpPtpClock->counters.pdelayRespMessagesReceived = 0;
-					snmpPtpClock->counters.pdelayRespFollowUpMessagesSent = 0;
-					snmpPtpClock->counters.pdelayRespFollowUpMessagesReceived = 0;
-					snmpPtpClock->counters.signalingMessagesSent = 0;
-					snmpPtpClock->counters.signalingMessagesReceived = 0;
-					snmpPtpClock->counters.managementMessagesSent = 0;
-					snmpPtpClock->counters.managementMessagesReceived = 0;
-					snmpPtpClock->counters.discardedMessages = 0;
-					snmpPtpClock->counters.unknownMessages = 0;
-					return SNMP_ERR_NOERROR;
+					clear = SNMP_CLEAR_MESSAGES;
 				}
 			break;
 		    case 13: /* protocol counters */
-				/* clear counters */
 				if(myOid2 == 5) {
-					snmpPtpClock->counters.foreignAdded = 0;
-					/* snmpPtpClock->counters.foreignCount = 0; */ /* we don't clear this */
-					snmpPtpClock->counters.foreignRemoved = 0;
-					snmpPtpClock->counters.foreignOverflows = 0;
-					snmpPtpClock->counters.stateTransitions = 0;
-					snmpPtpClock->counters.bestMasterChanges = 0;
-					snmpPtpClock->counters.announceTimeouts = 0;
-					return SNMP_ERR_NOERROR;
+					clear = SNMP_CLEAR_PROTOCOL;
 				}
 			break;
 		    case 14: /* error counters */
-				/* clear counters */
 				if(myOid2 == 5) {
-					snmpPtpClock->counters.messageRecvErrors = 0;
-					snmpPtpClock->counters.messageSendErrors = 0;
-					snmpPtpClock->counters.messageFormatErrors = 0;
-					snmpPtpClock->counters.protocolErrors = 0;
-					snmpPtpClock->counters.versionMismatchErrors = 0;
-					snmpPtpClock->counters.domainMismatchErrors = 0;
-					snmpPtpClock->counters.sequenceMismatchErrors = 0;
-					snmpPtpClock->counters.delayMechanismMismatchErrors = 0;
-					return SNMP_ERR_NOERROR;
+					clear = SNMP_CLEAR_ERRORS;
 				}
 			break;
 		    case 15: /* unicast negotiation counters */
-				/* clear counters */
 				if(myOid2 == 5) {
-					snmpPtpClock->counters.unicastGrantsRequested = 0;
-					snmpPtpClock->counters.unicastGrantsGranted = 0;
-					snmpPtpClock->counters.unicastGrantsDenied = 0;
-					snmpPtpClock->counters.unicastGrantsCancelSent = 0;
-					snmpPtpClock->counters.unicastGrantsCancelReceived = 0;
-					snmpPtpClock->counters.unicastGrantsCancelAckSent = 0;
-					snmpPtpClock->counters.unicastGrantsCancelAckReceived = 0;
-					return SNMP_ERR_NOERROR;
+					clear = SNMP_CLEAR_UNICAST;
 				}
 			break;
 		    case 17: /* security counters */
-				/* clear counters */
 				if(myOid2 == 5) {
-					snmpPtpClock->counters.aclTimingMessagesDiscarded = 0;
-					snmpPtpClock->counters.aclManagementMessagesDiscarded = 0;
-					return SNMP_ERR_NOERROR;
+					clear = SNMP_CLEAR_SECURITY;
 				}
 			break;
 		    case 21: /* ptpd counters */
-				/* clear counters */
 				if(myOid2 == 5) {
-					snmpPtpClock->counters.consecutiveSequenceErrors = 0;
-					snmpPtpClock->counters.ignoredAnnounce = 0;
-#ifdef PTPD_STATISTICS
-					snmpPtpClock->counters.delayMSOutliersFound = 0;
-					snmpPtpClock->counters.delaySMOutliersFound = 0;
-#endif
-					snmpPtpClock->counters.maxDelayDrops = 0;
-					return SNMP_ERR_NOERROR;
+					clear = SNMP_CLEAR_PTPD;
 				}
 			break;
 		    default:
 			return SNMP_ERR_WRONGVALUE;
 		}
-		return SNMP_ERR_WRONGVALUE;
+
+		if(!clear) {
+			return SNMP_ERR_WRONGVALUE;
+		}
+
+		/* the counters belong to the protocol engine, which clears them on its next snapshot */
+		__atomic_fetch_or(&snmpAgent.clearRequests, clear, __ATOMIC_RELEASE);
+		return SNMP_ERR_NOERROR;
 	    }
 
 	    return SNMP_ERR_WRONGVALUE;
@@ -875,6 +933,89 @@ snmpWriteClearCounters (int action, u_char *var_val, u_char var_val_type, size_t
 
 }
 
+/* apply counter clears requested through SNMP - protocol engine only */
+static void
+snmpClearCounters(PtpClock *ptpClock, int clear)
+{
+
+	if(clear & SNMP_CLEAR_ALL) {
+		memset(&ptpClock->counters, 0, sizeof(PtpdCounters));
+		return;
+	}
+
+	if(clear & SNMP_CLEAR_MESSAGES) {
+		ptpClock->counters.announceMessagesSent = 0;
+		ptpClock->counters.announceMessagesReceived = 0;
+		ptpClock->counters.syncMessagesSent = 0;
+		ptpClock->counters.syncMessagesReceived = 0;
+		ptpClock->counters.followUpMessagesSent = 0;
+		ptpClock->counters.followUpMessagesReceived = 0;
+		ptpClock->counters.delayReqMessagesSent = 0;
+		ptpClock->counters.delayReqMessagesReceived = 0;
+		ptpClock->counters.delayRespMessagesSent = 0;
+		ptpClock->counters.delayRespMessagesReceived = 0;
+		ptpClock->counters.pdelayReqMessagesSent = 0;
+		ptpClock->counters.pdelayReqMessagesReceived = 0;
+		ptpClock->counters.pdelayRespMessagesSent = 0;
+		ptpClock->counters.pdelayRespMessagesReceived = 0;
+		ptpClock->counters.pdelayRespFollowUpMessagesSent = 0;
+		ptpClock->counters.pdelayRespFollowUpMessagesReceived = 0;
+		ptpClock->counters.signalingMessagesSent = 0;
+		ptpClock->counters.signalingMessagesReceived = 0;
+		ptpClock->counters.managementMessagesSent = 0;
+		ptpClock->counters.managementMessagesReceived = 0;
+		ptpClock->counters.discardedMessages = 0;
+		ptpClock->counters.unknownMessages = 0;
+	}
+
+	if(clear & SNMP_CLEAR_PROTOCOL) {
+		ptpClock->counters.foreignAdded = 0;
+		/* ptpClock->counters.foreignCount = 0; */ /* we don't clear this */
+		ptpClock->counters.foreignRemoved = 0;
+		ptpClock->counters.foreignOverflows = 0;
+		ptpClock->counters.stateTransitions = 0;
+		ptpClock->counters.bestMasterChanges = 0;
+		ptpClock->counters.announceTimeouts = 0;
+	}
+
+	if(clear & SNMP_CLEAR_ERRORS) {
+		ptpClock->counters.messageRecvErrors = 0;
+		ptpClock->counters.messageSendErrors = 0;
+		ptpClock->counters.messageFormatErrors = 0;
+		ptpClock->counters.protocolErrors = 0;
+		ptpClock->counters.versionMismatchErrors = 0;
+		ptpClock->counters.domainMismatchErrors = 0;
+		ptpClock->counters.sequenceMismatchErrors = 0;
+		ptpClock->counters.delayMechanismMismatchErrors = 0;
+	}
+
+	if(clear & SNMP_CLEAR_UNICAST) {
+		ptpClock->counters.unicastGrantsRequested = 0;
+		ptpClock->counters.unicastGrantsGranted = 0;
+		ptpClock->counters.unicastGrantsDenied = 0;
+		ptpClock->counters.unicastGrantsCancelSent = 0;
+		ptpClock->counters.unicastGrantsCancelReceived = 0;
+		ptpClock->counters.unicastGrantsCancelAckSent = 0;
+		ptpClock->counters.unicastGrantsCancelAckReceived = 0;
+	}
+
+	if(clear & SNMP_CLEAR_SECURITY) {
+		ptpClock->counters.aclTimingMessagesDiscarded = 0;
+		ptpClock->counters.aclManagementMessagesDiscarded = 0;
+	}
+
+	if(clear & SNMP_CLEAR_PTPD) {
+		ptpClock->counters.consecutiveSequenceErrors = 0;
+		ptpClock->counters.ignoredAnnounce = 0;
+#ifdef PTPD_STATISTICS
+		ptpClock->counters.delayMSOutliersFound = 0;
+		ptpClock->counters.delaySMOutliersFound = 0;
+#endif
+		ptpClock->counters.maxDelayDrops = 0;
+	}
+
+}
+
 /**
  * Handle ptpbasePtpPortMessageCounters
  */
@@ -885,11 +1026,11 @@ snmpPtpPortMessageCountersTable(SNMP_SIGNATURE) {
 	SNMP_INDEXED_TABLE;
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	index[3] = snmpPtpClock->portDS.portIdentity.portNumber;
-	SNMP_ADD_INDEX(index, 4, snmpPtpClock);
+	index[3] = snmpSnapshot->portDS.portIdentity.portNumber;
+	SNMP_ADD_INDEX(index, 4, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
@@ -901,53 +1042,53 @@ snmpPtpPortMessageCountersTable(SNMP_SIGNATURE) {
 	    *write_method = snmpWriteClearCounters;
 	    return SNMP_FALSE;
 	case PTPBASE_PORT_MESSAGE_COUNTERS_TOTAL_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->netPath.sentPacketsTotal);
+	    return SNMP_INTEGER(snmpSnapshot->sentPacketsTotal);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_TOTAL_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->netPath.receivedPacketsTotal);
+	    return SNMP_INTEGER(snmpSnapshot->receivedPacketsTotal);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_ANNOUNCE_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->counters.announceMessagesSent);
+	    return SNMP_INTEGER(snmpSnapshot->counters.announceMessagesSent);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_ANNOUNCE_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->counters.announceMessagesReceived);
+	    return SNMP_INTEGER(snmpSnapshot->counters.announceMessagesReceived);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_SYNC_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->counters.syncMessagesSent);
+	    return SNMP_INTEGER(snmpSnapshot->counters.syncMessagesSent);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_SYNC_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->counters.syncMessagesReceived);
+	    return SNMP_INTEGER(snmpSnapshot->counters.syncMessagesReceived);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_FOLLOWUP_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->counters.followUpMessagesSent);
+	    return SNMP_INTEGER(snmpSnapshot->counters.followUpMessagesSent);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_FOLLOWUP_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->counters.followUpMessagesReceived);
+	    return SNMP_INTEGER(snmpSnapshot->counters.followUpMessagesReceived);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_DELAYREQ_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->counters.delayReqMessagesSent);
+	    return SNMP_INTEGER(snmpSnapshot->counters.delayReqMessagesSent);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_DELAYREQ_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->counters.delayReqMessagesReceived);
+	    return SNMP_INTEGER(snmpSnapshot->counters.delayReqMessagesReceived);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_DELAYRESP_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->counters.delayRespMessagesSent);
+	    return SNMP_INTEGER(snmpSnapshot->counters.delayRespMessagesSent);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_DELAYRESP_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->counters.delayRespMessagesReceived);
+	    return SNMP_INTEGER(snmpSnapshot->counters.delayRespMessagesReceived);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_PDELAYREQ_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->counters.pdelayReqMessagesSent);
+	    return SNMP_INTEGER(snmpSnapshot->counters.pdelayReqMessagesSent);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_PDELAYREQ_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->counters.pdelayReqMessagesReceived);
+	    return SNMP_INTEGER(snmpSnapshot->counters.pdelayReqMessagesReceived);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_PDELAYRESP_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->counters.pdelayRespMessagesSent);
+	    return SNMP_INTEGER(snmpSnapshot->counters.pdelayRespMessagesSent);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_PDELAYRESP_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->counters.pdelayRespMessagesReceived);
+	    return SNMP_INTEGER(snmpSnapshot->counters.pdelayRespMessagesReceived);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_PDELAYRESP_FOLLOWUP_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->counters.pdelayRespFollowUpMessagesSent);
+	    return SNMP_INTEGER(snmpSnapshot->counters.pdelayRespFollowUpMessagesSent);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_PDELAYRESP_FOLLOWUP_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->counters.pdelayRespFollowUpMessagesReceived);
+	    return SNMP_INTEGER(snmpSnapshot->counters.pdelayRespFollowUpMessagesReceived);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_SIGNALING_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->counters.signalingMessagesSent);
+	    return SNMP_INTEGER(snmpSnapshot->counters.signalingMessagesSent);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_SIGNALING_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->counters.signalingMessagesReceived);
+	    return SNMP_INTEGER(snmpSnapshot->counters.signalingMessagesReceived);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_MANAGEMENT_SENT:
-	    return SNMP_INTEGER(snmpPtpClock->counters.managementMessagesSent);
+	    return SNMP_INTEGER(snmpSnapshot->counters.managementMessagesSent);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_MANAGEMENT_RECEIVED:
-	    return SNMP_INTEGER(snmpPtpClock->counters.managementMessagesReceived);
+	    return SNMP_INTEGER(snmpSnapshot->counters.managementMessagesReceived);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_DISCARDED_MESSAGES:
-	    return SNMP_INTEGER(snmpPtpClock->counters.discardedMessages);
+	    return SNMP_INTEGER(snmpSnapshot->counters.discardedMessages);
 	case PTPBASE_PORT_MESSAGE_COUNTERS_UNKNOWN_MESSAGES:
-	    return SNMP_INTEGER(snmpPtpClock->counters.unknownMessages);
+	    return SNMP_INTEGER(snmpSnapshot->counters.unknownMessages);
 
     }
 
@@ -965,11 +1106,11 @@ snmpPtpPortProtocolCountersTable(SNMP_SIGNATURE) {
 	SNMP_INDEXED_TABLE;
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	index[3] = snmpPtpClock->portDS.portIdentity.portNumber;
-	SNMP_ADD_INDEX(index, 4, snmpPtpClock);
+	index[3] = snmpSnapshot->portDS.portIdentity.portNumber;
+	SNMP_ADD_INDEX(index, 4, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
@@ -978,19 +1119,19 @@ snmpPtpPortProtocolCountersTable(SNMP_SIGNATURE) {
 	    *write_method = snmpWriteClearCounters;
 	    return SNMP_FALSE;
     case PTPBASE_PORT_PROTOCOL_COUNTERS_FOREIGN_ADDED:
-	return SNMP_INTEGER(snmpPtpClock->counters.foreignAdded);
+	return SNMP_INTEGER(snmpSnapshot->counters.foreignAdded);
     case PTPBASE_PORT_PROTOCOL_COUNTERS_FOREIGN_COUNT:
-	return SNMP_INTEGER(snmpPtpClock->counters.foreignCount);
+	return SNMP_INTEGER(snmpSnapshot->counters.foreignCount);
     case PTPBASE_PORT_PROTOCOL_COUNTERS_FOREIGN_REMOVED:
-	return SNMP_INTEGER(snmpPtpClock->counters.foreignRemoved);
+	return SNMP_INTEGER(snmpSnapshot->counters.foreignRemoved);
     case PTPBASE_PORT_PROTOCOL_COUNTERS_FOREIGN_OVERFLOWS:
-	return SNMP_INTEGER(snmpPtpClock->counters.foreignOverflows);
+	return SNMP_INTEGER(snmpSnapshot->counters.foreignOverflows);
     case PTPBASE_PORT_PROTOCOL_COUNTERS_STATE_TRANSITIONS:
-	return SNMP_INTEGER(snmpPtpClock->counters.stateTransitions);
+	return SNMP_INTEGER(snmpSnapshot->counters.stateTransitions);
     case PTPBASE_PORT_PROTOCOL_COUNTERS_BEST_MASTER_CHANGES:
-	return SNMP_INTEGER(snmpPtpClock->counters.bestMasterChanges);
+	return SNMP_INTEGER(snmpSnapshot->counters.bestMasterChanges);
     case PTPBASE_PORT_PROTOCOL_COUNTERS_ANNOUNCE_TIMEOUTS:
-	return SNMP_INTEGER(snmpPtpClock->counters.announceTimeouts);
+	return SNMP_INTEGER(snmpSnapshot->counters.announceTimeouts);
 	}
 
 	return NULL;
@@ -1006,11 +1147,11 @@ snmpPtpPortErrorCountersTable(SNMP_SIGNATURE) {
 	SNMP_INDEXED_TABLE;
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	index[3] = snmpPtpClock->portDS.portIdentity.portNumber;
-	SNMP_ADD_INDEX(index, 4, snmpPtpClock);
+	index[3] = snmpSnapshot->portDS.portIdentity.portNumber;
+	SNMP_ADD_INDEX(index, 4, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
@@ -1019,21 +1160,21 @@ snmpPtpPortErrorCountersTable(SNMP_SIGNATURE) {
 	    *write_method = snmpWriteClearCounters;
 	    return SNMP_FALSE;
     case PTPBASE_PORT_ERROR_COUNTERS_MESSAGE_RECV:
-	return SNMP_INTEGER(snmpPtpClock->counters.messageRecvErrors);
+	return SNMP_INTEGER(snmpSnapshot->counters.messageRecvErrors);
     case PTPBASE_PORT_ERROR_COUNTERS_MESSAGE_SEND:
-	return SNMP_INTEGER(snmpPtpClock->counters.messageSendErrors);
+	return SNMP_INTEGER(snmpSnapshot->counters.messageSendErrors);
     case PTPBASE_PORT_ERROR_COUNTERS_MESSAGE_FORMAT:
-	return SNMP_INTEGER(snmpPtpClock->counters.messageFormatErrors);
+	return SNMP_INTEGER(snmpSnapshot->counters.messageFormatErrors);
     case PTPBASE_PORT_ERROR_COUNTERS_PROTOCOL:
-	return SNMP_INTEGER(snmpPtpClock->counters.protocolErrors);
+	return SNMP_INTEGER(snmpSnapshot->counters.protocolErrors);
     case PTPBASE_PORT_ERROR_COUNTERS_VERSION_MISMATCH:
-	return SNMP_INTEGER(snmpPtpClock->counters.versionMismatchErrors);
+	return SNMP_INTEGER(snmpSnapshot->counters.versionMismatchErrors);
     case PTPBASE_PORT_ERROR_COUNTERS_DOMAIN_MISMATCH:
-	return SNMP_INTEGER(snmpPtpClock->counters.domainMismatchErrors);
+	return SNMP_INTEGER(snmpSnapshot->counters.domainMismatchErrors);
     case PTPBASE_PORT_ERROR_COUNTERS_SEQUENCE_MISMATCH:
-	return SNMP_INTEGER(snmpPtpClock->counters.sequenceMismatchErrors);
+	return SNMP_INTEGER(snmpSnapshot->counters.sequenceMismatchErrors);
     case PTPBASE_PORT_ERROR_COUNTERS_DELAYMECH_MISMATCH:
-	return SNMP_INTEGER(snmpPtpClock->counters.delayMechanismMismatchErrors);
+	return SNMP_INTEGER(snmpSnapshot->counters.delayMechanismMismatchErrors);
 	}
 
 	return NULL;
@@ -1049,11 +1190,11 @@ snmpPtpPortUnicastNegotiationCountersTable(SNMP_SIGNATURE) {
 	SNMP_INDEXED_TABLE;
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	index[3] = snmpPtpClock->portDS.portIdentity.portNumber;
-	SNMP_ADD_INDEX(index, 4, snmpPtpClock);
+	index[3] = snmpSnapshot->portDS.portIdentity.portNumber;
+	SNMP_ADD_INDEX(index, 4, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
@@ -1062,19 +1203,19 @@ snmpPtpPortUnicastNegotiationCountersTable(SNMP_SIGNATURE) {
 	    *write_method = snmpWriteClearCounters;
 	    return SNMP_FALSE;
     case PTPBASE_PORT_UNICAST_NEGOTIATION_COUNTERS_GRANTS_REQUESTED:
-	return SNMP_INTEGER(snmpPtpClock->counters.unicastGrantsRequested);
+	return SNMP_INTEGER(snmpSnapshot->counters.unicastGrantsRequested);
     case PTPBASE_PORT_UNICAST_NEGOTIATION_COUNTERS_GRANTS_GRANTED:
-	return SNMP_INTEGER(snmpPtpClock->counters.unicastGrantsGranted);
+	return SNMP_INTEGER(snmpSnapshot->counters.unicastGrantsGranted);
     case PTPBASE_PORT_UNICAST_NEGOTIATION_COUNTERS_GRANTS_DENIED:
-	return SNMP_INTEGER(snmpPtpClock->counters.unicastGrantsDenied);
+	return SNMP_INTEGER(snmpSnapshot->counters.unicastGrantsDenied);
     case PTPBASE_PORT_UNICAST_NEGOTIATION_COUNTERS_GRANTS_CANCEL_SENT:
-	return SNMP_INTEGER(snmpPtpClock->counters.unicastGrantsCancelSent);
+	return SNMP_INTEGER(snmpSnapshot->counters.unicastGrantsCancelSent);
     case PTPBASE_PORT_UNICAST_NEGOTIATION_COUNTERS_GRANTS_CANCEL_RECEIVED:
-	return SNMP_INTEGER(snmpPtpClock->counters.unicastGrantsCancelReceived);
+	return SNMP_INTEGER(snmpSnapshot->counters.unicastGrantsCancelReceived);
     case PTPBASE_PORT_UNICAST_NEGOTIATION_COUNTERS_GRANTS_CANCEL_ACK_SENT:
-	return SNMP_INTEGER(snmpPtpClock->counters.unicastGrantsCancelAckSent);
+	return SNMP_INTEGER(snmpSnapshot->counters.unicastGrantsCancelAckSent);
     case PTPBASE_PORT_UNICAST_NEGOTIATION_COUNTERS_GRANTS_CANCEL_ACK_RECEIVED:
-	return SNMP_INTEGER(snmpPtpClock->counters.unicastGrantsCancelAckReceived);
+	return SNMP_INTEGER(snmpSnapshot->counters.unicastGrantsCancelAckReceived);
 	}
 
 	return NULL;
@@ -1090,19 +1231,19 @@ snmpPtpPortPerformanceCountersTable(SNMP_SIGNATURE) {
 	SNMP_INDEXED_TABLE;
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	index[3] = snmpPtpClock->portDS.portIdentity.portNumber;
-	SNMP_ADD_INDEX(index, 4, snmpPtpClock);
+	index[3] = snmpSnapshot->portDS.portIdentity.portNumber;
+	SNMP_ADD_INDEX(index, 4, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
 	switch (vp->magic) {
     case PTPBASE_PORT_PERFORMANCE_COUNTERS_MESSAGE_SEND_RATE:
-	return SNMP_INTEGER(snmpPtpClock->counters.messageSendRate);
+	return SNMP_INTEGER(snmpSnapshot->counters.messageSendRate);
     case PTPBASE_PORT_PERFORMANCE_COUNTERS_MESSAGE_RECEIVE_RATE:
-	return SNMP_INTEGER(snmpPtpClock->counters.messageReceiveRate);
+	return SNMP_INTEGER(snmpSnapshot->counters.messageReceiveRate);
 	}
 
 	return NULL;
@@ -1119,11 +1260,11 @@ snmpPtpPortSecurityCountersTable(SNMP_SIGNATURE) {
 	SNMP_INDEXED_TABLE;
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	index[3] = snmpPtpClock->portDS.portIdentity.portNumber;
-	SNMP_ADD_INDEX(index, 4, snmpPtpClock);
+	index[3] = snmpSnapshot->portDS.portIdentity.portNumber;
+	SNMP_ADD_INDEX(index, 4, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
@@ -1132,9 +1273,9 @@ snmpPtpPortSecurityCountersTable(SNMP_SIGNATURE) {
 	    *write_method = snmpWriteClearCounters;
 	    return SNMP_FALSE;
     case PTPBASE_PORT_SECURITY_COUNTERS_TIMING_ACL_DISCARDED:
-	return SNMP_INTEGER(snmpPtpClock->counters.aclTimingMessagesDiscarded);
+	return SNMP_INTEGER(snmpSnapshot->counters.aclTimingMessagesDiscarded);
     case PTPBASE_PORT_SECURITY_COUNTERS_MANAGEMENT_ACL_DISCARDED:
-	return SNMP_INTEGER(snmpPtpClock->counters.aclManagementMessagesDiscarded);
+	return SNMP_INTEGER(snmpSnapshot->counters.aclManagementMessagesDiscarded);
 	}
 
 	return NULL;
@@ -1152,48 +1293,48 @@ snmpSlaveOfmStatsTable(SNMP_SIGNATURE) {
 	memset(tmpStr, 0, sizeof(tmpStr));
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	SNMP_ADD_INDEX(index, 3, snmpPtpClock);
+	SNMP_ADD_INDEX(index, 3, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
 	switch (vp->magic) {
 	case PTPBASE_SLAVE_OFM_STATS_CURRENT_VALUE:
-		return SNMP_TIMEINTERNAL(snmpPtpClock->currentDS.offsetFromMaster);
+		return SNMP_TIMEINTERNAL(snmpSnapshot->currentDS.offsetFromMaster);
 	case PTPBASE_SLAVE_OFM_STATS_CURRENT_VALUE_STRING:
-		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpPtpClock->currentDS.offsetFromMaster));
+		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpSnapshot->currentDS.offsetFromMaster));
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 #ifdef PTPD_STATISTICS
 	case PTPBASE_SLAVE_OFM_STATS_PERIOD_SECONDS:
-		return SNMP_INTEGER(snmpRtOpts->statsUpdateInterval);
+		return SNMP_INTEGER(snmpSnapshot->statsUpdateInterval);
 	case PTPBASE_SLAVE_OFM_STATS_VALID:
-		return SNMP_BOOLEAN(snmpPtpClock->slaveStats.statsCalculated);
+		return SNMP_BOOLEAN(snmpSnapshot->slaveStats.statsCalculated);
 	case PTPBASE_SLAVE_OFM_STATS_MIN:
-		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpPtpClock->slaveStats.ofmMinFinal));
+		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpSnapshot->slaveStats.ofmMinFinal));
 	case PTPBASE_SLAVE_OFM_STATS_MAX:
-		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpPtpClock->slaveStats.ofmMaxFinal));
+		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpSnapshot->slaveStats.ofmMaxFinal));
 	case PTPBASE_SLAVE_OFM_STATS_MEAN:
-		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpPtpClock->slaveStats.ofmMean));
+		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpSnapshot->slaveStats.ofmMean));
 	case PTPBASE_SLAVE_OFM_STATS_STDDEV:
-		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpPtpClock->slaveStats.ofmStdDev));
+		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpSnapshot->slaveStats.ofmStdDev));
 	case PTPBASE_SLAVE_OFM_STATS_MEDIAN:
-		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpPtpClock->slaveStats.ofmMedian));
+		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpSnapshot->slaveStats.ofmMedian));
 	case PTPBASE_SLAVE_OFM_STATS_MIN_STRING:
-		snprintf(tmpStr, 64, "%.09f", snmpPtpClock->slaveStats.ofmMinFinal);
+		snprintf(tmpStr, 64, "%.09f", snmpSnapshot->slaveStats.ofmMinFinal);
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_SLAVE_OFM_STATS_MAX_STRING:
-		snprintf(tmpStr, 64, "%.09f", snmpPtpClock->slaveStats.ofmMaxFinal);
+		snprintf(tmpStr, 64, "%.09f", snmpSnapshot->slaveStats.ofmMaxFinal);
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_SLAVE_OFM_STATS_MEAN_STRING:
-		snprintf(tmpStr, 64, "%.09f", snmpPtpClock->slaveStats.ofmMean);
+		snprintf(tmpStr, 64, "%.09f", snmpSnapshot->slaveStats.ofmMean);
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_SLAVE_OFM_STATS_STDDEV_STRING:
-		snprintf(tmpStr, 64, "%.09f", snmpPtpClock->slaveStats.ofmStdDev);
+		snprintf(tmpStr, 64, "%.09f", snmpSnapshot->slaveStats.ofmStdDev);
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_SLAVE_OFM_STATS_MEDIAN_STRING:
-		snprintf(tmpStr, 64, "%.09f", snmpPtpClock->slaveStats.ofmMedian);
+		snprintf(tmpStr, 64, "%.09f", snmpSnapshot->slaveStats.ofmMedian);
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 #endif
 	}
@@ -1213,48 +1354,48 @@ snmpSlaveMpdStatsTable(SNMP_SIGNATURE) {
 	memset(tmpStr, 0, sizeof(tmpStr));
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	SNMP_ADD_INDEX(index, 3, snmpPtpClock);
+	SNMP_ADD_INDEX(index, 3, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
 	switch (vp->magic) {
 	case PTPBASE_SLAVE_MPD_STATS_CURRENT_VALUE:
-		return SNMP_TIMEINTERNAL(snmpPtpClock->currentDS.meanPathDelay);
+		return SNMP_TIMEINTERNAL(snmpSnapshot->currentDS.meanPathDelay);
 	case PTPBASE_SLAVE_MPD_STATS_CURRENT_VALUE_STRING:
-		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpPtpClock->currentDS.meanPathDelay));
+		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpSnapshot->currentDS.meanPathDelay));
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 #ifdef PTPD_STATISTICS
 	case PTPBASE_SLAVE_MPD_STATS_PERIOD_SECONDS:
-		return SNMP_INTEGER(snmpRtOpts->statsUpdateInterval);
+		return SNMP_INTEGER(snmpSnapshot->statsUpdateInterval);
 	case PTPBASE_SLAVE_MPD_STATS_VALID:
-		return SNMP_BOOLEAN(snmpPtpClock->slaveStats.statsCalculated);
+		return SNMP_BOOLEAN(snmpSnapshot->slaveStats.statsCalculated);
 	case PTPBASE_SLAVE_MPD_STATS_MIN:
-		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpPtpClock->slaveStats.mpdMinFinal));
+		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpSnapshot->slaveStats.mpdMinFinal));
 	case PTPBASE_SLAVE_MPD_STATS_MAX:
-		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpPtpClock->slaveStats.mpdMaxFinal));
+		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpSnapshot->slaveStats.mpdMaxFinal));
 	case PTPBASE_SLAVE_MPD_STATS_MEAN:
-		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpPtpClock->slaveStats.mpdMean));
+		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpSnapshot->slaveStats.mpdMean));
 	case PTPBASE_SLAVE_MPD_STATS_STDDEV:
-		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpPtpClock->slaveStats.mpdStdDev));
+		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpSnapshot->slaveStats.mpdStdDev));
 	case PTPBASE_SLAVE_MPD_STATS_MEDIAN:
-		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpPtpClock->slaveStats.mpdMedian));
+		return SNMP_TIMEINTERNAL(doubleToTimeInternal(snmpSnapshot->slaveStats.mpdMedian));
 	case PTPBASE_SLAVE_MPD_STATS_MIN_STRING:
-		snprintf(tmpStr, 64, "%.09f", snmpPtpClock->slaveStats.mpdMinFinal);
+		snprintf(tmpStr, 64, "%.09f", snmpSnapshot->slaveStats.mpdMinFinal);
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_SLAVE_MPD_STATS_MAX_STRING:
-		snprintf(tmpStr, 64, "%.09f", snmpPtpClock->slaveStats.mpdMaxFinal);
+		snprintf(tmpStr, 64, "%.09f", snmpSnapshot->slaveStats.mpdMaxFinal);
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_SLAVE_MPD_STATS_MEAN_STRING:
-		snprintf(tmpStr, 64, "%.09f", snmpPtpClock->slaveStats.mpdMean);
+		snprintf(tmpStr, 64, "%.09f", snmpSnapshot->slaveStats.mpdMean);
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_SLAVE_MPD_STATS_STDDEV_STRING:
-		snprintf(tmpStr, 64, "%.09f", snmpPtpClock->slaveStats.mpdStdDev);
+		snprintf(tmpStr, 64, "%.09f", snmpSnapshot->slaveStats.mpdStdDev);
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	case PTPBASE_SLAVE_MPD_STATS_MEDIAN_STRING:
-		snprintf(tmpStr, 64, "%.09f", snmpPtpClock->slaveStats.mpdMedian);
+		snprintf(tmpStr, 64, "%.09f", snmpSnapshot->slaveStats.mpdMedian);
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 #endif
 	}
@@ -1274,31 +1415,31 @@ snmpSlaveFreqAdjStatsTable(SNMP_SIGNATURE) {
 	memset(tmpStr, 0, sizeof(tmpStr));
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	SNMP_ADD_INDEX(index, 3, snmpPtpClock);
+	SNMP_ADD_INDEX(index, 3, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
 	switch (vp->magic) {
 	    case PTPBASE_SLAVE_FREQADJ_STATS_CURRENT_VALUE:
-		return SNMP_INTEGER(snmpPtpClock->servo.observedDrift);
+		return SNMP_INTEGER(snmpSnapshot->servo.observedDrift);
 #ifdef PTPD_STATISTICS
 	    case PTPBASE_SLAVE_FREQADJ_STATS_PERIOD_SECONDS:
-		return SNMP_INTEGER(snmpRtOpts->statsUpdateInterval);
+		return SNMP_INTEGER(snmpSnapshot->statsUpdateInterval);
 	    case PTPBASE_SLAVE_FREQADJ_STATS_VALID:
-		return SNMP_BOOLEAN(snmpPtpClock->servo.statsCalculated);
+		return SNMP_BOOLEAN(snmpSnapshot->servo.statsCalculated);
 	    case PTPBASE_SLAVE_FREQADJ_STATS_MIN:
-		return SNMP_INTEGER(snmpPtpClock->servo.driftMinFinal);
+		return SNMP_INTEGER(snmpSnapshot->servo.driftMinFinal);
 	    case PTPBASE_SLAVE_FREQADJ_STATS_MAX:
-		return SNMP_INTEGER(snmpPtpClock->servo.driftMaxFinal);
+		return SNMP_INTEGER(snmpSnapshot->servo.driftMaxFinal);
 	    case PTPBASE_SLAVE_FREQADJ_STATS_MEAN:
-		return SNMP_INTEGER(snmpPtpClock->servo.driftMean);
+		return SNMP_INTEGER(snmpSnapshot->servo.driftMean);
 	    case PTPBASE_SLAVE_FREQADJ_STATS_STDDEV:
-		return SNMP_INTEGER(snmpPtpClock->servo.driftStdDev);
+		return SNMP_INTEGER(snmpSnapshot->servo.driftStdDev);
 	    case PTPBASE_SLAVE_FREQADJ_STATS_MEDIAN:
-		return SNMP_INTEGER(snmpPtpClock->servo.driftMedian);
+		return SNMP_INTEGER(snmpSnapshot->servo.driftMedian);
 #endif
 	}
 
@@ -1317,11 +1458,11 @@ snmpPtpdSpecificCountersTable(SNMP_SIGNATURE) {
 	SNMP_INDEXED_TABLE;
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	index[3] = snmpPtpClock->portDS.portIdentity.portNumber;
-	SNMP_ADD_INDEX(index, 4, snmpPtpClock);
+	index[3] = snmpSnapshot->portDS.portIdentity.portNumber;
+	SNMP_ADD_INDEX(index, 4, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
@@ -1330,17 +1471,19 @@ snmpPtpdSpecificCountersTable(SNMP_SIGNATURE) {
 	    *write_method = snmpWriteClearCounters;
 	    return SNMP_FALSE;
     case PTPBASE_PTPD_SPECIFIC_COUNTERS_IGNORED_ANNOUNCE:
-	return SNMP_INTEGER(snmpPtpClock->counters.ignoredAnnounce);
+	return SNMP_INTEGER(snmpSnapshot->counters.ignoredAnnounce);
     case PTPBASE_PTPD_SPECIFIC_COUNTERS_CONSECUTIVE_SEQUENCE_ERRORS:
-	return SNMP_INTEGER(snmpPtpClock->counters.consecutiveSequenceErrors);
+	return SNMP_INTEGER(snmpSnapshot->counters.consecutiveSequenceErrors);
 #ifdef PTPD_STATISTICS
     case PTPBASE_PTPD_SPECIFIC_COUNTERS_DELAYMS_OUTLIERS_FOUND:
-	return SNMP_INTEGER(snmpPtpClock->counters.delayMSOutliersFound);
+	return SNMP_INTEGER(snmpSnapshot->counters.delayMSOutliersFound);
     case PTPBASE_PTPD_SPECIFIC_COUNTERS_DELAYSM_OUTLIERS_FOUND:
-	return SNMP_INTEGER(snmpPtpClock->counters.delaySMOutliersFound);
+	return SNMP_INTEGER(snmpSnapshot->counters.delaySMOutliersFound);
 #endif
     case PTPBASE_PTPD_SPECIFIC_COUNTERS_MAX_DELAY_DROPS:
-	return SNMP_INTEGER(snmpPtpClock->counters.maxDelayDrops);
+	return SNMP_INTEGER(snmpSnapshot->counters.maxDelayDrops);
+    case PTPBASE_PTPD_SPECIFIC_COUNTERS_SYNC_OVERRUNS:
+	return SNMP_INTEGER(snmpSnapshot->syncOverruns);
 	}
 
 	return NULL;
@@ -1358,26 +1501,146 @@ snmpPtpdSpecificDataTable(SNMP_SIGNATURE) {
 	memset(tmpStr, 0, sizeof(tmpStr));
 
 	/* We only have one valid index */
-	index[0] = snmpPtpClock->defaultDS.domainNumber;
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
 	index[1] = SNMP_PTP_ORDINARY_CLOCK;
 	index[2] = SNMP_PTP_CLOCK_INSTANCE;
-	SNMP_ADD_INDEX(index, 3, snmpPtpClock);
+	SNMP_ADD_INDEX(index, 3, snmpSnapshot);
 
 	if (!SNMP_BEST_MATCH) return NULL;
 
 #ifdef PTPD_STATISTICS
 	switch (vp->magic) {
 	    case PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYMS:
-		return SNMP_TIMEINTERNAL(snmpPtpClock->rawDelayMS);
+		return SNMP_TIMEINTERNAL(snmpSnapshot->rawDelayMS);
 	    case PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYMS_STRING:
-		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpPtpClock->rawDelayMS));
+		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpSnapshot->rawDelayMS));
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
 	    case PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYSM:
-		return SNMP_TIMEINTERNAL(snmpPtpClock->rawDelaySM);
+		return SNMP_TIMEINTERNAL(snmpSnapshot->rawDelaySM);
 	    case PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYSM_STRING:
-		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpPtpClock->rawDelaySM));
+		snprintf(tmpStr, 64, "%.09f", timeInternalToDouble(&snmpSnapshot->rawDelaySM));
+		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
+	    case PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_ACTIVE:
+		return SNMP_BOOLEAN(snmpSnapshot->holdover.active);
+	    case PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_SECONDS:
+		return SNMP_UNSIGNED(snmpSnapshot->holdover.elapsed);
+	    case PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_PREDICTED_DRIFT:
+		return SNMP_INTEGER(snmpSnapshot->holdover.predictedDrift);
+	    case PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_TIME_ERROR:
+		return SNMP_INTEGER(max(min(snmpSnapshot->holdover.timeError, (double)INT32_MAX), (double)INT32_MIN));
+	}
+#endif
+
+	return NULL;
+}
+
+/**
+ * Handle ptpBasePtpdStability
+ */
+static u_char*
+snmpPtpdStabilityTable(SNMP_SIGNATURE) {
+	oid index[4];
+	SNMP_LOCAL_VARIABLES;
+	SNMP_INDEXED_TABLE;
+
+	memset(tmpStr, 0, sizeof(tmpStr));
+
+#ifdef PTPD_STATISTICS
+	StabilityTau *tau;
+	int i;
+
+	/* one row per tau */
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
+	index[1] = SNMP_PTP_ORDINARY_CLOCK;
+	index[2] = SNMP_PTP_CLOCK_INSTANCE;
+	for (i = 0; i < STABILITY_TAUS; i++) {
+		index[3] = i + 1;
+		SNMP_ADD_INDEX(index, 4, &snmpSnapshot->taus[i]);
+	}
+
+	if ((tau = SNMP_BEST_MATCH) == NULL) return NULL;
+
+	switch (vp->magic) {
+	    case PTPBASE_PTPD_STABILITY_TAU:
+		return SNMP_UNSIGNED(getStabilityTau(tau));
+	    case PTPBASE_PTPD_STABILITY_ADEV_STRING:
+		snprintf(tmpStr, 64, "%.03e", getStabilityAdev(tau));
+		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
+	    case PTPBASE_PTPD_STABILITY_TDEV_STRING:
+		snprintf(tmpStr, 64, "%.03e", getStabilityTdev(tau));
+		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
+	    case PTPBASE_PTPD_STABILITY_MTIE_STRING:
+		snprintf(tmpStr, 64, "%.03e", getStabilityMtie(tau));
+		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
+	    case PTPBASE_PTPD_STABILITY_SAMPLES:
+		return SNMP_UNSIGNED(tau->adevCount);
+	}
+#else
+	(void)index;
+#endif
+
+	return NULL;
+}
+
+/* nanoseconds, clamped to Integer32 */
+#define SNMP_PERCENTILE_NS(V)	SNMP_INTEGER(min((V) * 1E9, (double)INT32_MAX))
+
+/**
+ * Handle ptpBasePtpdPercentile
+ */
+static u_char*
+snmpPtpdPercentileTable(SNMP_SIGNATURE) {
+	oid index[4];
+	SNMP_LOCAL_VARIABLES;
+	SNMP_INDEXED_TABLE;
+
+	memset(tmpStr, 0, sizeof(tmpStr));
+
+#ifdef PTPD_STATISTICS
+	LogHistogramSnapshot *snap;
+	int i;
+
+	/* one row per histogram, followed by the latency stages */
+	index[0] = snmpSnapshot->defaultDS.domainNumber;
+	index[1] = SNMP_PTP_ORDINARY_CLOCK;
+	index[2] = SNMP_PTP_CLOCK_INSTANCE;
+	for (i = 0; i < PTP_HISTOGRAM_MAX; i++) {
+		index[3] = i + 1;
+		SNMP_ADD_INDEX(index, 4, &snmpSnapshot->histograms[i]);
+	}
+	for (i = 0; i < LATENCY_STAGE_MAX; i++) {
+		index[3] = PTP_HISTOGRAM_MAX + i + 1;
+		SNMP_ADD_INDEX(index, 4, &snmpSnapshot->latency[i]);
+	}
+
+	if ((snap = SNMP_BEST_MATCH) == NULL) return NULL;
+
+	switch (vp->magic) {
+	    case PTPBASE_PTPD_PERCENTILE_NAME:
+		for (i = 0; i < PTP_HISTOGRAM_MAX; i++) {
+			if (snap == &snmpSnapshot->histograms[i]) {
+				strncpy(tmpStr, getPtpHistogramName(i), sizeof(tmpStr) - 1);
+			}
+		}
+		for (i = 0; i < LATENCY_STAGE_MAX; i++) {
+			if (snap == &snmpSnapshot->latency[i]) {
+				strncpy(tmpStr, getLatencyStageName(i), sizeof(tmpStr) - 1);
+			}
+		}
 		return SNMP_OCTETSTR(&tmpStr, strlen(tmpStr));
+	    case PTPBASE_PTPD_PERCENTILE_SAMPLES:
+		return SNMP_UNSIGNED(snap->count);
+	    case PTPBASE_PTPD_PERCENTILE_P50:
+		return SNMP_PERCENTILE_NS(snap->p50);
+	    case PTPBASE_PTPD_PERCENTILE_P99:
+		return SNMP_PERCENTILE_NS(snap->p99);
+	    case PTPBASE_PTPD_PERCENTILE_P999:
+		return SNMP_PERCENTILE_NS(snap->p999);
+	    case PTPBASE_PTPD_PERCENTILE_MAX:
+		return SNMP_PERCENTILE_NS(snap->max);
 	}
+#else
+	(void)index;
 #endif
 
 	return NULL;
@@ -1746,6 +2009,8 @@ static struct variable7 snmpVariables[] = {
 	  snmpPtpdSpecificCountersTable, 5, {1, 2, 21, 1, 9}},
 	{ PTPBASE_PTPD_SPECIFIC_COUNTERS_MAX_DELAY_DROPS, ASN_INTEGER, HANDLER_CAN_RONLY,
 	  snmpPtpdSpecificCountersTable, 5, {1, 2, 21, 1, 10}},
+	{ PTPBASE_PTPD_SPECIFIC_COUNTERS_SYNC_OVERRUNS, ASN_COUNTER, HANDLER_CAN_RONLY,
+	  snmpPtpdSpecificCountersTable, 5, {1, 2, 21, 1, 11}},
 	/* ptpBasePtpdSpecificData*/
 	{ PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYMS, ASN_OCTET_STR, HANDLER_CAN_RONLY,
 	  snmpPtpdSpecificDataTable, 5, {1, 2, 22, 1, 4}},
@@ -1754,7 +2019,39 @@ static struct variable7 snmpVariables[] = {
 	{ PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYSM, ASN_OCTET_STR, HANDLER_CAN_RONLY,
 	  snmpPtpdSpecificDataTable, 5, {1, 2, 22, 1, 6}},
 	{ PTPBASE_PTPD_SPECIFIC_DATA_RAW_DELAYSM_STRING, ASN_OCTET_STR, HANDLER_CAN_RONLY,
-	  snmpPtpdSpecificDataTable, 5, {1, 2, 22, 1, 7}}
+	  snmpPtpdSpecificDataTable, 5, {1, 2, 22, 1, 7}},
+	{ PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_ACTIVE, ASN_INTEGER, HANDLER_CAN_RONLY,
+	  snmpPtpdSpecificDataTable, 5, {1, 2, 22, 1, 8}},
+	{ PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_SECONDS, ASN_UNSIGNED, HANDLER_CAN_RONLY,
+	  snmpPtpdSpecificDataTable, 5, {1, 2, 22, 1, 9}},
+	{ PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_PREDICTED_DRIFT, ASN_INTEGER, HANDLER_CAN_RONLY,
+	  snmpPtpdSpecificDataTable, 5, {1, 2, 22, 1, 10}},
+	{ PTPBASE_PTPD_SPECIFIC_DATA_HOLDOVER_TIME_ERROR, ASN_INTEGER, HANDLER_CAN_RONLY,
+	  snmpPtpdSpecificDataTable, 5, {1, 2, 22, 1, 11}},
+	/* ptpbasePtpdStabilityTable */
+	{ PTPBASE_PTPD_STABILITY_TAU, ASN_UNSIGNED, HANDLER_CAN_RONLY,
+	  snmpPtpdStabilityTable, 5, {1, 2, 23, 1, 5}},
+	{ PTPBASE_PTPD_STABILITY_ADEV_STRING, ASN_OCTET_STR, HANDLER_CAN_RONLY,
+	  snmpPtpdStabilityTable, 5, {1, 2, 23, 1, 6}},
+	{ PTPBASE_PTPD_STABILITY_TDEV_STRING, ASN_OCTET_STR, HANDLER_CAN_RONLY,
+	  snmpPtpdStabilityTable, 5, {1, 2, 23, 1, 7}},
+	{ PTPBASE_PTPD_STABILITY_MTIE_STRING, ASN_OCTET_STR, HANDLER_CAN_RONLY,
+	  snmpPtpdStabilityTable, 5, {1, 2, 23, 1, 8}},
+	{ PTPBASE_PTPD_STABILITY_SAMPLES, ASN_UNSIGNED, HANDLER_CAN_RONLY,
+	  snmpPtpdStabilityTable, 5, {1, 2, 23, 1, 9}},
+	/* ptpbasePtpdPercentileTable */
+	{ PTPBASE_PTPD_PERCENTILE_NAME, ASN_OCTET_STR, HANDLER_CAN_RONLY,
+	  snmpPtpdPercentileTable, 5, {1, 2, 24, 1, 5}},
+	{ PTPBASE_PTPD_PERCENTILE_SAMPLES, ASN_UNSIGNED, HANDLER_CAN_RONLY,
+	  snmpPtpdPercentileTable, 5, {1, 2, 24, 1, 6}},
+	{ PTPBASE_PTPD_PERCENTILE_P50, ASN_INTEGER, HANDLER_CAN_RONLY,
+	  snmpPtpdPercentileTable, 5, {1, 2, 24, 1, 7}},
+	{ PTPBASE_PTPD_PERCENTILE_P99, ASN_INTEGER, HANDLER_CAN_RONLY,
+	  snmpPtpdPercentileTable, 5, {1, 2, 24, 1, 8}},
+	{ PTPBASE_PTPD_PERCENTILE_P999, ASN_INTEGER, HANDLER_CAN_RONLY,
+	  snmpPtpdPercentileTable, 5, {1, 2, 24, 1, 9}},
+	{ PTPBASE_PTPD_PERCENTILE_MAX, ASN_INTEGER, HANDLER_CAN_RONLY,
+	  snmpPtpdPercentileTable, 5, {1, 2, 24, 1, 10}}
 };
 
 /**
@@ -1825,6 +2122,10 @@ getNotifIndex(int eventType) {
 		    return 18;
 		case PTPBASE_NOTIFS_DOMAIN_MISMATCH_CLEARED:
 		    return 19;
+		case PTPBASE_NOTIFS_HOLDOVER:
+		    return 20;
+		case PTPBASE_NOTIFS_HOLDOVER_CLEARED:
+		    return 21;
 		default:
 		    return 0;
 	}
@@ -1863,7 +2164,7 @@ populateNotif (netsnmp_variable_list** varBinds, int eventType, PtpEventData *ev
 			snmp_varlist_add_variable(varBinds, ofmStringOid, OID_LENGTH(ofmStringOid),
 			    ASN_OCTET_STR, (u_char *) ofmStr, strlen(ofmStr));
 			snmp_varlist_add_variable(varBinds, thresholdOid, OID_LENGTH(thresholdOid),
-			    ASN_INTEGER, (u_char *) &eventData->ofmAlarmThreshold, sizeof(snmpRtOpts->ofmAlarmThreshold));
+			    ASN_INTEGER, (u_char *) &eventData->ofmAlarmThreshold, sizeof(eventData->ofmAlarmThreshold));
 		    }
 		    return;
 		case PTPBASE_NOTIFS_SLAVE_NO_SYNC:
@@ -2021,6 +2322,19 @@ populateNotif (netsnmp_variable_list** varBinds, int eventType, PtpEventData *ev
 			    ASN_INTEGER, (u_char *) &domainNumber, sizeof(domainNumber));
 		    }
 		    return;
+		case PTPBASE_NOTIFS_HOLDOVER:
+		case PTPBASE_NOTIFS_HOLDOVER_CLEARED:
+		    {
+			oid holdoverSecondsOid[] = { PTPBASE_MIB_OID, 1, 2, 22, 1, 9, PTPBASE_MIB_INDEX3 };
+			oid holdoverTimeErrorOid[] = { PTPBASE_MIB_OID, 1, 2, 22, 1, 11, PTPBASE_MIB_INDEX3 };
+			unsigned long holdoverSeconds = eventData->holdoverSeconds;
+			long holdoverTimeError = eventData->holdoverTimeError;
+			snmp_varlist_add_variable(varBinds, holdoverSecondsOid, OID_LENGTH(holdoverSecondsOid),
+			    ASN_UNSIGNED, (u_char *) &holdoverSeconds, sizeof(holdoverSeconds));
+			snmp_varlist_add_variable(varBinds, holdoverTimeErrorOid, OID_LENGTH(holdoverTimeErrorOid),
+			    ASN_INTEGER, (u_char *) &holdoverTimeError, sizeof(holdoverTimeError));
+		    }
+		    return;
 		default:
 		    return;
 	}
@@ -2058,11 +2372,167 @@ sendNotif(int eventType, PtpEventData *eventData) {
 }
 
 
+/* copy everything the MIB handlers read - protocol engine only */
+static void
+snmpFillSnapshot(SnmpTableSnapshot *snap, const RunTimeOpts *rtOpts, const PtpClock *ptpClock)
+{
+#ifdef PTPD_STATISTICS
+	int i;
+#endif /* PTPD_STATISTICS */
+
+	snap->defaultDS = ptpClock->defaultDS;
+	snap->currentDS = ptpClock->currentDS;
+	snap->parentDS = ptpClock->parentDS;
+	snap->timePropertiesDS = ptpClock->timePropertiesDS;
+	snap->portDS = ptpClock->portDS;
+	snap->counters = ptpClock->counters;
+	memcpy(snap->userDescription, ptpClock->userDescription, sizeof(snap->userDescription));
+
+	snap->sentPacketsTotal = ptpClock->netPath.sentPacketsTotal;
+	snap->receivedPacketsTotal = ptpClock->netPath.receivedPacketsTotal;
+	snap->interfaceAddr = ptpClock->netPath.interfaceAddr;
+	snap->ifIndex = ptpClock->netPath.interfaceInfo.ifIndex;
+
+	snap->bestMasterValid = (ptpClock->bestMaster != NULL);
+	snap->bestMasterAddr = ptpClock->bestMaster ? ptpClock->bestMaster->sourceAddr : 0;
+	snap->grantDuration = ptpClock->parentGrants ?
+		ptpClock->parentGrants->grantData[SYNC_INDEXED].duration : 0;
+	snap->number_foreign_records = ptpClock->number_foreign_records;
+	snap->unicastDestinationCount = ptpClock->unicastDestinationCount;
+	snap->slaveCount = ptpClock->slaveCount;
+	snap->syncOverruns = ptpClock->latency.syncOverruns;
+	snap->rawDelayMS = ptpClock->rawDelayMS;
+	snap->rawDelaySM = ptpClock->rawDelaySM;
+	snap->servo = ptpClock->servo;
+
+#ifdef PTPD_STATISTICS
+	snap->slaveStats = ptpClock->slaveStats;
+	snap->holdover = ptpClock->holdover;
+	/* the MTIE deque pointers are copied but never followed */
+	memcpy(snap->taus, ptpClock->stability.taus, sizeof(snap->taus));
+	memcpy(snap->histograms, ptpClock->histograms.snapshot, sizeof(snap->histograms));
+	for (i = 0; i < LATENCY_STAGE_MAX; i++) {
+		snap->latency[i] = ptpClock->latency.stages[i].snapshot;
+	}
+#endif /* PTPD_STATISTICS */
+
+	snap->ofmAlarmThreshold = rtOpts->ofmAlarmThreshold;
+	snap->transport = rtOpts->transport;
+	snap->ipMode = rtOpts->ipMode;
+	snap->unicastNegotiation = rtOpts->unicastNegotiation;
+	snap->statsUpdateInterval = rtOpts->statsUpdateInterval;
+
+}
+
+/* send notifications queued by the protocol engine - agent thread only */
+static void
+snmpSendQueuedNotifs()
+{
+
+	SnmpQueuedNotif *entry;
+	uint32_t tail = snmpAgent.notifTail;
+
+	while(tail != __atomic_load_n(&snmpAgent.notifHead, __ATOMIC_ACQUIRE)) {
+		entry = &snmpAgent.notifs[tail % SNMP_NOTIF_QUEUE];
+		sendNotif(entry->notifId, &entry->eventData);
+		tail++;
+		__atomic_store_n(&snmpAgent.notifTail, tail, __ATOMIC_RELEASE);
+	}
+
+}
+
+/* queue a notification for the agent thread - protocol engine only */
+static void
+snmpQueueNotif(int notifId, PtpEventData *eventData)
+{
+
+	SnmpQueuedNotif *entry;
+	uint32_t head = snmpAgent.notifHead;
+
+	if(!snmpAgent.started) {
+		return;
+	}
+
+	if(head - __atomic_load_n(&snmpAgent.notifTail, __ATOMIC_ACQUIRE) >= SNMP_NOTIF_QUEUE) {
+		snmpAgent.notifDropped++;
+		DBG("[snmp] Notification queue full, dropping notification %d\n", notifId);
+		return;
+	}
+
+	entry = &snmpAgent.notifs[head % SNMP_NOTIF_QUEUE];
+	entry->notifId = notifId;
+	memcpy(&entry->eventData, eventData, sizeof(PtpEventData));
+	__atomic_store_n(&snmpAgent.notifHead, head + 1, __ATOMIC_RELEASE);
+
+	/* a full pipe already means a wakeup is pending */
+	if(write(snmpAgent.wakeup[1], "", 1) < 0 && errno != EAGAIN) {
+		DBG("[snmp] Could not wake up agent thread: %s\n", strerror(errno));
+	}
+
+}
+
+/**
+ * AgentX session: everything the NetSNMP library does after
+ * initialisation happens on this thread.
+ */
+static void*
+snmpAgentThread(void *arg)
+{
+
+	fd_set readfds;
+	struct timeval tv;
+	int nfds, block, ret;
+	char buf[64];
+
+	while(__atomic_load_n(&snmpAgent.running, __ATOMIC_ACQUIRE)) {
+
+		FD_ZERO(&readfds);
+		FD_SET(snmpAgent.wakeup[0], &readfds);
+		nfds = snmpAgent.wakeup[0] + 1;
+		block = 0;
+		tv.tv_sec = SNMP_AGENT_IDLE_MS / 1000;
+		tv.tv_usec = (SNMP_AGENT_IDLE_MS % 1000) * 1000;
+		snmp_select_info(&nfds, &readfds, &tv, &block);
+
+		ret = select(nfds, &readfds, NULL, NULL, &tv);
+
+		if(ret < 0) {
+			if(errno != EINTR) {
+				PERROR("[snmp] select() failed in agent thread");
+			}
+			continue;
+		}
+
+		if(ret > 0 && FD_ISSET(snmpAgent.wakeup[0], &readfds)) {
+			while(read(snmpAgent.wakeup[0], buf, sizeof(buf)) > 0);
+		}
+
+		pthread_mutex_lock(&snmpAgent.snapshotLock);
+		if(ret > 0) {
+			snmp_read(&readfds);
+		} else {
+			snmp_timeout();
+			run_alarms();
+		}
+		netsnmp_check_outstanding_agent_requests();
+		snmpSendQueuedNotifs();
+		pthread_mutex_unlock(&snmpAgent.snapshotLock);
+
+	}
+
+	return NULL;
+
+}
+
 /**
  * Initialisation of SNMP subsystem.
  */
 void
 snmpInit(RunTimeOpts *rtOpts, PtpClock *ptpClock) {
+
+	sigset_t mask, oldMask;
+	int ret;
+
 	netsnmp_enable_subagent();
 	snmp_disable_log();
 	snmp_enable_calllog();
@@ -2074,10 +2544,80 @@ snmpInit(RunTimeOpts *rtOpts, PtpClock *ptpClock) {
 	REGISTER_MIB("ptpMib", snmpVariables, variable7, ptp_oid);
 	init_snmp("ptpAgent");
 
-	/* Currently, ptpd only handles one clock. We put it in a
-	 * global variable for the need of our subsystem. */
-	snmpPtpClock = ptpClock;
-	snmpRtOpts = rtOpts;
+	/* Currently, ptpd only handles one clock. The first snapshot
+	 * is taken before anything can be served from it. */
+	snmpSnapshot = &snmpAgent.snapshots[0];
+	snmpAgent.back = &snmpAgent.snapshots[1];
+	snmpFillSnapshot(snmpSnapshot, rtOpts, ptpClock);
+	snmpAgent.clearRequests = 0;
+	snmpAgent.notifHead = 0;
+	snmpAgent.notifTail = 0;
+	snmpAgent.notifDropped = 0;
+
+	if(pipe(snmpAgent.wakeup) < 0) {
+		PERROR("[snmp] Could not create agent wakeup pipe");
+		return;
+	}
+	fcntl(snmpAgent.wakeup[0], F_SETFL, O_NONBLOCK);
+	fcntl(snmpAgent.wakeup[1], F_SETFL, O_NONBLOCK);
+	pthread_mutex_init(&snmpAgent.snapshotLock, NULL);
+	snmpAgent.running = 1;
+
+	/* signals are handled by the main thread only */
+	sigfillset(&mask);
+	pthread_sigmask(SIG_SETMASK, &mask, &oldMask);
+	ret = pthread_create(&snmpAgent.thread, NULL, snmpAgentThread, NULL);
+	pthread_sigmask(SIG_SETMASK, &oldMask, NULL);
+
+	if(ret != 0) {
+		ERROR("[snmp] Could not start SNMP agent thread: %s\n", strerror(ret));
+		pthread_mutex_destroy(&snmpAgent.snapshotLock);
+		close(snmpAgent.wakeup[0]);
+		close(snmpAgent.wakeup[1]);
+		return;
+	}
+
+	snmpAgent.started = TRUE;
+	timerStart(&ptpClock->timers[SNMP_UPDATE_TIMER], rtOpts->snmpSnapshotInterval);
+
+}
+
+/**
+ * Publish a fresh table snapshot and apply counter clears requested
+ * through SNMP. Never waits for the agent: if it is in the middle of
+ * a request, the publish is retried shortly.
+ */
+void
+snmpUpdate(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	SnmpTableSnapshot *front;
+	int clear;
+
+	if(!snmpAgent.started) {
+		return;
+	}
+
+	clear = __atomic_exchange_n(&snmpAgent.clearRequests, 0, __ATOMIC_ACQUIRE);
+	if(clear) {
+		snmpClearCounters(ptpClock, clear);
+	}
+
+	snmpFillSnapshot(snmpAgent.back, rtOpts, ptpClock);
+
+	if(pthread_mutex_trylock(&snmpAgent.snapshotLock) != 0) {
+		DBGV("[snmp] Agent busy, snapshot publish deferred\n");
+		timerStart(&ptpClock->timers[SNMP_UPDATE_TIMER], SNMP_SNAPSHOT_RETRY);
+		return;
+	}
+
+	front = snmpSnapshot;
+	snmpSnapshot = snmpAgent.back;
+	snmpAgent.back = front;
+	pthread_mutex_unlock(&snmpAgent.snapshotLock);
+
+	/* ensures that the current update interval is used */
+	timerStart(&ptpClock->timers[SNMP_UPDATE_TIMER], rtOpts->snmpSnapshotInterval);
 
 }
 
@@ -2087,6 +2627,24 @@ snmpInit(RunTimeOpts *rtOpts, PtpClock *ptpClock) {
 
 void
 snmpShutdown() {
+
+	char c = 0;
+
+	if(snmpAgent.started) {
+		__atomic_store_n(&snmpAgent.running, 0, __ATOMIC_RELEASE);
+		if(write(snmpAgent.wakeup[1], &c, 1) < 0) {
+			DBG("[snmp] Could not wake up agent thread: %s\n", strerror(errno));
+		}
+		pthread_join(snmpAgent.thread, NULL);
+		pthread_mutex_destroy(&snmpAgent.snapshotLock);
+		close(snmpAgent.wakeup[0]);
+		close(snmpAgent.wakeup[1]);
+		snmpAgent.started = FALSE;
+		if(snmpAgent.notifDropped) {
+			WARNING("[snmp] Dropped %d notifications since start\n", snmpAgent.notifDropped);
+		}
+	}
+
 	unregister_mib(ptp_oid, sizeof(ptp_oid) / sizeof(oid));
 	snmp_shutdown("ptpMib");
 	SOCK_CLEANUP;
@@ -2125,6 +2683,9 @@ alarmHandler_snmp(AlarmEntry *alarm)
 		case ALRM_DOMAIN_MISMATCH:
 		    notifId = PTPBASE_NOTIFS_DOMAIN_MISMATCH;
 		    break;
+		case ALRM_HOLDOVER:
+		    notifId = PTPBASE_NOTIFS_HOLDOVER;
+		    break;
 	    }
 	}
 
@@ -2155,6 +2716,9 @@ alarmHandler_snmp(AlarmEntry *alarm)
 		case ALRM_DOMAIN_MISMATCH:
 		    notifId = PTPBASE_NOTIFS_DOMAIN_MISMATCH_CLEARED;
 		    break;
+		case ALRM_HOLDOVER:
+		    notifId = PTPBASE_NOTIFS_HOLDOVER_CLEARED;
+		    break;
 	    }
 	}
 
@@ -2177,7 +2741,7 @@ alarmHandler_snmp(AlarmEntry *alarm)
 
 
 	if(notifId >= 0) {
-	    sendNotif(notifId, &alarm->eventData);
+	    snmpQueueNotif(notifId, &alarm->eventData);
 	    return;
 	}
 
@@ -0,0 +1,501 @@
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file    sockserver.c
+ * @authors The PTPd Project
+ * @date   Fri Feb 5 10:12:37 2016
+ * This source file contains the non-blocking local socket server used by
+ * the OpenMetrics exporter and the control socket: listener setup on a
+ * Unix or TCP socket, client slots, select() integration and idle
+ * timeouts. Requests are read into the client's request buffer and the
+ * user's respond() callback renders replies a buffer at a time, so a slow
+ * client never holds up the protocol engine.
+ */
+
+#include "../ptpd.h"
+
+#include <sys/un.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif /* MSG_NOSIGNAL */
+
+static Boolean
+setNonBlocking(int fd)
+{
+	int flags = fcntl(fd, F_GETFL, 0);
+
+	return (flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) >= 0);
+}
+
+static int
+openUnixListener(SocketServer *server, const char *path)
+{
+
+	struct sockaddr_un sun;
+	struct stat st;
+	int fd;
+
+	if(path[0] != '/' || strlen(path) >= sizeof(sun.sun_path)) {
+		ERROR("Invalid %s socket path: %s\n", server->name, path);
+		return -1;
+	}
+
+	memset(&sun, 0, sizeof(sun));
+	sun.sun_family = AF_UNIX;
+	memcpy(sun.sun_path, path, strlen(path));
+
+	/* clean up after an unclean shutdown, but never remove anything but a socket */
+	if(lstat(path, &st) == 0) {
+		if(!S_ISSOCK(st.st_mode)) {
+			ERROR("Path %s for the %s socket exists and is not a socket\n", path, server->name);
+			return -1;
+		}
+		unlink(path);
+	}
+
+	if((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		PERROR("Could not create %s socket", server->name);
+		return -1;
+	}
+
+	if(bind(fd, (struct sockaddr*)&sun, sizeof(sun)) < 0) {
+		PERROR("Could not bind %s socket to %s", server->name, path);
+		close(fd);
+		return -1;
+	}
+
+	/* a socket that can change the configuration is for the owner only */
+	if(server->ownerOnly && chmod(path, S_IRUSR | S_IWUSR) < 0) {
+		PERROR("Could not set permissions of %s socket %s", server->name, path);
+		close(fd);
+		unlink(path);
+		return -1;
+	}
+
+	return fd;
+
+}
+
+/* [host:]port, IPv4 */
+static int
+openTcpListener(SocketServer *server, const char *address)
+{
+
+	struct sockaddr_in sin;
+	char host[INET_ADDRSTRLEN + 1];
+	const char *port;
+	int fd, one = 1;
+	long portNumber;
+	char *end;
+
+	memset(host, 0, sizeof(host));
+	if((port = strrchr(address, ':')) != NULL) {
+		if(port - address > INET_ADDRSTRLEN) {
+			ERROR("Invalid %s address: %s\n", server->name, address);
+			return -1;
+		}
+		memcpy(host, address, port - address);
+		port++;
+	} else {
+		port = address;
+	}
+
+	if(strlen(host) == 0) {
+		strcpy(host, "127.0.0.1");
+	}
+
+	portNumber = strtol(port, &end, 10);
+	if(*port == '\0' || *end != '\0' || portNumber < 1 || portNumber > 65535) {
+		ERROR("Invalid %s port: %s\n", server->name, address);
+		return -1;
+	}
+
+	memset(&sin, 0, sizeof(sin));
+	sin.sin_family = AF_INET;
+	sin.sin_port = htons(portNumber);
+	if(inet_pton(AF_INET, host, &sin.sin_addr) != 1) {
+		ERROR("Invalid %s listen address: %s\n", server->name, host);
+		return -1;
+	}
+
+	if((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+		PERROR("Could not create %s socket", server->name);
+		return -1;
+	}
+
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+	if(bind(fd, (struct sockaddr*)&sin, sizeof(sin)) < 0) {
+		PERROR("Could not bind %s socket to %s", server->name, address);
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+
+}
+
+/* hand the server a client slot with its buffers - at startup, once per slot */
+void
+socketServerAddClient(SocketServer *server, SocketClient *client,
+		      char *request, int requestSize, char *buffer, int bufferSize)
+{
+
+	if(server->clientCount >= SOCKSERVER_MAX_CLIENTS) {
+		return;
+	}
+
+	memset(client, 0, sizeof(SocketClient));
+	client->fd = -1;
+	client->request = request;
+	client->requestSize = requestSize;
+	client->buffer = buffer;
+	client->bufferSize = bufferSize;
+
+	server->clients[server->clientCount++] = client;
+
+}
+
+/* listen on address, moving the server if it listens elsewhere - TRUE if listening */
+Boolean
+socketServerStart(SocketServer *server, const char *address)
+{
+
+	int fd;
+
+	if(server->listenFd >= 0) {
+		if(!strcmp(server->address, address)) {
+			return TRUE;
+		}
+		socketServerStop(server);
+	}
+
+	server->listenUnix = (address[0] == '/' || !server->allowTcp);
+
+	if(server->listenUnix) {
+		fd = openUnixListener(server, address);
+	} else {
+		fd = openTcpListener(server, address);
+	}
+
+	if(fd < 0) {
+		return FALSE;
+	}
+
+	if(listen(fd, SOCKSERVER_BACKLOG) < 0 || !setNonBlocking(fd)) {
+		PERROR("Could not listen on %s socket %s", server->name, address);
+		close(fd);
+		if(server->listenUnix) {
+			unlink(address);
+		}
+		return FALSE;
+	}
+
+	server->listenFd = fd;
+	snprintf(server->address, sizeof(server->address), "%s", address);
+	INFO("Listening for %s requests on %s\n", server->name, server->address);
+
+	return TRUE;
+
+}
+
+void
+socketServerStop(SocketServer *server)
+{
+
+	int i;
+
+	if(server->listenFd < 0) {
+		return;
+	}
+
+	for(i = 0; i < server->clientCount; i++) {
+		socketClientClose(server->clients[i]);
+	}
+
+	close(server->listenFd);
+	server->listenFd = -1;
+	if(server->listenUnix) {
+		unlink(server->address);
+	}
+	memset(server->address, 0, sizeof(server->address));
+
+}
+
+/* add the server's sockets to the select() sets */
+void
+socketServerSelectInfo(SocketServer *server, int *nfds, fd_set *readfds, fd_set *writefds)
+{
+
+	Boolean slotFree = FALSE;
+	SocketClient *client;
+	int i;
+
+	if(server->listenFd < 0) {
+		return;
+	}
+
+	for(i = 0; i < server->clientCount; i++) {
+		client = server->clients[i];
+		if(client->fd < 0) {
+			slotFree = TRUE;
+			continue;
+		}
+		/* a client with a response pending is not read from until it has gone */
+		FD_SET(client->fd, client->writing ? writefds : readfds);
+		if(client->fd >= *nfds) {
+			*nfds = client->fd + 1;
+		}
+	}
+
+	/* when all slots are busy, new connections wait in the listen backlog */
+	if(slotFree) {
+		FD_SET(server->listenFd, readfds);
+		if(server->listenFd >= *nfds) {
+			*nfds = server->listenFd + 1;
+		}
+	}
+
+}
+
+void
+socketClientClose(SocketClient *client)
+{
+	if(client->fd >= 0) {
+		close(client->fd);
+	}
+	client->fd = -1;
+	client->writing = FALSE;
+}
+
+static void
+readRequest(SocketClient *client, const TimeInternal *now)
+{
+
+	ssize_t ret;
+
+	ret = recv(client->fd, client->request + client->requestLength,
+		    client->requestSize - client->requestLength, 0);
+
+	if(ret == 0 || (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+		socketClientClose(client);
+		return;
+	}
+
+	if(ret < 0) {
+		return;
+	}
+
+	client->lastActivity = *now;
+	client->requestLength += ret;
+	client->request[client->requestLength] = '\0';
+
+}
+
+/* send what we can, asking for more of the response each time the buffer has gone */
+static void
+writeResponse(SocketServer *server, SocketClient *client, const TimeInternal *now)
+{
+
+	ssize_t ret;
+
+	for(;;) {
+
+		if(client->bufferSent == client->bufferLength) {
+			client->bufferLength = 0;
+			client->bufferSent = 0;
+			client->overflow = FALSE;
+			server->respond(client);
+			if(client->fd < 0) {
+				return;
+			}
+			client->writing = (client->bufferLength > 0);
+			if(!client->writing) {
+				return;
+			}
+		}
+
+		ret = send(client->fd, client->buffer + client->bufferSent,
+			    client->bufferLength - client->bufferSent, MSG_NOSIGNAL);
+
+		if(ret < 0) {
+			if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+				socketClientClose(client);
+			}
+			return;
+		}
+
+		client->lastActivity = *now;
+		client->bufferSent += ret;
+
+	}
+
+}
+
+static void
+acceptClient(SocketServer *server, const TimeInternal *now)
+{
+
+	SocketClient *client = NULL;
+	int fd, i;
+
+	for(i = 0; i < server->clientCount; i++) {
+		if(server->clients[i]->fd < 0) {
+			client = server->clients[i];
+			break;
+		}
+	}
+
+	if(client == NULL) {
+		return;
+	}
+
+	if((fd = accept(server->listenFd, NULL, NULL)) < 0) {
+		return;
+	}
+
+	if(!setNonBlocking(fd)) {
+		close(fd);
+		return;
+	}
+
+	client->fd = fd;
+	client->writing = FALSE;
+	client->overflow = FALSE;
+	client->requestLength = 0;
+	client->request[0] = '\0';
+	client->bufferLength = 0;
+	client->bufferSent = 0;
+	client->lastActivity = *now;
+
+	if(server->connected != NULL) {
+		server->connected(client);
+	}
+
+}
+
+/*
+ * service the server's sockets after select() - with NULL sets (select()
+ * failed or timed out) only the idle timeouts are checked.
+ */
+void
+socketServerProcess(SocketServer *server, fd_set *readfds, fd_set *writefds)
+{
+
+	SocketClient *client;
+	TimeInternal now, idle;
+	int i;
+
+	if(server->listenFd < 0) {
+		return;
+	}
+
+	getTimeMonotonic(&now);
+
+	for(i = 0; i < server->clientCount; i++) {
+
+		client = server->clients[i];
+
+		if(client->fd < 0) {
+			continue;
+		}
+
+		if(client->writing) {
+			if(writefds != NULL && FD_ISSET(client->fd, writefds)) {
+				writeResponse(server, client, &now);
+			}
+		} else if(readfds != NULL && FD_ISSET(client->fd, readfds)) {
+			readRequest(client, &now);
+			/* the socket is almost certainly writable, reply straight away */
+			if(client->fd >= 0) {
+				writeResponse(server, client, &now);
+			}
+		}
+
+		if(client->fd < 0) {
+			continue;
+		}
+
+		subTime(&idle, &now, &client->lastActivity);
+		if(idle.seconds >= server->idleTimeout) {
+			DBG("Dropping idle %s client\n", server->name);
+			socketClientClose(client);
+		}
+
+	}
+
+	if(readfds != NULL && FD_ISSET(server->listenFd, readfds)) {
+		acceptClient(server, &now);
+	}
+
+}
+
+/* append to the response - once something does not fit, nothing more is appended */
+void
+socketClientAppend(SocketClient *client, const char *format, ...)
+{
+
+	va_list ap;
+	int len;
+	int space = client->bufferSize - client->bufferLength;
+
+	if(client->overflow) {
+		return;
+	}
+
+	va_start(ap, format);
+	len = vsnprintf(client->buffer + client->bufferLength, space, format, ap);
+	va_end(ap);
+
+	if(len < 0 || len >= space) {
+		client->overflow = TRUE;
+		return;
+	}
+
+	client->bufferLength += len;
+
+}
+
+void
+socketClientAppendClockIdentity(SocketClient *client, const ClockIdentity id)
+{
+	int i;
+
+	for(i = 0; i < CLOCK_IDENTITY_LENGTH; i++) {
+		socketClientAppend(client, "%02x", (unsigned char)id[i]);
+	}
+}
+
+void
+socketClientAppendPortIdentity(SocketClient *client, const PortIdentity *id)
+{
+	socketClientAppendClockIdentity(client, id->clockIdentity);
+	socketClientAppend(client, "/%d", (unsigned)id->portNumber);
+}
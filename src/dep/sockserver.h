@@ -0,0 +1,92 @@
+#ifndef PTPDSOCKSERVER_H_
+#define PTPDSOCKSERVER_H_
+
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file    sockserver.h
+ * @authors The PTPd Project
+ * @date   Fri Feb 5 10:12:37 2016
+ * Data type and function definitions for the non-blocking local socket
+ * server shared by the OpenMetrics exporter and the control socket.
+ */
+
+#include "datatypes_dep.h"
+
+#define SOCKSERVER_MAX_CLIENTS	4
+#define SOCKSERVER_BACKLOG	8
+
+/* one connection - the request and response buffers belong to the user */
+typedef struct {
+	int fd;
+	Boolean writing;		/* response pending: waiting to send, not reading */
+	Boolean overflow;		/* an append did not fit in the response buffer */
+	char *request;			/* requestSize + 1 bytes, always NUL-terminated */
+	int requestSize;
+	int requestLength;
+	char *buffer;
+	int bufferSize;
+	int bufferLength;
+	int bufferSent;
+	TimeInternal lastActivity;
+} SocketClient;
+
+typedef struct {
+	/* set by the user */
+	const char *name;		/* for log messages */
+	Boolean allowTcp;		/* accept [host:]port as well as a socket path */
+	Boolean ownerOnly;		/* Unix socket accessible by the owner only */
+	int idleTimeout;		/* seconds without progress before dropping a client */
+	/* a client was accepted - reset the per-connection state */
+	void (*connected)(SocketClient *client);
+	/*
+	 * the response buffer is empty: render more of the response from what
+	 * is in the request buffer. Leaving the buffer empty goes back to
+	 * reading requests, closing the client ends the connection.
+	 */
+	void (*respond)(SocketClient *client);
+	/* internal */
+	int listenFd;
+	Boolean listenUnix;
+	char address[PATH_MAX + 1];
+	int clientCount;
+	SocketClient *clients[SOCKSERVER_MAX_CLIENTS];
+} SocketServer;
+
+void socketServerAddClient(SocketServer *server, SocketClient *client,
+			   char *request, int requestSize, char *buffer, int bufferSize);
+Boolean socketServerStart(SocketServer *server, const char *address);
+void socketServerStop(SocketServer *server);
+void socketServerSelectInfo(SocketServer *server, int *nfds, fd_set *readfds, fd_set *writefds);
+void socketServerProcess(SocketServer *server, fd_set *readfds, fd_set *writefds);
+void socketClientClose(SocketClient *client);
+void socketClientAppend(SocketClient *client, const char *format, ...);
+void socketClientAppendClockIdentity(SocketClient *client, const ClockIdentity id);
+void socketClientAppendPortIdentity(SocketClient *client, const PortIdentity *id);
+
+#endif /*PTPDSOCKSERVER_H_*/
@@ -131,18 +131,26 @@ void
 do_signal_close(PtpClock * ptpClock)
 {
 
+	extern RunTimeOpts rtOpts;
+
+	/* only a clean stop may leave the unicast grants to the restarted daemon */
+	ptpClock->keepGrants = rtOpts.warmStartKeepGrants;
+
 	timingDomain.shutdown(&timingDomain);
 
 	NOTIFY("Shutdown on close signal\n");
 	exit(0);
 }
 
-void
+/* returns FALSE if the configuration has errors or could not be applied */
+Boolean
 applyConfig(dictionary *baseConfig, RunTimeOpts *rtOpts, PtpClock *ptpClock)
 {
 
 	Boolean reloadSuccessful = TRUE;
 
+	/* changes applied since the main loop last ran restartSubsystems() */
+	int pendingRestart = rtOpts->restartSubsystems > 0 ? rtOpts->restartSubsystems : 0;
 
 	/* Load default config to fill in the blanks in the config file */
 	RunTimeOpts tmpOpts;
@@ -151,7 +159,7 @@ applyConfig(dictionary *baseConfig, RunTimeOpts *rtOpts, PtpClock *ptpClock)
 	/* Check the new configuration for errors, fill in the blanks from defaults */
 	if( ( rtOpts->candidateConfig = parseConfig(CFGOP_PARSE, NULL, baseConfig, &tmpOpts)) == NULL ) {
 	    WARNING("Configuration has errors, reload aborted\n");
-	    return;
+	    return FALSE;
 	}
 
 	/* Check for changes between old and new configuration */
@@ -210,7 +218,7 @@ applyConfig(dictionary *baseConfig, RunTimeOpts *rtOpts, PtpClock *ptpClock)
 
 	if(!reloadSuccessful) {
 		ERROR("New configuration cannot be applied - aborting reload\n");
-		rtOpts->restartSubsystems = 0;
+		rtOpts->restartSubsystems = pendingRestart;
 		goto cleanup;
 	}
 
@@ -238,10 +246,17 @@ applyConfig(dictionary *baseConfig, RunTimeOpts *rtOpts, PtpClock *ptpClock)
 			abort();
 		}
 
+		/* keep what earlier changes still need applied, unless a full restart covers them */
+		if(rtOpts->restartSubsystems != -1) {
+			rtOpts->restartSubsystems |= pendingRestart;
+		}
+
 	/* clean up */
 	cleanup:
 
 		dictionary_del(&rtOpts->candidateConfig);
+
+		return reloadSuccessful;
 }
 
 
@@ -304,15 +319,157 @@ do_signal_sighup(RunTimeOpts * rtOpts, PtpClock * ptpClock)
 
 }
 
+static void
+applyDatasetConfig(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+	updateDatasets(ptpClock, rtOpts);
+}
+
+static void
+applyLoggingConfig(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+	/* log files themselves are reopened by the SIGHUP handler */
+	metricsInit(rtOpts, ptpClock);
+	controlInit(rtOpts, ptpClock);
+}
+
+static void
+applyAclConfig(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+	/* re-compile ACLs */
+	freeIpv4AccessList(&ptpClock->netPath.timingAcl);
+	freeIpv4AccessList(&ptpClock->netPath.managementAcl);
+	if(rtOpts->timingAclEnabled) {
+		ptpClock->netPath.timingAcl=createIpv4AccessList(rtOpts->timingAclPermitText,
+		    rtOpts->timingAclDenyText, rtOpts->timingAclOrder);
+	}
+	if(rtOpts->managementAclEnabled) {
+		ptpClock->netPath.managementAcl=createIpv4AccessList(rtOpts->managementAclPermitText,
+		    rtOpts->managementAclDenyText, rtOpts->managementAclOrder);
+	}
+}
+
+static void
+applyAlarmConfig(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+	configureAlarms(ptpClock->alarms, ALRM_MAX, (void*)ptpClock);
+}
+
+#ifdef PTPD_STATISTICS
+/* Reinitialising the outlier filter containers */
+static void
+applyFilterConfig(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	freeDoubleMovingStatFilter(&ptpClock->filterMS);
+	freeDoubleMovingStatFilter(&ptpClock->filterSM);
+
+	ptpClock->oFilterMS.shutdown(&ptpClock->oFilterMS);
+	ptpClock->oFilterSM.shutdown(&ptpClock->oFilterSM);
+
+	outlierFilterSetup(&ptpClock->oFilterMS);
+	outlierFilterSetup(&ptpClock->oFilterSM);
+
+	ptpClock->oFilterMS.init(&ptpClock->oFilterMS,&rtOpts->oFilterMSConfig, "delayMS");
+	ptpClock->oFilterSM.init(&ptpClock->oFilterSM,&rtOpts->oFilterSMConfig, "delaySM");
+
+	if(rtOpts->filterMSOpts.enabled) {
+		ptpClock->filterMS = createDoubleMovingStatFilter(&rtOpts->filterMSOpts,"delayMS");
+	}
+
+	if(rtOpts->filterSMOpts.enabled) {
+		ptpClock->filterSM = createDoubleMovingStatFilter(&rtOpts->filterSMOpts, "delaySM");
+	}
+
+}
+#endif /* PTPD_STATISTICS */
+
+/* re-arm running timers whose interval comes straight from the configuration */
+static void
+applyTimerConfig(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	IntervalTimer *timer;
+
+	timer = &ptpClock->timers[CLOCK_UPDATE_TIMER];
+	if(timerRunning(timer)) {
+		if(rtOpts->clockUpdateTimeout > 0) {
+			timerStart(timer, rtOpts->clockUpdateTimeout);
+		} else {
+			timerStop(timer);
+		}
+	}
+
+	/* a pending servo update goes out at the new interval, or straight away if now disabled */
+	timer = &ptpClock->timers[SERVO_UPDATE_TIMER];
+	if(timerRunning(timer)) {
+		if(rtOpts->servoUpdateInterval > 0.0) {
+			timerStart(timer, rtOpts->servoUpdateInterval);
+		} else {
+			timerStop(timer);
+			runServoUpdate(rtOpts, ptpClock);
+		}
+	}
+
+	if(ptpClock->portDS.portState == PTP_MASTER) {
+		timer = &ptpClock->timers[MASTER_NETREFRESH_TIMER];
+		if(rtOpts->do_IGMP_refresh &&
+		    rtOpts->transport == UDP_IPV4 &&
+		    rtOpts->ipMode != IPMODE_UNICAST &&
+		    rtOpts->masterRefreshInterval > 9) {
+			timerStart(timer, rtOpts->masterRefreshInterval);
+		} else {
+			timerStop(timer);
+		}
+	}
+
+}
+
+static void
+applySocketConfig(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+	netApplySocketOptions(&ptpClock->netPath, rtOpts);
+}
+
+/*
+ * Live configuration handlers, run in this order for every subsystem flag
+ * set by checkSubsystemRestart(). Options pick their handler through the
+ * restart flags they are mapped with in parseConfig().
+ */
+static const struct {
+	int flags;
+	const char *description;
+	void (*apply)(RunTimeOpts *rtOpts, PtpClock *ptpClock);
+} configHandlers[] = {
+	{ PTPD_UPDATE_DATASETS,	"PTP engine configuration: updating datasets",	applyDatasetConfig },
+	{ PTPD_UPDATE_TIMERS,	"timer configuration: re-arming timers",	applyTimerConfig },
+	{ PTPD_UPDATE_SOCKETS,	"socket options",				applySocketConfig },
+	{ PTPD_RESTART_LOGGING,	"logging configuration: restarting logging",	applyLoggingConfig },
+	{ PTPD_RESTART_ACLS,	"access control list configuration",		applyAclConfig },
+	{ PTPD_RESTART_ALARMS,	"alarm configuration",				applyAlarmConfig },
+#ifdef PTPD_STATISTICS
+	{ PTPD_RESTART_FILTERS,	"filter configuration: re-initialising filters", applyFilterConfig },
+#endif /* PTPD_STATISTICS */
+};
+
+/* port re-initialisation re-reads everything these handlers would apply */
+#define PTPD_REINIT_COVERS (PTPD_UPDATE_DATASETS | PTPD_UPDATE_TIMERS | PTPD_UPDATE_SOCKETS)
+
 void
 restartSubsystems(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 {
+
+		int flags = rtOpts->restartSubsystems;
+		int i;
+
 			DBG("RestartSubsystems: %d\n",rtOpts->restartSubsystems);
+		    /* new configuration may show in management responses */
+		    ptpClock->datasetGeneration++;
 		    /* So far, PTP_INITIALIZING is required for both network and protocol restart */
-		    if((rtOpts->restartSubsystems & PTPD_RESTART_PROTOCOL) ||
-			(rtOpts->restartSubsystems & PTPD_RESTART_NETWORK)) {
+		    if((flags & PTPD_RESTART_PROTOCOL) ||
+			(flags & PTPD_RESTART_NETWORK)) {
 
-			    if(rtOpts->restartSubsystems & PTPD_RESTART_NETWORK) {
+			    if(flags & PTPD_RESTART_NETWORK) {
 				NOTIFY("Applying network configuration: going into PTP_INITIALIZING\n");
 			    }
 
@@ -321,7 +478,7 @@ restartSubsystems(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 			    ptpClock->defaultDS.slaveOnly = rtOpts->slaveOnly;
 			    ptpClock->disabled = rtOpts->portDisabled;
 
-			    if(rtOpts->restartSubsystems & PTPD_RESTART_PROTOCOL) {
+			    if(flags & PTPD_RESTART_PROTOCOL) {
 				INFO("Applying protocol configuration: going into %s\n",
 				ptpClock->disabled ? "PTP_DISABLED" : "PTP_INITIALIZING");
 			    }
@@ -330,80 +487,29 @@ restartSubsystems(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 			    ptpClock->runningBackupInterface = FALSE;
 			    toState(ptpClock->disabled ? PTP_DISABLED : PTP_INITIALIZING, rtOpts, ptpClock);
 
-		    } else {
-		    /* Nothing happens here for now - SIGHUP handler does this anyway */
-		    if(rtOpts->restartSubsystems & PTPD_UPDATE_DATASETS) {
-				NOTIFY("Applying PTP engine configuration: updating datasets\n");
-				updateDatasets(ptpClock, rtOpts);
-		    }}
-		    /* Nothing happens here for now - SIGHUP handler does this anyway */
-		    if(rtOpts->restartSubsystems & PTPD_RESTART_LOGGING) {
-				NOTIFY("Applying logging configuration: restarting logging\n");
-		    }
-
-
-    		if(rtOpts->restartSubsystems & PTPD_RESTART_ACLS) {
-            		NOTIFY("Applying access control list configuration\n");
-            		/* re-compile ACLs */
-            		freeIpv4AccessList(&ptpClock->netPath.timingAcl);
-            		freeIpv4AccessList(&ptpClock->netPath.managementAcl);
-            		if(rtOpts->timingAclEnabled) {
-                    	    ptpClock->netPath.timingAcl=createIpv4AccessList(rtOpts->timingAclPermitText,
-                                rtOpts->timingAclDenyText, rtOpts->timingAclOrder);
-            		}
-            		if(rtOpts->managementAclEnabled) {
-                    	    ptpClock->netPath.managementAcl=createIpv4AccessList(rtOpts->managementAclPermitText,
-                                rtOpts->managementAclDenyText, rtOpts->managementAclOrder);
-            		}
-    		}
-
-    		if(rtOpts->restartSubsystems & PTPD_RESTART_ALARMS) {
-		    NOTIFY("Applying alarm configuration\n");
-		    configureAlarms(ptpClock->alarms, ALRM_MAX, (void*)ptpClock);
-		}
-
-#ifdef PTPD_STATISTICS
-                    /* Reinitialising the outlier filter containers */
-                    if(rtOpts->restartSubsystems & PTPD_RESTART_FILTERS) {
-
-                                NOTIFY("Applying filter configuration: re-initialising filters\n");
-
-				freeDoubleMovingStatFilter(&ptpClock->filterMS);
-				freeDoubleMovingStatFilter(&ptpClock->filterSM);
-
-				ptpClock->oFilterMS.shutdown(&ptpClock->oFilterMS);
-				ptpClock->oFilterSM.shutdown(&ptpClock->oFilterSM);
-
-				outlierFilterSetup(&ptpClock->oFilterMS);
-				outlierFilterSetup(&ptpClock->oFilterSM);
-
-				ptpClock->oFilterMS.init(&ptpClock->oFilterMS,&rtOpts->oFilterMSConfig, "delayMS");
-				ptpClock->oFilterSM.init(&ptpClock->oFilterSM,&rtOpts->oFilterSMConfig, "delaySM");
-
-
-				if(rtOpts->filterMSOpts.enabled) {
-					ptpClock->filterMS = createDoubleMovingStatFilter(&rtOpts->filterMSOpts,"delayMS");
-				}
-
-				if(rtOpts->filterSMOpts.enabled) {
-					ptpClock->filterSM = createDoubleMovingStatFilter(&rtOpts->filterSMOpts, "delaySM");
-				}
+			    flags &= ~(PTPD_REINIT_COVERS);
 
 		    }
-#endif /* PTPD_STATISTICS */
 
+		    /* everything else is applied in place, without touching port state */
+		    for(i = 0; i < sizeof(configHandlers) / sizeof(configHandlers[0]); i++) {
+			    if(flags & configHandlers[i].flags) {
+				NOTIFY("Applying %s\n", configHandlers[i].description);
+				configHandlers[i].apply(rtOpts, ptpClock);
+			    }
+		    }
 
 	    ptpClock->timingService.reloadRequested = TRUE;
 
-            if(rtOpts->restartSubsystems & PTPD_RESTART_NTPENGINE && timingDomain.serviceCount > 1) {
+            if(flags & PTPD_RESTART_NTPENGINE && timingDomain.serviceCount > 1) {
 		ptpClock->ntpControl.timingService.shutdown(&ptpClock->ntpControl.timingService);
 	    }
 
-	    if((rtOpts->restartSubsystems & PTPD_RESTART_NTPENGINE) ||
-        	(rtOpts->restartSubsystems & PTPD_RESTART_NTPCONFIG)) {
+	    if((flags & PTPD_RESTART_NTPENGINE) ||
+        	(flags & PTPD_RESTART_NTPCONFIG)) {
         	ntpSetup(rtOpts, ptpClock);
     	    }
-		if((rtOpts->restartSubsystems & PTPD_RESTART_NTPENGINE) && rtOpts->ntpOptions.enableEngine) {
+		if((flags & PTPD_RESTART_NTPENGINE) && rtOpts->ntpOptions.enableEngine) {
 		    timingServiceSetup(&ptpClock->ntpControl.timingService);
 		    ptpClock->ntpControl.timingService.init(&ptpClock->ntpControl.timingService);
 		}
@@ -427,6 +533,10 @@ restartSubsystems(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 
 		    /* Update PI servo parameters */
 		    setupPIservo(&ptpClock->servo, rtOpts);
+#ifdef PTPD_STATISTICS
+		    /* Update holdover model parameters */
+		    setupHoldover(&ptpClock->holdover, rtOpts);
+#endif /* PTPD_STATISTICS */
 		    /* Config changes don't require subsystem restarts - acknowledge it */
 		    if(rtOpts->restartSubsystems == PTPD_RESTART_NONE) {
 				NOTIFY("Applying configuration\n");
@@ -573,7 +683,17 @@ ptpdShutdown(PtpClock * ptpClock)
 {
 
 	extern RunTimeOpts rtOpts;
-	
+
+	/*
+	 * snapshot the slave state before leaving SLAVE clears it. On a clean stop
+	 * with warm_start_keep_grants, our unicast grants are left running and the
+	 * restarted daemon picks them up from the snapshot - without a snapshot
+	 * to pick them up from, they are cancelled after all.
+	 */
+	if(!rtOpts.warmStart || !saveWarmStart(&rtOpts, ptpClock, FALSE)) {
+		ptpClock->keepGrants = FALSE;
+	}
+
 	/*
          * go into DISABLED state so the FSM can call any PTP-specific shutdown actions,
 	 * such as canceling unicast transmission
@@ -596,6 +716,9 @@ ptpdShutdown(PtpClock * ptpClock)
 	snmpShutdown();
 #endif /* PTPD_SNMP */
 
+	metricsShutdown();
+	controlShutdown();
+
 #ifndef PTPD_STATISTICS
 	/* Not running statistics code - write observed drift to driftfile if enabled, inform user */
 	if(ptpClock->defaultDS.slaveOnly && !ptpClock->servo.runningMaxOutput)
@@ -633,6 +756,9 @@ ptpdShutdown(PtpClock * ptpClock)
 	}
 	unlink(rtOpts.lockFile);
 
+	/* drain any queued output before closing files behind the writer's back */
+	logWriterStop();
+
 	if(rtOpts.statusLog.logEnabled) {
 		/* close and remove the status file */
 		if(rtOpts.statusLog.logFP != NULL) {
@@ -887,6 +1013,9 @@ configcheck:
 		}
 	}
 
+	/* this thread owns all log output - threads started from here on hand their messages over */
+	logWriterInit();
+
 	/* Second lock check, to replace the contents with our own new PID and re-acquire the advisory lock */
 	if(!rtOpts->nonDaemon && !rtOpts->ignore_daemon_lock){
 		/* check and create Lock */
@@ -942,6 +1071,9 @@ configcheck:
 		snmpInit(rtOpts, ptpClock);
 #endif
 
+	metricsInit(rtOpts, ptpClock);
+	controlInit(rtOpts, ptpClock);
+
 
 
 	NOTICE(USER_DESCRIPTION" started successfully on %s using \"%s\" preset (PID %d)\n",
@@ -1045,3 +1045,312 @@ resetPtpEngineSlaveStats(PtpEngineSlaveStats* stats) {
 	stats->ofmStatsUpdated = FALSE;
 	stats->mpdStatsUpdated = FALSE;
 }
+
+void
+resetLogHistogram(LogHistogram* hist)
+{
+	memset(hist, 0, sizeof(*hist));
+}
+
+static int
+getLogHistogramIndex(uint64_t value)
+{
+	int msb;
+
+	if(value < 2 * LOGHIST_SUB_COUNT) {
+		return value;
+	}
+
+	if(value >> LOGHIST_MAX_BITS) {
+		return LOGHIST_BUCKETS - 1;
+	}
+
+#ifdef __GNUC__
+	msb = 63 - __builtin_clzll(value);
+#else
+	for(msb = LOGHIST_SUB_BITS + 1; value >> (msb + 1); msb++);
+#endif /* __GNUC__ */
+
+	/* the top LOGHIST_SUB_BITS bits below the leading one select the bucket */
+	return (msb - LOGHIST_SUB_BITS) * LOGHIST_SUB_COUNT +
+		(value >> (msb - LOGHIST_SUB_BITS));
+}
+
+/* middle of the value range counted by a bucket */
+static uint64_t
+getLogHistogramValue(int index)
+{
+	int shift;
+
+	if(index < 2 * LOGHIST_SUB_COUNT) {
+		return index;
+	}
+
+	shift = index / LOGHIST_SUB_COUNT - 1;
+
+	return ((uint64_t)(LOGHIST_SUB_COUNT + index % LOGHIST_SUB_COUNT) << shift) +
+		((1ULL << shift) - 1) / 2;
+}
+
+void
+feedLogHistogram(LogHistogram* hist, double sample)
+{
+	uint64_t value = fabs(sample) * 1E9 + 0.5;
+
+	if(!hist->count || value < hist->min) {
+		hist->min = value;
+	}
+	if(value > hist->max) {
+		hist->max = value;
+	}
+
+	hist->buckets[getLogHistogramIndex(value)]++;
+	hist->count++;
+}
+
+double
+getLogHistogramPercentile(const LogHistogram* hist, double percentile)
+{
+	uint32_t target, seen = 0;
+	uint64_t value;
+	int i;
+
+	if(!hist->count) {
+		return 0.0;
+	}
+
+	target = ceil(percentile * hist->count / 100.0);
+	if(target < 1) {
+		target = 1;
+	}
+
+	for(i = 0; i < LOGHIST_BUCKETS; i++) {
+		seen += hist->buckets[i];
+		if(seen >= target) {
+			break;
+		}
+	}
+
+	/* the last bucket also holds everything out of range */
+	if(i >= LOGHIST_BUCKETS - 1) {
+		return hist->max / 1E9;
+	}
+
+	/* the bucket estimate can never be outside the observed range */
+	value = getLogHistogramValue(i);
+	value = max(hist->min, min(hist->max, value));
+
+	return value / 1E9;
+}
+
+void
+snapshotLogHistogram(const LogHistogram* hist, LogHistogramSnapshot* snapshot)
+{
+	snapshot->count = hist->count;
+	snapshot->min = hist->min / 1E9;
+	snapshot->p50 = getLogHistogramPercentile(hist, 50.0);
+	snapshot->p99 = getLogHistogramPercentile(hist, 99.0);
+	snapshot->p999 = getLogHistogramPercentile(hist, 99.9);
+	snapshot->max = hist->max / 1E9;
+}
+
+void
+resetPtpEngineHistograms(PtpEngineHistograms* histograms)
+{
+	memset(histograms, 0, sizeof(*histograms));
+}
+
+void
+snapshotPtpEngineHistograms(PtpEngineHistograms* histograms)
+{
+	int i;
+
+	for(i = 0; i < PTP_HISTOGRAM_MAX; i++) {
+		snapshotLogHistogram(&histograms->live[i], &histograms->snapshot[i]);
+		resetLogHistogram(&histograms->live[i]);
+	}
+}
+
+const char*
+getPtpHistogramName(int histogram)
+{
+	switch(histogram) {
+	case PTP_HISTOGRAM_OFM:
+		return "Offset";
+	case PTP_HISTOGRAM_MPD:
+		return "Path delay";
+	case PTP_HISTOGRAM_DELAYMS:
+		return "Raw delayMS";
+	case PTP_HISTOGRAM_DELAYSM:
+		return "Raw delaySM";
+	default:
+		return "unknown";
+	}
+}
+
+void
+resetClockStability(ClockStability* stability)
+{
+	int i;
+	uint32_t *pool = stability->dequePool;
+
+	memset(stability, 0, sizeof(*stability));
+
+	for(i = 0; i < STABILITY_TAUS; i++) {
+		StabilityTau *tau = &stability->taus[i];
+		tau->m = 1 << i;
+		tau->maxDeque = pool;
+		pool += tau->m + 1;
+		tau->minDeque = pool;
+		pool += tau->m + 1;
+	}
+}
+
+#define PHASE(st, n) ((st)->history[(n) & (STABILITY_HISTORY - 1)])
+
+/* push one phase sample and update every tau it completes a term for */
+static void
+feedStabilityPhase(ClockStability* stability, double phase)
+{
+	int i;
+	uint32_t n = stability->samples++;
+
+	PHASE(stability, n) = phase;
+
+	for(i = 0; i < STABILITY_TAUS; i++) {
+
+		StabilityTau *tau = &stability->taus[i];
+		uint32_t m = tau->m;
+		uint32_t slots = m + 1;
+		double d;
+
+		/* MTIE: extremes over the window n-m..n via monotonic deques */
+		if(n > m) {
+			while(tau->maxTail != tau->maxHead &&
+			    tau->maxDeque[tau->maxHead % slots] < n - m) {
+				tau->maxHead++;
+			}
+			while(tau->minTail != tau->minHead &&
+			    tau->minDeque[tau->minHead % slots] < n - m) {
+				tau->minHead++;
+			}
+		}
+		while(tau->maxTail != tau->maxHead &&
+		    PHASE(stability, tau->maxDeque[(tau->maxTail - 1) % slots]) <= phase) {
+			tau->maxTail--;
+		}
+		tau->maxDeque[tau->maxTail++ % slots] = n;
+		while(tau->minTail != tau->minHead &&
+		    PHASE(stability, tau->minDeque[(tau->minTail - 1) % slots]) >= phase) {
+			tau->minTail--;
+		}
+		tau->minDeque[tau->minTail++ % slots] = n;
+
+		if(n < m) {
+			continue;
+		}
+
+		tau->mtie = max(tau->mtie,
+			PHASE(stability, tau->maxDeque[tau->maxHead % slots]) -
+			PHASE(stability, tau->minDeque[tau->minHead % slots]));
+
+		if(n < 2 * m) {
+			continue;
+		}
+
+		/* overlapping ADEV: second differences of phase at lag m */
+		d = phase - 2 * PHASE(stability, n - m) + PHASE(stability, n - 2 * m);
+		tau->adevSum += d * d;
+		tau->adevCount++;
+
+		/* TDEV: sum of the last m second differences */
+		tau->tdevWindow += d;
+		if(n >= 3 * m) {
+			tau->tdevWindow -= PHASE(stability, n - m) - 2 * PHASE(stability, n - 2 * m)
+						+ PHASE(stability, n - 3 * m);
+		}
+		if(n >= 3 * m - 1) {
+			tau->tdevSum += tau->tdevWindow * tau->tdevWindow;
+			tau->tdevCount++;
+		}
+	}
+}
+
+#undef PHASE
+
+/*
+ * Feed one offset from master (seconds) observed at the given monotonic
+ * second. Offsets within one tau0 are averaged into a single phase sample,
+ * short gaps are bridged by holding the last phase, long gaps restart.
+ */
+void
+feedClockStability(ClockStability* stability, double offset, int32_t second)
+{
+	double phase;
+	int32_t gap;
+
+	if(!stability->binValid) {
+		goto newbin;
+	}
+
+	gap = (second - stability->binSecond) / STABILITY_TAU0;
+
+	if(gap == 0) {
+		stability->binSum += offset;
+		stability->binCount++;
+		return;
+	}
+
+	phase = stability->binSum / stability->binCount;
+
+	if(gap < 0 || gap > STABILITY_MAX_GAP) {
+		resetClockStability(stability);
+		goto newbin;
+	}
+
+	while(gap--) {
+		feedStabilityPhase(stability, phase);
+	}
+
+newbin:
+	stability->binValid = TRUE;
+	stability->binSecond = second - second % STABILITY_TAU0;
+	stability->binSum = offset;
+	stability->binCount = 1;
+}
+
+double
+getStabilityTau(const StabilityTau* tau)
+{
+	return (double)tau->m * STABILITY_TAU0;
+}
+
+double
+getStabilityAdev(const StabilityTau* tau)
+{
+	double t = getStabilityTau(tau);
+
+	if(!tau->adevCount) {
+		return 0.0;
+	}
+
+	return sqrt(tau->adevSum / (2.0 * t * t * tau->adevCount));
+}
+
+double
+getStabilityTdev(const StabilityTau* tau)
+{
+	double m = tau->m;
+
+	if(!tau->tdevCount) {
+		return 0.0;
+	}
+
+	return sqrt(tau->tdevSum / (6.0 * m * m * tau->tdevCount));
+}
+
+double
+getStabilityMtie(const StabilityTau* tau)
+{
+	return tau->mtie;
+}
@@ -214,6 +214,7 @@ typedef struct
     double mpdMax;
     double mpdMaxFinal;
     Boolean mpdIsStable;
+    int mpdStableCount;
     double mpdStabilityThreshold;
     int mpdStabilityPeriod;
     DoublePermanentStdDev ofmStats;
@@ -225,6 +226,110 @@ typedef struct
 void clearPtpEngineSlaveStats(PtpEngineSlaveStats* stats);
 void resetPtpEngineSlaveStats(PtpEngineSlaveStats* stats);
 
+/*
+ * Log-linear (HDR-style) histogram of magnitudes in nanoseconds: values
+ * below 2 * LOGHIST_SUB_COUNT are counted exactly, above that every power
+ * of two is split into LOGHIST_SUB_COUNT linear buckets, giving a relative
+ * error of at most 1 / LOGHIST_SUB_COUNT over the whole range in fixed memory.
+ */
+#define LOGHIST_SUB_BITS	5
+#define LOGHIST_SUB_COUNT	(1 << LOGHIST_SUB_BITS)
+/* values from 2^LOGHIST_MAX_BITS ns (~18 minutes) go into the last bucket */
+#define LOGHIST_MAX_BITS	40
+#define LOGHIST_BUCKETS		((LOGHIST_MAX_BITS - LOGHIST_SUB_BITS + 1) * LOGHIST_SUB_COUNT)
+
+typedef struct {
+	uint32_t count;
+	uint64_t min;
+	uint64_t max;
+	uint32_t buckets[LOGHIST_BUCKETS];
+} LogHistogram;
+
+/* percentiles taken from a histogram, in seconds */
+typedef struct {
+	uint32_t count;
+	double min;
+	double p50;
+	double p99;
+	double p999;
+	double max;
+} LogHistogramSnapshot;
+
+void resetLogHistogram(LogHistogram* hist);
+void feedLogHistogram(LogHistogram* hist, double sample);
+double getLogHistogramPercentile(const LogHistogram* hist, double percentile);
+void snapshotLogHistogram(const LogHistogram* hist, LogHistogramSnapshot* snapshot);
+
+/* the slave engine histograms */
+enum {
+	PTP_HISTOGRAM_OFM = 0,		/* offset from master */
+	PTP_HISTOGRAM_MPD,		/* mean path delay */
+	PTP_HISTOGRAM_DELAYMS,		/* raw master to slave delay */
+	PTP_HISTOGRAM_DELAYSM,		/* raw slave to master delay */
+	PTP_HISTOGRAM_MAX
+};
+
+/*
+ * Live histograms are fed continuously, and moved to the snapshots
+ * and reset on every statistics update
+ */
+typedef struct {
+	LogHistogram live[PTP_HISTOGRAM_MAX];
+	LogHistogramSnapshot snapshot[PTP_HISTOGRAM_MAX];
+} PtpEngineHistograms;
+
+void resetPtpEngineHistograms(PtpEngineHistograms* histograms);
+void snapshotPtpEngineHistograms(PtpEngineHistograms* histograms);
+const char* getPtpHistogramName(int histogram);
+
+/*
+ * Streaming clock stability estimates (ADEV, TDEV, MTIE) over the offset
+ * from master. Offsets are averaged into one phase sample per STABILITY_TAU0
+ * second, estimates are kept for taus of tau0 * 2^k, k = 0..STABILITY_TAUS-1.
+ * Memory use is fixed: the phase history must cover 3 * the largest m.
+ */
+#define STABILITY_TAU0		1
+#define STABILITY_TAUS		12
+#define STABILITY_MAX_M		(1 << (STABILITY_TAUS - 1))
+#define STABILITY_HISTORY	(4 * STABILITY_MAX_M)
+/* phase gaps longer than this many tau0 restart the estimates */
+#define STABILITY_MAX_GAP	10
+/* monotonic deque slots for all taus: sum of (m + 1) */
+#define STABILITY_DEQUE_POOL	(2 * STABILITY_MAX_M - 1 + STABILITY_TAUS)
+
+typedef struct {
+	uint32_t m;		/* tau = m * tau0 */
+	uint32_t adevCount;
+	double adevSum;		/* sum of squared second differences */
+	uint32_t tdevCount;
+	double tdevSum;		/* sum of squared m-sample sums of second differences */
+	double tdevWindow;	/* running sum of the last m second differences */
+	double mtie;		/* largest peak-to-peak phase in any m * tau0 window */
+	/* monotonic deques of sample numbers for the MTIE window extremes */
+	uint32_t *maxDeque;
+	uint32_t *minDeque;
+	uint32_t maxHead, maxTail;
+	uint32_t minHead, minTail;
+} StabilityTau;
+
+typedef struct {
+	Boolean binValid;
+	int32_t binSecond;
+	double binSum;
+	uint32_t binCount;
+	uint32_t samples;	/* phase samples fed since the last reset */
+	double history[STABILITY_HISTORY];
+	uint32_t dequePool[2 * STABILITY_DEQUE_POOL];
+	StabilityTau taus[STABILITY_TAUS];
+} ClockStability;
+
+void resetClockStability(ClockStability* stability);
+void feedClockStability(ClockStability* stability, double offset, int32_t second);
+double getStabilityTau(const StabilityTau* tau);
+double getStabilityAdev(const StabilityTau* tau);
+double getStabilityTdev(const StabilityTau* tau);
+double getStabilityMtie(const StabilityTau* tau);
+
 #endif /*STATISTICS_H_*/
 
 
@@ -0,0 +1,225 @@
+#ifndef PTPDSTATSLOG_H_
+#define PTPDSTATSLOG_H_
+
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file    statslog.h
+ * @authors The PTPd Project
+ * @date   Sun Jan 10 12:41:52 2016
+ * Binary statistics log record layout, shared between ptpd and
+ * the ptpd2-statsdecode tool. The file is a sequence of fixed-size
+ * little-endian records, so it can be appended to, mmapped and indexed
+ * directly. A header record is written when the file is (re)started;
+ * readers must accept header records anywhere in the file.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#define STATSLOG_MAGIC		"PTPS"
+#define STATSLOG_VERSION	1
+#define STATSLOG_RECORD_SIZE	80
+
+/* record types - first byte of every record */
+enum {
+	STATSLOG_RECORD_HEADER = 1,
+	STATSLOG_RECORD_SAMPLE = 2
+};
+
+/* header flags */
+#define STATSLOG_HDR_STATISTICS		0x0001	/* written by a PTPD_STATISTICS build */
+
+/* sample flags */
+#define STATSLOG_FLAG_P2P		0x0001	/* delay is peer delay */
+#define STATSLOG_FLAG_SERVO_STABLE	0x0002
+#define STATSLOG_FLAG_SERVO_MAXOUTPUT	0x0004
+#define STATSLOG_FLAG_DELAY_STABLE	0x0008
+#define STATSLOG_FLAG_MS_OUTLIER	0x0010	/* last delayMS sample rejected by the filter */
+#define STATSLOG_FLAG_SM_OUTLIER	0x0020	/* last delaySM sample rejected by the filter */
+
+typedef struct {
+	uint8_t version;
+	uint16_t recordSize;
+	uint32_t seconds;
+	uint32_t nanoseconds;
+	uint8_t clockIdentity[8];
+	uint16_t portNumber;
+	uint8_t delayMechanism;
+	uint8_t domainNumber;
+	uint32_t flags;
+} StatsLogHeader;
+
+typedef struct {
+	uint8_t portState;
+	char lastMessage;
+	uint16_t sequenceId;
+	uint16_t flags;
+	uint32_t seconds;
+	uint32_t nanoseconds;
+	int64_t offsetFromMaster;	/* all times in nanoseconds */
+	int64_t meanPathDelay;
+	int64_t delayMS;
+	int64_t delaySM;
+	int64_t rawDelayMS;
+	int64_t rawDelaySM;
+	double observedDrift;		/* ppb */
+} StatsLogSample;
+
+/*
+ * Record layout (offsets in bytes):
+ *
+ * header: 0 type, 1 version, 2 recordSize, 4 magic, 8 seconds, 12 nanoseconds,
+ *         16 clockIdentity, 24 portNumber, 26 delayMechanism, 27 domainNumber,
+ *         28 flags, 32-79 reserved
+ * sample: 0 type, 1 portState, 2 lastMessage, 3 reserved, 4 sequenceId, 6 flags,
+ *         8 seconds, 12 nanoseconds, 16 offsetFromMaster, 24 meanPathDelay,
+ *         32 delayMS, 40 delaySM, 48 rawDelayMS, 56 rawDelaySM, 64 observedDrift,
+ *         72-79 reserved
+ */
+
+static inline void
+statsLogPut16(unsigned char *buf, uint16_t val)
+{
+	buf[0] = val & 0xff;
+	buf[1] = val >> 8;
+}
+
+static inline void
+statsLogPut32(unsigned char *buf, uint32_t val)
+{
+	statsLogPut16(buf, val & 0xffff);
+	statsLogPut16(buf + 2, val >> 16);
+}
+
+static inline void
+statsLogPut64(unsigned char *buf, uint64_t val)
+{
+	statsLogPut32(buf, val & 0xffffffff);
+	statsLogPut32(buf + 4, val >> 32);
+}
+
+static inline uint16_t
+statsLogGet16(const unsigned char *buf)
+{
+	return buf[0] | (buf[1] << 8);
+}
+
+static inline uint32_t
+statsLogGet32(const unsigned char *buf)
+{
+	return statsLogGet16(buf) | ((uint32_t)statsLogGet16(buf + 2) << 16);
+}
+
+static inline uint64_t
+statsLogGet64(const unsigned char *buf)
+{
+	return statsLogGet32(buf) | ((uint64_t)statsLogGet32(buf + 4) << 32);
+}
+
+static inline void
+statsLogPackHeader(unsigned char *buf, const StatsLogHeader *hdr)
+{
+	memset(buf, 0, STATSLOG_RECORD_SIZE);
+	buf[0] = STATSLOG_RECORD_HEADER;
+	buf[1] = hdr->version;
+	statsLogPut16(buf + 2, hdr->recordSize);
+	memcpy(buf + 4, STATSLOG_MAGIC, 4);
+	statsLogPut32(buf + 8, hdr->seconds);
+	statsLogPut32(buf + 12, hdr->nanoseconds);
+	memcpy(buf + 16, hdr->clockIdentity, 8);
+	statsLogPut16(buf + 24, hdr->portNumber);
+	buf[26] = hdr->delayMechanism;
+	buf[27] = hdr->domainNumber;
+	statsLogPut32(buf + 28, hdr->flags);
+}
+
+/* returns 0 if this is not a valid header record */
+static inline int
+statsLogUnpackHeader(const unsigned char *buf, StatsLogHeader *hdr)
+{
+	if(buf[0] != STATSLOG_RECORD_HEADER || memcmp(buf + 4, STATSLOG_MAGIC, 4)) {
+		return 0;
+	}
+	hdr->version = buf[1];
+	hdr->recordSize = statsLogGet16(buf + 2);
+	hdr->seconds = statsLogGet32(buf + 8);
+	hdr->nanoseconds = statsLogGet32(buf + 12);
+	memcpy(hdr->clockIdentity, buf + 16, 8);
+	hdr->portNumber = statsLogGet16(buf + 24);
+	hdr->delayMechanism = buf[26];
+	hdr->domainNumber = buf[27];
+	hdr->flags = statsLogGet32(buf + 28);
+	return 1;
+}
+
+static inline void
+statsLogPackSample(unsigned char *buf, const StatsLogSample *smp)
+{
+	uint64_t drift;
+
+	memset(buf, 0, STATSLOG_RECORD_SIZE);
+	buf[0] = STATSLOG_RECORD_SAMPLE;
+	buf[1] = smp->portState;
+	buf[2] = smp->lastMessage;
+	statsLogPut16(buf + 4, smp->sequenceId);
+	statsLogPut16(buf + 6, smp->flags);
+	statsLogPut32(buf + 8, smp->seconds);
+	statsLogPut32(buf + 12, smp->nanoseconds);
+	statsLogPut64(buf + 16, smp->offsetFromMaster);
+	statsLogPut64(buf + 24, smp->meanPathDelay);
+	statsLogPut64(buf + 32, smp->delayMS);
+	statsLogPut64(buf + 40, smp->delaySM);
+	statsLogPut64(buf + 48, smp->rawDelayMS);
+	statsLogPut64(buf + 56, smp->rawDelaySM);
+	memcpy(&drift, &smp->observedDrift, sizeof(drift));
+	statsLogPut64(buf + 64, drift);
+}
+
+static inline void
+statsLogUnpackSample(const unsigned char *buf, StatsLogSample *smp)
+{
+	uint64_t drift;
+
+	smp->portState = buf[1];
+	smp->lastMessage = buf[2];
+	smp->sequenceId = statsLogGet16(buf + 4);
+	smp->flags = statsLogGet16(buf + 6);
+	smp->seconds = statsLogGet32(buf + 8);
+	smp->nanoseconds = statsLogGet32(buf + 12);
+	smp->offsetFromMaster = statsLogGet64(buf + 16);
+	smp->meanPathDelay = statsLogGet64(buf + 24);
+	smp->delayMS = statsLogGet64(buf + 32);
+	smp->delaySM = statsLogGet64(buf + 40);
+	smp->rawDelayMS = statsLogGet64(buf + 48);
+	smp->rawDelaySM = statsLogGet64(buf + 56);
+	drift = statsLogGet64(buf + 64);
+	memcpy(&smp->observedDrift, &drift, sizeof(drift));
+}
+
+#endif /*PTPDSTATSLOG_H_*/
@@ -0,0 +1,251 @@
+
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file    statsshm.c
+ * @authors The PTPd Project
+ * @date   Mon Jan 11 09:12:37 2016
+ * This source file contains the implementation of the shared memory
+ * statistics segment: creation, removal and seqlock-protected updates.
+ */
+
+#include "../ptpd.h"
+
+#ifdef PTPD_STATSSHM
+
+#include <sys/mman.h>
+
+/* all of PtpdCounters is published, under its field names */
+typedef char statsShmCounterCheck[(PTPD_COUNTER_MAX <= STATSSHM_MAX_COUNTERS) ? 1 : -1];
+
+static PtpdStatsSegment *segment = NULL;
+static char segmentName[PATH_MAX + 1];
+
+static void
+fillSegmentName(char *out, size_t len, const RunTimeOpts *rtOpts)
+{
+	if(strlen(rtOpts->statsSegmentName) > 0) {
+		snprintf(out, len, "%s", rtOpts->statsSegmentName);
+	} else {
+		snprintf(out, len, "/"PTPD_PROGNAME".%s", rtOpts->ifaceName);
+	}
+}
+
+/* create the segment, or re-create it if the name has changed */
+void
+restartStatsSegment(const RunTimeOpts *rtOpts)
+{
+
+	char name[PATH_MAX + 1];
+	int fd, i;
+
+	if(!rtOpts->statsSegment) {
+		closeStatsSegment();
+		return;
+	}
+
+	memset(name, 0, sizeof(name));
+	fillSegmentName(name, sizeof(name), rtOpts);
+
+	if(segment != NULL) {
+		if(!strcmp(name, segmentName)) {
+			return;
+		}
+		closeStatsSegment();
+	}
+
+	/*
+	 * never reuse an existing object: /dev/shm is world-writable, and a
+	 * segment someone else created could be truncated under our mapping
+	 */
+	shm_unlink(name);
+	if((fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644)) < 0) {
+		PERROR("Could not create statistics segment %s", name);
+		return;
+	}
+
+	if(ftruncate(fd, sizeof(PtpdStatsSegment)) < 0) {
+		PERROR("Could not size statistics segment %s", name);
+		close(fd);
+		shm_unlink(name);
+		return;
+	}
+
+	segment = mmap(NULL, sizeof(PtpdStatsSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if(segment == MAP_FAILED) {
+		PERROR("Could not map statistics segment %s", name);
+		segment = NULL;
+		shm_unlink(name);
+		return;
+	}
+
+	snprintf(segmentName, sizeof(segmentName), "%s", name);
+
+	/* invalidate while the static part is being written */
+	segment->magic = 0;
+	memset(&segment->version, 0, sizeof(PtpdStatsSegment) - sizeof(segment->magic));
+	segment->version = STATSSHM_VERSION;
+	segment->size = sizeof(PtpdStatsSegment);
+	segment->pid = getpid();
+	snprintf(segment->interfaceName, sizeof(segment->interfaceName), "%s", rtOpts->ifaceName);
+	segment->counterCount = PTPD_COUNTER_MAX;
+	for(i = 0; i < PTPD_COUNTER_MAX; i++) {
+		snprintf(segment->counterNames[i], sizeof(segment->counterNames[i]), "%s",
+			getPtpdCounterInfo(i)->name);
+	}
+	__atomic_store_n(&segment->magic, STATSSHM_MAGIC, __ATOMIC_RELEASE);
+
+	INFO("Publishing statistics in shared memory segment %s\n", name);
+
+}
+
+void
+closeStatsSegment()
+{
+
+	if(segment == NULL) {
+		return;
+	}
+
+	segment->magic = 0;
+	munmap(segment, sizeof(PtpdStatsSegment));
+	shm_unlink(segmentName);
+	segment = NULL;
+	memset(segmentName, 0, sizeof(segmentName));
+
+}
+
+#define TI_NS(t) ((int64_t)(t).seconds * 1000000000LL + (t).nanoseconds)
+
+/* publish the current state - called on every servo update and state change */
+void
+updateStatsSegment(PtpClock *ptpClock)
+{
+
+	PtpdStatsSnapshot *data;
+	TimeInternal now;
+	uint32_t seq;
+	int i;
+
+	if(segment == NULL) {
+		return;
+	}
+
+	/* alarms only exist once the clock is set up, so their names go in on first use */
+	if(segment->alarmCount == 0) {
+		for(i = 0; i < ALRM_MAX && i < STATSSHM_MAX_ALARMS; i++) {
+			snprintf(segment->alarmNames[i], sizeof(segment->alarmNames[i]), "%s",
+				ptpClock->alarms[i].name);
+		}
+		segment->alarmCount = i;
+	}
+
+	getTime(&now);
+
+	seq = segment->sequence;
+	__atomic_store_n(&segment->sequence, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	data = &segment->data;
+
+	data->updateTime = TI_NS(now);
+	data->updateCount++;
+	data->flags = 0;
+	data->portState = ptpClock->portDS.portState;
+	data->delayMechanism = ptpClock->portDS.delayMechanism;
+	data->domainNumber = ptpClock->defaultDS.domainNumber;
+	data->portNumber = ptpClock->portDS.portIdentity.portNumber;
+	memcpy(data->clockIdentity, ptpClock->portDS.portIdentity.clockIdentity, CLOCK_IDENTITY_LENGTH);
+	data->parentPortNumber = ptpClock->parentDS.parentPortIdentity.portNumber;
+	memcpy(data->parentClockIdentity, ptpClock->parentDS.parentPortIdentity.clockIdentity, CLOCK_IDENTITY_LENGTH);
+	memcpy(data->grandmasterIdentity, ptpClock->parentDS.grandmasterIdentity, CLOCK_IDENTITY_LENGTH);
+
+	data->offsetFromMaster = TI_NS(ptpClock->currentDS.offsetFromMaster);
+	if(ptpClock->portDS.delayMechanism == P2P) {
+		data->flags |= STATSSHM_FLAG_P2P;
+		data->meanPathDelay = TI_NS(ptpClock->portDS.peerMeanPathDelay);
+	} else {
+		data->meanPathDelay = TI_NS(ptpClock->currentDS.meanPathDelay);
+	}
+	data->observedDrift = ptpClock->servo.observedDrift;
+
+	if(ptpClock->servo.runningMaxOutput)
+		data->flags |= STATSSHM_FLAG_SERVO_MAXOUTPUT;
+
+#ifdef PTPD_STATISTICS
+	if(ptpClock->servo.isStable)
+		data->flags |= STATSSHM_FLAG_SERVO_STABLE;
+	data->flags |= STATSSHM_FLAG_STATISTICS;
+	if(ptpClock->slaveStats.mpdIsStable)
+		data->flags |= STATSSHM_FLAG_DELAY_STABLE;
+	if(ptpClock->holdover.active)
+		data->flags |= STATSSHM_FLAG_HOLDOVER;
+	data->mpdMean = ptpClock->slaveStats.mpdMean;
+	data->mpdStdDev = ptpClock->slaveStats.mpdStdDev;
+	data->ofmMean = ptpClock->slaveStats.ofmMean;
+	data->ofmStdDev = ptpClock->slaveStats.ofmStdDev;
+	data->driftMean = ptpClock->servo.driftMean;
+	data->driftStdDev = ptpClock->servo.driftStdDev;
+#endif /* PTPD_STATISTICS */
+
+	for(i = 0; i < PTPD_COUNTER_MAX; i++) {
+		data->counters[i] = getPtpdCounter(&ptpClock->counters, i);
+	}
+
+	for(i = 0; i < segment->alarmCount; i++) {
+		data->alarmState[i] = ptpClock->alarms[i].state;
+	}
+
+	__atomic_store_n(&segment->sequence, seq + 2, __ATOMIC_RELEASE);
+
+}
+
+#else
+
+void
+restartStatsSegment(const RunTimeOpts *rtOpts)
+{
+	if(rtOpts->statsSegment) {
+		WARNING("Shared memory statistics segment is not supported on this platform\n");
+	}
+}
+
+void
+closeStatsSegment()
+{
+}
+
+void
+updateStatsSegment(PtpClock *ptpClock)
+{
+}
+
+#endif /* PTPD_STATSSHM */
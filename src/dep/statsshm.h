@@ -0,0 +1,147 @@
+#ifndef PTPDSTATSSHM_H_
+#define PTPDSTATSSHM_H_
+
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file    statsshm.h
+ * @authors The PTPd Project
+ * @date   Mon Jan 11 09:12:37 2016
+ * Layout of the shared memory statistics segment published by ptpd
+ * (global:stats_segment), and a header-only reader for monitoring tools.
+ *
+ * The static part (names) is written once when the segment is created.
+ * The dynamic part is protected by a sequence lock: the writer makes
+ * the sequence odd, updates the data and makes it even again. Readers
+ * copy the data and retry if the sequence was odd or has changed.
+ * Reading never makes a system call.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#define STATSSHM_MAGIC		0x50545044	/* "PTPD" */
+#define STATSSHM_VERSION	1
+
+#define STATSSHM_MAX_COUNTERS	64
+#define STATSSHM_MAX_ALARMS	32
+#define STATSSHM_NAME_LENGTH	40
+
+/* snapshot flags */
+#define STATSSHM_FLAG_STATISTICS	0x0001	/* slave statistics fields are valid */
+#define STATSSHM_FLAG_SERVO_STABLE	0x0002
+#define STATSSHM_FLAG_SERVO_MAXOUTPUT	0x0004
+#define STATSSHM_FLAG_DELAY_STABLE	0x0008
+#define STATSSHM_FLAG_HOLDOVER		0x0010
+#define STATSSHM_FLAG_P2P		0x0020
+
+typedef struct {
+	int64_t updateTime;		/* time of this update, ns since the epoch */
+	uint32_t updateCount;
+	uint32_t flags;
+
+	uint8_t portState;
+	uint8_t delayMechanism;
+	uint8_t domainNumber;
+	uint8_t reserved;
+	uint16_t portNumber;
+	uint16_t parentPortNumber;
+	uint8_t clockIdentity[8];
+	uint8_t parentClockIdentity[8];
+	uint8_t grandmasterIdentity[8];
+
+	int64_t offsetFromMaster;	/* ns */
+	int64_t meanPathDelay;		/* ns */
+	double observedDrift;		/* ppb */
+
+	/* slave statistics - only valid with STATSSHM_FLAG_STATISTICS */
+	double mpdMean;			/* s */
+	double mpdStdDev;		/* s */
+	double ofmMean;			/* s */
+	double ofmStdDev;		/* s */
+	double driftMean;		/* ppb */
+	double driftStdDev;		/* ppb */
+
+	uint32_t counters[STATSSHM_MAX_COUNTERS];
+	uint8_t alarmState[STATSSHM_MAX_ALARMS];	/* 0 unset, 1 set, 2 cleared */
+} PtpdStatsSnapshot;
+
+typedef struct {
+	/* static part */
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;			/* size of the whole segment */
+	uint32_t pid;
+	uint32_t counterCount;
+	uint32_t alarmCount;
+	char interfaceName[STATSSHM_NAME_LENGTH];
+	char counterNames[STATSSHM_MAX_COUNTERS][STATSSHM_NAME_LENGTH];
+	char alarmNames[STATSSHM_MAX_ALARMS][STATSSHM_NAME_LENGTH];
+
+	/* sequence lock - odd while an update is in progress */
+	uint32_t sequence;
+	uint32_t pad;
+
+	PtpdStatsSnapshot data;
+} PtpdStatsSegment;
+
+/* returns 0 if the segment is not a compatible ptpd statistics segment */
+static inline int
+statsShmValid(const PtpdStatsSegment *seg)
+{
+	return seg->magic == STATSSHM_MAGIC && seg->version == STATSSHM_VERSION &&
+		seg->size >= sizeof(PtpdStatsSegment);
+}
+
+/*
+ * Take a consistent copy of the dynamic data. Gives up after maxTries
+ * attempts (if the writer keeps updating or has died mid-update) and
+ * returns 0, otherwise returns 1.
+ */
+static inline int
+statsShmRead(const PtpdStatsSegment *seg, PtpdStatsSnapshot *out, int maxTries)
+{
+	uint32_t seq1, seq2;
+
+	while(maxTries-- > 0) {
+		seq1 = __atomic_load_n(&seg->sequence, __ATOMIC_ACQUIRE);
+		if(seq1 & 1) {
+			continue;
+		}
+		memcpy(out, (const void*)&seg->data, sizeof(PtpdStatsSnapshot));
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		seq2 = __atomic_load_n(&seg->sequence, __ATOMIC_RELAXED);
+		if(seq1 == seq2) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+#endif /*PTPDSTATSSHM_H_*/
@@ -333,54 +333,60 @@ snprint_PortIdentity(char *s, int max_len, const PortIdentity *id)
 	return len;
 }
 
-/* Write a formatted string to file pointer */
-int writeMessage(FILE* destination, uint32_t *lastHash, int priority, const char * format, va_list ap) {
+#define PTPD_COUNTER_INFO(field, type, family, labels, help) \
+	{ #field, offsetof(PtpdCounters, field), PTPD_METRIC_##type, family, labels, help },
+
+static const PtpdCounterInfo ptpdCounterTable[PTPD_COUNTER_MAX] = {
+	PTPD_COUNTERS(PTPD_COUNTER_INFO)
+};
+
+#undef PTPD_COUNTER_INFO
+
+/* name, offset and metric description of a PtpdCounters field, NULL past the last one */
+const PtpdCounterInfo*
+getPtpdCounterInfo(int counter)
+{
+	if(counter < 0 || counter >= PTPD_COUNTER_MAX) {
+		return NULL;
+	}
+
+	return &ptpdCounterTable[counter];
+}
+
+/* value of a PtpdCounters field */
+uint32_t
+getPtpdCounter(const PtpdCounters *counters, int counter)
+{
+	uint32_t value;
 
+	memcpy(&value, (const char*)counters + ptpdCounterTable[counter].offset, sizeof(value));
+	return value;
+}
+
+/*
+ * Format a log message into a buffer, prefixed with timestamp, priority and port state
+ * if requested. Returns the length of the line, or 0 if it repeats the last message.
+ */
+static int
+formatMessage(char *out, int max, Boolean prefix, uint32_t *lastHash, int priority, const char * format, va_list ap)
+{
 
 	extern RunTimeOpts rtOpts;
 	extern Boolean startupInProgress;
 
-	int written;
+	int len = 0;
+	int msgLen;
 	char time_str[MAXTIMESTR];
 	struct timeval now;
 #ifndef RUNTIME_DEBUG
-	char buf[PATH_MAX +1];
 	uint32_t hash;
-	va_list ap1;
 #endif /* RUNTIME_DEBUG */
 
 	extern char *translatePortState(PtpClock *ptpClock);
 	extern PtpClock *G_ptpClock;
 
-	if(destination == NULL)
-		return -1;
-
-	/* If we're starting up as daemon, only print <= WARN */
-	if ((destination == stderr) &&
-		!rtOpts.nonDaemon && startupInProgress &&
-		(priority > LOG_WARNING)){
-		    return 1;
-		}
-
-#ifndef RUNTIME_DEBUG
-	/* check if this message produces the same hash as last */
-	memset(buf, 0, sizeof(buf));
-	va_copy(ap1, ap);
-	vsnprintf(buf, PATH_MAX, format, ap1);
-	hash = fnvHash(buf, sizeof(buf), 0);
-	if(lastHash != NULL) {
-	    if(format[0] != '\n' && lastHash != NULL) {
-		    /* last message was the same - don't print the next one */
-		    if( (lastHash != 0) && (hash == *lastHash)) {
-		    return 0;
-		}
-	    }
-	    *lastHash = hash;
-	}
-#endif /* RUNTIME_DEBUG */
-
 	/* Print timestamps and prefixes only if we're running in foreground or logging to file*/
-	if( rtOpts.nonDaemon || destination != stderr) {
+	if(prefix) {
 
 		/*
 		 * select debug tagged with timestamps. This will slow down PTP itself if you send a lot of messages!
@@ -389,8 +395,8 @@ int writeMessage(FILE* destination, uint32_t *lastHash, int priority, const char
 		 */
 		gettimeofday(&now, 0);
 		strftime(time_str, MAXTIMESTR, "%F %X", localtime((time_t*)&now.tv_sec));
-		fprintf(destination, "%s.%06d ", time_str, (int)now.tv_usec  );
-		fprintf(destination,PTPD_PROGNAME"[%d].%s (%-9s ",
+		len += snprintf(out + len, max - len, "%s.%06d ", time_str, (int)now.tv_usec  );
+		len += snprintf(out + len, max - len, PTPD_PROGNAME"[%d].%s (%-9s ",
 		(int)getpid(), startupInProgress ? "startup" : rtOpts.ifaceName,
 		priority == LOG_EMERG   ? "emergency)" :
 		priority == LOG_ALERT   ? "alert)" :
@@ -404,12 +410,102 @@ int writeMessage(FILE* destination, uint32_t *lastHash, int priority, const char
 		priority == LOG_DEBUGV  ? "debug3)" :
 		"unk)");
 
-
-		fprintf(destination, " (%s) ", G_ptpClock ?
+		len += snprintf(out + len, max - len, " (%s) ", G_ptpClock ?
 		       translatePortState(G_ptpClock) : "___");
+
+		if(len >= max) {
+			len = max - 1;
+		}
+	}
+
+	msgLen = vsnprintf(out + len, max - len, format, ap);
+	if(msgLen < 0) {
+		return -1;
+	}
+	if(msgLen >= max - len) {
+		msgLen = max - len - 1;
+	}
+
+#ifndef RUNTIME_DEBUG
+	/* check if this message produces the same hash as last */
+	hash = fnvHash(out + len, msgLen, 0);
+	if(lastHash != NULL) {
+	    if(format[0] != '\n') {
+		    /* last message was the same - don't print the next one */
+		    if( (*lastHash != 0) && (hash == *lastHash)) {
+		    return 0;
+		}
+	    }
+	    *lastHash = hash;
+	}
+#endif /* RUNTIME_DEBUG */
+
+	return len + msgLen;
+
+}
+
+/* Write a formatted string to file pointer */
+int writeMessage(FILE* destination, uint32_t *lastHash, int priority, const char * format, va_list ap) {
+
+	extern RunTimeOpts rtOpts;
+	extern Boolean startupInProgress;
+
+	int len;
+	char buf[PATH_MAX + 256];
+
+	if(destination == NULL)
+		return -1;
+
+	/* If we're starting up as daemon, only print <= WARN */
+	if ((destination == stderr) &&
+		!rtOpts.nonDaemon && startupInProgress &&
+		(priority > LOG_WARNING)){
+		    return 1;
+		}
+
+	len = formatMessage(buf, sizeof(buf), rtOpts.nonDaemon || destination != stderr,
+			    lastHash, priority, format, ap);
+	if(len <= 0)
+		return len;
+
+	if(fputs(buf, destination) == EOF)
+		return -1;
+
+	return len;
+
+}
+
+/*
+ * Hand a log message over to the log writer thread: log file if enabled,
+ * otherwise syslog, otherwise stderr - same order as logMessage().
+ */
+static void
+queueMessage(int priority, const char * format, va_list ap)
+{
+
+	extern RunTimeOpts rtOpts;
+
+	int len;
+	char buf[PATH_MAX + 256];
+
+	if(rtOpts.eventLog.logEnabled && rtOpts.eventLog.logFP != NULL) {
+		len = formatMessage(buf, sizeof(buf), TRUE, &rtOpts.eventLog.lastHash, priority, format, ap);
+		if(len > 0)
+			logWriterQueue(LOGWRITER_FILE, &rtOpts.eventLog, priority, buf, len);
+	} else if(rtOpts.useSysLog) {
+		len = formatMessage(buf, sizeof(buf), FALSE, NULL, priority, format, ap);
+#ifdef RUNTIME_DEBUG
+		if(priority > LOG_DEBUG){
+			priority = LOG_DEBUG;
+		}
+#endif
+		if(len > 0)
+			logWriterQueue(LOGWRITER_SYSLOG, NULL, priority, buf, len);
+	} else {
+		len = formatMessage(buf, sizeof(buf), rtOpts.nonDaemon, &rtOpts.eventLog.lastHash, priority, format, ap);
+		if(len > 0)
+			logWriterQueue(LOGWRITER_STDERR, NULL, priority, buf, len);
 	}
-	written = vfprintf(destination, format, ap);
-	return written;
 
 }
 
@@ -457,6 +553,21 @@ logMessage(int priority, const char * format, ...)
 	if(priority > rtOpts.logLevel) {
 	    goto end;
 	}
+
+	/* other threads never touch log output - the main thread logs their messages */
+	if(logWriterDefer(priority, format, ap)) {
+	    goto end;
+	}
+
+	/* keep the order: whatever other threads logged before us goes first */
+	logWriterFlushDeferred();
+
+	/* the log writer thread is running - never touch files from here */
+	if(logWriterActive()) {
+	    queueMessage(priority, format, ap);
+	    goto end;
+	}
+
 	/* If we're using a log file and the message has been written OK, we're done*/
 	if(rtOpts.eventLog.logEnabled && rtOpts.eventLog.logFP != NULL) {
 	    if(writeMessage(rtOpts.eventLog.logFP, &rtOpts.eventLog.lastHash, priority, format, ap) > 0) {
@@ -644,6 +755,11 @@ void
 restartLogging(RunTimeOpts* rtOpts)
 {
 
+	extern Boolean startupInProgress;
+
+	/* the writer thread owns the log files while running - drain and stop it first */
+	logWriterStop();
+
 	if(!restartLog(&rtOpts->statisticsLog, TRUE))
 		NOTIFY("Failed logging to %s file\n", rtOpts->statisticsLog.logID);
 
@@ -656,29 +772,275 @@ restartLogging(RunTimeOpts* rtOpts)
 	if(!restartLog(&rtOpts->statusLog, TRUE))
 		NOTIFY("Failed logging to %s file\n", rtOpts->statusLog.logID);
 
+	restartStatsSegment(rtOpts);
+
+	/* during startup the writer is started once we have daemonised */
+	if(rtOpts->logAsync && !startupInProgress)
+		logWriterStart();
+
 }
 
 void
 stopLogging(RunTimeOpts* rtOpts)
 {
+	logWriterStop();
+	closeStatsSegment();
 	closeLog(&rtOpts->statisticsLog);
 	closeLog(&rtOpts->recordLog);
 	closeLog(&rtOpts->eventLog);
 	closeLog(&rtOpts->statusLog);
 }
 
+/* Write a statistics line either directly or through the log writer thread */
+static Boolean
+writeStatisticsLine(FILE *destination, const char *line, int len)
+{
+	extern RunTimeOpts rtOpts;
+
+	if(logWriterActive()) {
+		logWriterQueue(destination == stdout ? LOGWRITER_STDOUT : LOGWRITER_FILE,
+			&rtOpts.statisticsLog, LOG_INFO, line, len);
+		return TRUE;
+	}
+
+	/* fwrite may get interrupted by a signal - silently retry once */
+	if (fwrite(line, 1, len, destination) < len) {
+	    if (fwrite(line, 1, len, destination) < len) {
+		return FALSE;
+	    }
+	}
+
+	return TRUE;
+}
+
+#define TI_NS(t) ((int64_t)(t).seconds * 1000000000LL + (t).nanoseconds)
+
+/* Pack a binary statistics log header record, return its length */
+static int
+packStatisticsHeader(PtpClock *ptpClock, TimeInternal *now, char *buf)
+{
+	StatsLogHeader hdr;
+
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.version = STATSLOG_VERSION;
+	hdr.recordSize = STATSLOG_RECORD_SIZE;
+	hdr.seconds = now->seconds;
+	hdr.nanoseconds = now->nanoseconds;
+	memcpy(hdr.clockIdentity, ptpClock->portDS.portIdentity.clockIdentity, CLOCK_IDENTITY_LENGTH);
+	hdr.portNumber = ptpClock->portDS.portIdentity.portNumber;
+	hdr.delayMechanism = ptpClock->portDS.delayMechanism;
+	hdr.domainNumber = ptpClock->defaultDS.domainNumber;
+#ifdef PTPD_STATISTICS
+	hdr.flags |= STATSLOG_HDR_STATISTICS;
+#endif /* PTPD_STATISTICS */
+
+	statsLogPackHeader((unsigned char*)buf, &hdr);
+	return STATSLOG_RECORD_SIZE;
+}
+
+/* Pack a binary statistics log sample record, return its length */
+static int
+packStatisticsSample(PtpClock *ptpClock, TimeInternal *now, char *buf)
+{
+	extern RunTimeOpts rtOpts;
+	StatsLogSample smp;
+
+	memset(&smp, 0, sizeof(smp));
+	smp.portState = ptpClock->portDS.portState;
+	smp.lastMessage = ptpClock->char_last_msg;
+	smp.sequenceId = ptpClock->msgTmpHeader.sequenceId;
+	smp.seconds = now->seconds;
+	smp.nanoseconds = now->nanoseconds;
+	smp.offsetFromMaster = TI_NS(ptpClock->currentDS.offsetFromMaster);
+	smp.delayMS = TI_NS(ptpClock->delayMS);
+	smp.observedDrift = ptpClock->servo.observedDrift;
+
+	if(rtOpts.delayMechanism == E2E) {
+		smp.meanPathDelay = TI_NS(ptpClock->currentDS.meanPathDelay);
+		smp.delaySM = TI_NS(ptpClock->delaySM);
+	} else {
+		smp.flags |= STATSLOG_FLAG_P2P;
+		smp.meanPathDelay = TI_NS(ptpClock->portDS.peerMeanPathDelay);
+		smp.delaySM = TI_NS(ptpClock->pdelaySM);
+	}
+
+	if(ptpClock->servo.runningMaxOutput)
+		smp.flags |= STATSLOG_FLAG_SERVO_MAXOUTPUT;
+
+#ifdef PTPD_STATISTICS
+	if(ptpClock->servo.isStable)
+		smp.flags |= STATSLOG_FLAG_SERVO_STABLE;
+	smp.rawDelayMS = TI_NS(ptpClock->rawDelayMS);
+	smp.rawDelaySM = TI_NS(ptpClock->rawDelaySM);
+	if(ptpClock->slaveStats.mpdIsStable)
+		smp.flags |= STATSLOG_FLAG_DELAY_STABLE;
+	if(ptpClock->oFilterMS.lastOutlier)
+		smp.flags |= STATSLOG_FLAG_MS_OUTLIER;
+	if(ptpClock->oFilterSM.lastOutlier)
+		smp.flags |= STATSLOG_FLAG_SM_OUTLIER;
+#else
+	smp.rawDelayMS = smp.delayMS;
+	smp.rawDelaySM = smp.delaySM;
+#endif /* PTPD_STATISTICS */
+
+	statsLogPackSample((unsigned char*)buf, &smp);
+	return STATSLOG_RECORD_SIZE;
+}
+
+static void
+resetStatsLogAccumulator(StatsLogAccumulator *acc)
+{
+	acc->count = 0;
+	acc->min = 0.0;
+	acc->max = 0.0;
+	acc->mean = 0.0;
+	acc->m2 = 0.0;
+#ifdef PTPD_STATISTICS
+	resetLogHistogram(&acc->histogram);
+#endif /* PTPD_STATISTICS */
+}
+
+/* Welford's online mean and variance */
+static void
+feedStatsLogAccumulator(StatsLogAccumulator *acc, double sample)
+{
+	double delta;
+
+	if(!acc->count || sample < acc->min)
+		acc->min = sample;
+	if(!acc->count || sample > acc->max)
+		acc->max = sample;
+	acc->count++;
+	delta = sample - acc->mean;
+	acc->mean += delta / acc->count;
+	acc->m2 += delta * (sample - acc->mean);
+#ifdef PTPD_STATISTICS
+	feedLogHistogram(&acc->histogram, sample);
+#endif /* PTPD_STATISTICS */
+}
+
+static int
+snprint_StatsLogAccumulator(char *s, int max_len, const StatsLogAccumulator *acc)
+{
+	int len;
+
+	len = snprintf(s, max_len, ", %d, %.09f, %.09f, %.09f, %.09f", acc->count,
+		acc->min, acc->max, acc->mean,
+		(acc->count > 1) ? sqrt(acc->m2 / (acc->count - 1)) : 0.0);
+#ifdef PTPD_STATISTICS
+	len += snprintf(s + len, max_len - len, ", %.09f, %.09f, %.09f",
+		getLogHistogramPercentile(&acc->histogram, 50.0),
+		getLogHistogramPercentile(&acc->histogram, 99.0),
+		getLogHistogramPercentile(&acc->histogram, 99.9));
+#endif /* PTPD_STATISTICS */
+	return len;
+}
+
+/* start a new summary interval */
+static void
+startStatsLogAggregate(PtpClock *ptpClock, TimeInternal *now)
+{
+	StatsLogAggregate *agg = &ptpClock->statsLogAggregate;
+
+	agg->started = TRUE;
+	agg->start = now->seconds;
+	resetStatsLogAccumulator(&agg->offset);
+	resetStatsLogAccumulator(&agg->delay);
+	agg->sequenceErrors = ptpClock->counters.sequenceMismatchErrors;
+#ifdef PTPD_STATISTICS
+	agg->delayMSOutliers = ptpClock->counters.delayMSOutliersFound;
+	agg->delaySMOutliers = ptpClock->counters.delaySMOutliersFound;
+#endif /* PTPD_STATISTICS */
+}
+
+/* Count the current sample into the summary, return TRUE when the interval is over */
+static Boolean
+feedStatsLogAggregate(PtpClock *ptpClock, TimeInternal *now)
+{
+	extern RunTimeOpts rtOpts;
+	StatsLogAggregate *agg = &ptpClock->statsLogAggregate;
+
+	if(!agg->started) {
+		startStatsLogAggregate(ptpClock, now);
+	}
+
+	if(ptpClock->portDS.portState == PTP_SLAVE &&
+	    (ptpClock->char_last_msg != agg->lastMessage ||
+	    ptpClock->msgTmpHeader.sequenceId != agg->lastSequenceId)) {
+		agg->lastMessage = ptpClock->char_last_msg;
+		agg->lastSequenceId = ptpClock->msgTmpHeader.sequenceId;
+		switch(ptpClock->char_last_msg) {
+			case 'S':
+				feedStatsLogAccumulator(&agg->offset,
+				    timeInternalToDouble(&ptpClock->currentDS.offsetFromMaster));
+				break;
+			case 'D':
+				feedStatsLogAccumulator(&agg->delay,
+				    timeInternalToDouble(&ptpClock->currentDS.meanPathDelay));
+				break;
+			case 'P':
+				feedStatsLogAccumulator(&agg->delay,
+				    timeInternalToDouble(&ptpClock->portDS.peerMeanPathDelay));
+				break;
+			default:
+				break;
+		}
+	}
+
+	return (now->seconds - agg->start) >= max(rtOpts.statisticsLogInterval, 1);
+}
+
+/* Format the interval summary and start the next interval */
+static int
+snprint_StatsLogAggregate(char *s, int max_len, PtpClock *ptpClock, TimeInternal *now)
+{
+	StatsLogAggregate *agg = &ptpClock->statsLogAggregate;
+	int len;
+
+	len = snprint_PortIdentity(s, max_len, &ptpClock->parentDS.parentPortIdentity);
+	len += snprintf(s + len, max_len - len, ", %d", now->seconds - agg->start);
+	len += snprint_StatsLogAccumulator(s + len, max_len - len, &agg->offset);
+	len += snprint_StatsLogAccumulator(s + len, max_len - len, &agg->delay);
+	len += snprintf(s + len, max_len - len, ", %d",
+		ptpClock->counters.sequenceMismatchErrors - agg->sequenceErrors);
+#ifdef PTPD_STATISTICS
+	len += snprintf(s + len, max_len - len, ", %d, %d",
+		ptpClock->counters.delayMSOutliersFound - agg->delayMSOutliers,
+		ptpClock->counters.delaySMOutliersFound - agg->delaySMOutliers);
+#endif /* PTPD_STATISTICS */
+
+	startStatsLogAggregate(ptpClock, now);
+	return len;
+}
+
+/*
+ * Clamp a running snprintf() length to the buffer size: once an append is
+ * truncated, the returned length runs past the buffer and the next append
+ * would be handed a wrapped size.
+ */
+static int
+clampLength(int len, int size)
+{
+	return (len >= size) ? size - 1 : len;
+}
+
 void
 logStatistics(PtpClock * ptpClock)
 {
 	extern RunTimeOpts rtOpts;
 	static int errorMsg = 0;
-	static char sbuf[SCREEN_BUFSZ * 2];
+	/* header and percentile columns need well over two screen lines */
+	static char sbuf[SCREEN_BUFSZ * 8];
 	int len = 0;
 	TimeInternal now;
 	time_t time_s;
 	FILE* destination;
 	static TimeInternal prev_now_sync, prev_now_delay;
 	char time_str[MAXTIMESTR];
+	Boolean binary, aggregate;
+#ifdef PTPD_STATISTICS
+	int i;
+#endif /* PTPD_STATISTICS */
 
 	if (!rtOpts.logStatistics) {
 		return;
@@ -689,26 +1051,81 @@ logStatistics(PtpClock * ptpClock)
 	else
 	    destination = stdout;
 
+	/* binary records only ever go to a file */
+	binary = (rtOpts.statisticsLogFormat == STATSLOG_FORMAT_BINARY) && (destination != stdout);
+	aggregate = (rtOpts.statisticsLogMode == STATSLOG_MODE_AGGREGATE) && !binary;
+
+	/* the log writer thread rotated the file - write the header again */
+	if(destination != stdout && logWriterRotated(&rtOpts.statisticsLog))
+		ptpClock->resetStatisticsLog = TRUE;
+
+	getTime(&now);
+
+	if (ptpClock->resetStatisticsLog && binary) {
+		ptpClock->resetStatisticsLog = FALSE;
+		writeStatisticsLine(destination, sbuf, packStatisticsHeader(ptpClock, &now, sbuf));
+	}
+
+	if (ptpClock->resetStatisticsLog && aggregate) {
+		ptpClock->resetStatisticsLog = FALSE;
+		len = snprintf(sbuf, sizeof(sbuf), "# %s, State, Clock ID, Interval",
+			(rtOpts.statisticsTimestamp == TIMESTAMP_BOTH) ? "Timestamp, Unix timestamp" : "Timestamp");
+		len = clampLength(len, sizeof(sbuf));
+		len += snprintf(sbuf + len, sizeof(sbuf) - len, ", Offset From Master Count, Offset From Master Min"
+			", Offset From Master Max, Offset From Master Mean, Offset From Master Std Dev"
+#ifdef PTPD_STATISTICS
+			", Offset From Master p50, Offset From Master p99, Offset From Master p99.9"
+#endif /* PTPD_STATISTICS */
+			", One Way Delay Count, One Way Delay Min, One Way Delay Max, One Way Delay Mean"
+			", One Way Delay Std Dev"
+#ifdef PTPD_STATISTICS
+			", One Way Delay p50, One Way Delay p99, One Way Delay p99.9"
+#endif /* PTPD_STATISTICS */
+			", Sequence Errors"
+#ifdef PTPD_STATISTICS
+			", delayMS Outliers, delaySM Outliers"
+#endif /* PTPD_STATISTICS */
+			"\n");
+		len = clampLength(len, sizeof(sbuf));
+		writeStatisticsLine(destination, sbuf, len);
+		len = 0;
+	}
+
 	if (ptpClock->resetStatisticsLog) {
 		ptpClock->resetStatisticsLog = FALSE;
-		fprintf(destination,"# %s, State, Clock ID, One Way Delay, "
+		len = snprintf(sbuf, sizeof(sbuf), "# %s, State, Clock ID, One Way Delay, "
 		       "Offset From Master, Slave to Master, "
 		       "Master to Slave, Observed Drift, Last packet Received, Sequence ID"
 #ifdef PTPD_STATISTICS
 			", One Way Delay Mean, One Way Delay Std Dev, Offset From Master Mean, Offset From Master Std Dev, Observed Drift Mean, Observed Drift Std Dev, raw delayMS, raw delaySM"
 #endif
-			"\n", (rtOpts.statisticsTimestamp == TIMESTAMP_BOTH) ? "Timestamp, Unix timestamp" : "Timestamp");
+			, (rtOpts.statisticsTimestamp == TIMESTAMP_BOTH) ? "Timestamp, Unix timestamp" : "Timestamp");
+		len = clampLength(len, sizeof(sbuf));
+#ifdef PTPD_STATISTICS
+		for(i = 0; i < PTP_HISTOGRAM_MAX; i++) {
+			len += snprintf(sbuf + len, sizeof(sbuf) - len, ", %s p50, %s p99, %s p99.9",
+				getPtpHistogramName(i), getPtpHistogramName(i), getPtpHistogramName(i));
+			len = clampLength(len, sizeof(sbuf));
+		}
+#endif /* PTPD_STATISTICS */
+		len += snprintf(sbuf + len, sizeof(sbuf) - len, "\n");
+		len = clampLength(len, sizeof(sbuf));
+		writeStatisticsLine(destination, sbuf, len);
+		len = 0;
 	}
 
 	memset(sbuf, 0, sizeof(sbuf));
 
-	getTime(&now);
-
 	/*
-	 * print one log entry per X seconds for Sync and DelayResp messages, to reduce disk usage.
+	 * print one log entry per X seconds for Sync and DelayResp messages, to reduce disk usage,
+	 * or in aggregate mode count every sample and print one summary per X seconds.
 	 */
 
-	if ((ptpClock->portDS.portState == PTP_SLAVE) && (rtOpts.statisticsLogInterval)) {
+	if (aggregate) {
+		if (!feedStatsLogAggregate(ptpClock, &now)) {
+			return;
+		}
+	} else if ((ptpClock->portDS.portState == PTP_SLAVE) && (rtOpts.statisticsLogInterval)) {
 			
 		switch(ptpClock->char_last_msg) {
 			case 'S':
@@ -730,6 +1147,11 @@ logStatistics(PtpClock * ptpClock)
 		}
 	}
 
+	if(binary) {
+		len = packStatisticsSample(ptpClock, &now, sbuf);
+		goto write;
+	}
+
 	time_s = now.seconds;
 
 	/* output date-time timestamp if configured */
@@ -749,7 +1171,10 @@ logStatistics(PtpClock * ptpClock)
 		       translatePortState(ptpClock)); /* State */
 	}
 
-	if (ptpClock->portDS.portState == PTP_SLAVE) {
+	if (aggregate) {
+		len += snprint_StatsLogAggregate(sbuf + len, sizeof(sbuf) - len, ptpClock, &now);
+		len = clampLength(len, sizeof(sbuf));
+	} else if (ptpClock->portDS.portState == PTP_SLAVE) {
 		len += snprint_PortIdentity(sbuf + len, sizeof(sbuf) - len,
 			 &ptpClock->parentDS.parentPortIdentity); /* Clock ID */
 
@@ -820,6 +1245,15 @@ logStatistics(PtpClock * ptpClock)
 
 		len += snprint_TimeInternal(sbuf + len, sizeof(sbuf) - len,
 							&(ptpClock->rawDelaySM));
+		len = clampLength(len, sizeof(sbuf));
+
+		for(i = 0; i < PTP_HISTOGRAM_MAX; i++) {
+			len += snprintf(sbuf + len, sizeof(sbuf) - len, ", %.09f, %.09f, %.09f",
+				ptpClock->histograms.snapshot[i].p50,
+				ptpClock->histograms.snapshot[i].p99,
+				ptpClock->histograms.snapshot[i].p999);
+			len = clampLength(len, sizeof(sbuf));
+		}
 
 #endif /* PTPD_STATISTICS */
 
@@ -838,10 +1272,12 @@ logStatistics(PtpClock * ptpClock)
 						     sizeof(sbuf) - len,
 						     " %d ", ptpClock->resetCount);
 		}
+		len = clampLength(len, sizeof(sbuf));
 	}
 	
 	/* add final \n in normal status lines */
 	len += snprintf(sbuf + len, sizeof(sbuf) - len, "\n");
+	len = clampLength(len, sizeof(sbuf));
 
 #if 0   /* NOTE: Do we want this? */
 	if (rtOpts.nonDaemon) {
@@ -850,17 +1286,16 @@ logStatistics(PtpClock * ptpClock)
 	}
 #endif
 
-	/* fprintf may get interrupted by a signal - silently retry once */
-	if (fprintf(destination, "%s", sbuf) < len) {
-	    if (fprintf(destination, "%s", sbuf) < len) {
+write:
+	if(!writeStatisticsLine(destination, sbuf, len)) {
 		if(!errorMsg) {
 		    PERROR("Error while writing statistics");
 		}
 		errorMsg = TRUE;
-	    }
 	}
 
-	if(destination == rtOpts.statisticsLog.logFP) {
+	/* with the log writer running, rotation is done by the writer thread */
+	if(destination == rtOpts.statisticsLog.logFP && !logWriterActive()) {
 		if (maintainLogSize(&rtOpts.statisticsLog))
 			ptpClock->resetStatisticsLog = TRUE;
 	}
@@ -981,6 +1416,7 @@ writeStatusFile(PtpClock *ptpClock,const RunTimeOpts *rtOpts, Boolean quiet)
 
 	char outBuf[2048];
 	char tmpBuf[200];
+	int i;
 
 	int n = getAlarmSummary(NULL, 0, ptpClock->alarms, ALRM_MAX);
 	char alarmBuf[n];
@@ -1001,13 +1437,26 @@ writeStatusFile(PtpClock *ptpClock,const RunTimeOpts *rtOpts, Boolean quiet)
 	strftime(timeStr, MAXTIMESTR, "%a %b %d %X %Z %Y", localtime((time_t*)&now.tv_sec));
 	
 	FILE* out = rtOpts->statusLog.logFP;
-	memset(outBuf, 0, sizeof(outBuf));
+	char *asyncBuf = NULL;
+	size_t asyncLen = 0;
+	Boolean async = logWriterActive();
+
+	/* render into memory and let the log writer replace the file contents */
+	if(async) {
+	    out = open_memstream(&asyncBuf, &asyncLen);
+	    if(out == NULL) {
+		DBG("writeStatusFile: open_memstream() failed\n");
+		return;
+	    }
+	} else {
+	    memset(outBuf, 0, sizeof(outBuf));
 
-	setbuf(out, outBuf);
-	if(ftruncate(fileno(out), 0) < 0) {
-	    DBG("writeStatusFile: ftruncate() failed\n");
+	    setbuf(out, outBuf);
+	    if(ftruncate(fileno(out), 0) < 0) {
+		DBG("writeStatusFile: ftruncate() failed\n");
+	    }
+	    rewind(out);
 	}
-	rewind(out);
 
 	fprintf(out, 		STATUSPREFIX"  %s, PID %d\n","Host info", hostName, (int)getpid());
 	fprintf(out, 		STATUSPREFIX"  %s\n","Local time", timeStr);
@@ -1183,6 +1632,81 @@ else {
 
 	}
 
+#ifdef PTPD_STATISTICS
+	if(ptpClock->holdover.enabled) {
+	fprintf(out, 		STATUSPREFIX"  ","Holdover");
+	if(ptpClock->holdover.active) {
+	    fprintf(out, "active %.0f s, drift % .03f ppm, est. time error %.0f ns",
+		ptpClock->holdover.elapsed,
+		ptpClock->holdover.predictedDrift / 1000.0,
+		ptpClock->holdover.timeError);
+	} else if(ptpClock->holdover.modelValid) {
+	    fprintf(out, "ready, trend % .06f ppb/s, residual %.03f ppb, %d samples",
+		ptpClock->holdover.driftTrend,
+		ptpClock->holdover.driftResidual,
+		ptpClock->holdover.count);
+	} else {
+	    fprintf(out, "learning, %d of %d samples",
+		ptpClock->holdover.count, HOLDOVER_MIN_SAMPLES);
+	}
+	fprintf(out,"\n");
+	}
+
+	/* every other octave keeps the lines short */
+	if(ptpClock->portDS.portState == PTP_SLAVE &&
+	    ptpClock->stability.taus[0].adevCount) {
+	    fprintf(out, 		STATUSPREFIX" ","ADEV");
+	    for(i = 0; i < STABILITY_TAUS && ptpClock->stability.taus[i].adevCount; i += 2) {
+		fprintf(out, " %.0fs %.02e", getStabilityTau(&ptpClock->stability.taus[i]),
+		    getStabilityAdev(&ptpClock->stability.taus[i]));
+	    }
+	    fprintf(out,"\n");
+	    fprintf(out, 		STATUSPREFIX" ","TDEV (ns)");
+	    for(i = 0; i < STABILITY_TAUS && ptpClock->stability.taus[i].tdevCount; i += 2) {
+		fprintf(out, " %.0fs %.01f", getStabilityTau(&ptpClock->stability.taus[i]),
+		    getStabilityTdev(&ptpClock->stability.taus[i]) * 1E9);
+	    }
+	    fprintf(out,"\n");
+	    fprintf(out, 		STATUSPREFIX" ","MTIE (ns)");
+	    for(i = 0; i < STABILITY_TAUS && ptpClock->stability.taus[i].adevCount; i += 2) {
+		fprintf(out, " %.0fs %.0f", getStabilityTau(&ptpClock->stability.taus[i]),
+		    getStabilityMtie(&ptpClock->stability.taus[i]) * 1E9);
+	    }
+	    fprintf(out,"\n");
+	}
+
+	if(ptpClock->portDS.portState == PTP_SLAVE) {
+	    for(i = 0; i < PTP_HISTOGRAM_MAX; i++) {
+		LogHistogramSnapshot *snap = &ptpClock->histograms.snapshot[i];
+		if(!snap->count) {
+		    continue;
+		}
+		fprintf(out, 	STATUSPREFIX" p50 %.0f ns, p99 %.0f ns, p99.9 %.0f ns, max %.0f ns, %d samples\n",
+		    getPtpHistogramName(i), snap->p50 * 1E9, snap->p99 * 1E9,
+		    snap->p999 * 1E9, snap->max * 1E9, snap->count);
+	    }
+	}
+#endif /* PTPD_STATISTICS */
+
+	for(i = 0; i < LATENCY_STAGE_MAX; i++) {
+	    const LatencyStage *stage = &ptpClock->latency.stages[i];
+	    if(!stage->count) {
+		continue;
+	    }
+	    fprintf(out, 	STATUSPREFIX" last %u ns, mean %llu ns, max %u ns",
+		getLatencyStageName(i), stage->last,
+		(unsigned long long)(stage->total / stage->count), stage->max);
+#ifdef PTPD_STATISTICS
+	    if(stage->snapshot.count) {
+		fprintf(out, ", p99 %.0f ns", stage->snapshot.p99 * 1E9);
+	    }
+#endif /* PTPD_STATISTICS */
+	    if(i == LATENCY_TX_SYNC && ptpClock->latency.syncOverruns) {
+		fprintf(out, ", %u overruns", ptpClock->latency.syncOverruns);
+	    }
+	    fprintf(out, "\n");
+	}
+
 
 
 	if(ptpClock->portDS.portState == PTP_MASTER || ptpClock->portDS.portState == PTP_PASSIVE) {
@@ -1364,6 +1888,13 @@ else {
 
 
 	fflush(out);
+
+	if(async) {
+	    logWriterQueue(LOGWRITER_REPLACE, (LogFileHandler*)&rtOpts->statusLog,
+			    LOG_INFO, asyncBuf, asyncLen);
+	    fclose(out);
+	    free(asyncBuf);
+	}
 }
 
 void
@@ -1384,7 +1915,15 @@ void
 recordSync(UInteger16 sequenceId, TimeInternal * time)
 {
 	extern RunTimeOpts rtOpts;
-	if (rtOpts.recordLog.logEnabled && rtOpts.recordLog.logFP != NULL) {
+	char buf[40];
+	int len;
+
+	if (rtOpts.recordLog.logEnabled && rtOpts.recordLog.logFP != NULL && logWriterActive()) {
+		len = snprintf(buf, sizeof(buf), "%d %llu\n", sequenceId,
+		  ((time->seconds * 1000000000ULL) + time->nanoseconds)
+		);
+		logWriterQueue(LOGWRITER_FILE, &rtOpts.recordLog, LOG_INFO, buf, len);
+	} else if (rtOpts.recordLog.logEnabled && rtOpts.recordLog.logFP != NULL) {
 		fprintf(rtOpts.recordLog.logFP, "%d %llu\n", sequenceId,
 		  ((time->seconds * 1000000000ULL) + time->nanoseconds)
 		);
@@ -1521,7 +2060,7 @@ getTimeMonotonic(TimeInternal * time)
 #if defined(_POSIX_TIMERS) && (_POSIX_TIMERS > 0)
 
 	struct timespec tp;
-#ifndef CLOCK_MONOTINIC                                                                                                      
+#ifndef CLOCK_MONOTONIC
 	if (clock_gettime(CLOCK_REALTIME, &tp) < 0) {
 #else
 	if (clock_gettime(CLOCK_MONOTONIC, &tp) < 0) {
@@ -1856,6 +2395,154 @@ end:
 
 #ifdef HAVE_SYS_TIMEX_H
 
+/*
+ * Clock actuator: every adjtimex() modification goes through here. Changes to
+ * frequency, status flags, TAI offset, error estimates and phase are staged in
+ * a single struct timex. Outside of a batch they are applied immediately; between
+ * clockActuatorBegin() and clockActuatorCommit() they are coalesced and applied
+ * with one adjtimex() call, and the kernel status is only read once.
+ */
+typedef struct {
+	Boolean initialised;
+	/* USER_HZ and derived values - constant, so only queried once */
+	Integer32 userHZ;
+	Integer32 tickRes;
+	long baseTick;
+	/* batch nesting level */
+	int batch;
+	/* kernel status (incl. staged changes), valid for the duration of a batch */
+	Boolean statusValid;
+	int status;
+	/* report TIME_OOP / TIME_WAIT on commit */
+	Boolean leapWarnings;
+	/* staged changes */
+	struct timex tmx;
+} ClockActuator;
+
+static ClockActuator actuator;
+
+static void
+initClockActuator(void)
+{
+
+	if(actuator.initialised)
+		return;
+
+	memset(&actuator, 0, sizeof(actuator));
+
+#ifdef HAVE_STRUCT_TIMEX_TICK
+	/* Get the USER_HZ value */
+	actuator.userHZ = sysconf(_SC_CLK_TCK);
+	if(actuator.userHZ <= 0)
+		actuator.userHZ = 100;
+
+	/*
+	 * Get the tick resolution (ppb) - offset caused by changing the tick value by 1.
+	 * The ticks value is the duration of one tick in us. So with userHz = 100  ticks per second,
+	 * change of ticks by 1 (us) means a 100 us frequency shift = 100 ppm = 100000 ppb.
+	 * For userHZ = 1000, change by 1 is a 1ms offset (10 times more ticks per second)
+	 */
+	actuator.tickRes = actuator.userHZ * 1000;
+
+	/* Base tick duration - 10000 when userHZ = 100 */
+	actuator.baseTick = 1E6 / actuator.userHZ;
+#endif /* HAVE_STRUCT_TIMEX_TICK */
+
+	actuator.initialised = TRUE;
+
+}
+
+/* apply all staged changes with a single adjtimex() call */
+static Boolean
+flushClockActuator(void)
+{
+
+	int ret;
+
+	if(!actuator.tmx.modes)
+		return TRUE;
+
+	DBGV("flushClockActuator: applying modes 0x%04x\n", actuator.tmx.modes);
+
+	ret = adjtimex(&actuator.tmx);
+
+	if (ret < 0) {
+		PERROR("Could not adjust kernel clock: %s", strerror(errno));
+		actuator.statusValid = FALSE;
+	} else {
+		/* adjtimex() returns the current state in the same struct */
+		actuator.status = actuator.tmx.status;
+		actuator.statusValid = (actuator.batch > 0);
+	}
+
+	if(actuator.leapWarnings && ret > 2) {
+		switch (ret) {
+		case TIME_OOP:
+			WARNING("Adjtimex: leap second already in progress\n");
+			break;
+		case TIME_WAIT:
+			WARNING("Adjtimex: leap second already occurred\n");
+			break;
+#if !defined(TIME_BAD)
+		case TIME_ERROR:
+#else
+		case TIME_BAD:
+#endif /* TIME_BAD */
+		default:
+			DBGV("flushClockActuator: adjtimex() returned TIME_BAD\n");
+			break;
+		}
+	}
+
+	memset(&actuator.tmx, 0, sizeof(actuator.tmx));
+	actuator.leapWarnings = FALSE;
+
+	return (ret >= 0);
+
+}
+
+/* commit staged changes unless a batch is open */
+static Boolean
+stageClockActuator(void)
+{
+
+	if(actuator.batch > 0)
+		return TRUE;
+
+	return flushClockActuator();
+
+}
+
+/* open an actuation batch - batches can be nested */
+void
+clockActuatorBegin(void)
+{
+
+	initClockActuator();
+
+	if(actuator.batch++ == 0)
+		actuator.statusValid = FALSE;
+
+}
+
+/* close an actuation batch - the outermost commit issues the adjtimex() call */
+Boolean
+clockActuatorCommit(void)
+{
+
+	if(actuator.batch == 0) {
+		DBG("clockActuatorCommit called without clockActuatorBegin\n");
+		return flushClockActuator();
+	}
+
+	if(--actuator.batch > 0)
+		return TRUE;
+
+	actuator.statusValid = FALSE;
+	return flushClockActuator();
+
+}
+
 /*
  * Apply a tick / frequency shift to the kernel clock
  */
@@ -1865,7 +2552,6 @@ adjFreq(double adj)
 {
 
 	extern RunTimeOpts rtOpts;
-	struct timex t;
 
 #ifdef HAVE_STRUCT_TIMEX_TICK
 	Integer32 tickAdj = 0;
@@ -1876,7 +2562,9 @@ adjFreq(double adj)
 
 #endif /* HAVE_STRUCT_TIMEX_TICK */
 
-	memset(&t, 0, sizeof(t));
+	PTPD_PROBE1(adj__freq, (int64_t)(adj * 1000.0));
+
+	initClockActuator();
 
 	/* Clamp to max PPM */
 	if (adj > rtOpts.servoMaxPpb){
@@ -1888,20 +2576,9 @@ adjFreq(double adj)
 /* Y U NO HAVE TICK? */
 #ifdef HAVE_STRUCT_TIMEX_TICK
 
-	/* Get the USER_HZ value */
-	Integer32 userHZ = sysconf(_SC_CLK_TCK);
-
-	/*
-	 * Get the tick resolution (ppb) - offset caused by changing the tick value by 1.
-	 * The ticks value is the duration of one tick in us. So with userHz = 100  ticks per second,
-	 * change of ticks by 1 (us) means a 100 us frequency shift = 100 ppm = 100000 ppb.
-	 * For userHZ = 1000, change by 1 is a 1ms offset (10 times more ticks per second)
-	 */
-	Integer32 tickRes = userHZ * 1000;
-
 	/*
 	 * If we are outside the standard +/-512ppm, switch to a tick + freq combination:
-	 * Keep moving ticks from adj to tickAdj until we get back to the normal range.
+	 * Move whole ticks from adj to tickAdj until we get back to the normal range.
 	 * The offset change will not be super smooth as we flip between tick and frequency,
 	 * but this in general should only be happening under extreme conditions when dragging the
 	 * offset down from very large values. When maxPPM is left at the default value, behaviour
@@ -1910,37 +2587,67 @@ adjFreq(double adj)
 	 * from a previous NTP run.
 	 */
 	if (adj > ADJ_FREQ_MAX){
-		while (adj > ADJ_FREQ_MAX) {
-		    tickAdj++;
-		    adj -= tickRes;
-		}
-
+		tickAdj = ceil((adj - ADJ_FREQ_MAX) / actuator.tickRes);
 	} else if (adj < -ADJ_FREQ_MAX){
-		while (adj < -ADJ_FREQ_MAX) {
-		    tickAdj--;
-		    adj += tickRes;
-		}
-        }
-	/* Base tick duration - 10000 when userHZ = 100 */
-	t.tick = 1E6 / userHZ;
-	/* Tick adjustment if necessary */
-        t.tick += tickAdj;
+		tickAdj = -ceil((-adj - ADJ_FREQ_MAX) / actuator.tickRes);
+	}
+	adj -= tickAdj * actuator.tickRes;
 
+	/* Base tick duration plus tick adjustment if necessary */
+	actuator.tmx.tick = actuator.baseTick + tickAdj;
 
-	t.modes = ADJ_TICK;
+	actuator.tmx.modes |= ADJ_TICK;
 
 #endif /* HAVE_STRUCT_TIMEX_TICK */
 
-	t.modes |= MOD_FREQUENCY;
+	actuator.tmx.modes |= MOD_FREQUENCY;
 
 	double dFreq = adj * ((1 << 16) / 1000.0);
-	t.freq = (int) round(dFreq);
+	actuator.tmx.freq = (int) round(dFreq);
 #ifdef HAVE_STRUCT_TIMEX_TICK
-	DBG2("adjFreq: oldadj: %.09f, newadj: %.09f, tick: %d, tickadj: %d\n", oldAdj, adj,t.tick,tickAdj);
+	DBG2("adjFreq: oldadj: %.09f, newadj: %.09f, tick: %d, tickadj: %d\n", oldAdj, adj,actuator.tmx.tick,tickAdj);
 #endif /* HAVE_STRUCT_TIMEX_TICK */
-	DBG2("        adj is %.09f;  t freq is %d       (float: %.09f)\n", adj, t.freq,  dFreq);
-	
-	return !adjtimex(&t);
+	DBG2("        adj is %.09f;  t freq is %d       (float: %.09f)\n", adj, actuator.tmx.freq,  dFreq);
+
+	return stageClockActuator();
+}
+
+/*
+ * Step the clock by a relative amount. Where the kernel supports ADJ_SETOFFSET
+ * the step is applied in one call, avoiding the read-modify-write race of
+ * getTime() + setTime(). Returns FALSE if the step could not be done this way.
+ */
+static Boolean
+stepTimeKernel(TimeInternal *delta)
+{
+#if defined(ADJ_SETOFFSET) && defined(ADJ_NANO)
+
+	TimeInternal step = *delta;
+
+	initClockActuator();
+
+	normalizeTime(&step);
+
+	/* kernel wants a positive nanoseconds field */
+	if(step.nanoseconds < 0) {
+		step.seconds--;
+		step.nanoseconds += 1000000000;
+	}
+
+	actuator.tmx.modes |= ADJ_SETOFFSET | ADJ_NANO;
+	actuator.tmx.time.tv_sec = step.seconds;
+	actuator.tmx.time.tv_usec = step.nanoseconds;
+
+	/* a step must not wait for the end of the batch */
+	if(!flushClockActuator())
+		return FALSE;
+
+	WARNING("Stepped the system clock by: %s s\n", time2st(delta));
+	return TRUE;
+
+#else
+	return FALSE;
+#endif /* ADJ_SETOFFSET && ADJ_NANO */
 }
 
 
@@ -1969,61 +2676,45 @@ getAdjFreq(void)
 void
 informClockSource(PtpClock* ptpClock)
 {
-	struct timex tmx;
 
-	memset(&tmx, 0, sizeof(tmx));
+	initClockActuator();
 
-	tmx.modes = MOD_MAXERROR | MOD_ESTERROR;
+	actuator.tmx.modes |= MOD_MAXERROR | MOD_ESTERROR;
 
-	tmx.maxerror = (ptpClock->currentDS.offsetFromMaster.seconds * 1E9 +
+	actuator.tmx.maxerror = (ptpClock->currentDS.offsetFromMaster.seconds * 1E9 +
 			ptpClock->currentDS.offsetFromMaster.nanoseconds) / 1000;
-	tmx.esterror = tmx.maxerror;
+	actuator.tmx.esterror = actuator.tmx.maxerror;
 
-	if (adjtimex(&tmx) < 0)
-		DBG("informClockSource: could not set adjtimex flags: %s", strerror(errno));
+	stageClockActuator();
 }
 
-
-void
-unsetTimexFlags(int flags, Boolean quiet)
+/* stage a new kernel status word */
+static void
+stageTimexStatus(int status, Boolean quiet)
 {
-	struct timex tmx;
-	int ret;
 
-	memset(&tmx, 0, sizeof(tmx));
+	/* unset all read-only flags */
+	status &= ~STA_RONLY;
 
-	tmx.modes = MOD_STATUS;
+	actuator.tmx.modes |= MOD_STATUS;
+	actuator.tmx.status = status;
+	actuator.status = status;
 
-	tmx.status = getTimexFlags();
-	if(tmx.status == -1)
-		return;
-	/* unset all read-only flags */
-	tmx.status &= ~STA_RONLY;
-	tmx.status &= ~flags;
+	if(!quiet)
+		actuator.leapWarnings = TRUE;
 
-	ret = adjtimex(&tmx);
+	stageClockActuator();
+}
 
-	if (ret < 0)
-		PERROR("Could not unset adjtimex flags: %s", strerror(errno));
+void
+unsetTimexFlags(int flags, Boolean quiet)
+{
+	int status = getTimexFlags();
 
-	if(!quiet && ret > 2) {
-		switch (ret) {
-		case TIME_OOP:
-			WARNING("Adjtimex: leap second already in progress\n");
-			break;
-		case TIME_WAIT:
-			WARNING("Adjtimex: leap second already occurred\n");
-			break;
-#if !defined(TIME_BAD)
-		case TIME_ERROR:
-#else
-		case TIME_BAD:
-#endif /* TIME_BAD */
-		default:
-			DBGV("unsetTimexFlags: adjtimex() returned TIME_BAD\n");
-			break;
-		}
-	}
+	if(status == -1)
+		return;
+
+	stageTimexStatus(status & ~flags, quiet);
 }
 
 int getTimexFlags(void)
@@ -2031,6 +2722,12 @@ int getTimexFlags(void)
 	struct timex tmx;
 	int ret;
 
+	initClockActuator();
+
+	/* within a batch, the status only needs to be read once */
+	if(actuator.batch > 0 && actuator.statusValid)
+		return actuator.status;
+
 	memset(&tmx, 0, sizeof(tmx));
 
 	tmx.modes = 0;
@@ -2040,7 +2737,16 @@ int getTimexFlags(void)
 		return(-1);
 
 	}
-	return( tmx.status );
+
+	/* staged status changes take precedence over what the kernel has now */
+	if(actuator.tmx.modes & MOD_STATUS) {
+		actuator.status = actuator.tmx.status;
+	} else {
+		actuator.status = tmx.status;
+	}
+	actuator.statusValid = (actuator.batch > 0);
+
+	return( actuator.status );
 }
 
 Boolean
@@ -2062,22 +2768,15 @@ checkTimexFlags(int flags) {
 void
 setKernelUtcOffset(int utc_offset) {
 
-	struct timex tmx;
-	int ret;
-
-	memset(&tmx, 0, sizeof(tmx));
-
-	tmx.modes = MOD_TAI;
-	tmx.constant = utc_offset;
+	initClockActuator();
 
 	DBG2("Kernel NTP API supports TAI offset. "
 	     "Setting TAI offset to %d", utc_offset);
 
-	ret = adjtimex(&tmx);
+	actuator.tmx.modes |= MOD_TAI;
+	actuator.tmx.constant = utc_offset;
 
-	if (ret < 0) {
-		PERROR("Could not set kernel TAI offset: %s", strerror(errno));
-	}
+	stageClockActuator();
 }
 Boolean
 getKernelUtcOffset(int *utc_offset) {
@@ -2122,46 +2821,36 @@ getKernelUtcOffset(int *utc_offset) {
 void
 setTimexFlags(int flags, Boolean quiet)
 {
-	struct timex tmx;
-	int ret;
+	int status = getTimexFlags();
 
-	memset(&tmx, 0, sizeof(tmx));
+	if(status == -1)
+		return;
 
-	tmx.modes = MOD_STATUS;
+	stageTimexStatus(status | flags, quiet);
+}
 
-	tmx.status = getTimexFlags();
-	if(tmx.status == -1)
-		return;
-	/* unset all read-only flags */
-	tmx.status &= ~STA_RONLY;
-	tmx.status |= flags;
+#endif /* SYS_TIMEX_H */
 
-	ret = adjtimex(&tmx);
+/*
+ * Step the clock by delta: use the kernel's relative step if available,
+ * otherwise fall back to reading and setting the absolute time.
+ */
+void
+stepTime(TimeInternal *delta)
+{
 
-	if (ret < 0)
-		PERROR("Could not set adjtimex flags: %s", strerror(errno));
+	TimeInternal now, newTime;
 
-	if(!quiet && ret > 2) {
-		switch (ret) {
-		case TIME_OOP:
-			WARNING("Adjtimex: leap second already in progress\n");
-			break;
-		case TIME_WAIT:
-			WARNING("Adjtimex: leap second already occurred\n");
-			break;
-#if !defined(TIME_BAD)
-		case TIME_ERROR:
-#else
-		case TIME_BAD:
-#endif /* TIME_BAD */
-		default:
-			DBGV("unsetTimexFlags: adjtimex() returned TIME_BAD\n");
-			break;
-		}
-	}
-}
+#ifdef HAVE_SYS_TIMEX_H
+	if(stepTimeKernel(delta))
+		return;
+#endif /* HAVE_SYS_TIMEX_H */
 
-#endif /* SYS_TIMEX_H */
+	getTime(&now);
+	addTime(&newTime, &now, delta);
+	setTime(&newTime);
+
+}
 
 #define DRIFTFORMAT "%.0f"
 
@@ -2175,6 +2864,14 @@ restoreDrift(PtpClock * ptpClock, const RunTimeOpts * rtOpts, Boolean quiet)
 
 	DBGV("restoreDrift called\n");
 
+#ifdef PTPD_STATISTICS
+	/* holdover is driving the clock frequency - leave it alone */
+	if(ptpClock->holdover.active) {
+		DBGV("restoreDrift: clock in holdover, not restoring drift\n");
+		return;
+	}
+#endif /* PTPD_STATISTICS */
+
 	if (ptpClock->drift_saved && rtOpts->drift_recovery_method > 0 ) {
 		ptpClock->servo.observedDrift = ptpClock->last_saved_drift;
 		if (!rtOpts->noAdjust && ptpClock->clockControl.granted) {
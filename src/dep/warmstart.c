@@ -0,0 +1,449 @@
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file    warmstart.c
+ * @authors The PTPd Project
+ * @date   Wed Feb 3 14:52:18 2016
+ * This source file contains the warm start state snapshot: what a slave
+ * has learned about its parent, written periodically and on shutdown,
+ * so that a restarted daemon can pick up where it left off.
+ *
+ * The snapshot is a header followed by a WarmStartState record in host
+ * layout - it is only ever read back by the same host. It is written to
+ * a temporary file and renamed, so a reader never sees a partial record.
+ *
+ * loadWarmStart() runs from doInit(): it restores the drift, the time
+ * properties and - if they were left running on shutdown - the parent's
+ * unicast grants straight away.
+ * applyWarmStart() runs when entering SLAVE: if the saved parent was
+ * selected again, the path delay filter, calibration, servo statistics
+ * and outlier filter thresholds are restored, otherwise the snapshot
+ * is dropped and the slave learns from scratch.
+ */
+
+#include "../ptpd.h"
+
+#define WARMSTART_MAGIC		"PTPW"
+#define WARMSTART_VERSION	1
+
+/* snapshot flags */
+#define WARMSTART_SERVO_STABLE		0x0001
+#define WARMSTART_CLOCK_CONTROL		0x0002	/* PTP was in control of the clock */
+#define WARMSTART_GRANTS		0x0004	/* grants[] holds the parent's grants */
+
+/* grants this close to expiry are left to be re-requested */
+#define WARMSTART_GRANT_MARGIN		10
+
+typedef struct {
+	char magic[4];
+	UInteger16 version;
+	UInteger16 size;		/* sizeof(WarmStartState) - layout check */
+} WarmStartHeader;
+
+static void restoreGrants(const RunTimeOpts *rtOpts, PtpClock *ptpClock, Integer32 age);
+
+/* take a snapshot of the slave state and write it to the state file */
+Boolean
+saveWarmStart(const RunTimeOpts *rtOpts, PtpClock *ptpClock, Boolean quiet)
+{
+
+	WarmStartHeader header;
+	WarmStartState state;
+	TimeInternal now;
+	UnicastGrantData *grant;
+	char tmpPath[PATH_MAX + 5];
+	FILE *fp;
+	int i;
+
+	DBGV("saveWarmStart called\n");
+
+	/* only a slave with a path delay measurement has anything worth restoring */
+	if(ptpClock->portDS.portState != PTP_SLAVE ||
+	    ptpClock->defaultDS.clockQuality.clockClass < 128 ||
+	    ptpClock->delayRespWaiting) {
+		DBGV("Not a calibrated slave - not saving warm start state\n");
+		return FALSE;
+	}
+
+	if(ptpClock->servo.runningMaxOutput) {
+		DBG("Servo running at maximum shift - not saving warm start state\n");
+		return FALSE;
+	}
+
+	memset(&state, 0, sizeof(state));
+
+	getTime(&now);
+	state.savedAt = now.seconds;
+
+	copyClockIdentity(state.clockIdentity, ptpClock->defaultDS.clockIdentity);
+	state.domainNumber = ptpClock->defaultDS.domainNumber;
+	state.delayMechanism = ptpClock->portDS.delayMechanism;
+
+	state.parentPortIdentity = ptpClock->parentDS.parentPortIdentity;
+	copyClockIdentity(state.grandmasterIdentity, ptpClock->parentDS.grandmasterIdentity);
+	if(ptpClock->bestMaster != NULL) {
+		state.parentAddress = ptpClock->bestMaster->sourceAddr;
+	}
+
+	if(ptpClock->portDS.delayMechanism == P2P) {
+		state.meanPathDelay = ptpClock->portDS.peerMeanPathDelay.nanoseconds;
+	} else {
+		state.meanPathDelay = ptpClock->currentDS.meanPathDelay.nanoseconds;
+	}
+
+	state.observedDrift = ptpClock->servo.observedDrift;
+
+#ifdef PTPD_STATISTICS
+	if(ptpClock->servo.isStable) {
+		state.flags |= WARMSTART_SERVO_STABLE;
+	}
+	state.driftMean = ptpClock->servo.driftMean;
+	state.driftStdDev = ptpClock->servo.driftStdDev;
+	if(ptpClock->oFilterMS.config.enabled) {
+		state.oFilterMSThreshold = ptpClock->oFilterMS.threshold;
+	}
+	if(ptpClock->oFilterSM.config.enabled) {
+		state.oFilterSMThreshold = ptpClock->oFilterSM.threshold;
+	}
+#endif /* PTPD_STATISTICS */
+
+	if(ptpClock->clockControl.granted) {
+		state.flags |= WARMSTART_CLOCK_CONTROL;
+	}
+
+	state.timePropertiesDS = ptpClock->timePropertiesDS;
+
+	/* grants only go in the snapshot taken on a stop that leaves them running */
+	if(ptpClock->keepGrants && rtOpts->unicastNegotiation && ptpClock->parentGrants != NULL) {
+		state.parentAddress = ptpClock->parentGrants->transportAddress;
+		for(i = 0; i < PTP_MAX_MESSAGE_INDEXED; i++) {
+			grant = &ptpClock->parentGrants->grantData[i];
+			if(!grant->granted || grant->expired || grant->canceled) {
+				continue;
+			}
+			state.grants[i].granted = TRUE;
+			state.grants[i].logInterval = grant->logInterval;
+			state.grants[i].duration = grant->duration;
+			state.grants[i].timeLeft = grant->timeLeft;
+			state.flags |= WARMSTART_GRANTS;
+		}
+	}
+
+	memcpy(header.magic, WARMSTART_MAGIC, sizeof(header.magic));
+	header.version = WARMSTART_VERSION;
+	header.size = sizeof(state);
+
+	snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", rtOpts->warmStartFile);
+
+	if((fp = fopen(tmpPath, "w")) == NULL) {
+		PERROR("Could not open warm start state file %s for writing", tmpPath);
+		return FALSE;
+	}
+
+	if(fwrite(&header, sizeof(header), 1, fp) != 1 ||
+	    fwrite(&state, sizeof(state), 1, fp) != 1 ||
+	    fflush(fp) != 0) {
+		PERROR("Could not write warm start state to %s", tmpPath);
+		fclose(fp);
+		unlink(tmpPath);
+		return FALSE;
+	}
+
+	fclose(fp);
+
+	if(rename(tmpPath, rtOpts->warmStartFile) == -1) {
+		PERROR("Could not rename %s to %s", tmpPath, rtOpts->warmStartFile);
+		unlink(tmpPath);
+		return FALSE;
+	}
+
+	if(quiet) {
+		DBGV("Wrote warm start state to %s\n", rtOpts->warmStartFile);
+	} else {
+		INFO("Wrote warm start state to %s\n", rtOpts->warmStartFile);
+	}
+
+	return TRUE;
+
+}
+
+/* read the state file and restore what does not depend on the parent being selected again */
+void
+loadWarmStart(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	static Boolean loaded = FALSE;
+
+	WarmStartHeader header;
+	WarmStartState state;
+	TimeInternal now;
+	Integer32 age;
+	char portId[PATH_MAX];
+	FILE *fp;
+
+	DBGV("loadWarmStart called\n");
+
+	ptpClock->warmStartPending = FALSE;
+
+	/*
+	 * doInit() also runs when the port is re-initialised (fault recovery,
+	 * network restart, backup interface switch) - by then the in-memory
+	 * state is fresher than the file, so only the first init uses it.
+	 */
+	if(loaded) {
+		return;
+	}
+
+	loaded = TRUE;
+
+	if(!rtOpts->warmStart || ptpClock->defaultDS.clockQuality.clockClass < 128) {
+		return;
+	}
+
+	if((fp = fopen(rtOpts->warmStartFile, "r")) == NULL) {
+		if(errno != ENOENT) {
+			PERROR("Could not open warm start state file %s", rtOpts->warmStartFile);
+		} else {
+			INFO("Warm start state file %s not found - will be initialised on write\n",
+			    rtOpts->warmStartFile);
+		}
+		return;
+	}
+
+	if(fread(&header, sizeof(header), 1, fp) != 1 ||
+	    fread(&state, sizeof(state), 1, fp) != 1) {
+		WARNING("Could not read warm start state from %s - ignoring\n", rtOpts->warmStartFile);
+		fclose(fp);
+		return;
+	}
+
+	fclose(fp);
+
+	if(memcmp(header.magic, WARMSTART_MAGIC, sizeof(header.magic)) ||
+	    header.version != WARMSTART_VERSION || header.size != sizeof(state)) {
+		WARNING("Warm start state file %s has an unsupported format - ignoring\n",
+		    rtOpts->warmStartFile);
+		return;
+	}
+
+	if(memcmp(state.clockIdentity, ptpClock->defaultDS.clockIdentity, CLOCK_IDENTITY_LENGTH) ||
+	    state.domainNumber != ptpClock->defaultDS.domainNumber ||
+	    state.delayMechanism != ptpClock->portDS.delayMechanism) {
+		INFO("Warm start state in %s was saved with a different clock identity, domain "
+		    "or delay mechanism - ignoring\n", rtOpts->warmStartFile);
+		return;
+	}
+
+	getTime(&now);
+	age = now.seconds - state.savedAt;
+
+	if(age < 0 || age > rtOpts->warmStartMaxAge) {
+		INFO("Warm start state in %s is %d seconds old - ignoring\n",
+		    rtOpts->warmStartFile, age);
+		return;
+	}
+
+	ptpClock->warmStart = state;
+	ptpClock->warmStartPending = TRUE;
+
+	/* same as restoreDrift() with a cached value */
+#ifdef PTPD_STATISTICS
+	if(!ptpClock->holdover.active)
+#endif /* PTPD_STATISTICS */
+	{
+		ptpClock->servo.observedDrift = state.observedDrift;
+		ptpClock->last_saved_drift = state.observedDrift;
+		ptpClock->drift_saved = TRUE;
+		if(!rtOpts->noAdjust && ptpClock->clockControl.granted) {
+			adjFreq_wrapper(rtOpts, ptpClock, -state.observedDrift);
+		}
+	}
+
+	/* leap flags only hold until the end of the UTC day they were announced on */
+	if(now.seconds / 86400 != state.savedAt / 86400) {
+		state.timePropertiesDS.leap59 = FALSE;
+		state.timePropertiesDS.leap61 = FALSE;
+	}
+	ptpClock->timePropertiesDS = state.timePropertiesDS;
+
+	restoreGrants(rtOpts, ptpClock, age);
+
+	/* PTP had the clock before the restart - no need to hold the election */
+	if((state.flags & WARMSTART_CLOCK_CONTROL) && timingDomain.current == NULL) {
+		timingDomain.electionLeft = 0;
+	}
+
+	snprint_PortIdentity(portId, PATH_MAX, &state.parentPortIdentity);
+	INFO("Warm start state loaded from %s (%d seconds old): parent %s, "
+	    "mean path delay %d ns, observed drift %.0f ppb\n",
+	    rtOpts->warmStartFile, age, portId, state.meanPathDelay, state.observedDrift);
+
+}
+
+/* entering SLAVE: if the saved parent is back, continue from the saved state */
+void
+applyWarmStart(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	WarmStartState *state = &ptpClock->warmStart;
+	Integer16 s;
+
+	if(!ptpClock->warmStartPending) {
+		return;
+	}
+
+	/* one shot: a later SLAVE transition has nothing to gain from it */
+	ptpClock->warmStartPending = FALSE;
+
+	if(cmpPortIdentity(&state->parentPortIdentity, &ptpClock->parentDS.parentPortIdentity) ||
+	    memcmp(state->grandmasterIdentity, ptpClock->parentDS.grandmasterIdentity, CLOCK_IDENTITY_LENGTH) ||
+	    (state->parentAddress && ptpClock->bestMaster != NULL && ptpClock->bestMaster->sourceAddr &&
+		state->parentAddress != ptpClock->bestMaster->sourceAddr)) {
+		INFO("Warm start: parent differs from the saved state - starting from scratch\n");
+		return;
+	}
+
+	/* pre-load the path delay filter as if it had converged */
+	if(state->meanPathDelay > 0) {
+		s = rtOpts->s;
+		while (abs(state->meanPathDelay) >> (31 - s))
+			--s;
+		ptpClock->mpd_filt.y = state->meanPathDelay;
+		ptpClock->mpd_filt.nsec_prev = state->meanPathDelay;
+		ptpClock->mpd_filt.s_exp = 1 << s;
+		if(ptpClock->portDS.delayMechanism == P2P) {
+			ptpClock->portDS.peerMeanPathDelay.seconds = 0;
+			ptpClock->portDS.peerMeanPathDelay.nanoseconds = state->meanPathDelay;
+		} else {
+			ptpClock->currentDS.meanPathDelay.seconds = 0;
+			ptpClock->currentDS.meanPathDelay.nanoseconds = state->meanPathDelay;
+		}
+	}
+
+	ptpClock->servo.observedDrift = state->observedDrift;
+	if(!rtOpts->noAdjust && ptpClock->clockControl.granted) {
+		adjFreq_wrapper(rtOpts, ptpClock, -state->observedDrift);
+	}
+
+	/* the offset computation was calibrated against this parent already */
+	if(rtOpts->calibrationDelay) {
+		ptpClock->isCalibrated = TRUE;
+		timerStop(&ptpClock->timers[CALIBRATION_DELAY_TIMER]);
+	}
+
+#ifdef PTPD_STATISTICS
+	/* still re-evaluated after the next stability period */
+	ptpClock->servo.isStable = (state->flags & WARMSTART_SERVO_STABLE) != 0;
+	ptpClock->servo.driftMean = state->driftMean;
+	ptpClock->servo.driftStdDev = state->driftStdDev;
+
+	if(ptpClock->oFilterMS.config.enabled && state->oFilterMSThreshold > 0) {
+		ptpClock->oFilterMS.threshold = state->oFilterMSThreshold;
+	}
+	if(ptpClock->oFilterSM.config.enabled && state->oFilterSMThreshold > 0) {
+		ptpClock->oFilterSM.threshold = state->oFilterSMThreshold;
+	}
+#endif /* PTPD_STATISTICS */
+
+	NOTICE("Warm start: same parent as before restart - restored mean path delay %d ns, "
+	    "observed drift %.0f ppb\n", state->meanPathDelay, state->observedDrift);
+
+}
+
+/* the master keeps serving the grants we did not cancel on shutdown - pick them up */
+static void
+restoreGrants(const RunTimeOpts *rtOpts, PtpClock *ptpClock, Integer32 age)
+{
+
+	WarmStartState *state = &ptpClock->warmStart;
+	UnicastGrantTable *nodeTable = NULL;
+	UnicastGrantData *grantData;
+	WarmStartGrant *saved;
+	struct in_addr tmpAddr;
+	int i, restored = 0;
+
+	if(!rtOpts->unicastNegotiation || rtOpts->ipMode != IPMODE_UNICAST ||
+	    !ptpClock->defaultDS.slaveOnly || !(state->flags & WARMSTART_GRANTS)) {
+		return;
+	}
+
+	/* only from a master we are still configured to use */
+	for(i = 0; i < ptpClock->unicastDestinationCount; i++) {
+		if(ptpClock->unicastGrants[i].transportAddress == state->parentAddress) {
+			nodeTable = &ptpClock->unicastGrants[i];
+			break;
+		}
+	}
+
+	if(nodeTable == NULL) {
+		DBG("Warm start: saved parent is no longer a unicast destination - not restoring grants\n");
+		return;
+	}
+
+	/* binds the port identity to the destination and updates the index */
+	nodeTable = findUnicastGrants(&state->parentPortIdentity, state->parentAddress,
+			ptpClock->unicastGrants, &ptpClock->grantIndex,
+			ptpClock->unicastDestinationCount, TRUE);
+
+	if(nodeTable == NULL) {
+		return;
+	}
+
+	for(i = 0; i < PTP_MAX_MESSAGE_INDEXED; i++) {
+
+		saved = &state->grants[i];
+		grantData = &nodeTable->grantData[i];
+
+		if(!saved->granted || !grantData->requestable ||
+		    saved->timeLeft <= age + WARMSTART_GRANT_MARGIN) {
+			continue;
+		}
+
+		grantData->requested = TRUE;
+		grantData->granted = TRUE;
+		grantData->expired = FALSE;
+		grantData->canceled = FALSE;
+		grantData->logInterval = saved->logInterval;
+		grantData->duration = saved->duration;
+		grantData->timeLeft = saved->timeLeft - age;
+
+		if(grantData->timeLeft > nodeTable->timeLeft) {
+			nodeTable->timeLeft = grantData->timeLeft;
+		}
+
+		restored++;
+
+	}
+
+	if(restored) {
+		tmpAddr.s_addr = state->parentAddress;
+		INFO("Warm start: restored %d unicast grants from %s\n", restored, inet_ntoa(tmpAddr));
+	}
+
+}
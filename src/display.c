@@ -855,6 +855,8 @@ const char
 void
 displayCounters(const PtpClock * ptpClock)
 {
+	const LatencyStage *stage;
+	int i;
 
 	/* TODO: print port identity */
 	INFO("\n============= PTP port counters =============\n");
@@ -974,6 +976,8 @@ displayCounters(const PtpClock * ptpClock)
 		(unsigned long)ptpClock->counters.delayMechanismMismatchErrors);
 	INFO("           maxDelayDrops : %lu\n",
 		(unsigned long)ptpClock->counters.maxDelayDrops);
+	INFO("       logRecordsDropped : %lu\n",
+		(unsigned long)ptpClock->counters.logRecordsDropped);
 
 
 #ifdef PTPD_STATISTICS
@@ -984,6 +988,23 @@ displayCounters(const PtpClock * ptpClock)
 		(unsigned long)ptpClock->counters.delaySMOutliersFound);
 #endif /* PTPD_STATISTICS */
 
+	INFO("Hot path latency (ns):\n");
+	for(i = 0; i < LATENCY_STAGE_MAX; i++) {
+		stage = &ptpClock->latency.stages[i];
+		INFO("%34s : count %lu, last %lu, mean %lu, max %lu\n",
+			getLatencyStageName(i), (unsigned long)stage->count,
+			(unsigned long)stage->last,
+			(unsigned long)(stage->count ? stage->total / stage->count : 0),
+			(unsigned long)stage->max);
+#ifdef PTPD_STATISTICS
+		INFO("%34s   p50 %.0f, p99 %.0f, p99.9 %.0f over %lu samples\n", "",
+			stage->snapshot.p50 * 1E9, stage->snapshot.p99 * 1E9,
+			stage->snapshot.p999 * 1E9, (unsigned long)stage->snapshot.count);
+#endif /* PTPD_STATISTICS */
+	}
+	INFO("                      syncOverruns : %lu\n",
+		(unsigned long)ptpClock->latency.syncOverruns);
+
 }
 
 const char *
@@ -90,7 +90,10 @@ static void handleErrorManagementMessage(MsgManagement *incoming, MsgManagement
 #if 0
 static void issueManagement(MsgHeader*,MsgManagement*,const RunTimeOpts*,PtpClock*);
 #endif
-static void issueManagementRespOrAck(MsgManagement*, Integer32, const RunTimeOpts*,PtpClock*);
+static MMCacheEntry* getManagementCacheEntry(MsgManagement*, PtpClock*);
+static void issueManagementRespOrAck(MsgManagement*, MMCacheEntry*, Integer32, const RunTimeOpts*,PtpClock*);
+static void issueManagementCachedResp(MsgManagement*, MsgManagement*, const MMCacheEntry*, Integer32, const RunTimeOpts*,PtpClock*);
+static void sendManagementRespOrAck(MsgManagement*, Integer32, const RunTimeOpts*,PtpClock*);
 static void issueManagementErrorStatus(MsgManagement*, Integer32, const RunTimeOpts*,PtpClock*);
 
 void
@@ -102,8 +105,11 @@ handleManagement(MsgHeader *header,
 
 	int tlvOffset = 0;
 	int tlvFound = 0;
+	/* every TLV and its response are decoded / built in the arena */
+	size_t arenaMark = msgArenaMark(&ptpClock->msgArena);
 
 	MsgManagement *mgmtMsg = &ptpClock->msgTmp.manage;
+	MMCacheEntry *cache;
 
 	/*
 	 * If request was unicast, reply to source, always, even if we ourselves are running multicast.
@@ -174,8 +180,21 @@ handleManagement(MsgHeader *header,
 		goto end;
 	}
 
+	/* GET responses are served from the cache while the datasets are unchanged */
+	cache = getManagementCacheEntry(mgmtMsg, ptpClock);
+	if(cache != NULL && cache->length > 0 &&
+	    cache->generation == ptpClock->datasetGeneration) {
+		DBGV("handleManagement: cached response for managementTLV %d\n",
+				mgmtMsg->tlv->managementId);
+		issueManagementCachedResp(mgmtMsg, &ptpClock->outgoingManageTmp, cache, dst, rtOpts, ptpClock);
+		goto end;
+	}
+
 	/* if this is a SET, there is potential for applying new config */
 	if (mgmtMsg->actionField & (SET | COMMAND)) {
+	    /* datasets may change below - send templates and cached responses get rebuilt on next use */
+	    msgInvalidateTemplates(ptpClock);
+	    ptpClock->datasetGeneration++;
 	    ptpClock->managementConfig = dictionary_new(0);
 	    dictionary_merge(rtOpts->currentConfig, ptpClock->managementConfig, 1, 0, NULL);
 	}
@@ -455,7 +474,7 @@ handleManagement(MsgHeader *header,
 	if(ptpClock->outgoingManageTmp.tlv->tlvType == TLV_MANAGEMENT) {
 		if(ptpClock->outgoingManageTmp.actionField == RESPONSE ||
 				ptpClock->outgoingManageTmp.actionField == ACKNOWLEDGE) {
-			issueManagementRespOrAck(&ptpClock->outgoingManageTmp, dst, rtOpts, ptpClock);
+			issueManagementRespOrAck(&ptpClock->outgoingManageTmp, cache, dst, rtOpts, ptpClock);
 		}
 	} else if(ptpClock->outgoingManageTmp.tlv->tlvType == TLV_MANAGEMENT_ERROR_STATUS) {
 		issueManagementErrorStatus(&ptpClock->outgoingManageTmp, dst, rtOpts, ptpClock);
@@ -468,6 +487,7 @@ handleManagement(MsgHeader *header,
 	freeManagementTLV(mgmtMsg);
 	/* cleanup outgoing managementTLV */
 	freeManagementTLV(&ptpClock->outgoingManageTmp);
+	msgArenaRelease(&ptpClock->msgArena, arenaMark);
 
 	}
 
@@ -489,6 +509,96 @@ handleManagement(MsgHeader *header,
 }
 
 
+/*
+ * Cache entry for the response to a GET management message, or NULL if the
+ * response can't be cached: TIME and CURRENT_DATA_SET change with every
+ * servo update, and so does PORT_DATA_SET (peerMeanPathDelay) with P2P.
+ * Everything else only changes when datasetGeneration is bumped.
+ */
+static MMCacheEntry*
+getManagementCacheEntry(MsgManagement *incoming, PtpClock *ptpClock)
+{
+	int slot;
+
+	if(incoming->actionField != GET) {
+		return NULL;
+	}
+
+	switch(incoming->tlv->managementId)
+	{
+	case MM_CLOCK_DESCRIPTION:
+		slot = MM_CACHE_CLOCK_DESCRIPTION;
+		break;
+	case MM_USER_DESCRIPTION:
+		slot = MM_CACHE_USER_DESCRIPTION;
+		break;
+	case MM_DEFAULT_DATA_SET:
+		slot = MM_CACHE_DEFAULT_DATA_SET;
+		break;
+	case MM_PARENT_DATA_SET:
+		slot = MM_CACHE_PARENT_DATA_SET;
+		break;
+	case MM_TIME_PROPERTIES_DATA_SET:
+		slot = MM_CACHE_TIME_PROPERTIES_DATA_SET;
+		break;
+	case MM_PORT_DATA_SET:
+		if(ptpClock->portDS.delayMechanism == P2P) {
+			return NULL;
+		}
+		slot = MM_CACHE_PORT_DATA_SET;
+		break;
+	case MM_PRIORITY1:
+		slot = MM_CACHE_PRIORITY1;
+		break;
+	case MM_PRIORITY2:
+		slot = MM_CACHE_PRIORITY2;
+		break;
+	case MM_DOMAIN:
+		slot = MM_CACHE_DOMAIN;
+		break;
+	case MM_SLAVE_ONLY:
+		slot = MM_CACHE_SLAVE_ONLY;
+		break;
+	case MM_LOG_ANNOUNCE_INTERVAL:
+		slot = MM_CACHE_LOG_ANNOUNCE_INTERVAL;
+		break;
+	case MM_ANNOUNCE_RECEIPT_TIMEOUT:
+		slot = MM_CACHE_ANNOUNCE_RECEIPT_TIMEOUT;
+		break;
+	case MM_LOG_SYNC_INTERVAL:
+		slot = MM_CACHE_LOG_SYNC_INTERVAL;
+		break;
+	case MM_VERSION_NUMBER:
+		slot = MM_CACHE_VERSION_NUMBER;
+		break;
+	case MM_CLOCK_ACCURACY:
+		slot = MM_CACHE_CLOCK_ACCURACY;
+		break;
+	case MM_UTC_PROPERTIES:
+		slot = MM_CACHE_UTC_PROPERTIES;
+		break;
+	case MM_TRACEABILITY_PROPERTIES:
+		slot = MM_CACHE_TRACEABILITY_PROPERTIES;
+		break;
+	case MM_TIMESCALE_PROPERTIES:
+		slot = MM_CACHE_TIMESCALE_PROPERTIES;
+		break;
+	case MM_UNICAST_NEGOTIATION_ENABLE:
+		slot = MM_CACHE_UNICAST_NEGOTIATION_ENABLE;
+		break;
+	case MM_DELAY_MECHANISM:
+		slot = MM_CACHE_DELAY_MECHANISM;
+		break;
+	case MM_LOG_MIN_PDELAY_REQ_INTERVAL:
+		slot = MM_CACHE_LOG_MIN_PDELAY_REQ_INTERVAL;
+		break;
+	default:
+		return NULL;
+	}
+
+	return &ptpClock->mmCache[slot];
+}
+
 /**\brief Initialize outgoing management message fields*/
 void initOutgoingMsgManagement(MsgManagement* incoming, MsgManagement* outgoing, PtpClock *ptpClock)
 {
@@ -514,7 +624,7 @@ void initOutgoingMsgManagement(MsgManagement* incoming, MsgManagement* outgoing,
         outgoing->actionField = 0; /* set default action, avoid uninitialized value */
 
 	/* init managementTLV */
-	XMALLOC(outgoing->tlv, sizeof(ManagementTLV));
+	ARENA_ALLOC(outgoing->tlv, sizeof(ManagementTLV));
 	outgoing->tlv->dataField = NULL;
 	outgoing->tlv->lengthField = 0;
 }
@@ -544,7 +654,6 @@ void handleMMNullManagement(MsgManagement* incoming, MsgManagement* outgoing, Pt
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_NULL_MANAGEMENT,
 			NOT_SUPPORTED);
@@ -568,7 +677,7 @@ void handleMMClockDescription(MsgManagement* incoming, MsgManagement* outgoing,
 		DBGV(" GET action \n");
 		/* Table 38 */
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof( MMClockDescription));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof( MMClockDescription));
 		data = (MMClockDescription*)outgoing->tlv->dataField;
 		memset(data, 0, sizeof( MMClockDescription));
 		/* GET actions */
@@ -577,21 +686,21 @@ void handleMMClockDescription(MsgManagement* incoming, MsgManagement* outgoing,
 		data->clockType1 = 0x00;
 		/* physical layer protocol */
                 data->physicalLayerProtocol.lengthField = sizeof(PROTOCOL) - 1;
-                XMALLOC(data->physicalLayerProtocol.textField,
+                ARENA_ALLOC(data->physicalLayerProtocol.textField,
                                 data->physicalLayerProtocol.lengthField);
                 memcpy(data->physicalLayerProtocol.textField,
                         &PROTOCOL,
                         data->physicalLayerProtocol.lengthField);
 		/* physical address */
                 data->physicalAddress.addressLength = PTP_UUID_LENGTH;
-                XMALLOC(data->physicalAddress.addressField, PTP_UUID_LENGTH);
+                ARENA_ALLOC(data->physicalAddress.addressField, PTP_UUID_LENGTH);
                 memcpy(data->physicalAddress.addressField,
                         ptpClock->netPath.interfaceID,
                         PTP_UUID_LENGTH);
 		/* protocol address */
                 data->protocolAddress.addressLength = 4;
                 data->protocolAddress.networkProtocol = 1;
-                XMALLOC(data->protocolAddress.addressField,
+                ARENA_ALLOC(data->protocolAddress.addressField,
                         data->protocolAddress.addressLength);
                 memcpy(data->protocolAddress.addressField,
                         &ptpClock->netPath.interfaceAddr.s_addr,
@@ -605,21 +714,21 @@ void handleMMClockDescription(MsgManagement* incoming, MsgManagement* outgoing,
 		/* product description */
 		tmpsnprintf(tmpStr, 64, PRODUCT_DESCRIPTION, rtOpts->productDescription);
                 data->productDescription.lengthField = strlen(tmpStr);
-                XMALLOC(data->productDescription.textField,
+                ARENA_ALLOC(data->productDescription.textField,
                                         data->productDescription.lengthField);
                 memcpy(data->productDescription.textField,
                         tmpStr,
                         data->productDescription.lengthField);
 		/* revision data */
                 data->revisionData.lengthField = sizeof(REVISION) - 1;
-                XMALLOC(data->revisionData.textField,
+                ARENA_ALLOC(data->revisionData.textField,
                                         data->revisionData.lengthField);
                 memcpy(data->revisionData.textField,
                         &REVISION,
                         data->revisionData.lengthField);
 		/* user description */
                 data->userDescription.lengthField = strlen(ptpClock->userDescription);
-                XMALLOC(data->userDescription.textField,
+                ARENA_ALLOC(data->userDescription.textField,
                                         data->userDescription.lengthField);
                 memcpy(data->userDescription.textField,
                         ptpClock->userDescription,
@@ -633,7 +742,6 @@ void handleMMClockDescription(MsgManagement* incoming, MsgManagement* outgoing,
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_CLOCK_DESCRIPTION,
 			NOT_SUPPORTED);
@@ -663,7 +771,7 @@ void handleMMSlaveOnly(MsgManagement* incoming, MsgManagement* outgoing, PtpCloc
 	case GET:
 		DBGV(" GET action \n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMSlaveOnly));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMSlaveOnly));
 		data = (MMSlaveOnly*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->so = ptpClock->defaultDS.slaveOnly;
@@ -671,7 +779,6 @@ void handleMMSlaveOnly(MsgManagement* incoming, MsgManagement* outgoing, PtpCloc
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_SLAVE_ONLY,
 			NOT_SUPPORTED);
@@ -710,12 +817,12 @@ void handleMMUserDescription(MsgManagement* incoming, MsgManagement* outgoing, P
 	case GET:
 		DBGV(" GET action \n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof( MMUserDescription));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof( MMUserDescription));
 		data = (MMUserDescription*)outgoing->tlv->dataField;
 		memset(data, 0, sizeof(MMUserDescription));
 		/* GET actions */
                 data->userDescription.lengthField = strlen(ptpClock->userDescription);
-                XMALLOC(data->userDescription.textField,
+                ARENA_ALLOC(data->userDescription.textField,
                                         data->userDescription.lengthField);
                 memcpy(data->userDescription.textField,
                         ptpClock->userDescription,
@@ -723,7 +830,6 @@ void handleMMUserDescription(MsgManagement* incoming, MsgManagement* outgoing, P
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_USER_DESCRIPTION,
 			NOT_SUPPORTED);
@@ -748,7 +854,6 @@ void handleMMSaveInNonVolatileStorage(MsgManagement* incoming, MsgManagement* ou
 		/* issue a NOT_SUPPORTED error management message, intentionally fall through */
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_SAVE_IN_NON_VOLATILE_STORAGE,
 			NOT_SUPPORTED);
@@ -773,7 +878,6 @@ void handleMMResetNonVolatileStorage(MsgManagement* incoming, MsgManagement* out
 		/* issue a NOT_SUPPORTED error management message, intentionally fall through */
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_RESET_NON_VOLATILE_STORAGE,
 			NOT_SUPPORTED);
@@ -797,7 +901,7 @@ void handleMMInitialize(MsgManagement* incoming, MsgManagement* outgoing, PtpClo
 	case COMMAND:
 		DBGV(" COMMAND action\n");
 		outgoing->actionField = ACKNOWLEDGE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMInitialize));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMInitialize));
 		incomingData = (MMInitialize*)incoming->tlv->dataField;
 		outgoingData = (MMInitialize*)outgoing->tlv->dataField;
 		/* Table 45 - INITIALIZATION_KEY enumeration */
@@ -819,7 +923,6 @@ void handleMMInitialize(MsgManagement* incoming, MsgManagement* outgoing, PtpClo
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_INITIALIZE,
 			NOT_SUPPORTED);
@@ -842,7 +945,7 @@ void handleMMDefaultDataSet(MsgManagement* incoming, MsgManagement* outgoing, Pt
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMDefaultDataSet));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMDefaultDataSet));
 		data = (MMDefaultDataSet*)outgoing->tlv->dataField;
 		/* GET actions */
 		/* get bit and align for slave only */
@@ -869,7 +972,6 @@ void handleMMDefaultDataSet(MsgManagement* incoming, MsgManagement* outgoing, Pt
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_DEFAULT_DATA_SET,
 			NOT_SUPPORTED);
@@ -892,7 +994,7 @@ void handleMMCurrentDataSet(MsgManagement* incoming, MsgManagement* outgoing, Pt
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof( MMCurrentDataSet));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof( MMCurrentDataSet));
 		data = (MMCurrentDataSet*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->stepsRemoved = ptpClock->currentDS.stepsRemoved;
@@ -915,7 +1017,6 @@ void handleMMCurrentDataSet(MsgManagement* incoming, MsgManagement* outgoing, Pt
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_CURRENT_DATA_SET,
 			NOT_SUPPORTED);
@@ -938,7 +1039,7 @@ void handleMMParentDataSet(MsgManagement* incoming, MsgManagement* outgoing, Ptp
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMParentDataSet));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMParentDataSet));
 		data = (MMParentDataSet*)outgoing->tlv->dataField;
 		/* GET actions */
 		copyPortIdentity(&data->parentPortIdentity, &ptpClock->parentDS.parentPortIdentity);
@@ -964,7 +1065,6 @@ void handleMMParentDataSet(MsgManagement* incoming, MsgManagement* outgoing, Ptp
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_PARENT_DATA_SET,
 			NOT_SUPPORTED);
@@ -987,7 +1087,7 @@ void handleMMTimePropertiesDataSet(MsgManagement* incoming, MsgManagement* outgo
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMTimePropertiesDataSet));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMTimePropertiesDataSet));
 		data = (MMTimePropertiesDataSet*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->currentUtcOffset = ptpClock->timePropertiesDS.currentUtcOffset;
@@ -1006,7 +1106,6 @@ void handleMMTimePropertiesDataSet(MsgManagement* incoming, MsgManagement* outgo
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_TIME_PROPERTIES_DATA_SET,
 			NOT_SUPPORTED);
@@ -1029,7 +1128,7 @@ void handleMMPortDataSet(MsgManagement* incoming, MsgManagement* outgoing, PtpCl
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMPortDataSet));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMPortDataSet));
 		data = (MMPortDataSet*)outgoing->tlv->dataField;
 		copyPortIdentity(&data->portIdentity, &ptpClock->portDS.portIdentity);
 		data->portState = ptpClock->portDS.portState;
@@ -1054,7 +1153,6 @@ void handleMMPortDataSet(MsgManagement* incoming, MsgManagement* outgoing, PtpCl
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_PORT_DATA_SET,
 			NOT_SUPPORTED);
@@ -1086,7 +1184,7 @@ void handleMMPriority1(MsgManagement* incoming, MsgManagement* outgoing, PtpCloc
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMPriority1));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMPriority1));
 		data = (MMPriority1*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->priority1 = ptpClock->defaultDS.priority1;
@@ -1098,7 +1196,6 @@ void handleMMPriority1(MsgManagement* incoming, MsgManagement* outgoing, PtpCloc
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_PRIORITY1,
 			NOT_SUPPORTED);
@@ -1130,7 +1227,7 @@ void handleMMPriority2(MsgManagement* incoming, MsgManagement* outgoing, PtpCloc
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMPriority2));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMPriority2));
 		data = (MMPriority2*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->priority2 = ptpClock->defaultDS.priority2;
@@ -1142,7 +1239,6 @@ void handleMMPriority2(MsgManagement* incoming, MsgManagement* outgoing, PtpCloc
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_PRIORITY2,
 			NOT_SUPPORTED);
@@ -1174,7 +1270,7 @@ void handleMMDomain(MsgManagement* incoming, MsgManagement* outgoing, PtpClock*
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMDomain));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMDomain));
 		data = (MMDomain*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->domainNumber = ptpClock->defaultDS.domainNumber;
@@ -1186,7 +1282,6 @@ void handleMMDomain(MsgManagement* incoming, MsgManagement* outgoing, PtpClock*
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_DOMAIN,
 			NOT_SUPPORTED);
@@ -1218,7 +1313,7 @@ void handleMMLogAnnounceInterval(MsgManagement* incoming, MsgManagement* outgoin
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMLogAnnounceInterval));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMLogAnnounceInterval));
 		data = (MMLogAnnounceInterval*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->logAnnounceInterval = ptpClock->portDS.logAnnounceInterval;
@@ -1230,7 +1325,6 @@ void handleMMLogAnnounceInterval(MsgManagement* incoming, MsgManagement* outgoin
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_LOG_ANNOUNCE_INTERVAL,
 			NOT_SUPPORTED);
@@ -1262,7 +1356,7 @@ void handleMMAnnounceReceiptTimeout(MsgManagement* incoming, MsgManagement* outg
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMAnnounceReceiptTimeout));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMAnnounceReceiptTimeout));
 		data = (MMAnnounceReceiptTimeout*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->announceReceiptTimeout = ptpClock->portDS.announceReceiptTimeout;
@@ -1274,7 +1368,6 @@ void handleMMAnnounceReceiptTimeout(MsgManagement* incoming, MsgManagement* outg
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_ANNOUNCE_RECEIPT_TIMEOUT,
 			NOT_SUPPORTED);
@@ -1306,7 +1399,7 @@ void handleMMLogSyncInterval(MsgManagement* incoming, MsgManagement* outgoing, P
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMLogSyncInterval));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMLogSyncInterval));
 		data = (MMLogSyncInterval*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->logSyncInterval = ptpClock->portDS.logSyncInterval;
@@ -1318,7 +1411,6 @@ void handleMMLogSyncInterval(MsgManagement* incoming, MsgManagement* outgoing, P
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_LOG_SYNC_INTERVAL,
 			NOT_SUPPORTED);
@@ -1341,7 +1433,7 @@ void handleMMVersionNumber(MsgManagement* incoming, MsgManagement* outgoing, Ptp
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMVersionNumber));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMVersionNumber));
 		data = (MMVersionNumber*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->reserved0 = 0x0;
@@ -1356,7 +1448,6 @@ void handleMMVersionNumber(MsgManagement* incoming, MsgManagement* outgoing, Ptp
 	case SET:
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_VERSION_NUMBER,
 			NOT_SUPPORTED);
@@ -1386,7 +1477,6 @@ void handleMMEnablePort(MsgManagement* incoming, MsgManagement* outgoing, PtpClo
 		/* TODO: implementation specific */
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_ENABLE_PORT,
 			NOT_SUPPORTED);
@@ -1417,7 +1507,6 @@ void handleMMDisablePort(MsgManagement* incoming, MsgManagement* outgoing, PtpCl
 		/* TODO: implementation specific */
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_DISABLE_PORT,
 			NOT_SUPPORTED);
@@ -1445,7 +1534,7 @@ void handleMMTime(MsgManagement* incoming, MsgManagement* outgoing, PtpClock* pt
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMTime));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMTime));
 		data = (MMTime*)outgoing->tlv->dataField;
 		/* GET actions */
 		TimeInternal internalTime;
@@ -1462,7 +1551,6 @@ void handleMMTime(MsgManagement* incoming, MsgManagement* outgoing, PtpClock* pt
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_TIME,
 			NOT_SUPPORTED);
@@ -1496,7 +1584,7 @@ void handleMMClockAccuracy(MsgManagement* incoming, MsgManagement* outgoing, Ptp
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMClockAccuracy));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMClockAccuracy));
 		data = (MMClockAccuracy*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->clockAccuracy = ptpClock->defaultDS.clockQuality.clockAccuracy;
@@ -1508,7 +1596,6 @@ void handleMMClockAccuracy(MsgManagement* incoming, MsgManagement* outgoing, Ptp
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_CLOCK_ACCURACY,
 			NOT_SUPPORTED);
@@ -1546,7 +1633,7 @@ void handleMMUtcProperties(MsgManagement* incoming, MsgManagement* outgoing, Ptp
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMUtcProperties));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMUtcProperties));
 		data = (MMUtcProperties*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->currentUtcOffset = ptpClock->timePropertiesDS.currentUtcOffset;
@@ -1562,7 +1649,6 @@ void handleMMUtcProperties(MsgManagement* incoming, MsgManagement* outgoing, Ptp
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_UTC_PROPERTIES,
 			NOT_SUPPORTED);
@@ -1595,7 +1681,7 @@ void handleMMTraceabilityProperties(MsgManagement* incoming, MsgManagement* outg
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMTraceabilityProperties));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMTraceabilityProperties));
 		data = (MMTraceabilityProperties*)outgoing->tlv->dataField;
 		/* GET actions */
 		Octet ftra = SET_FIELD(ptpClock->timePropertiesDS.frequencyTraceable, FTRA);
@@ -1609,7 +1695,6 @@ void handleMMTraceabilityProperties(MsgManagement* incoming, MsgManagement* outg
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_TRACEABILITY_PROPERTIES,
 			NOT_SUPPORTED);
@@ -1639,7 +1724,7 @@ void handleMMTimescaleProperties(MsgManagement* incoming, MsgManagement* outgoin
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMTimescaleProperties));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMTimescaleProperties));
 		data = (MMTimescaleProperties*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->ptp = ptpClock->timePropertiesDS.ptpTimescale;
@@ -1651,7 +1736,6 @@ void handleMMTimescaleProperties(MsgManagement* incoming, MsgManagement* outgoin
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_TRACEABILITY_PROPERTIES,
 			NOT_SUPPORTED);
@@ -1681,7 +1765,7 @@ void handleMMUnicastNegotiationEnable(MsgManagement* incoming, MsgManagement* ou
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMUnicastNegotiationEnable));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMUnicastNegotiationEnable));
 		data = (MMUnicastNegotiationEnable*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->en = rtOpts->unicastNegotiation;
@@ -1693,7 +1777,6 @@ void handleMMUnicastNegotiationEnable(MsgManagement* incoming, MsgManagement* ou
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_UNICAST_NEGOTIATION_ENABLE,
 			NOT_SUPPORTED);
@@ -1727,7 +1810,7 @@ void handleMMDelayMechanism(MsgManagement* incoming, MsgManagement* outgoing, Pt
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMDelayMechanism));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMDelayMechanism));
 		data = (MMDelayMechanism*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->delayMechanism = ptpClock->portDS.delayMechanism;
@@ -1739,7 +1822,6 @@ void handleMMDelayMechanism(MsgManagement* incoming, MsgManagement* outgoing, Pt
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_DELAY_MECHANISM,
 			NOT_SUPPORTED);
@@ -1771,7 +1853,7 @@ void handleMMLogMinPdelayReqInterval(MsgManagement* incoming, MsgManagement* out
 	case GET:
 		DBGV(" GET action\n");
 		outgoing->actionField = RESPONSE;
-		XMALLOC(outgoing->tlv->dataField, sizeof(MMLogMinPdelayReqInterval));
+		ARENA_ALLOC(outgoing->tlv->dataField, sizeof(MMLogMinPdelayReqInterval));
 		data = (MMLogMinPdelayReqInterval*)outgoing->tlv->dataField;
 		/* GET actions */
 		data->logMinPdelayReqInterval = ptpClock->portDS.logMinPdelayReqInterval;
@@ -1783,7 +1865,6 @@ void handleMMLogMinPdelayReqInterval(MsgManagement* incoming, MsgManagement* out
 		break;
 	default:
 		DBGV(" unknown actionType \n");
-		free(outgoing->tlv);
 		handleErrorManagementMessage(incoming, outgoing,
 			ptpClock, MM_LOG_MIN_PDELAY_REQ_INTERVAL,
 			NOT_SUPPORTED);
@@ -1821,7 +1902,7 @@ void handleErrorManagementMessage(MsgManagement *incoming, MsgManagement *outgoi
 		outgoing->actionField = 0;
 	}
 
-	XMALLOC(outgoing->tlv->dataField, sizeof( MMErrorStatus));
+	ARENA_ALLOC(outgoing->tlv->dataField, sizeof( MMErrorStatus));
 	MMErrorStatus *data = (MMErrorStatus*)outgoing->tlv->dataField;
 	/* set managementId */
 	data->managementId = mgmtId;
@@ -1843,7 +1924,7 @@ issueManagement(MsgHeader *header,MsgManagement *manage,const RunTimeOpts *rtOpt
 #endif
 
 static void
-issueManagementRespOrAck(MsgManagement *outgoing, Integer32 dst, const RunTimeOpts *rtOpts,
+issueManagementRespOrAck(MsgManagement *outgoing, MMCacheEntry *cache, Integer32 dst, const RunTimeOpts *rtOpts,
 		PtpClock *ptpClock)
 {
 
@@ -1855,6 +1936,37 @@ issueManagementRespOrAck(MsgManagement *outgoing, Integer32 dst, const RunTimeOp
 					TL_LENGTH +
 					outgoing->tlv->lengthField;
 
+	/* keep the packed GET response until the datasets change */
+	if(cache != NULL && outgoing->actionField == RESPONSE &&
+	    outgoing->header.messageLength - MANAGEMENT_LENGTH <= MM_CACHE_TLV_LENGTH) {
+		cache->length = outgoing->header.messageLength - MANAGEMENT_LENGTH;
+		memcpy(cache->buf, ptpClock->msgObuf + MANAGEMENT_LENGTH, cache->length);
+		cache->generation = ptpClock->datasetGeneration;
+	}
+
+	sendManagementRespOrAck(outgoing, dst, rtOpts, ptpClock);
+}
+
+/* GET response from the cache: only the management header is packed */
+static void
+issueManagementCachedResp(MsgManagement *incoming, MsgManagement *outgoing, const MMCacheEntry *cache,
+		Integer32 dst, const RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+	initOutgoingMsgManagement(incoming, outgoing, ptpClock);
+	outgoing->actionField = RESPONSE;
+
+	memcpy(ptpClock->msgObuf + MANAGEMENT_LENGTH, cache->buf, cache->length);
+	outgoing->header.messageLength = MANAGEMENT_LENGTH + cache->length;
+
+	sendManagementRespOrAck(outgoing, dst, rtOpts, ptpClock);
+}
+
+static void
+sendManagementRespOrAck(MsgManagement *outgoing, Integer32 dst, const RunTimeOpts *rtOpts,
+		PtpClock *ptpClock)
+{
+
 	msgPackManagement( ptpClock->msgObuf, outgoing, ptpClock);
 
 
@@ -0,0 +1,582 @@
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file    msgbench.c
+ * @authors The PTPd Project
+ * @date   Fri Jan 15 11:20:41 2016
+ * ptpd2-msgbench: message codec benchmark and fuzzer for dep/msg.c.
+ * Not built by default - "make ptpd2-msgbench".
+ *
+ * -b measures pack and unpack cost per message type in ns/message.
+ * -f generates management and signaling messages by packing randomised
+ * TLV data fields with the src/def driven pack functions, mutates them and
+ * runs them through the same unpack sequence as handleManagement() and
+ * handleSignaling(). Build with -fsanitize=address to catch over-reads.
+ *
+ * Defining MSGBENCH_LIBFUZZER replaces main() with LLVMFuzzerTestOneInput(),
+ * e.g.: clang -DMSGBENCH_LIBFUZZER -fsanitize=fuzzer,address ...
+ * The first input byte selects management or signaling, the rest is the message.
+ */
+
+#include "ptpd.h"
+
+#include <inttypes.h>
+
+/* what dep/msg.c needs from the rest of the daemon */
+RunTimeOpts rtOpts;
+
+void
+logMessage(int priority, const char *format, ...)
+{
+}
+
+void
+ptpdShutdown(PtpClock *ptpClock)
+{
+}
+
+const char*
+getLatencyStageName(int stage)
+{
+	return "";
+}
+
+typedef int (*MMUnpackFn)(Octet*, int, MsgManagement*, PtpClock*);
+typedef void (*SMUnpackFn)(Octet*, MsgSignaling*, PtpClock*);
+
+typedef struct {
+	Enumeration16 managementId;
+	const char *name;
+	size_t size;
+	MMUnpackFn unpack;
+} MMCodec;
+
+typedef struct {
+	Enumeration16 tlvType;
+	const char *name;
+	size_t size;
+	SMUnpackFn unpack;
+} SMCodec;
+
+#define MM_CODEC(id, type) { id, #type, sizeof(type), unpack##type }
+#define SM_CODEC(id, type) { id, #type, sizeof(type), unpack##type }
+
+static const MMCodec mmCodecs[] = {
+	MM_CODEC(MM_CLOCK_DESCRIPTION, MMClockDescription),
+	MM_CODEC(MM_USER_DESCRIPTION, MMUserDescription),
+	MM_CODEC(MM_INITIALIZE, MMInitialize),
+	MM_CODEC(MM_DEFAULT_DATA_SET, MMDefaultDataSet),
+	MM_CODEC(MM_CURRENT_DATA_SET, MMCurrentDataSet),
+	MM_CODEC(MM_PARENT_DATA_SET, MMParentDataSet),
+	MM_CODEC(MM_TIME_PROPERTIES_DATA_SET, MMTimePropertiesDataSet),
+	MM_CODEC(MM_PORT_DATA_SET, MMPortDataSet),
+	MM_CODEC(MM_PRIORITY1, MMPriority1),
+	MM_CODEC(MM_PRIORITY2, MMPriority2),
+	MM_CODEC(MM_DOMAIN, MMDomain),
+	MM_CODEC(MM_SLAVE_ONLY, MMSlaveOnly),
+	MM_CODEC(MM_LOG_ANNOUNCE_INTERVAL, MMLogAnnounceInterval),
+	MM_CODEC(MM_ANNOUNCE_RECEIPT_TIMEOUT, MMAnnounceReceiptTimeout),
+	MM_CODEC(MM_LOG_SYNC_INTERVAL, MMLogSyncInterval),
+	MM_CODEC(MM_VERSION_NUMBER, MMVersionNumber),
+	MM_CODEC(MM_TIME, MMTime),
+	MM_CODEC(MM_CLOCK_ACCURACY, MMClockAccuracy),
+	MM_CODEC(MM_UTC_PROPERTIES, MMUtcProperties),
+	MM_CODEC(MM_TRACEABILITY_PROPERTIES, MMTraceabilityProperties),
+	MM_CODEC(MM_TIMESCALE_PROPERTIES, MMTimescaleProperties),
+	MM_CODEC(MM_UNICAST_NEGOTIATION_ENABLE, MMUnicastNegotiationEnable),
+	MM_CODEC(MM_DELAY_MECHANISM, MMDelayMechanism),
+	MM_CODEC(MM_LOG_MIN_PDELAY_REQ_INTERVAL, MMLogMinPdelayReqInterval),
+};
+
+static const SMCodec smCodecs[] = {
+	SM_CODEC(TLV_REQUEST_UNICAST_TRANSMISSION, SMRequestUnicastTransmission),
+	SM_CODEC(TLV_GRANT_UNICAST_TRANSMISSION, SMGrantUnicastTransmission),
+	SM_CODEC(TLV_CANCEL_UNICAST_TRANSMISSION, SMCancelUnicastTransmission),
+	SM_CODEC(TLV_ACKNOWLEDGE_CANCEL_UNICAST_TRANSMISSION, SMAcknowledgeCancelUnicastTransmission),
+};
+
+#define MM_CODEC_COUNT (sizeof(mmCodecs) / sizeof(mmCodecs[0]))
+#define SM_CODEC_COUNT (sizeof(smCodecs) / sizeof(smCodecs[0]))
+
+static PtpClock *ptpClock;
+
+/* received messages are decoded from a buffer of exactly PACKET_SIZE, like msgIbuf */
+static Octet *rxBuf;
+
+static const MMCodec*
+findMMCodec(Enumeration16 managementId)
+{
+	int i;
+	for(i = 0; i < MM_CODEC_COUNT; i++) {
+		if(mmCodecs[i].managementId == managementId) {
+			return &mmCodecs[i];
+		}
+	}
+	return NULL;
+}
+
+static const SMCodec*
+findSMCodec(Enumeration16 tlvType)
+{
+	int i;
+	for(i = 0; i < SM_CODEC_COUNT; i++) {
+		if(smCodecs[i].tlvType == tlvType) {
+			return &smCodecs[i];
+		}
+	}
+	return NULL;
+}
+
+/* the unpack sequence of handleManagement(), minus acting on the data */
+static int
+decodeManagement(Octet *buf)
+{
+	MsgHeader header;
+	MsgManagement *m = &ptpClock->msgTmp.manage;
+	const MMCodec *codec;
+	size_t arenaMark = msgArenaMark(&ptpClock->msgArena);
+	int tlvOffset = 0;
+	int tlvs = 0;
+
+	msgUnpackHeader(buf, &header);
+
+	while(msgUnpackManagement(buf, m, &header, ptpClock, tlvOffset)) {
+		if(m->tlv == NULL) {
+			break;
+		}
+		tlvs++;
+		if(m->tlv->tlvType == TLV_MANAGEMENT_ERROR_STATUS) {
+			unpackMMErrorStatus(buf, tlvOffset, m, ptpClock);
+		} else if((codec = findMMCodec(m->tlv->managementId)) != NULL) {
+			codec->unpack(buf, tlvOffset, m, ptpClock);
+		}
+		tlvOffset += TL_LENGTH + m->tlv->lengthField;
+		freeManagementTLV(m);
+		msgArenaRelease(&ptpClock->msgArena, arenaMark);
+	}
+
+	return tlvs;
+}
+
+/* the unpack sequence of handleSignaling() */
+static int
+decodeSignaling(Octet *buf)
+{
+	MsgHeader header;
+	MsgSignaling *m = &ptpClock->msgTmp.signaling;
+	const SMCodec *codec;
+	size_t arenaMark = msgArenaMark(&ptpClock->msgArena);
+	int tlvOffset = 0;
+	int tlvs = 0;
+
+	msgUnpackHeader(buf, &header);
+
+	while(msgUnpackSignaling(buf, m, &header, ptpClock, tlvOffset)) {
+		if(m->tlv == NULL) {
+			break;
+		}
+		tlvs++;
+		if((codec = findSMCodec(m->tlv->tlvType)) != NULL) {
+			codec->unpack(buf + tlvOffset, m, ptpClock);
+		}
+		tlvOffset += TL_LENGTH + m->tlv->lengthField;
+		freeSignalingTLV(m);
+		msgArenaRelease(&ptpClock->msgArena, arenaMark);
+	}
+
+	return tlvs;
+}
+
+static void
+initBenchClock(void)
+{
+	int i;
+
+	ptpClock = calloc(1, sizeof(PtpClock));
+	rxBuf = calloc(1, PACKET_SIZE);
+	if(ptpClock == NULL || rxBuf == NULL) {
+		fprintf(stderr, "could not allocate memory\n");
+		exit(1);
+	}
+
+	ptpClock->portDS.versionNumber = VERSION_PTP;
+	ptpClock->portDS.portIdentity.portNumber = 1;
+	for(i = 0; i < CLOCK_IDENTITY_LENGTH; i++) {
+		ptpClock->portDS.portIdentity.clockIdentity[i] = i + 1;
+	}
+	ptpClock->defaultDS.twoStepFlag = TRUE;
+	ptpClock->defaultDS.clockQuality.clockClass = 248;
+	ptpClock->parentDS.grandmasterPriority1 = 128;
+	ptpClock->parentDS.grandmasterPriority2 = 128;
+	ptpClock->portDS.logSyncInterval = 0;
+	ptpClock->portDS.logAnnounceInterval = 1;
+}
+
+/* common management / signaling header fields */
+static void
+initHeader(MsgHeader *header, Enumeration4 messageType, UInteger16 length)
+{
+	memset(header, 0, sizeof(MsgHeader));
+	header->messageType = messageType;
+	header->versionPTP = VERSION_PTP;
+	header->messageLength = length;
+	header->sequenceId = 1;
+	header->controlField = messageType == MANAGEMENT ? 0x04 : 0x05;
+	header->logMessageInterval = 0x7F;
+	copyPortIdentity(&header->sourcePortIdentity, &ptpClock->portDS.portIdentity);
+}
+
+/* random PTPText / address fields, stored in the arena */
+static void
+randomText(PTPText *text)
+{
+	int i;
+	text->lengthField = random() % 32;
+	text->textField = msgArenaAlloc(&ptpClock->msgArena, text->lengthField + 1);
+	for(i = 0; i < text->lengthField; i++) {
+		text->textField[i] = 'a' + random() % 26;
+	}
+}
+
+static void
+randomData(Octet *data, size_t size)
+{
+	size_t i;
+	for(i = 0; i < size; i++) {
+		data[i] = random();
+	}
+}
+
+/*
+ * Pack a management message with 1..4 TLVs, data fields randomised and
+ * encoded by the X-macro pack functions. Returns message length.
+ */
+static int
+generateManagement(Octet *buf)
+{
+	static Octet scratch[PACKET_SIZE * 2];
+	MsgManagement m;
+	ManagementTLV tlv;
+	const MMCodec *codec;
+	size_t arenaMark = msgArenaMark(&ptpClock->msgArena);
+	int length = MANAGEMENT_LENGTH;
+	int count = 1 + random() % 4;
+	int tlvLength;
+
+	memset(buf, 0, PACKET_SIZE);
+
+	while(count--) {
+		codec = &mmCodecs[random() % MM_CODEC_COUNT];
+		memset(&tlv, 0, sizeof(tlv));
+		memset(&m, 0, sizeof(m));
+		m.tlv = &tlv;
+		tlv.tlvType = TLV_MANAGEMENT;
+		tlv.managementId = codec->managementId;
+		tlv.dataField = msgArenaAlloc(&ptpClock->msgArena, codec->size);
+		randomData(tlv.dataField, codec->size);
+
+		if(codec->managementId == MM_CLOCK_DESCRIPTION) {
+			MMClockDescription *data = (MMClockDescription*)tlv.dataField;
+			randomText(&data->physicalLayerProtocol);
+			randomText(&data->productDescription);
+			randomText(&data->revisionData);
+			randomText(&data->userDescription);
+			data->physicalAddress.addressLength = PTP_UUID_LENGTH;
+			data->physicalAddress.addressField = msgArenaAlloc(&ptpClock->msgArena, PTP_UUID_LENGTH);
+			data->protocolAddress.addressLength = 4;
+			data->protocolAddress.addressField = msgArenaAlloc(&ptpClock->msgArena, 4);
+		} else if(codec->managementId == MM_USER_DESCRIPTION) {
+			randomText(&((MMUserDescription*)tlv.dataField)->userDescription);
+		}
+
+		memset(scratch, 0, sizeof(scratch));
+		msgPackManagementTLV(scratch, &m, ptpClock);
+		tlvLength = TL_LENGTH + tlv.lengthField;
+		if(length + tlvLength > PACKET_SIZE) {
+			break;
+		}
+		memcpy(buf + length, scratch + MANAGEMENT_LENGTH, tlvLength);
+		length += tlvLength;
+	}
+
+	memset(&m, 0, sizeof(m));
+	initHeader(&m.header, MANAGEMENT, length);
+	memset(&m.targetPortIdentity, 0xFF, sizeof(m.targetPortIdentity));
+	m.actionField = SET;
+	packMsgManagement(&m, buf);
+
+	msgArenaRelease(&ptpClock->msgArena, arenaMark);
+	return length;
+}
+
+static int
+generateSignaling(Octet *buf)
+{
+	static Octet scratch[PACKET_SIZE * 2];
+	MsgSignaling m;
+	SignalingTLV tlv;
+	const SMCodec *codec;
+	size_t arenaMark = msgArenaMark(&ptpClock->msgArena);
+	int length = SIGNALING_LENGTH;
+	int count = 1 + random() % 6;
+	int tlvLength;
+
+	memset(buf, 0, PACKET_SIZE);
+
+	while(count--) {
+		codec = &smCodecs[random() % SM_CODEC_COUNT];
+		memset(&tlv, 0, sizeof(tlv));
+		memset(&m, 0, sizeof(m));
+		m.tlv = &tlv;
+		tlv.tlvType = codec->tlvType;
+		tlv.valueField = msgArenaAlloc(&ptpClock->msgArena, codec->size);
+		randomData(tlv.valueField, codec->size);
+
+		memset(scratch, 0, sizeof(scratch));
+		msgPackSignalingTLV(scratch, &m, ptpClock);
+		tlvLength = TL_LENGTH + tlv.lengthField;
+		if(length + tlvLength > PACKET_SIZE) {
+			break;
+		}
+		memcpy(buf + length, scratch + SIGNALING_LENGTH, tlvLength);
+		length += tlvLength;
+	}
+
+	memset(&m, 0, sizeof(m));
+	initHeader(&m.header, SIGNALING, length);
+	memset(&m.targetPortIdentity, 0xFF, sizeof(m.targetPortIdentity));
+	packMsgSignaling(&m, buf);
+
+	msgArenaRelease(&ptpClock->msgArena, arenaMark);
+	return length;
+}
+
+/* flip bits, overwrite lengths and truncate - keeps most of the structure */
+static void
+mutate(Octet *buf, int length)
+{
+	int i, n = random() % 8;
+	int tail;
+	UInteger16 value;
+
+	for(i = 0; i < n; i++) {
+		switch(random() % 4) {
+		case 0:
+			buf[random() % length] ^= 1 << (random() % 8);
+			break;
+		case 1:
+			buf[random() % length] = random();
+			break;
+		case 2:
+			/* a 16-bit field - often a length */
+			value = flip16(random() % 2 ? random() % 512 : 0xFFFF);
+			memcpy(buf + random() % (length - 1), &value, 2);
+			break;
+		default:
+			/* zero part of the tail, as if the message was cut short */
+			tail = 1 + random() % (length - HEADER_LENGTH);
+			memset(buf + length - tail, 0, random() % tail);
+			break;
+		}
+	}
+}
+
+/* decode like processMessage(): through the message view length checks first */
+static int
+decodeMessage(const Octet *data, size_t size)
+{
+	MsgView view;
+	ssize_t length;
+
+	if(size < 1) {
+		return 0;
+	}
+	length = min(size - 1, PACKET_SIZE);
+	memset(rxBuf, 0, PACKET_SIZE);
+	memcpy(rxBuf, data + 1, length);
+	if(!msgViewInit(&view, rxBuf, length)) {
+		return 0;
+	}
+	return (data[0] & 1) ? decodeSignaling(rxBuf) : decodeManagement(rxBuf);
+}
+
+#ifdef MSGBENCH_LIBFUZZER
+
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+	if(ptpClock == NULL) {
+		initBenchClock();
+	}
+	decodeMessage((const Octet*)data, size);
+	return 0;
+}
+
+#else
+
+static void
+fuzz(long iterations)
+{
+	Octet input[1 + PACKET_SIZE];
+	long i, tlvs = 0;
+	int length;
+
+	for(i = 0; i < iterations; i++) {
+		input[0] = random() % 2;
+		length = input[0] ? generateSignaling(input + 1) : generateManagement(input + 1);
+		mutate(input + 1, length);
+		tlvs += decodeMessage(input, 1 + length);
+		if(ptpClock->msgArena.used != 0) {
+			fprintf(stderr, "arena not released after message %ld\n", i);
+			exit(1);
+		}
+	}
+
+	printf("fuzz: %ld messages, %ld TLVs decoded\n", iterations, tlvs);
+}
+
+static double
+nsNow(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1E9 + ts.tv_nsec;
+}
+
+#define BENCH(label, iterations, statement) \
+	do { \
+		long _i; \
+		double _start = nsNow(); \
+		for(_i = 0; _i < (iterations); _i++) { \
+			statement; \
+		} \
+		printf("%-32s %8.1f ns/message\n", label, (nsNow() - _start) / (iterations)); \
+	} while(0)
+
+static void
+bench(long iterations)
+{
+	static Octet buf[PACKET_SIZE];
+	Timestamp timestamp = { { 1452860000, 0 }, 123456789 };
+	MsgHeader header;
+	MsgAnnounce announce;
+	MsgSync sync;
+	MsgFollowUp followUp;
+	MsgDelayReq delayReq;
+	MsgDelayResp delayResp;
+	MsgPdelayResp pdelayResp;
+	Octet management[PACKET_SIZE];
+	Octet signaling[PACKET_SIZE];
+
+	msgPackSync(buf, 1, &timestamp, ptpClock);
+	msgUnpackHeader(buf, &header);
+
+	BENCH("pack header", iterations, msgPackHeader(buf, ptpClock));
+	BENCH("unpack header", iterations, msgUnpackHeader(buf, &header));
+	BENCH("pack Sync", iterations, msgPackSync(buf, _i, &timestamp, ptpClock));
+	BENCH("unpack Sync", iterations, msgUnpackSync(buf, &sync));
+	BENCH("pack Follow_Up", iterations, msgPackFollowUp(buf, &timestamp, ptpClock, _i));
+	BENCH("unpack Follow_Up", iterations, msgUnpackFollowUp(buf, &followUp));
+	BENCH("pack Delay_Req", iterations, msgPackDelayReq(buf, &timestamp, ptpClock));
+	BENCH("unpack Delay_Req", iterations, msgUnpackDelayReq(buf, &delayReq));
+	BENCH("pack Delay_Resp", iterations, msgPackDelayResp(buf, &header, &timestamp, ptpClock));
+	BENCH("unpack Delay_Resp", iterations, msgUnpackDelayResp(buf, &delayResp));
+	BENCH("pack Pdelay_Resp", iterations, msgPackPdelayResp(buf, &header, &timestamp, ptpClock));
+	BENCH("unpack Pdelay_Resp", iterations, msgUnpackPdelayResp(buf, &pdelayResp));
+	BENCH("pack Announce", iterations, msgPackAnnounce(buf, _i, &timestamp, ptpClock));
+	BENCH("unpack Announce", iterations, msgUnpackAnnounce(buf, &announce));
+
+	srandom(1);
+	generateManagement(management);
+	generateSignaling(signaling);
+	BENCH("generate management", iterations / 10, generateManagement(buf));
+	BENCH("unpack management (all TLVs)", iterations / 10,
+		memcpy(rxBuf, management, PACKET_SIZE); decodeManagement(rxBuf));
+	BENCH("generate signaling", iterations / 10, generateSignaling(buf));
+	BENCH("unpack signaling (all TLVs)", iterations / 10,
+		memcpy(rxBuf, signaling, PACKET_SIZE); decodeSignaling(rxBuf));
+}
+
+static void
+usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-b iterations] [-f iterations] [-s seed]\n"
+		"\n"
+		"Benchmark and fuzz the ptpd2 message codec (dep/msg.c).\n"
+		"\n"
+		"  -b  benchmark pack / unpack per message type (default 1000000 iterations)\n"
+		"  -f  decode n generated and mutated management / signaling messages\n"
+		"  -s  random seed for -f (default 1)\n",
+		name);
+}
+
+int
+main(int argc, char **argv)
+{
+	long benchIterations = 0, fuzzIterations = 0;
+	unsigned int seed = 1;
+	int c;
+
+	while((c = getopt(argc, argv, "b:f:s:h")) != -1) {
+		switch(c) {
+		case 'b':
+			benchIterations = strtol(optarg, NULL, 10);
+			break;
+		case 'f':
+			fuzzIterations = strtol(optarg, NULL, 10);
+			break;
+		case 's':
+			seed = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			usage(argv[0]);
+			return c == 'h' ? 0 : 1;
+		}
+	}
+
+	if(benchIterations <= 0 && fuzzIterations <= 0) {
+		benchIterations = 1000000;
+	}
+
+	initBenchClock();
+
+	if(benchIterations > 0) {
+		bench(benchIterations);
+	}
+
+	if(fuzzIterations > 0) {
+		srandom(seed);
+		fuzz(fuzzIterations);
+	}
+
+	return 0;
+}
+
+#endif /* MSGBENCH_LIBFUZZER */
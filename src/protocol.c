@@ -90,7 +90,7 @@ static void processSyncFromSelf(const TimeInternal * tint, const RunTimeOpts * r
 static void indexSync(TimeInternal *timeStamp, UInteger16 sequenceId, Integer32 transportAddress, SyncDestEntry *index);
 #endif /* PTPD_SLAVE_ONLY */
 
-static void processDelayReqFromSelf(const TimeInternal * tint, const RunTimeOpts * rtOpts, PtpClock * ptpClock);
+static void processDelayReqFromSelf(const TimeInternal * tint, const RunTimeOpts * rtOpts, PtpClock * ptpClock, const UInteger16 sequenceId);
 static void processPdelayReqFromSelf(const TimeInternal * tint, const RunTimeOpts * rtOpts, PtpClock * ptpClock);
 static void processPdelayRespFromSelf(const TimeInternal * tint, const RunTimeOpts * rtOpts, PtpClock * ptpClock, Integer32 dst, const UInteger16 sequenceId);
 
@@ -100,6 +100,13 @@ static void timestampCorrection(const RunTimeOpts * rtOpts, PtpClock *ptpClock,
 static Integer32 lookupSyncIndex(TimeInternal *timeStamp, UInteger16 sequenceId, SyncDestEntry *index);
 static Integer32 findSyncDestination(TimeInternal *timeStamp, const RunTimeOpts *rtOpts, PtpClock *ptpClock);
 
+static double getDelayReqInterval(const RunTimeOpts *rtOpts, PtpClock *ptpClock);
+
+static void recordExchange(PtpExchange *table, UInteger16 sequenceId, const PortIdentity *peer, const TimeInternal *timestamp, const TimeInternal *correctionField);
+static PtpExchange* matchExchange(PtpExchange *table, UInteger16 sequenceId, const PortIdentity *peer);
+
+static void setPortInterval(PtpClock *ptpClock, Integer8 *interval, Integer8 value);
+
 
 #ifndef PTPD_SLAVE_ONLY
 
@@ -159,6 +166,108 @@ lookupSyncIndex(TimeInternal *timeStamp, UInteger16 sequenceId, SyncDestEntry *i
 
 }
 
+/*
+ * Current Delay_Req interval (seconds): the minimum interval (master, grant or config),
+ * or with adaptive Delay_Req rate, the sparse interval once a burst is over
+ * and mean path delay is stable. Never faster than the minimum interval.
+ */
+static double
+getDelayReqInterval(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+    Integer8 logInterval = ptpClock->portDS.logMinDelayReqInterval;
+
+#ifdef PTPD_STATISTICS
+    if(rtOpts->delayReqAdaptive && ptpClock->delayReqBurstLeft <= 0 &&
+	ptpClock->slaveStats.mpdIsStable &&
+	rtOpts->logDelayReqIntervalSparse > logInterval) {
+	    logInterval = rtOpts->logDelayReqIntervalSparse;
+    }
+#endif /* PTPD_STATISTICS */
+
+    return pow(2, logInterval);
+
+}
+
+#ifdef PTPD_STATISTICS
+/* go back to sending Delay_Reqs at the minimum interval for a while */
+void
+startDelayReqBurst(const RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+
+    if(!rtOpts->delayReqAdaptive || ptpClock->portDS.delayMechanism != E2E) {
+	return;
+    }
+
+    DBG("Starting Delay_Req burst of %d messages\n", rtOpts->delayReqBurstLength);
+
+    ptpClock->delayReqBurstLeft = rtOpts->delayReqBurstLength;
+
+    /* do not wait for a sparse interval to run out */
+    if(ptpClock->portDS.portState == PTP_SLAVE && !ptpClock->syncWaiting) {
+	timerStart(&ptpClock->timers[DELAYREQ_INTERVAL_TIMER],
+	    pow(2,ptpClock->portDS.logMinDelayReqInterval) * getRand() * 2.0);
+    }
+
+}
+#endif /* PTPD_STATISTICS */
+
+/* set a port dataset message interval learnt from the wire, bumping the dataset generation on change */
+static void
+setPortInterval(PtpClock *ptpClock, Integer8 *interval, Integer8 value)
+{
+	if(*interval != value) {
+		*interval = value;
+		ptpClock->datasetGeneration++;
+	}
+}
+
+/* in-flight exchange table: record an exchange, replacing whatever was left in its slot */
+static void
+recordExchange(PtpExchange *table, UInteger16 sequenceId, const PortIdentity *peer, const TimeInternal *timestamp, const TimeInternal *correctionField)
+{
+
+    PtpExchange *entry = &table[sequenceId % EXCHANGE_TABLE_SIZE];
+
+    if(entry->inUse) {
+	DBG("recordExchange: sequence %d never completed - replaced by %d\n",
+	    entry->sequenceId, sequenceId);
+    }
+
+    entry->inUse = TRUE;
+    entry->sequenceId = sequenceId;
+    entry->peer = *peer;
+    entry->timestamp = *timestamp;
+
+    if(correctionField != NULL) {
+	entry->correctionField = *correctionField;
+    } else {
+	clearTime(&entry->correctionField);
+    }
+
+}
+
+/*
+ * in-flight exchange table: find and release the exchange for this sequenceId.
+ * Sequence numbers are per sender, so an exchange left over from a previous
+ * parent never pairs with the new parent's message of the same sequenceId.
+ */
+static PtpExchange*
+matchExchange(PtpExchange *table, UInteger16 sequenceId, const PortIdentity *peer)
+{
+
+    PtpExchange *entry = &table[sequenceId % EXCHANGE_TABLE_SIZE];
+
+    if(!entry->inUse || entry->sequenceId != sequenceId ||
+	cmpPortIdentity(&entry->peer, peer)) {
+	return NULL;
+    }
+
+    entry->inUse = FALSE;
+    return entry;
+
+}
+
 /* iterative search for Sync destination for the given cached timestamp */
 static Integer32
 findSyncDestination(TimeInternal *timeStamp, const RunTimeOpts *rtOpts, PtpClock *ptpClock)
@@ -322,6 +431,9 @@ protocol(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 			}
 		}
 
+		/* log what the other threads (SNMP agent, log writer) have handed over */
+		logWriterFlushDeferred();
+
 		/* Perform the heavy signal processing synchronously */
 		checkSignals(rtOpts, ptpClock);
 	}
@@ -356,7 +468,13 @@ void setPortState(PtpClock *ptpClock, Enumeration8 state)
 void
 toState(UInteger8 state, const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 {
+	PTPD_PROBE2(state__change, ptpClock->portDS.portState, state);
+
 	ptpClock->message_activity = TRUE;
+
+	/* BMC and re-initialisation rewrite the datasets the send templates use */
+	msgInvalidateTemplates(ptpClock);
+	ptpClock->datasetGeneration++;
 	
 	/* leaving state tasks */
 	switch (ptpClock->portDS.portState)
@@ -383,6 +501,14 @@ toState(UInteger8 state, const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 		timerStop(&ptpClock->timers[ANNOUNCE_RECEIPT_TIMER]);
 		timerStop(&ptpClock->timers[SYNC_RECEIPT_TIMER]);
 		timerStop(&ptpClock->timers[DELAY_RECEIPT_TIMER]);
+		timerStop(&ptpClock->timers[SERVO_UPDATE_TIMER]);
+
+#ifdef PTPD_STATISTICS
+		/* master lost - keep the clock on the predicted frequency (before initClock clears the offset) */
+		if(state != PTP_SLAVE) {
+			startHoldover(rtOpts, ptpClock);
+		}
+#endif /* PTPD_STATISTICS */
 		
 		if(rtOpts->unicastNegotiation && rtOpts->ipMode==IPMODE_UNICAST && ptpClock->parentGrants != NULL) {
 			/* do not cancel, just start re-requesting so we can still send a cancel on exit */
@@ -496,7 +622,7 @@ toState(UInteger8 state, const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 		
 	case PTP_DISABLED:
 		/* well, theoretically we're still in the previous state, so we're not in breach of standard */
-		if(rtOpts->unicastNegotiation && rtOpts->ipMode==IPMODE_UNICAST) {
+		if(rtOpts->unicastNegotiation && rtOpts->ipMode==IPMODE_UNICAST && !ptpClock->keepGrants) {
 		    cancelAllGrants(ptpClock->unicastGrants, ptpClock->unicastDestinationCount,
 				rtOpts, ptpClock);
 		}
@@ -646,6 +772,10 @@ toState(UInteger8 state, const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 		 * reset on failure or when -F 0 (default) is used, don't inform user
 		 */
 		restoreDrift(ptpClock, rtOpts, TRUE);
+#ifdef PTPD_STATISTICS
+		/* back from holdover: the servo continues from the predicted drift */
+		endHoldover(rtOpts, ptpClock);
+#endif /* PTPD_STATISTICS */
 
 		ptpClock->waitingForFollow = FALSE;
 		ptpClock->waitingForDelayResp = FALSE;
@@ -698,7 +828,6 @@ toState(UInteger8 state, const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 		ptpClock->announceTimeouts = 0;
 		setPortState(ptpClock, PTP_SLAVE);
 		displayStatus(ptpClock, "Now in state: ");
-		ptpClock->followUpGap = 0;
 
 #ifdef PTPD_STATISTICS
 		if(rtOpts->oFilterMSConfig.enabled) {
@@ -714,6 +843,10 @@ toState(UInteger8 state, const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 			resetDoubleMovingStatFilter(ptpClock->filterSM);
 		}
 		clearPtpEngineSlaveStats(&ptpClock->slaveStats);
+		resetClockStability(&ptpClock->stability);
+		resetPtpEngineHistograms(&ptpClock->histograms);
+		/* new master: measure path delay at the full rate first */
+		startDelayReqBurst(rtOpts, ptpClock);
 		ptpClock->servo.driftMean = 0;
 		ptpClock->servo.driftStdDev = 0;
 		ptpClock->servo.isStable = FALSE;
@@ -725,6 +858,8 @@ toState(UInteger8 state, const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 		resetDoublePermanentStdDev(&ptpClock->servo.driftStats);
 		timerStart(&ptpClock->timers[STATISTICS_UPDATE_TIMER], rtOpts->statsUpdateInterval);
 #endif /* PTPD_STATISTICS */
+		/* back to the parent we had before a restart: continue from the saved state */
+		applyWarmStart(rtOpts, ptpClock);
 		break;
 	default:
 		DBG("to unrecognized state\n");
@@ -733,6 +868,8 @@ toState(UInteger8 state, const RunTimeOpts *rtOpts, PtpClock *ptpClock)
 
 	if (rtOpts->logStatistics)
 		logStatistics(ptpClock);
+
+	updateStatsSegment(ptpClock);
 }
 
 
@@ -767,6 +904,11 @@ doInit(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 	initData(rtOpts, ptpClock);
 	initClock(rtOpts, ptpClock);
 	setupPIservo(&ptpClock->servo, rtOpts);
+#ifdef PTPD_STATISTICS
+	setupHoldover(&ptpClock->holdover, rtOpts);
+	resetClockStability(&ptpClock->stability);
+	resetPtpEngineHistograms(&ptpClock->histograms);
+#endif /* PTPD_STATISTICS */
 	/* restore observed drift and inform user */
 	if(ptpClock->defaultDS.clockQuality.clockClass > 127)
 		restoreDrift(ptpClock, rtOpts, FALSE);
@@ -775,6 +917,9 @@ doInit(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 	
 	toState(PTP_LISTENING, rtOpts, ptpClock);
 
+	/* state snapshot from the previous run, first init only - after the grant tables were initialised */
+	loadWarmStart(rtOpts, ptpClock);
+
 	if(rtOpts->statusLog.logEnabled)
 		writeStatusFile(ptpClock, rtOpts, TRUE);
 
@@ -786,6 +931,9 @@ static void
 doState(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 {
 	UInteger8 state;
+#ifndef PTPD_SLAVE_ONLY
+	TimePropertiesDS tpPrevious;
+#endif /* PTPD_SLAVE_ONLY */
 	
 	ptpClock->message_activity = FALSE;
 
@@ -1029,6 +1177,7 @@ doState(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 		 */
 
 		/* master leap second triggers */
+		tpPrevious = ptpClock->timePropertiesDS;
 
 		/* if we have an offset from some source, we assume it's valid */
 		if(ptpClock->clockStatus.utcOffset != 0) {
@@ -1047,6 +1196,10 @@ doState(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 		    ptpClock->timePropertiesDS.leap61 = FALSE;
 		}
 
+		if(memcmp(&tpPrevious, &ptpClock->timePropertiesDS, sizeof(TimePropertiesDS))) {
+		    ptpClock->datasetGeneration++;
+		}
+
 		if(ptpClock->timePropertiesDS.leap59 ||
 		    ptpClock->timePropertiesDS.leap61 ) {
 		    if(!ptpClock->leapSecondInProgress) {
@@ -1177,8 +1330,38 @@ doState(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 		periodicUpdate(rtOpts, ptpClock);
 	}
 
-        if(rtOpts->statusLog.logEnabled && timerExpired(&ptpClock->timers[STATUSFILE_UPDATE_TIMER])) {
-                writeStatusFile(ptpClock,rtOpts,TRUE);
+	if(ptpClock->portDS.portState == PTP_SLAVE && timerExpired(&ptpClock->timers[SERVO_UPDATE_TIMER])) {
+		runServoUpdate(rtOpts, ptpClock);
+	}
+
+#ifdef PTPD_STATISTICS
+	if(timerExpired(&ptpClock->timers[HOLDOVER_UPDATE_TIMER])) {
+		updateHoldover(rtOpts, ptpClock);
+	}
+#endif /* PTPD_STATISTICS */
+
+#ifdef PTPD_SNMP
+	if(rtOpts->snmpEnabled && timerExpired(&ptpClock->timers[SNMP_UPDATE_TIMER])) {
+		snmpUpdate(rtOpts, ptpClock);
+	}
+#endif /* PTPD_SNMP */
+
+	if(rtOpts->warmStart) {
+		if(timerExpired(&ptpClock->timers[WARMSTART_UPDATE_TIMER])) {
+			saveWarmStart(rtOpts, ptpClock, TRUE);
+			/* ensures that the current update interval is used */
+			timerStart(&ptpClock->timers[WARMSTART_UPDATE_TIMER], rtOpts->warmStartSaveInterval);
+		} else if(!timerRunning(&ptpClock->timers[WARMSTART_UPDATE_TIMER])) {
+			timerStart(&ptpClock->timers[WARMSTART_UPDATE_TIMER], rtOpts->warmStartSaveInterval);
+		}
+	}
+
+        if((rtOpts->statusLog.logEnabled || rtOpts->statsSegment) &&
+	    timerExpired(&ptpClock->timers[STATUSFILE_UPDATE_TIMER])) {
+		if(rtOpts->statusLog.logEnabled)
+			writeStatusFile(ptpClock,rtOpts,TRUE);
+		/* counters and alarms move without servo updates too */
+		updateStatsSegment(ptpClock);
 		/* ensures that the current updare interval is used */
 		timerStart(&ptpClock->timers[STATUSFILE_UPDATE_TIMER],rtOpts->statusFileUpdateInterval);
         }
@@ -1240,6 +1423,8 @@ processMessage(RunTimeOpts* rtOpts, PtpClock* ptpClock, TimeInternal* timeStamp,
 
     Boolean isFromSelf;
 
+    PTPD_PROBE1(msg__receive, length);
+
     /*
      * make sure we use the TAI to UTC offset specified, if the
      * master is sending the UTC_VALID bit
@@ -1261,8 +1446,9 @@ processMessage(RunTimeOpts* rtOpts, PtpClock* ptpClock, TimeInternal* timeStamp,
     }
 
     ptpClock->message_activity = TRUE;
-    if (length < HEADER_LENGTH) {
-	DBG("Error: message shorter than header length\n");
+    /* the only length check: handlers read fields through ptpClock->msgView */
+    if (!msgViewInit(&ptpClock->msgView, ptpClock->msgIbuf, length)) {
+	DBG("Error: message truncated or shorter than its minimum length (%d bytes)\n", (int)length);
 	ptpClock->counters.messageFormatErrors++;
 	return;
     }
@@ -1380,6 +1566,9 @@ processMessage(RunTimeOpts* rtOpts, PtpClock* ptpClock, TimeInternal* timeStamp,
     DBG("      ==> %s message received, sequence %d\n", getMessageTypeName(ptpClock->msgTmpHeader.messageType),
 							ptpClock->msgTmpHeader.sequenceId);
 
+    PTPD_PROBE3(msg__dispatch, ptpClock->msgTmpHeader.messageType,
+		ptpClock->msgTmpHeader.sequenceId, isFromSelf);
+
     /*
      *  on the table below, note that only the event messsages are passed the local time,
      *  (collected by us by loopback+kernel TS, and adjusted with UTC seconds
@@ -1435,6 +1624,9 @@ processMessage(RunTimeOpts* rtOpts, PtpClock* ptpClock, TimeInternal* timeStamp,
 	break;
     }
 
+    PTPD_PROBE2(msg__done, ptpClock->msgTmpHeader.messageType,
+		ptpClock->msgTmpHeader.sequenceId);
+
     if (rtOpts->displayPackets)
 	msgDump(ptpClock);
 
@@ -1489,7 +1681,7 @@ handle(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 	    if(ptpClock->leapSecondInProgress) {
 		DBG("Leap second in progress - will not process event message\n");
 	    } else {
-
+		latencyRxDispatch(rtOpts, ptpClock, &timeStamp);
 		processMessage(rtOpts, ptpClock, &timeStamp, length);
 	    }
 	}
@@ -1503,6 +1695,7 @@ handle(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 		ptpClock->counters.messageRecvErrors++;
 		return;
 	    }
+	    latencyRxDispatch(rtOpts, ptpClock, NULL);
 	    processMessage(rtOpts, ptpClock, &timeStamp, length);
 	}
     } else {
@@ -1519,6 +1712,7 @@ handle(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 	    if(ptpClock->leapSecondInProgress) {
 		DBG("Leap second in progress - will not process event message\n");
 	    } else {
+		latencyRxDispatch(rtOpts, ptpClock, &timeStamp);
 		processMessage(rtOpts, ptpClock, &timeStamp, length);
 	    }
 	}
@@ -1531,6 +1725,7 @@ handle(RunTimeOpts *rtOpts, PtpClock *ptpClock)
 		ptpClock->counters.messageRecvErrors++;
 		return;
 	    }
+	    latencyRxDispatch(rtOpts, ptpClock, NULL);
 	    processMessage(rtOpts, ptpClock, &timeStamp, length);
 	}
 #ifdef PTPD_PCAP
@@ -1550,11 +1745,6 @@ handleAnnounce(MsgHeader *header, ssize_t length,
 
 	DBGV("HandleAnnounce : Announce message received : \n");
 
-	if(length < ANNOUNCE_LENGTH) {
-		DBG("Error: Announce message too short\n");
-		ptpClock->counters.messageFormatErrors++;
-		return;
-	}
 
 	/* if we're ignoring announces (telecom) */
 	if(ptpClock->defaultDS.clockQuality.clockClass <= 127 && rtOpts->disableBMCA) {
@@ -1608,17 +1798,14 @@ handleAnnounce(MsgHeader *header, ssize_t length,
 
 		switch (isFromCurrentParent(ptpClock, header)) {
 		case TRUE:
+			/* the current master's fmr is the only persistent copy we need */
 	   		msgUnpackAnnounce(ptpClock->msgIbuf,
-					  &ptpClock->msgTmp.announce);
-
-			/* update datasets (file bmc.c) */
-	   		s1(header,&ptpClock->msgTmp.announce,ptpClock, rtOpts);
-
-			/* update current master in the fmr as well */
+					  &ptpClock->bestMaster->announce);
 			memcpy(&ptpClock->bestMaster->header,
 			       header,sizeof(MsgHeader));
-			memcpy(&ptpClock->bestMaster->announce,
-			       &ptpClock->msgTmp.announce,sizeof(MsgAnnounce));
+
+			/* update datasets (file bmc.c) */
+	   		s1(header,&ptpClock->bestMaster->announce,ptpClock, rtOpts);
 
 			if(ptpClock->leapSecondInProgress) {
 				/*
@@ -1650,6 +1837,7 @@ handleAnnounce(MsgHeader *header, ssize_t length,
 					}
 					ptpClock->timePropertiesDS.leap59 = FALSE;
 					ptpClock->timePropertiesDS.leap61 = FALSE;
+					ptpClock->datasetGeneration++;
 					ptpClock->clockStatus.leapInsert = FALSE;
 					ptpClock->clockStatus.leapDelete = FALSE;
 					ptpClock->clockStatus.update = TRUE;
@@ -1789,6 +1977,7 @@ handleSync(const MsgHeader *header, ssize_t length,
 
 	TimeInternal OriginTimestamp;
 	TimeInternal correctionField;
+	Timestamp timestamp;
 
 	Integer32 dst = 0;
 
@@ -1800,11 +1989,6 @@ handleSync(const MsgHeader *header, ssize_t length,
 
 	DBGV("Sync message received : \n");
 
-	if (length < SYNC_LENGTH) {
-		DBG("Error: Sync message too short\n");
-		ptpClock->counters.messageFormatErrors++;
-		return;
-	}
 
 	if(!isFromSelf && rtOpts->unicastNegotiation && rtOpts->ipMode == IPMODE_UNICAST) {
 	    UnicastGrantTable *nodeTable = NULL;
@@ -1877,12 +2061,12 @@ handleSync(const MsgHeader *header, ssize_t length,
 			    }
 			}
 
-			ptpClock->portDS.logSyncInterval = header->logMessageInterval;
+			setPortInterval(ptpClock, &ptpClock->portDS.logSyncInterval, header->logMessageInterval);
 
 			/* this will be 0x7F for unicast so if we have a grant, use the granted value */
 			if(rtOpts->unicastNegotiation && ptpClock->parentGrants
 				&& ptpClock->parentGrants->grantData[SYNC_INDEXED].granted) {
-				ptpClock->portDS.logSyncInterval =  ptpClock->parentGrants->grantData[SYNC_INDEXED].logInterval;
+				setPortInterval(ptpClock, &ptpClock->portDS.logSyncInterval, ptpClock->parentGrants->grantData[SYNC_INDEXED].logInterval);
 			}
 			
 
@@ -1890,31 +2074,25 @@ handleSync(const MsgHeader *header, ssize_t length,
 
 			if ((header->flagField0 & PTP_TWO_STEP) == PTP_TWO_STEP) {
 				DBG2("HandleSync: waiting for follow-up \n");
-				ptpClock->defaultDS.twoStepFlag=TRUE;
-				if(ptpClock->waitingForFollow) {
-				    ptpClock->followUpGap++;
-				    if(ptpClock->followUpGap < MAX_FOLLOWUP_GAP) {
-					DBG("Received Sync while waiting for follow-up - "
-					    "will wait for another %d messages\n",
-					    MAX_FOLLOWUP_GAP - ptpClock->followUpGap);
-					    break;		  
-				    }
-					DBG("No follow-up for %d sync - waiting for new follow-up\n",
-					    ptpClock->followUpGap);
+				if(!ptpClock->defaultDS.twoStepFlag) {
+					ptpClock->defaultDS.twoStepFlag=TRUE;
+					ptpClock->datasetGeneration++;
 				}
 
 				ptpClock->sync_receive_time.seconds = tint->seconds;
 				ptpClock->sync_receive_time.nanoseconds = tint->nanoseconds;
 
 				ptpClock->waitingForFollow = TRUE;
-				/*Save correctionField of Sync message*/
+				/*
+				 * Save receive time and correctionField of Sync message:
+				 * earlier Syncs stay in the table, so late or interleaved
+				 * Follow_Ups can still be matched
+				 */
 				integer64_to_internalTime(
 					header->correctionField,
 					&correctionField);
-				ptpClock->lastSyncCorrectionField.seconds =
-					correctionField.seconds;
-				ptpClock->lastSyncCorrectionField.nanoseconds =
-					correctionField.nanoseconds;
+				recordExchange(ptpClock->syncExchanges, header->sequenceId,
+					&header->sourcePortIdentity, tint, &correctionField);
 				ptpClock->recvSyncSequenceId =
 					header->sequenceId;
 				break;
@@ -1925,15 +2103,14 @@ handleSync(const MsgHeader *header, ssize_t length,
 
 				ptpClock->recvSyncSequenceId =
 					header->sequenceId;
-				msgUnpackSync(ptpClock->msgIbuf,
-					      &ptpClock->msgTmp.sync);
+				msgViewTimestamp(&ptpClock->msgView,
+						 SYNC_OFFSET_originTimestamp, &timestamp);
 				integer64_to_internalTime(
 					ptpClock->msgTmpHeader.correctionField,
 					&correctionField);
 				timeInternal_display(&correctionField);
 				ptpClock->waitingForFollow = FALSE;
-				toInternalTime(&OriginTimestamp,
-					       &ptpClock->msgTmp.sync.originTimestamp);
+				toInternalTime(&OriginTimestamp, &timestamp);
 				updateOffset(&OriginTimestamp,
 					     &ptpClock->sync_receive_time,
 					     &ptpClock->ofm_filt,rtOpts,
@@ -1941,11 +2118,14 @@ handleSync(const MsgHeader *header, ssize_t length,
 				checkOffset(rtOpts,ptpClock);
 				if (ptpClock->clockControl.updateOK) {
 					ptpClock->acceptedUpdates++;
-					updateClock(rtOpts,ptpClock);
+					queueClockUpdate(rtOpts,ptpClock);
 				}
 				ptpClock->offsetUpdates++;
 				
-				ptpClock->defaultDS.twoStepFlag=FALSE;
+				if(ptpClock->defaultDS.twoStepFlag) {
+					ptpClock->defaultDS.twoStepFlag=FALSE;
+					ptpClock->datasetGeneration++;
+				}
 				break;
 			}
 		} else {
@@ -1968,9 +2148,9 @@ handleSync(const MsgHeader *header, ssize_t length,
 
 			/* who do we send the followUp to? no destination given - try looking up index */
 			if((rtOpts->ipMode == IPMODE_UNICAST) && !dst) {
-				msgUnpackSync(ptpClock->msgIbuf,
-					      &ptpClock->msgTmp.sync);
-				toInternalTime(&OriginTimestamp, &ptpClock->msgTmp.sync.originTimestamp);
+				msgViewTimestamp(&ptpClock->msgView,
+						 SYNC_OFFSET_originTimestamp, &timestamp);
+				toInternalTime(&OriginTimestamp, &timestamp);
 			    dst = lookupSyncIndex(&OriginTimestamp, header->sequenceId, ptpClock->syncDestIndex);
 
 #ifdef RUNTIME_DEBUG
@@ -2022,15 +2202,11 @@ handleFollowUp(const MsgHeader *header, ssize_t length,
 {
 	TimeInternal preciseOriginTimestamp;
 	TimeInternal correctionField;
+	Timestamp timestamp;
+	PtpExchange *sync;
 
 	DBGV("Handlefollowup : Follow up message received \n");
 
-	if (length < FOLLOW_UP_LENGTH)
-	{
-		DBG("Error: Follow up message too short\n");
-		ptpClock->counters.messageFormatErrors++;
-		return;
-	}
 
 	if (isFromSelf)
 	{
@@ -2052,56 +2228,61 @@ handleFollowUp(const MsgHeader *header, ssize_t length,
 	case PTP_SLAVE:
 		if (isFromCurrentParent(ptpClock, header)) {
 			ptpClock->counters.followUpMessagesReceived++;
-			ptpClock->portDS.logSyncInterval = header->logMessageInterval;
+			setPortInterval(ptpClock, &ptpClock->portDS.logSyncInterval, header->logMessageInterval);
 			/* this will be 0x7F for unicast so if we have a grant, use the granted value */
 			if(rtOpts->unicastNegotiation && ptpClock->parentGrants
 				&& ptpClock->parentGrants->grantData[SYNC_INDEXED].granted) {
-				ptpClock->portDS.logSyncInterval =  ptpClock->parentGrants->grantData[SYNC_INDEXED].logInterval;
+				setPortInterval(ptpClock, &ptpClock->portDS.logSyncInterval, ptpClock->parentGrants->grantData[SYNC_INDEXED].logInterval);
 			}
 
-			if (ptpClock->waitingForFollow)	{
-				if (ptpClock->recvSyncSequenceId ==
-				     header->sequenceId) {
-					ptpClock->followUpGap = 0;
-					msgUnpackFollowUp(ptpClock->msgIbuf,
-							  &ptpClock->msgTmp.follow);
-					ptpClock->waitingForFollow = FALSE;
-					toInternalTime(&preciseOriginTimestamp,
-						       &ptpClock->msgTmp.follow.preciseOriginTimestamp);
-					integer64_to_internalTime(ptpClock->msgTmpHeader.correctionField,
-								  &correctionField);
-					addTime(&correctionField,&correctionField,
-						&ptpClock->lastSyncCorrectionField);
-
-					/*
-					send_time = preciseOriginTimestamp (received inside followup)
-					recv_time = sync_receive_time (received as CMSG in handleEvent)
-					*/
-					updateOffset(&preciseOriginTimestamp,
-						     &ptpClock->sync_receive_time,&ptpClock->ofm_filt,
-						     rtOpts,ptpClock,
-						     &correctionField);
-					checkOffset(rtOpts,ptpClock);
-					if (ptpClock->clockControl.updateOK) {
-						ptpClock->acceptedUpdates++;
-						updateClock(rtOpts,ptpClock);
-					}
-					ptpClock->offsetUpdates++;
+			sync = matchExchange(ptpClock->syncExchanges, header->sequenceId,
+					&header->sourcePortIdentity);
 
-					break;
+			if (sync != NULL) {
+				if (ptpClock->recvSyncSequenceId == header->sequenceId) {
+					ptpClock->waitingForFollow = FALSE;
 				} else {
-					    DBG("HandleFollowUp : sequence mismatch - "
+					DBG("HandleFollowUp : matched earlier Sync - "
 					    "last Sync: %d, this FollowUp: %d\n",
 					    ptpClock->recvSyncSequenceId,
 					    header->sequenceId);
-					    ptpClock->counters.sequenceMismatchErrors++;
-					    ptpClock->counters.discardedMessages++;
-					}
+				}
+				msgViewTimestamp(&ptpClock->msgView,
+						 FOLLOW_UP_OFFSET_preciseOriginTimestamp, &timestamp);
+				toInternalTime(&preciseOriginTimestamp, &timestamp);
+				integer64_to_internalTime(ptpClock->msgTmpHeader.correctionField,
+							  &correctionField);
+				addTime(&correctionField,&correctionField,
+					&sync->correctionField);
+
+				/*
+				send_time = preciseOriginTimestamp (received inside followup)
+				recv_time = receive time of the matching Sync (received as CMSG in handleEvent)
+				*/
+				updateOffset(&preciseOriginTimestamp,
+					     &sync->timestamp,&ptpClock->ofm_filt,
+					     rtOpts,ptpClock,
+					     &correctionField);
+				checkOffset(rtOpts,ptpClock);
+				if (ptpClock->clockControl.updateOK) {
+					ptpClock->acceptedUpdates++;
+					queueClockUpdate(rtOpts,ptpClock);
+				}
+				ptpClock->offsetUpdates++;
+
+				break;
+			} else if (ptpClock->waitingForFollow) {
+				DBG("HandleFollowUp : sequence mismatch - "
+				    "last Sync: %d, this FollowUp: %d\n",
+				    ptpClock->recvSyncSequenceId,
+				    header->sequenceId);
+				ptpClock->counters.sequenceMismatchErrors++;
+				ptpClock->counters.discardedMessages++;
 			} else {
 				DBG2("Ignored followup, Slave was not waiting a follow up "
 				     "message \n");
 				ptpClock->counters.discardedMessages++;
-				}
+			}
 		} else {
 			DBG2("Ignored, Follow up message is not from current parent \n");
 			ptpClock->counters.discardedMessages++;
@@ -2153,11 +2334,6 @@ handleDelayReq(const MsgHeader *header, ssize_t length,
 
 		DBG("delayReq message received : \n");
 		
-		if (length < DELAY_REQ_LENGTH) {
-			DBG("Error: DelayReq message too short\n");
-			ptpClock->counters.messageFormatErrors++;
-			return;
-		}
 
 		switch (ptpClock->portDS.portState) {
 		case PTP_INITIALIZING:
@@ -2174,8 +2350,9 @@ handleDelayReq(const MsgHeader *header, ssize_t length,
 			if (isFromSelf)	{
 				DBG("==> Handle DelayReq (%d)\n",
 					 header->sequenceId);
-				if ( ((UInteger16)(header->sequenceId + 1)) !=
-					ptpClock->sentDelayReqSequenceId) {
+				/* any Delay_Req still covered by the exchange table is fine */
+				if ( ((UInteger16)(ptpClock->sentDelayReqSequenceId - header->sequenceId - 1)) >=
+					EXCHANGE_TABLE_SIZE) {
 					DBG("HandledelayReq : sequence mismatch - "
 					    "last DelayReq sent: %d, received: %d\n",
 					    ptpClock->sentDelayReqSequenceId,
@@ -2193,13 +2370,11 @@ handleDelayReq(const MsgHeader *header, ssize_t length,
 
 				/*
 				 *  Make sure we process the REQ
-				 *  _before_ the RESP. While we could
-				 *  do this by any order, (because
-				 *  it's implicitly indexed by
-				 *  (ptpClock->sentDelayReqSequenceId
-				 *  - 1), this is now made explicit
+				 *  _before_ the RESP: the RESP is
+				 *  matched against the exchange
+				 *  recorded here by its sequenceId
 				 */
-				processDelayReqFromSelf(tint, rtOpts, ptpClock);
+				processDelayReqFromSelf(tint, rtOpts, ptpClock, header->sequenceId);
 
 				break;
 			} else {
@@ -2235,7 +2410,7 @@ handleDelayReq(const MsgHeader *header, ssize_t length,
 
 
 static void
-processDelayReqFromSelf(const TimeInternal * tint, const RunTimeOpts * rtOpts, PtpClock * ptpClock) {
+processDelayReqFromSelf(const TimeInternal * tint, const RunTimeOpts * rtOpts, PtpClock * ptpClock, const UInteger16 sequenceId) {
 
 
 	ptpClock->waitingForDelayResp = TRUE;
@@ -2247,6 +2422,10 @@ processDelayReqFromSelf(const TimeInternal * tint, const RunTimeOpts * rtOpts, P
 	addTime(&ptpClock->delay_req_send_time,
 		&ptpClock->delay_req_send_time,
 		&rtOpts->outboundLatency);
+
+	/* several Delay_Reqs can be outstanding - the Delay_Resp is matched by sequenceId */
+	recordExchange(ptpClock->delayReqExchanges, sequenceId,
+		&ptpClock->parentDS.parentPortIdentity, &ptpClock->delay_req_send_time, NULL);
 	
 	DBGV("processDelayReqFromSelf: %s %d\n",
 	    dump_TimeInternal(&ptpClock->delay_req_send_time),
@@ -2264,6 +2443,8 @@ handleDelayResp(const MsgHeader *header, ssize_t length,
 
 		TimeInternal requestReceiptTimestamp;
 		TimeInternal correctionField;
+		Timestamp timestamp;
+		PtpExchange *delayReq;
 
 		if(rtOpts->unicastNegotiation && rtOpts->ipMode == IPMODE_UNICAST) {
 		    UnicastGrantTable *nodeTable = NULL;
@@ -2279,11 +2460,6 @@ handleDelayResp(const MsgHeader *header, ssize_t length,
 
 		DBGV("delayResp message received : \n");
 
-		if(length < DELAY_RESP_LENGTH) {
-			DBG("Error: DelayResp message too short\n");
-			ptpClock->counters.messageFormatErrors++;
-			return;
-		}
 
 		switch(ptpClock->portDS.portState) {
 		case PTP_INITIALIZING:
@@ -2295,31 +2471,28 @@ handleDelayResp(const MsgHeader *header, ssize_t length,
 			ptpClock->counters.discardedMessages++;
 			return;
 		case PTP_SLAVE:
-			msgUnpackDelayResp(ptpClock->msgIbuf,
-					   &ptpClock->msgTmp.resp);
-
-			if ((memcmp(ptpClock->portDS.portIdentity.clockIdentity,
-				    ptpClock->msgTmp.resp.requestingPortIdentity.clockIdentity,
-				    CLOCK_IDENTITY_LENGTH) == 0) &&
-			    (ptpClock->portDS.portIdentity.portNumber ==
-			     ptpClock->msgTmp.resp.requestingPortIdentity.portNumber)
+			/* in multicast most responses are for other slaves - match in place */
+			if (msgViewPortIdentityEqual(&ptpClock->msgView,
+				    DELAY_RESP_OFFSET_requestingPortIdentity,
+				    &ptpClock->portDS.portIdentity)
 			    && isFromCurrentParent(ptpClock, header)) {
 				DBG("==> Handle DelayResp (%d)\n",
 					 header->sequenceId);
 
 				timerStart(&ptpClock->timers[DELAY_RECEIPT_TIMER], max(
 				    (ptpClock->portDS.announceReceiptTimeout) * (pow(2,ptpClock->portDS.logAnnounceInterval)),
-					MISSED_MESSAGES_MAX * (pow(2,ptpClock->portDS.logMinDelayReqInterval))));
+					MISSED_MESSAGES_MAX * getDelayReqInterval(rtOpts, ptpClock)));
 
-				if (!ptpClock->waitingForDelayResp) {
-					DBG("Ignored DelayResp sequence %d - wasn't waiting for one\n",
-						header->sequenceId);
-					ptpClock->counters.discardedMessages++;
-					break;
-				}
+				delayReq = matchExchange(ptpClock->delayReqExchanges, header->sequenceId,
+						&header->sourcePortIdentity);
 
-				if (ptpClock->sentDelayReqSequenceId !=
-				((UInteger16)(header->sequenceId + 1))) {
+				if (delayReq == NULL) {
+					if (!ptpClock->waitingForDelayResp) {
+						DBG("Ignored DelayResp sequence %d - wasn't waiting for one\n",
+							header->sequenceId);
+						ptpClock->counters.discardedMessages++;
+						break;
+					}
 					DBG("HandledelayResp : sequence mismatch - "
 					    "last DelayReq sent: %d, delayResp received: %d\n",
 					    ptpClock->sentDelayReqSequenceId,
@@ -2331,10 +2504,17 @@ handleDelayResp(const MsgHeader *header, ssize_t length,
 				}
 
 				ptpClock->counters.delayRespMessagesReceived++;
-				ptpClock->waitingForDelayResp = FALSE;
+				if (ptpClock->sentDelayReqSequenceId ==
+				    ((UInteger16)(header->sequenceId + 1))) {
+					ptpClock->waitingForDelayResp = FALSE;
+				}
 
-				toInternalTime(&requestReceiptTimestamp,
-					       &ptpClock->msgTmp.resp.receiveTimestamp);
+				/* send time of the Delay_Req this response belongs to */
+				ptpClock->delay_req_send_time = delayReq->timestamp;
+
+				msgViewTimestamp(&ptpClock->msgView,
+						 DELAY_RESP_OFFSET_receiveTimestamp, &timestamp);
+				toInternalTime(&requestReceiptTimestamp, &timestamp);
 				ptpClock->delay_req_receive_time.seconds =
 					requestReceiptTimestamp.seconds;
 				ptpClock->delay_req_receive_time.nanoseconds =
@@ -2369,14 +2549,14 @@ handleDelayResp(const MsgHeader *header, ssize_t length,
 							    NOTICE("Received Delay Interval %d from master\n",
 							    ptpClock->parentGrants->grantData[DELAY_RESP_INDEXED].logInterval);
 						    }
-						    ptpClock->portDS.logMinDelayReqInterval = ptpClock->parentGrants->grantData[DELAY_RESP_INDEXED].logInterval;
+						    setPortInterval(ptpClock, &ptpClock->portDS.logMinDelayReqInterval, ptpClock->parentGrants->grantData[DELAY_RESP_INDEXED].logInterval);
 						} else {
 
 						    if(ptpClock->delayRespWaiting) {
 							    NOTICE("Received Delay Interval %d from master (unicast-unknown) - overriding with %d\n",
 							    header->logMessageInterval, rtOpts->logMinDelayReqInterval);
 						    }
-						    ptpClock->portDS.logMinDelayReqInterval = rtOpts->logMinDelayReqInterval;
+						    setPortInterval(ptpClock, &ptpClock->portDS.logMinDelayReqInterval, rtOpts->logMinDelayReqInterval);
 
 						}	
 					} else {
@@ -2386,7 +2566,7 @@ handleDelayResp(const MsgHeader *header, ssize_t length,
 							     header->logMessageInterval, ptpClock->portDS.logMinDelayReqInterval );
 
 						    // collect new value indicated by the Master
-						    ptpClock->portDS.logMinDelayReqInterval = header->logMessageInterval;
+						    setPortInterval(ptpClock, &ptpClock->portDS.logMinDelayReqInterval, header->logMessageInterval);
 						}
 					/* FIXME: the actual rearming of this timer with the new value only happens later in doState()/issueDelayReq() */
 				    }
@@ -2396,12 +2576,12 @@ handleDelayResp(const MsgHeader *header, ssize_t length,
 						INFO("New Delay Request interval applied: %d (was: %d)\n",
 							rtOpts->logMinDelayReqInterval, ptpClock->portDS.logMinDelayReqInterval);
 					}
-					ptpClock->portDS.logMinDelayReqInterval = rtOpts->logMinDelayReqInterval;
+					setPortInterval(ptpClock, &ptpClock->portDS.logMinDelayReqInterval, rtOpts->logMinDelayReqInterval);
 				}
 				/* arm the timer again now that we have the correct delayreq interval */
 				timerStart(&ptpClock->timers[DELAY_RECEIPT_TIMER], max(
 				    (ptpClock->portDS.announceReceiptTimeout) * (pow(2,ptpClock->portDS.logAnnounceInterval)),
-					MISSED_MESSAGES_MAX * (pow(2,ptpClock->portDS.logMinDelayReqInterval))));
+					MISSED_MESSAGES_MAX * getDelayReqInterval(rtOpts, ptpClock)));
 			} else {
 
 				DBG("HandledelayResp : delayResp doesn't match with the delayReq. \n");
@@ -2450,11 +2630,6 @@ handlePdelayReq(MsgHeader *header, ssize_t length,
 
 		DBGV("PdelayReq message received : \n");
 
-		if(length < PDELAY_REQ_LENGTH) {
-			DBG("Error: PdelayReq message too short\n");
-			ptpClock->counters.messageFormatErrors++;
-			return;
-		}
 
 		switch (ptpClock->portDS.portState ) {
 		case PTP_INITIALIZING:
@@ -2536,11 +2711,6 @@ handlePdelayResp(const MsgHeader *header, TimeInternal *tint,
 	
 		DBG("PdelayResp message received : \n");
 
-		if (length < PDELAY_RESP_LENGTH) {
-			DBG("Error: PdelayResp message too short\n");
-			ptpClock->counters.messageFormatErrors++;
-			return;
-		}
 
 		switch (ptpClock->portDS.portState ) {
 		case PTP_INITIALIZING:
@@ -2609,14 +2779,14 @@ handlePdelayResp(const MsgHeader *header, TimeInternal *tint,
 							    NOTICE("Received Peer Delay Interval %d from peer\n",
 							    ptpClock->peerGrants.grantData[PDELAY_RESP_INDEXED].logInterval);
 						    }
-						    ptpClock->portDS.logMinPdelayReqInterval = ptpClock->peerGrants.grantData[PDELAY_RESP_INDEXED].logInterval;
+						    setPortInterval(ptpClock, &ptpClock->portDS.logMinPdelayReqInterval, ptpClock->peerGrants.grantData[PDELAY_RESP_INDEXED].logInterval);
 						} else {
 
 						    if(ptpClock->delayRespWaiting) {
 							    NOTICE("Received Peer Delay Interval %d from peer (unicast-unknown) - overriding with %d\n",
 							    header->logMessageInterval, rtOpts->logMinPdelayReqInterval);
 						    }
-						    ptpClock->portDS.logMinPdelayReqInterval = rtOpts->logMinPdelayReqInterval;
+						    setPortInterval(ptpClock, &ptpClock->portDS.logMinPdelayReqInterval, rtOpts->logMinPdelayReqInterval);
 
 						}	
 					} else {
@@ -2626,7 +2796,7 @@ handlePdelayResp(const MsgHeader *header, TimeInternal *tint,
 							     header->logMessageInterval, ptpClock->portDS.logMinPdelayReqInterval );
 
 						    // collect new value indicated by the Master
-						    ptpClock->portDS.logMinPdelayReqInterval = header->logMessageInterval;
+						    setPortInterval(ptpClock, &ptpClock->portDS.logMinPdelayReqInterval, header->logMessageInterval);
 				    }
 				} else {
 
@@ -2634,7 +2804,7 @@ handlePdelayResp(const MsgHeader *header, TimeInternal *tint,
 						INFO("New Peer Delay Request interval applied: %d (was: %d)\n",
 							rtOpts->logMinPdelayReqInterval, ptpClock->portDS.logMinPdelayReqInterval);
 					}
-					ptpClock->portDS.logMinPdelayReqInterval = rtOpts->logMinPdelayReqInterval;
+					setPortInterval(ptpClock, &ptpClock->portDS.logMinPdelayReqInterval, rtOpts->logMinPdelayReqInterval);
 				}
 				
 				}
@@ -2693,11 +2863,6 @@ handlePdelayRespFollowUp(const MsgHeader *header, ssize_t length,
 	
 		DBG("PdelayRespfollowup message received : \n");
 	
-		if(length < PDELAY_RESP_FOLLOW_UP_LENGTH) {
-			DBG("Error: PdelayRespfollowup message too short\n");
-			ptpClock->counters.messageFormatErrors++;
-			return;
-		}	
 	
 		switch(ptpClock->portDS.portState) {
 		case PTP_INITIALIZING:
@@ -2751,14 +2916,14 @@ handlePdelayRespFollowUp(const MsgHeader *header, ssize_t length,
 							    NOTICE("Received Peer Delay Interval %d from peer\n",
 							    ptpClock->peerGrants.grantData[PDELAY_RESP_INDEXED].logInterval);
 						    }
-						    ptpClock->portDS.logMinPdelayReqInterval = ptpClock->peerGrants.grantData[PDELAY_RESP_INDEXED].logInterval;
+						    setPortInterval(ptpClock, &ptpClock->portDS.logMinPdelayReqInterval, ptpClock->peerGrants.grantData[PDELAY_RESP_INDEXED].logInterval);
 						} else {
 
 						    if(ptpClock->delayRespWaiting) {
 							    NOTICE("Received Peer Delay Interval %d from peer (unicast-unknown) - overriding with %d\n",
 							    header->logMessageInterval, rtOpts->logMinPdelayReqInterval);
 						    }
-						    ptpClock->portDS.logMinPdelayReqInterval = rtOpts->logMinPdelayReqInterval;
+						    setPortInterval(ptpClock, &ptpClock->portDS.logMinPdelayReqInterval, rtOpts->logMinPdelayReqInterval);
 
 						}	
 					} else {
@@ -2768,7 +2933,7 @@ handlePdelayRespFollowUp(const MsgHeader *header, ssize_t length,
 							     header->logMessageInterval, ptpClock->portDS.logMinPdelayReqInterval );
 
 						    // collect new value indicated by the Master
-						    ptpClock->portDS.logMinPdelayReqInterval = header->logMessageInterval;
+						    setPortInterval(ptpClock, &ptpClock->portDS.logMinPdelayReqInterval, header->logMessageInterval);
 				    }
 				} else {
 
@@ -2776,7 +2941,7 @@ handlePdelayRespFollowUp(const MsgHeader *header, ssize_t length,
 						INFO("New Peer Delay Request interval applied: %d (was: %d)\n",
 							rtOpts->logMinPdelayReqInterval, ptpClock->portDS.logMinPdelayReqInterval);
 					}
-					ptpClock->portDS.logMinPdelayReqInterval = rtOpts->logMinPdelayReqInterval;
+					setPortInterval(ptpClock, &ptpClock->portDS.logMinPdelayReqInterval, rtOpts->logMinPdelayReqInterval);
 				}
 
 /* pdelay interval handling end */
@@ -2930,6 +3095,8 @@ issueSync(const RunTimeOpts *rtOpts,PtpClock *ptpClock)
 	UnicastGrantData *grant = NULL;
 	Boolean okToSend = TRUE;
 
+	latencyTxSync(rtOpts, ptpClock);
+
 	/* send Sync to Ethernet or multicast */
 	if(rtOpts->transport == IEEE_802_3 || (rtOpts->ipMode != IPMODE_UNICAST)) {
 		(void)issueSyncSingle(dst, &ptpClock->sentSyncSequenceId, rtOpts, ptpClock);
@@ -3150,7 +3317,7 @@ issueDelayReq(const RunTimeOpts *rtOpts,PtpClock *ptpClock)
 				internalTime.seconds += ptpClock->timePropertiesDS.currentUtcOffset;
 			}			
 			
-			processDelayReqFromSelf(&internalTime, rtOpts, ptpClock);
+			processDelayReqFromSelf(&internalTime, rtOpts, ptpClock, ptpClock->sentDelayReqSequenceId);
 		}
 #endif
 
@@ -3159,12 +3326,18 @@ issueDelayReq(const RunTimeOpts *rtOpts,PtpClock *ptpClock)
 				internalTime.seconds += ptpClock->timePropertiesDS.currentUtcOffset;
 			}			
 			
-			processDelayReqFromSelf(&internalTime, rtOpts, ptpClock);
+			processDelayReqFromSelf(&internalTime, rtOpts, ptpClock, ptpClock->sentDelayReqSequenceId);
 #endif
 
 		ptpClock->sentDelayReqSequenceId++;
 		ptpClock->counters.delayReqMessagesSent++;
 
+#ifdef PTPD_STATISTICS
+		if(ptpClock->delayReqBurstLeft > 0) {
+			ptpClock->delayReqBurstLeft--;
+		}
+#endif /* PTPD_STATISTICS */
+
 		/* From now on, we will only accept delayreq and
 		 * delayresp of (sentDelayReqSequenceId - 1) */
 
@@ -3174,7 +3347,7 @@ issueDelayReq(const RunTimeOpts *rtOpts,PtpClock *ptpClock)
 		 */
 
 		timerStart(&ptpClock->timers[DELAYREQ_INTERVAL_TIMER],
-		   pow(2,ptpClock->portDS.logMinDelayReqInterval) * getRand() * 2.0);
+		   getDelayReqInterval(rtOpts, ptpClock) * getRand() * 2.0);
 #if 0 /* PCAP ONLY */
 		msgUnpackHeader(ptpClock->msgObuf, &ourDelayReq);
 		handleDelayReq(&ourDelayReq, DELAY_REQ_LENGTH, &internalTime,
@@ -3363,7 +3536,7 @@ addForeign(Octet *buf,MsgHeader *header,PtpClock *ptpClock, UInteger8 localPrefe
 			ptpClock->foreign[j].foreignMasterAnnounceMessages++;
 			found = TRUE;
 			DBGV("addForeign : AnnounceMessage incremented \n");
-			msgUnpackHeader(buf,&ptpClock->foreign[j].header);
+			ptpClock->foreign[j].header = *header;
 			msgUnpackAnnounce(buf,&ptpClock->foreign[j].announce);
 			ptpClock->foreign[j].disqualified = FALSE;
 			ptpClock->foreign[j].localPreference = localPreference;
@@ -3401,7 +3574,7 @@ addForeign(Octet *buf,MsgHeader *header,PtpClock *ptpClock, UInteger8 localPrefe
 		 * header and announce field of each Foreign Master are
 		 * usefull to run Best Master Clock Algorithm
 		 */
-		msgUnpackHeader(buf,&ptpClock->foreign[j].header);
+		ptpClock->foreign[j].header = *header;
 		msgUnpackAnnounce(buf,&ptpClock->foreign[j].announce);
 		DBGV("New foreign Master added \n");
 		
@@ -3429,6 +3602,9 @@ updateDatasets(PtpClock* ptpClock, const RunTimeOpts* rtOpts)
 	memset(ptpClock->userDescription, 0, sizeof(ptpClock->userDescription));
 	memcpy(ptpClock->userDescription, rtOpts->portDescription, strlen(rtOpts->portDescription));
 
+	msgInvalidateTemplates(ptpClock);
+	ptpClock->datasetGeneration++;
+
 	switch(ptpClock->portDS.portState) {
 
 		/* We are master so update both the port and the parent dataset */
@@ -3522,6 +3698,7 @@ clearCounters(PtpClock * ptpClock)
 	/* TODO: print port info */
 	DBG("Port counters cleared\n");
 	memset(&ptpClock->counters, 0, sizeof(ptpClock->counters));
+	resetLatencyProbes(&ptpClock->latency);
 }
 
 Boolean
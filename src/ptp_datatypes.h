@@ -587,6 +587,8 @@ typedef struct {
     ParentDS 		parentDS;
     ForeignMasterRecord bestMaster;
     Integer32		ofmAlarmThreshold;
+    UInteger32		holdoverSeconds;	/* time spent in holdover */
+    Integer32		holdoverTimeError;	/* estimated holdover time error, ns */
 } PtpEventData;
 
 #endif /*PTP_DATATYPES_H_*/
@@ -43,6 +43,15 @@
 
 #include "ptpd.h"
 
+static double
+monotonicSeconds(void)
+{
+	TimeInternal now;
+
+	getTimeMonotonic(&now);
+	return timeInternalToDouble(&now);
+}
+
 void
 timerStop(IntervalTimer * itimer)
 {
@@ -67,6 +76,8 @@ timerStart(IntervalTimer * itimer, double interval)
 	EventTimer* timer = (EventTimer *)(itimer->data);
 
 	timer->start(timer, interval);
+
+	itimer->deadline = monotonicSeconds() + interval;
 }
 
 Boolean
@@ -77,8 +88,19 @@ timerExpired(IntervalTimer * itimer)
 		return FALSE;
 
 	EventTimer *timer = (EventTimer *)(itimer->data);
+	double late;
+
+	if(!timer->isExpired(timer)) {
+		return FALSE;
+	}
+
+	/* move on to the next deadline, counting any we have slept through */
+	late = monotonicSeconds() - itimer->deadline;
+	itimer->overruns = (late > itimer->interval) ? late / itimer->interval : 0;
+	itimer->lastDeadline = itimer->deadline + itimer->overruns * itimer->interval;
+	itimer->deadline = itimer->lastDeadline + itimer->interval;
 
-	return timer->isExpired(timer);
+	return TRUE;
 }
 
 Boolean
@@ -118,12 +140,18 @@ Boolean timerSetup(IntervalTimer *itimers)
   "PERIODIC_INFO_TIMER",
 #ifdef PTPD_STATISTICS
   "STATISTICS_UPDATE",
+  "HOLDOVER_UPDATE",
 #endif /* PTPD_STATISTICS */
   "ALARM_UPDATE",
   "MASTER_NETREFRESH",
   "CALIBRATION_DELAY",
   "CLOCK_UPDATE",
-  "TIMINGDOMAIN_UPDATE"
+  "SERVO_UPDATE",
+  "TIMINGDOMAIN_UPDATE",
+  "WARMSTART_UPDATE",
+#ifdef PTPD_SNMP
+  "SNMP_UPDATE"
+#endif /* PTPD_SNMP */
     };
 
     int i = 0;
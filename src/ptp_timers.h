@@ -48,6 +48,11 @@ typedef struct {
 	double interval;
 	Boolean expired;
 	Boolean running;
+	/* monotonic seconds: next expiry due, and the one timerExpired() last reported */
+	double deadline;
+	double lastDeadline;
+	/* expiries missed before the last one was reported */
+	uint32_t overruns;
 	/* hook for a generic timer object that can be assigned */
 	void *data;
 } IntervalTimer;
@@ -75,12 +80,18 @@ enum {
   PERIODIC_INFO_TIMER,	   /* timer used for dumping periodic status updates */
 #ifdef PTPD_STATISTICS
   STATISTICS_UPDATE_TIMER, /* online mean / std dev updare interval (non-moving statistics) */
+  HOLDOVER_UPDATE_TIMER,   /* applies the predicted frequency while in holdover */
 #endif /* PTPD_STATISTICS */
   ALARM_UPDATE_TIMER,
   MASTER_NETREFRESH_TIMER,
   CALIBRATION_DELAY_TIMER,
   CLOCK_UPDATE_TIMER,
+  SERVO_UPDATE_TIMER,	   /* fixed-rate servo updates from queued offsets */
   TIMINGDOMAIN_UPDATE_TIMER,
+  WARMSTART_UPDATE_TIMER,   /* periodic warm start state snapshot */
+#ifdef PTPD_SNMP
+  SNMP_UPDATE_TIMER,	   /* publishes a fresh SNMP table snapshot */
+#endif /* PTPD_SNMP */
   PTP_MAX_TIMER
 };
 
@@ -123,6 +123,10 @@ main(int argc, char **argv)
 
 	startupInProgress = FALSE;
 
+	/* threads do not survive daemon(), so the log writer starts only now */
+	if(rtOpts.logAsync)
+		logWriterStart();
+
 	/* global variable for message(), please see comment on top of this file */
 	G_ptpClock = ptpClock;
 
@@ -171,6 +171,13 @@
 #endif
 
 #include "dep/ptpd_dep.h"
+#include "dep/msglayout.h"
+#include "dep/msgview.h"
+#include "dep/logwriter.h"
+#include "dep/sockserver.h"
+#include "dep/statslog.h"
+#include "dep/statsshm.h"
+#include "dep/probes.h"
 #include "dep/iniparser/dictionary.h"
 #include "dep/iniparser/iniparser.h"
 #include "dep/daemonconfig.h"
@@ -187,6 +194,14 @@
 		exit(1); \
 	}
 
+/* same as XMALLOC, but from the per-message TLV arena - see MSG_ARENA_SIZE */
+#define ARENA_ALLOC(ptr,size) \
+	if(!((ptr)=msgArenaAlloc(&ptpClock->msgArena, size))) { \
+		CRITICAL("message arena exhausted\n"); \
+		ptpdShutdown(ptpClock); \
+		exit(1); \
+	}
+
 #define SAFE_FREE(pointer) \
 	if(pointer != NULL) { \
 		free(pointer); \
@@ -315,6 +330,9 @@ void initData(RunTimeOpts*,PtpClock*);
 void protocol(RunTimeOpts*,PtpClock*);
 void updateDatasets(PtpClock* ptpClock, const RunTimeOpts* rtOpts);
 void setPortState(PtpClock *ptpClock, Enumeration8 state);
+#ifdef PTPD_STATISTICS
+void startDelayReqBurst(const RunTimeOpts *rtOpts, PtpClock *ptpClock);
+#endif /* PTPD_STATISTICS */
 
 Boolean acceptPortIdentity(PortIdentity thisPort, PortIdentity targetPort);
 
@@ -0,0 +1,244 @@
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file    shmstat.c
+ * @authors The PTPd Project
+ * @date   Mon Jan 11 09:12:37 2016
+ * ptpd2-shmstat: print the shared memory statistics segment published
+ * by ptpd with global:stats_segment enabled.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_SHM_OPEN
+#include <sys/mman.h>
+#endif /* HAVE_SHM_OPEN */
+
+#include "dep/statsshm.h"
+
+#define READ_TRIES 1000
+
+static const char *portStateNames[] = {
+	"UNKNOWN", "INITIALIZING", "FAULTY", "DISABLED", "LISTENING", "PRE_MASTER",
+	"MASTER", "PASSIVE", "UNCALIBRATED", "SLAVE"
+};
+
+static const char *alarmStateNames[] = {
+	"UNSET", "SET", "CLEARED"
+};
+
+static void
+usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-w seconds] [-c count] [-1] <interface | /segment_name>\n"
+		"\n"
+		"Print the statistics segment published by ptpd2 with global:stats_segment.\n"
+		"An interface name is expanded to the default segment name /ptpd2.<interface>.\n"
+		"\n"
+		"  -w  repeat every n seconds\n"
+		"  -c  stop after n samples (with -w)\n"
+		"  -1  print one CSV line per sample instead of the full listing\n",
+		name);
+}
+
+static void
+printIdentity(const uint8_t *id, int port)
+{
+	int i;
+	for(i = 0; i < 8; i++) {
+		printf("%02x%s", id[i], i < 7 ? ":" : "");
+	}
+	if(port >= 0) {
+		printf("/%d", port);
+	}
+}
+
+static const char*
+stateName(int state)
+{
+	return state < sizeof(portStateNames) / sizeof(portStateNames[0]) ?
+		portStateNames[state] : "UNKNOWN";
+}
+
+static void
+printFull(const PtpdStatsSegment *seg, const PtpdStatsSnapshot *d)
+{
+	int i;
+
+	printf("%-32s: %s (PID %u)\n", "interface", seg->interfaceName, seg->pid);
+	printf("%-32s: %" PRId64 ".%09" PRId64 "\n", "updateTime",
+		d->updateTime / 1000000000, d->updateTime % 1000000000);
+	printf("%-32s: %u\n", "updateCount", d->updateCount);
+	printf("%-32s: %s\n", "portState", stateName(d->portState));
+	printf("%-32s: ", "portIdentity");
+	printIdentity(d->clockIdentity, d->portNumber);
+	printf("\n%-32s: ", "parentPortIdentity");
+	printIdentity(d->parentClockIdentity, d->parentPortNumber);
+	printf("\n%-32s: ", "grandmasterIdentity");
+	printIdentity(d->grandmasterIdentity, -1);
+	printf("\n%-32s: %d\n", "domainNumber", d->domainNumber);
+	printf("%-32s: %s\n", "delayMechanism", (d->flags & STATSSHM_FLAG_P2P) ? "P2P" : "E2E");
+	printf("%-32s: %" PRId64 " ns\n", "offsetFromMaster", d->offsetFromMaster);
+	printf("%-32s: %" PRId64 " ns\n", "meanPathDelay", d->meanPathDelay);
+	printf("%-32s: %.03f ppb\n", "observedDrift", d->observedDrift);
+	printf("%-32s: %s%s%s%s\n", "flags",
+		(d->flags & STATSSHM_FLAG_SERVO_STABLE) ? "servoStable " : "",
+		(d->flags & STATSSHM_FLAG_SERVO_MAXOUTPUT) ? "servoMaxOutput " : "",
+		(d->flags & STATSSHM_FLAG_DELAY_STABLE) ? "delayStable " : "",
+		(d->flags & STATSSHM_FLAG_HOLDOVER) ? "holdover " : "");
+
+	if(d->flags & STATSSHM_FLAG_STATISTICS) {
+		printf("%-32s: %.09f s\n", "mpdMean", d->mpdMean);
+		printf("%-32s: %.09f s\n", "mpdStdDev", d->mpdStdDev);
+		printf("%-32s: %.09f s\n", "ofmMean", d->ofmMean);
+		printf("%-32s: %.09f s\n", "ofmStdDev", d->ofmStdDev);
+		printf("%-32s: %.03f ppb\n", "driftMean", d->driftMean);
+		printf("%-32s: %.03f ppb\n", "driftStdDev", d->driftStdDev);
+	}
+
+	for(i = 0; i < seg->counterCount && i < STATSSHM_MAX_COUNTERS; i++) {
+		printf("%-32.*s: %u\n", STATSSHM_NAME_LENGTH, seg->counterNames[i], d->counters[i]);
+	}
+
+	for(i = 0; i < seg->alarmCount && i < STATSSHM_MAX_ALARMS; i++) {
+		printf("alarm.%-26.*s: %s\n", STATSSHM_NAME_LENGTH, seg->alarmNames[i],
+			d->alarmState[i] < 3 ? alarmStateNames[d->alarmState[i]] : "UNKNOWN");
+	}
+}
+
+static void
+printLine(const PtpdStatsSnapshot *d)
+{
+	printf("%" PRId64 ".%09" PRId64 ", %s, %" PRId64 ", %" PRId64 ", %.03f\n",
+		d->updateTime / 1000000000, d->updateTime % 1000000000,
+		stateName(d->portState), d->offsetFromMaster, d->meanPathDelay,
+		d->observedDrift);
+}
+
+int
+main(int argc, char **argv)
+{
+#ifdef HAVE_SHM_OPEN
+	int c, fd;
+	int interval = 0, count = 0, oneLine = 0;
+	char name[256];
+	struct stat st;
+	const PtpdStatsSegment *seg;
+	PtpdStatsSnapshot data;
+
+	while((c = getopt(argc, argv, "w:c:1h")) != -1) {
+		switch(c) {
+		case 'w':
+			interval = atoi(optarg);
+			break;
+		case 'c':
+			count = atoi(optarg);
+			break;
+		case '1':
+			oneLine = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return (c == 'h') ? 0 : 1;
+		}
+	}
+
+	if(optind != argc - 1) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if(argv[optind][0] == '/') {
+		snprintf(name, sizeof(name), "%s", argv[optind]);
+	} else {
+		snprintf(name, sizeof(name), "/ptpd2.%s", argv[optind]);
+	}
+
+	if((fd = shm_open(name, O_RDONLY, 0)) < 0) {
+		perror(name);
+		return 2;
+	}
+
+	if(fstat(fd, &st) < 0 || st.st_size < sizeof(PtpdStatsSegment)) {
+		fprintf(stderr, "%s: not a ptpd statistics segment\n", name);
+		return 2;
+	}
+
+	seg = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(seg == MAP_FAILED) {
+		perror(name);
+		return 2;
+	}
+
+	if(!statsShmValid(seg)) {
+		fprintf(stderr, "%s: incompatible or inactive statistics segment\n", name);
+		return 2;
+	}
+
+	if(oneLine) {
+		printf("# Update time, State, Offset From Master (ns), One Way Delay (ns), Observed Drift (ppb)\n");
+	}
+
+	for(;;) {
+		if(!statsShmRead(seg, &data, READ_TRIES)) {
+			fprintf(stderr, "%s: could not get a consistent snapshot\n", name);
+			return 3;
+		}
+		if(oneLine) {
+			printLine(&data);
+		} else {
+			printFull(seg, &data);
+		}
+		fflush(stdout);
+		if(interval <= 0 || (count > 0 && --count == 0)) {
+			break;
+		}
+		if(!oneLine) {
+			printf("\n");
+		}
+		sleep(interval);
+	}
+
+	return 0;
+#else
+	fprintf(stderr, "%s: shared memory is not supported on this platform\n", argv[0]);
+	return 1;
+#endif /* HAVE_SHM_OPEN */
+}
@@ -293,7 +293,7 @@ initOutgoingMsgSignaling(PortIdentity* targetPortIdentity, MsgSignaling* outgoin
 	copyPortIdentity( &outgoing->targetPortIdentity, targetPortIdentity);
 
 	/* init managementTLV */
-	XMALLOC(outgoing->tlv, sizeof(SignalingTLV));
+	ARENA_ALLOC(outgoing->tlv, sizeof(SignalingTLV));
 	outgoing->tlv->valueField = NULL;
 	outgoing->tlv->lengthField = 0;
 }
@@ -319,7 +319,7 @@ handleSMRequestUnicastTransmission(MsgSignaling* incoming, MsgSignaling* outgoin
 	snprint_PortIdentity(portId, PATH_MAX, &incoming->header.sourcePortIdentity);
 
 	initOutgoingMsgSignaling(&incoming->header.sourcePortIdentity, outgoing, ptpClock);
-	XMALLOC(outgoing->tlv->valueField, sizeof(SMGrantUnicastTransmission));
+	ARENA_ALLOC(outgoing->tlv->valueField, sizeof(SMGrantUnicastTransmission));
 	grantData = (SMGrantUnicastTransmission*)outgoing->tlv->valueField;
 
         outgoing->header.flagField0 |= PTP_UNICAST;
@@ -417,6 +417,8 @@ handleSMRequestUnicastTransmission(MsgSignaling* incoming, MsgSignaling* outgoin
 	    myGrant->cancelCount = 0;
 	    myGrant->logInterval = grantData->logInterMessagePeriod;
 
+	    PTPD_PROBE5(grant__create, messageType, sourceAddress, myGrant->duration, myGrant->logInterval, TRUE);
+
 	    /* this could be the very first grant for this node - update node's timeLeft so it's not seen as free anymore */
 	    if(nodeTable->timeLeft <= 0) {
 		/* + 10 seconds for a grace period */
@@ -524,6 +526,8 @@ handleSMGrantUnicastTransmission(MsgSignaling* incoming, Integer32 sourceAddress
 	myGrant->canceled = FALSE;
 	myGrant->cancelCount = 0;
 
+	PTPD_PROBE5(grant__create, messageType, sourceAddress, myGrant->duration, myGrant->logInterval, FALSE);
+
 }
 
 /**\brief Handle incoming CANCEL_UNICAST_TRANSMISSION signaling message type*/
@@ -549,7 +553,7 @@ handleSMCancelUnicastTransmission(MsgSignaling* incoming, MsgSignaling* outgoing
 	outgoing->tlv->tlvType = TLV_ACKNOWLEDGE_CANCEL_UNICAST_TRANSMISSION;
 	outgoing->tlv->lengthField = 2;
 
-	XMALLOC(outgoing->tlv->valueField, sizeof(SMAcknowledgeCancelUnicastTransmission));
+	ARENA_ALLOC(outgoing->tlv->valueField, sizeof(SMAcknowledgeCancelUnicastTransmission));
 	acknowledgeData = (SMAcknowledgeCancelUnicastTransmission*)outgoing->tlv->valueField;
 	snprint_PortIdentity(portId, PATH_MAX, &incoming->header.sourcePortIdentity);
 
@@ -690,7 +694,7 @@ prepareSMRequestUnicastTransmission(MsgSignaling* outgoing, UnicastGrantData *gr
 
 	SMRequestUnicastTransmission* requestData = NULL;
 
-	XMALLOC(outgoing->tlv->valueField, sizeof(SMRequestUnicastTransmission));
+	ARENA_ALLOC(outgoing->tlv->valueField, sizeof(SMRequestUnicastTransmission));
 	requestData = (SMRequestUnicastTransmission*)outgoing->tlv->valueField;
 
 	requestData->messageType = grant->messageType;
@@ -722,7 +726,7 @@ prepareSMCancelUnicastTransmission(MsgSignaling* outgoing, UnicastGrantData* gra
 
 	SMCancelUnicastTransmission* cancelData = NULL;
 
-	XMALLOC(outgoing->tlv->valueField, sizeof(SMCancelUnicastTransmission));
+	ARENA_ALLOC(outgoing->tlv->valueField, sizeof(SMCancelUnicastTransmission));
 	cancelData = (SMCancelUnicastTransmission*)outgoing->tlv->valueField;
 
 	grant->requested = FALSE;
@@ -926,6 +930,7 @@ updateUnicastGrantTable(UnicastGrantTable *grantTable, int nodeCount, const RunT
 static void
 requestUnicastTransmission(UnicastGrantData *grant, UInteger32 duration, const RunTimeOpts* rtOpts, PtpClock* ptpClock)
 {
+	size_t arenaMark = msgArenaMark(&ptpClock->msgArena);
 
 	if(duration == 0) {
 		DBG("Will not request unicast transmission for 0 duration\n");
@@ -952,15 +957,18 @@ requestUnicastTransmission(UnicastGrantData *grant, UInteger32 duration, const R
 			grant->expired = FALSE;
 	}
 
-	/* cleanup msgTmp signalingTLV */
-	freeSignalingTLV(&ptpClock->msgTmp.signaling);
-	/* cleanup outgoing signalingTLV */
+	/*
+	 * cleanup outgoing signalingTLV - msgTmp is left alone, this can be
+	 * called while an incoming message is still being handled
+	 */
 	freeSignalingTLV(&ptpClock->outgoingSignalingTmp);
+	msgArenaRelease(&ptpClock->msgArena, arenaMark);
 }
 
 void
 cancelUnicastTransmission(UnicastGrantData* grant, const const RunTimeOpts* rtOpts, PtpClock* ptpClock)
 {
+	size_t arenaMark = msgArenaMark(&ptpClock->msgArena);
 
 /* todo: dbg sending */
 
@@ -972,10 +980,12 @@ cancelUnicastTransmission(UnicastGrantData* grant, const const RunTimeOpts* rtOp
 			ptpClock->counters.unicastGrantsCancelSent++;
 	}
 
-	/* cleanup msgTmp signalingTLV */
-	freeSignalingTLV(&ptpClock->msgTmp.signaling);
-	/* cleanup outgoing signalingTLV */
+	/*
+	 * cleanup outgoing signalingTLV - msgTmp is left alone, this can be
+	 * called while an incoming message is still being handled
+	 */
 	freeSignalingTLV(&ptpClock->outgoingSignalingTmp);
+	msgArenaRelease(&ptpClock->msgArena, arenaMark);
 }
 
 static void
@@ -1055,6 +1065,8 @@ handleSignaling(MsgHeader *header,
 
 	int tlvOffset = 0;
 	int tlvFound = 0;
+	/* every TLV and its response are decoded / built in the arena */
+	size_t arenaMark = msgArenaMark(&ptpClock->msgArena);
 
 	/* loop over all supported TLVs as if they came in separate messages */
 	while(msgUnpackSignaling(ptpClock->msgIbuf,&ptpClock->msgTmp.signaling, header, ptpClock, tlvOffset)) {
@@ -1183,6 +1195,7 @@ handleSignaling(MsgHeader *header,
 	freeSignalingTLV(&ptpClock->msgTmp.signaling);
 	/* cleanup outgoing signalingTLV */
 	freeSignalingTLV(&ptpClock->outgoingSignalingTmp);
+	msgArenaRelease(&ptpClock->msgArena, arenaMark);
 	}
 
     	if(!tlvFound) {
@@ -1248,6 +1261,8 @@ refreshUnicastGrants(UnicastGrantTable *grantTable, int nodeCount, const RunTime
 		     */
 		    if(grantData->timeLeft <= 5) {
 			DBG("grant for message %s expired\n", getMessageTypeName(grantData->messageType));
+			if(!grantData->expired)
+			    PTPD_PROBE2(grant__expire, grantData->messageType, nodeTable->transportAddress);
 			grantData->expired = TRUE;
 		    } else {
 			if(grantData->timeLeft > maxTime) {
@@ -0,0 +1,231 @@
+/*-
+ * Copyright (c) 2016 The PTPd Project
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file    statsdecode.c
+ * @authors The PTPd Project
+ * @date   Sun Jan 10 12:41:52 2016
+ * ptpd2-statsdecode: convert binary statistics logs written with
+ * global:statistics_log_format=binary into CSV.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <unistd.h>
+
+#include "dep/statslog.h"
+
+/* PTP port state names, indexed by portState as in constants.h */
+static const char *portStateNames[] = {
+	"unk", "init", "flt", "dsbl", "lstn", "pmst", "mst", "pass", "uncl", "slv"
+};
+
+static int nanoseconds = 0;
+static int quiet = 0;
+
+static void
+usage(const char *name)
+{
+	fprintf(stderr,
+		"usage: %s [-n] [-q] [file ...]\n"
+		"\n"
+		"Convert binary ptpd statistics logs to CSV on standard output.\n"
+		"Reads standard input if no files are given.\n"
+		"\n"
+		"  -n  print times as integer nanoseconds instead of seconds\n"
+		"  -q  do not print file header records as comments\n",
+		name);
+}
+
+static void
+printTime(int64_t ns)
+{
+	if(nanoseconds) {
+		printf("%" PRId64, ns);
+	} else {
+		printf("%s%" PRId64 ".%09" PRId64, ns < 0 ? "-" : "",
+			(ns < 0 ? -ns : ns) / 1000000000, (ns < 0 ? -ns : ns) % 1000000000);
+	}
+}
+
+static void
+printColumns(void)
+{
+	printf("# Unix timestamp, State, Sequence ID, Last packet Received, "
+		"Offset From Master, One Way Delay, Master to Slave, Slave to Master, "
+		"raw delayMS, raw delaySM, Observed Drift, Flags\n");
+}
+
+static void
+printHeader(const StatsLogHeader *hdr)
+{
+	int i;
+
+	if(quiet) {
+		return;
+	}
+
+	printf("# ptpd statistics log v%d, started %" PRIu32 ".%09" PRIu32 ", port ",
+		hdr->version, hdr->seconds, hdr->nanoseconds);
+	for(i = 0; i < 8; i++) {
+		printf("%02x%s", hdr->clockIdentity[i], i < 7 ? ":" : "");
+	}
+	printf("/%d, domain %d, %s%s\n", hdr->portNumber, hdr->domainNumber,
+		hdr->delayMechanism == 2 ? "P2P" : "E2E",
+		(hdr->flags & STATSLOG_HDR_STATISTICS) ? ", statistics" : "");
+	printColumns();
+}
+
+static void
+printSample(const StatsLogSample *smp)
+{
+	printTime((int64_t)smp->seconds * 1000000000 + smp->nanoseconds);
+	printf(", %s, %05d, %c, ",
+		smp->portState < sizeof(portStateNames) / sizeof(portStateNames[0]) ?
+		    portStateNames[smp->portState] : "unk",
+		smp->sequenceId, smp->lastMessage ? smp->lastMessage : '-');
+	printTime(smp->offsetFromMaster);
+	printf(", ");
+	printTime(smp->meanPathDelay);
+	printf(", ");
+	printTime(smp->delayMS);
+	printf(", ");
+	printTime(smp->delaySM);
+	printf(", ");
+	printTime(smp->rawDelayMS);
+	printf(", ");
+	printTime(smp->rawDelaySM);
+	printf(", %.09f, 0x%04x\n", smp->observedDrift, smp->flags);
+}
+
+/* decode one stream, return number of records that could not be decoded */
+static long
+decodeFile(FILE *in, const char *name)
+{
+	unsigned char buf[65536];
+	StatsLogHeader hdr;
+	StatsLogSample smp;
+	size_t stride = STATSLOG_RECORD_SIZE;
+	size_t got;
+	long errors = 0;
+	int seenHeader = 0;
+
+	/* records are never larger than 64k, but newer versions may be larger than ours */
+	while((got = fread(buf, 1, STATSLOG_RECORD_SIZE, in)) == STATSLOG_RECORD_SIZE) {
+
+		if(statsLogUnpackHeader(buf, &hdr)) {
+			if(hdr.recordSize < STATSLOG_RECORD_SIZE) {
+				fprintf(stderr, "%s: invalid record size %d\n", name, hdr.recordSize);
+				return ++errors;
+			}
+			if(hdr.recordSize > STATSLOG_RECORD_SIZE &&
+			    fread(buf + STATSLOG_RECORD_SIZE, 1, hdr.recordSize - STATSLOG_RECORD_SIZE, in) !=
+			    hdr.recordSize - STATSLOG_RECORD_SIZE) {
+				break;
+			}
+			stride = hdr.recordSize;
+			seenHeader = 1;
+			printHeader(&hdr);
+			continue;
+		}
+
+		/* skip any trailing bytes of newer, larger records */
+		if(stride > STATSLOG_RECORD_SIZE &&
+		    fread(buf + STATSLOG_RECORD_SIZE, 1, stride - STATSLOG_RECORD_SIZE, in) !=
+		    stride - STATSLOG_RECORD_SIZE) {
+			break;
+		}
+
+		if(buf[0] != STATSLOG_RECORD_SAMPLE) {
+			errors++;
+			continue;
+		}
+
+		if(!seenHeader) {
+			printColumns();
+			seenHeader = 1;
+		}
+
+		statsLogUnpackSample(buf, &smp);
+		printSample(&smp);
+
+	}
+
+	if(got != 0 && got != STATSLOG_RECORD_SIZE) {
+		fprintf(stderr, "%s: ignoring truncated record at end of file\n", name);
+	}
+
+	if(errors) {
+		fprintf(stderr, "%s: %ld records could not be decoded\n", name, errors);
+	}
+
+	return errors;
+}
+
+int
+main(int argc, char **argv)
+{
+	int c, i;
+	long errors = 0;
+	FILE *in;
+
+	while((c = getopt(argc, argv, "nqh")) != -1) {
+		switch(c) {
+		case 'n':
+			nanoseconds = 1;
+			break;
+		case 'q':
+			quiet = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return (c == 'h') ? 0 : 1;
+		}
+	}
+
+	if(optind >= argc) {
+		errors += decodeFile(stdin, "stdin");
+	}
+
+	for(i = optind; i < argc; i++) {
+		if((in = fopen(argv[i], "rb")) == NULL) {
+			perror(argv[i]);
+			errors++;
+			continue;
+		}
+		errors += decodeFile(in, argv[i]);
+		fclose(in);
+	}
+
+	return errors ? 2 : 0;
+}
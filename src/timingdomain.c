@@ -400,11 +400,8 @@ ptpServiceClockUpdate (TimingService* service)
 	TimeInternal newTime, oldTime;
 
 #ifdef HAVE_SYS_TIMEX_H
-	int flags = getTimexFlags();
-
-	Boolean leapInsert = flags & STA_INS;
-	Boolean leapDelete = flags & STA_DEL;
-	Boolean inSync = !(flags & STA_UNSYNC);
+	int flags;
+	Boolean leapInsert, leapDelete, inSync;
 #endif /* HAVE_SYS_TIMEX_H */
 
 	ClockStatusInfo *clockStatus = &ptpClock->clockStatus;
@@ -416,6 +413,17 @@ ptpServiceClockUpdate (TimingService* service)
 
 	DBG_LOCAL_ID(service, "clock status update\n");
 
+#ifdef HAVE_SYS_TIMEX_H
+	/* all kernel clock changes below are applied with a single adjtimex() */
+	clockActuatorBegin();
+
+	flags = getTimexFlags();
+
+	leapInsert = flags & STA_INS;
+	leapDelete = flags & STA_DEL;
+	inSync = !(flags & STA_UNSYNC);
+#endif /* HAVE_SYS_TIMEX_H */
+
 #if defined(MOD_TAI) &&  NTP_API == 4
 	setKernelUtcOffset(clockStatus->utcOffset);
 
@@ -462,6 +470,8 @@ ptpServiceClockUpdate (TimingService* service)
 		unsetTimexFlags(STA_DEL, TRUE);
 	}
     }
+
+	clockActuatorCommit();
 #else
 	if(clockStatus->leapInsert || clockStatus->leapDelete) {
 		if(rtOpts->leapSecondHandling != LEAP_SMEAR) {